@@ -0,0 +1,62 @@
+/*
+ * Arquivo: AnelConsistente.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define a classe AnelConsistente, um anel de hash
+ * consistente usado para distribuir os caminhões (truck ids) entre vários
+ * processos hospedeiros da frota (ver HostFrota.h).
+ *
+ * Funcionamento:
+ * - Cada host é colocado no anel em 'vnodes' posições (nós virtuais), obtidas
+ * pelo hash de "<host>#<k>". Os nós virtuais equilibram a carga mesmo com
+ * poucos hosts.
+ * - O dono de um caminhão é o primeiro nó virtual no sentido horário a partir
+ * do hash do truck id.
+ * - Quando um host entra ou sai, só mudam de dono os caminhões cujos hashes
+ * caem nos arcos daquele host (~1/N da frota), o que minimiza a quantidade
+ * de estado que precisa ser transferida.
+ *
+ * Determinismo:
+ * - O hash (FNV-1a 64 bits + mistura splitmix64) não depende da plataforma
+ * nem da ordem de inserção: todos os hosts calculam o mesmo dono a partir
+ * da mesma lista de membros.
+ */
+
+#pragma once
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+class AnelConsistente
+{
+public:
+    explicit AnelConsistente(int vnodes = 64);
+
+    // Adiciona/remove um host (idempotente).
+    void adicionar_host(const std::string& host);
+    void remover_host(const std::string& host);
+
+    // Substitui o conjunto completo de hosts.
+    void definir_hosts(const std::set<std::string>& hosts);
+
+    // Host dono do caminhão; string vazia se o anel estiver vazio.
+    std::string dono(int truck_id) const;
+
+    // Caminhões de 'candidatos' cujo dono é 'host'.
+    std::vector<int> caminhoes_de(const std::string& host, const std::vector<int>& candidatos) const;
+
+    const std::set<std::string>& hosts() const { return hosts_; }
+
+    // Hash estável usado no anel (exposto para diagnóstico).
+    static uint64_t hash(const std::string& chave);
+
+private:
+    int vnodes_;
+    std::set<std::string> hosts_;
+    std::map<uint64_t, std::string> anel_; // posição -> host
+};
+
+// Interpreta listas de caminhões como "1-20" ou "1,2,5-8" (ordem preservada,
+// sem repetição). Ids inválidos são ignorados.
+std::vector<int> parse_lista_caminhoes(const std::string& spec);
@@ -30,6 +30,7 @@
 
 #include <atomic>  // Inclui a biblioteca para suporte a tipos atômicos
 #include <mutex>   // Inclui a biblioteca para suporte a mutexes
+#include "PerfilLocks.h" // MutexAtr (lock instrumentável)
 
 // ---------- Estados ----------
 struct EstadosCaminhao {
@@ -58,6 +59,6 @@ struct AtuadoresCaminhao {
 extern EstadosCaminhao  ESTADO;  // Declaração externa da variável ESTADO
 extern ComandosCaminhao COMANDO; // Declaração externa da variável COMANDO
 extern AtuadoresCaminhao ATUADOR; // Declaração externa da variável ATUADOR
-extern std::mutex state_mtx;   // Declaração externa do mutex state_mtx
+extern MutexAtr state_mtx;     // Declaração externa do mutex state_mtx
 
 #endif
\ No newline at end of file
@@ -22,15 +22,44 @@
  * - push_force(const T& v) / push_force(T&& v): Insere um elemento no buffer.
  * Se estiver cheio, sobrescreve o elemento mais antigo. Não bloqueia.
  * - push_wait(const T& v) / push_wait(T&& v): Insere um elemento no buffer.
- * Se estiver cheio, bloqueia a thread até que haja espaço.
+ * Se estiver cheio, bloqueia a thread até que haja espaço (false se fechado).
+ * - try_push(const T& v): Insere se houver espaço (ou um consumidor à espera).
+ * Retorna false se cheio. Não bloqueia.
  * - try_pop(T& out): Tenta remover o elemento mais antigo do buffer. Retorna
  * true se conseguiu, false se o buffer estava vazio. Não bloqueia.
  * - pop_wait(T& out): Remove o elemento mais antigo do buffer. Se estiver
- * vazio, bloqueia a thread até que haja um elemento disponível.
+ * vazio, bloqueia a thread até que haja um elemento disponível (false se
+ * fechado vazio).
  * - size(): Retorna o número atual de elementos no buffer.
  * - capacity(): Retorna a capacidade total do buffer.
  * - empty(): Retorna true se o buffer estiver vazio, false caso contrário.
  * - clear(): Esvazia o buffer.
+ * - fechar(): Encerra o buffer (ver "Encerramento").
+ *
+ * Awaitables (corrotinas C++20, ver Executor.h):
+ * - co_await pop(): remove o elemento mais antigo, suspendendo enquanto vazio.
+ * - co_await pop_for(timeout): idem, retornando std::optional<T> (nullopt no
+ * timeout).
+ * - co_await push(v): insere, suspendendo enquanto cheio; false se o buffer
+ * foi fechado.
+ * - co_await push_for(v, timeout): idem, false também no timeout.
+ * Um elemento inserido com o buffer vazio é entregue diretamente à corrotina
+ * que espera há mais tempo; um pop com produtores suspensos admite o valor
+ * do produtor mais antigo. Threads bloqueadas (pop_wait*) e corrotinas podem
+ * usar o mesmo buffer.
+ *
+ * Encerramento:
+ * - fechar() retoma na hora as corrotinas suspensas em pop()/pop_for()/
+ * push()/push_for() e acorda as threads em pop_wait/push_wait, todas com
+ * resultado de falha (nullopt ou false; pop() lança BufferFechado). Assim um
+ * produtor parado num buffer cheio cujo consumidor já terminou não prende o
+ * desligamento. Depois de fechado, as inserções falham e as remoções ainda
+ * entregam o que restou, falhando (sem esperar) quando o buffer esvazia.
+ *
+ * Perfil de contenção:
+ * - O mutex interno é do tipo MutexAtr (PerfilLocks.h). Com a opção de
+ * compilação ATR_LOCK_PROFILING, cada buffer registra aquisições, contenção
+ * e tempos de espera/posse sob o nome passado ao construtor.
  */
 
 #pragma once
@@ -47,14 +76,27 @@
 #include <optional>
 #include <cstddef>
 #include <stdexcept>
+#include <deque>
+#include <coroutine>
+
+#include "PerfilLocks.h" // MutexAtr / CondVarAtr
+#include "Executor.h"    // EsperaAssincrona
+
+// Lançada por co_await pop() quando o buffer é fechado vazio.
+struct BufferFechado : std::runtime_error
+{
+    BufferFechado() : std::runtime_error("BufferCircular fechado") {}
+};
 
 template<typename T>
 class BufferCircular
 {
 public:
     // Construtor: Inicializa o buffer com a capacidade especificada.
-    explicit BufferCircular(size_t cap)
+    // 'nome' identifica o lock interno no perfil de contenção (PerfilLocks.h).
+    explicit BufferCircular(size_t cap, const char* nome = "BufferCircular")
     {
+        nomear_lock(mtx_, nome);
         if (cap == 0) throw std::invalid_argument("BufferCircular capacity must be > 0");
         data_.resize(cap); // Aloca espaço para os elementos
         cap_ = cap;        // Define a capacidade
@@ -66,7 +108,10 @@ public:
     // push_force (copia): Insere um elemento, sobrescrevendo se necessário.
     void push_force(const T& v)
     {
-        std::lock_guard<std::mutex> lg(mtx_); // Bloqueia o mutex
+        std::unique_lock<MutexAtr> lg(mtx_); // Bloqueia o mutex
+        if (fechado_) return; // fechado: descarta
+        // Corrotina esperando (buffer vazio): entrega direta
+        if (EsperaPtr e = entregar_a_consumidor(v)) { lg.unlock(); e->retomar(); return; }
         data_[head_] = v; // Copia o elemento para a posição atual de escrita
         head_ = (head_ + 1) % cap_; // Avança o índice de escrita circularmente
         if (count_ < cap_) {
@@ -82,7 +127,10 @@ public:
     // push_force (move): Versão para mover elementos (mais eficiente para tipos complexos).
     void push_force(T&& v)
     {
-        std::lock_guard<std::mutex> lg(mtx_); // Bloqueia o mutex
+        std::unique_lock<MutexAtr> lg(mtx_); // Bloqueia o mutex
+        if (fechado_) return; // fechado: descarta
+        // Corrotina esperando (buffer vazio): entrega direta
+        if (EsperaPtr e = entregar_a_consumidor(std::move(v))) { lg.unlock(); e->retomar(); return; }
         data_[head_] = std::move(v); // Move o elemento para a posição atual de escrita
         head_ = (head_ + 1) % cap_; // Avança o índice de escrita circularmente
         if (count_ < cap_) {
@@ -99,9 +147,10 @@ public:
     template<typename Rep, typename Period>
     bool push_wait_for(const T& v, const std::chrono::duration<Rep, Period>& timeout)
     {
-        std::unique_lock<std::mutex> lk(mtx_); // Bloqueia o mutex
-        // Espera até que haja espaço ou o tempo limite expire
-        if (!not_full_cv_.wait_for(lk, timeout, [this]{ return count_ < cap_; })) return false;
+        std::unique_lock<MutexAtr> lk(mtx_); // Bloqueia o mutex
+        // Espera até que haja espaço, o buffer seja fechado ou o tempo limite expire
+        if (!not_full_cv_.wait_for(lk, timeout, [this]{ return count_ < cap_ || fechado_; }) || fechado_) return false;
+        if (EsperaPtr e = entregar_a_consumidor(v)) { lk.unlock(); e->retomar(); return true; }
         data_[head_] = v; // Copia o elemento
         head_ = (head_ + 1) % cap_; // Avança o índice de escrita
         ++count_; // Incrementa o contador
@@ -113,9 +162,10 @@ public:
     template<typename Rep, typename Period>
     bool push_wait_for(T&& v, const std::chrono::duration<Rep, Period>& timeout)
     {
-        std::unique_lock<std::mutex> lk(mtx_); // Bloqueia o mutex
-        // Espera até que haja espaço ou o tempo limite expire
-        if (!not_full_cv_.wait_for(lk, timeout, [this]{ return count_ < cap_; })) return false;
+        std::unique_lock<MutexAtr> lk(mtx_); // Bloqueia o mutex
+        // Espera até que haja espaço, o buffer seja fechado ou o tempo limite expire
+        if (!not_full_cv_.wait_for(lk, timeout, [this]{ return count_ < cap_ || fechado_; }) || fechado_) return false;
+        if (EsperaPtr e = entregar_a_consumidor(std::move(v))) { lk.unlock(); e->retomar(); return true; }
         data_[head_] = std::move(v); // Move o elemento
         head_ = (head_ + 1) % cap_; // Avança o índice de escrita
         ++count_; // Incrementa o contador
@@ -123,46 +173,65 @@ public:
         return true;
     }
 
-    // push_wait: Insere um elemento, esperando indefinidamente se estiver cheio.
-    void push_wait(const T& v)
+    // push_wait: Insere um elemento, esperando enquanto estiver cheio.
+    // Retorna false (sem inserir) se o buffer for fechado.
+    bool push_wait(const T& v)
     {
-        std::unique_lock<std::mutex> lk(mtx_); // Bloqueia o mutex
-        // Espera até que haja espaço
-        not_full_cv_.wait(lk, [this]{ return count_ < cap_; });
+        std::unique_lock<MutexAtr> lk(mtx_); // Bloqueia o mutex
+        // Espera até que haja espaço ou o buffer seja fechado
+        not_full_cv_.wait(lk, [this]{ return count_ < cap_ || fechado_; });
+        if (fechado_) return false;
+        if (EsperaPtr e = entregar_a_consumidor(v)) { lk.unlock(); e->retomar(); return true; }
         data_[head_] = v; // Copia o elemento
         head_ = (head_ + 1) % cap_; // Avança o índice de escrita
         ++count_; // Incrementa o contador
         cv_.notify_one(); // Notifica uma thread consumidora
+        return true;
     }
 
     // push_wait (move): Versão para mover elementos.
-    void push_wait(T&& v)
+    bool push_wait(T&& v)
     {
-        std::unique_lock<std::mutex> lk(mtx_); // Bloqueia o mutex
-        // Espera até que haja espaço
-        not_full_cv_.wait(lk, [this]{ return count_ < cap_; });
+        std::unique_lock<MutexAtr> lk(mtx_); // Bloqueia o mutex
+        // Espera até que haja espaço ou o buffer seja fechado
+        not_full_cv_.wait(lk, [this]{ return count_ < cap_ || fechado_; });
+        if (fechado_) return false;
+        if (EsperaPtr e = entregar_a_consumidor(std::move(v))) { lk.unlock(); e->retomar(); return true; }
         data_[head_] = std::move(v); // Move o elemento
         head_ = (head_ + 1) % cap_; // Avança o índice de escrita
         ++count_; // Incrementa o contador
         cv_.notify_one(); // Notifica uma thread consumidora
+        return true;
+    }
+
+    // try_push: Insere se houver espaço; false se cheio ou fechado. Não bloqueia.
+    bool try_push(const T& v)
+    {
+        std::unique_lock<MutexAtr> lg(mtx_); // Bloqueia o mutex
+        if (fechado_) return false;
+        if (EsperaPtr e = entregar_a_consumidor(v)) { lg.unlock(); e->retomar(); return true; }
+        if (count_ >= cap_) return false; // cheio (corrotinas produtoras já na fila)
+        inserir(T(v));
+        return true;
     }
 
     // try_pop: Tenta remover o elemento mais antigo. Não bloqueia.
     bool try_pop(T& out)
     {
-        std::lock_guard<std::mutex> lg(mtx_); // Bloqueia o mutex
+        std::unique_lock<MutexAtr> lg(mtx_); // Bloqueia o mutex
         if (count_ == 0) return false; // Retorna false se vazio
         out = std::move(data_[tail_]); // Move o elemento para a variável de saída
         tail_ = (tail_ + 1) % cap_; // Avança o índice de leitura circularmente
         --count_; // Decrementa o contador
         not_full_cv_.notify_one(); // Notifica uma thread produtora que há espaço
+        if (EsperaPtr e = admitir_produtor()) { lg.unlock(); e->retomar(); }
         return true;
     }
 
     // try_peek: Tenta obter o elemento mais antigo sem remover. Não bloqueia.
     bool try_peek(T& out) const
     {
-        std::lock_guard<std::mutex> lg(mtx_); // Bloqueia o mutex
+        std::lock_guard<MutexAtr> lg(mtx_); // Bloqueia o mutex
         if (count_ == 0) return false; // Retorna false se vazio
         out = data_[tail_]; // Copia o elemento para a variável de saída
         return true;
@@ -172,32 +241,165 @@ public:
     template<typename Rep, typename Period>
     bool pop_wait_for(T& out, const std::chrono::duration<Rep, Period>& timeout)
     {
-        std::unique_lock<std::mutex> lg(mtx_); // Bloqueia o mutex
-        // Espera até que haja dados ou o tempo limite expire
-        if (!cv_.wait_for(lg, timeout, [this]{ return count_ > 0; })) return false;
+        std::unique_lock<MutexAtr> lg(mtx_); // Bloqueia o mutex
+        // Espera até que haja dados, o buffer seja fechado ou o tempo limite expire
+        if (!cv_.wait_for(lg, timeout, [this]{ return count_ > 0 || fechado_; }) || count_ == 0) return false;
         out = std::move(data_[tail_]); // Move o elemento
         tail_ = (tail_ + 1) % cap_; // Avança o índice de leitura
         --count_; // Decrementa o contador
         not_full_cv_.notify_one(); // Notifica uma thread produtora
+        if (EsperaPtr e = admitir_produtor()) { lg.unlock(); e->retomar(); }
         return true;
     }
 
-    // pop_wait: Remove o elemento mais antigo, esperando indefinidamente se estiver vazio.
-    void pop_wait(T& out)
+    // pop_wait: Remove o elemento mais antigo, esperando enquanto estiver vazio.
+    // Retorna false se o buffer for fechado vazio.
+    bool pop_wait(T& out)
     {
-        std::unique_lock<std::mutex> lg(mtx_); // Bloqueia o mutex
-        // Espera até que haja dados
-        cv_.wait(lg, [this]{ return count_ > 0; });
+        std::unique_lock<MutexAtr> lg(mtx_); // Bloqueia o mutex
+        // Espera até que haja dados ou o buffer seja fechado
+        cv_.wait(lg, [this]{ return count_ > 0 || fechado_; });
+        if (count_ == 0) return false;
         out = std::move(data_[tail_]); // Move o elemento
         tail_ = (tail_ + 1) % cap_; // Avança o índice de leitura
         --count_; // Decrementa o contador
         not_full_cv_.notify_one(); // Notifica uma thread produtora
+        if (EsperaPtr e = admitir_produtor()) { lg.unlock(); e->retomar(); }
+        return true;
+    }
+
+    // ---------------- Awaitables (corrotinas) ----------------
+
+    // co_await pop_for(timeout): std::optional<T> (nullopt se o tempo esgotar).
+    class AguardaPop
+    {
+    public:
+        AguardaPop(BufferCircular& b, std::chrono::steady_clock::duration timeout, bool com_timeout)
+            : b_(b), timeout_(timeout), com_timeout_(com_timeout) {}
+
+        bool await_ready() { return false; }
+
+        bool await_suspend(std::coroutine_handle<> h)
+        {
+            auto e = std::make_shared<EsperaAssincrona>();
+            e->h = h;
+            e->ex = Executor::atual();
+            if (!e->ex) throw std::logic_error("BufferCircular::pop fora de um executor");
+            const bool com_timeout = com_timeout_; // 'this' pode morrer após o unlock
+            const auto prazo = std::chrono::steady_clock::now() + timeout_;
+            {
+                std::unique_lock<MutexAtr> lg(b_.mtx_);
+                if (b_.count_ > 0) {
+                    valor_ = b_.retirar();
+                    EsperaPtr p = b_.admitir_produtor();
+                    lg.unlock();
+                    if (p) p->retomar();
+                    return false; // não suspende
+                }
+                if (b_.fechado_) return false; // fechado e vazio: nullopt
+                // descarta esperas cujo timeout já venceu
+                while (!b_.consumidores_.empty() && b_.consumidores_.front().e->concluida.load())
+                    b_.consumidores_.pop_front();
+                b_.consumidores_.push_back({e, &valor_});
+            }
+            if (com_timeout) {
+                e->ex->agendar_em(prazo, [e] { if (e->reivindicar()) e->retomar(); });
+            }
+            return true;
+        }
+
+        std::optional<T> await_resume() { return std::move(valor_); }
+
+    protected:
+        BufferCircular& b_;
+        std::chrono::steady_clock::duration timeout_;
+        bool com_timeout_;
+        std::optional<T> valor_;
+    };
+
+    // co_await pop(): T (suspende enquanto vazio).
+    class AguardaPopValor : public AguardaPop
+    {
+    public:
+        explicit AguardaPopValor(BufferCircular& b) : AguardaPop(b, {}, false) {}
+        T await_resume()
+        {
+            if (!this->valor_) throw BufferFechado();
+            return std::move(*this->valor_);
+        }
+    };
+
+    // co_await push(v) / push_for(v, timeout): bool (false se fechado ou no
+    // timeout; o valor não é inserido).
+    class AguardaPush
+    {
+    public:
+        AguardaPush(BufferCircular& b, T v, std::chrono::steady_clock::duration timeout, bool com_timeout)
+            : b_(b), valor_(std::move(v)), timeout_(timeout), com_timeout_(com_timeout) {}
+
+        bool await_ready() { return false; }
+
+        bool await_suspend(std::coroutine_handle<> h)
+        {
+            auto e = std::make_shared<EsperaAssincrona>();
+            e->h = h;
+            e->ex = Executor::atual();
+            if (!e->ex) throw std::logic_error("BufferCircular::push fora de um executor");
+            const bool com_timeout = com_timeout_; // 'this' pode morrer após o unlock
+            const auto prazo = std::chrono::steady_clock::now() + timeout_;
+            {
+                std::unique_lock<MutexAtr> lg(b_.mtx_);
+                if (b_.fechado_) return false; // aceito_ continua false
+                if (EsperaPtr c = b_.entregar_a_consumidor(std::move(valor_))) {
+                    aceito_ = true;
+                    lg.unlock();
+                    c->retomar();
+                    return false;
+                }
+                if (b_.count_ < b_.cap_) {
+                    b_.inserir(std::move(valor_));
+                    aceito_ = true;
+                    return false;
+                }
+                b_.produtores_.push_back({e, &valor_, &aceito_});
+            }
+            if (com_timeout) {
+                e->ex->agendar_em(prazo, [e] { if (e->reivindicar()) e->retomar(); });
+            }
+            return true;
+        }
+
+        bool await_resume() { return aceito_; }
+
+    private:
+        BufferCircular& b_;
+        T valor_;
+        std::chrono::steady_clock::duration timeout_;
+        bool com_timeout_;
+        bool aceito_ = false;
+    };
+
+    AguardaPopValor pop() { return AguardaPopValor(*this); }
+
+    template<typename Rep, typename Period>
+    AguardaPop pop_for(const std::chrono::duration<Rep, Period>& timeout)
+    {
+        return AguardaPop(*this, std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout), true);
+    }
+
+    AguardaPush push(T v) { return AguardaPush(*this, std::move(v), {}, false); }
+
+    template<typename Rep, typename Period>
+    AguardaPush push_for(T v, const std::chrono::duration<Rep, Period>& timeout)
+    {
+        return AguardaPush(*this, std::move(v),
+                           std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout), true);
     }
 
     // size: Retorna o número atual de elementos no buffer.
     size_t size() const
     {
-        std::lock_guard<std::mutex> lg(mtx_); // Bloqueia o mutex
+        std::lock_guard<MutexAtr> lg(mtx_); // Bloqueia o mutex
         return count_;
     }
 
@@ -210,20 +412,102 @@ public:
     // clear: Esvazia o buffer.
     void clear()
     {
-        std::lock_guard<std::mutex> lg(mtx_); // Bloqueia o mutex
+        std::lock_guard<MutexAtr> lg(mtx_); // Bloqueia o mutex
         head_ = tail_ = count_ = 0; // Reseta os índices e o contador
         cv_.notify_all(); // Notifica todas as threads consumidoras (que podem estar esperando dados)
         not_full_cv_.notify_all(); // Notifica todas as threads produtoras (que podem estar esperando espaço)
     }
 
+    // fechar: Encerra o buffer e retoma, com falha, todas as corrotinas e
+    // threads que esperam nele. Idempotente.
+    void fechar()
+    {
+        std::vector<EsperaPtr> retomar;
+        {
+            std::lock_guard<MutexAtr> lg(mtx_);
+            fechado_ = true;
+            for (EsperaConsumidor& c : consumidores_)
+                if (c.e->reivindicar()) retomar.push_back(c.e); // destino fica nullopt
+            for (EsperaProdutor& p : produtores_)
+                if (p.e->reivindicar()) retomar.push_back(p.e); // aceito fica false
+            consumidores_.clear();
+            produtores_.clear();
+            cv_.notify_all();
+            not_full_cv_.notify_all();
+        }
+        for (EsperaPtr& e : retomar) e->retomar();
+    }
+
+    // fechado: true depois de fechar().
+    bool fechado() const
+    {
+        std::lock_guard<MutexAtr> lg(mtx_);
+        return fechado_;
+    }
+
 private:
+    // Corrotina consumidora suspensa e onde depositar o valor entregue.
+    struct EsperaConsumidor { EsperaPtr e; std::optional<T>* destino; };
+    // Corrotina produtora suspensa, o valor que ela quer inserir e onde
+    // marcar que ele foi aceito.
+    struct EsperaProdutor { EsperaPtr e; T* origem; bool* aceito; };
+
+    // (mtx_ travado) Entrega 'v' à corrotina consumidora mais antiga ainda
+    // válida. Retorna a espera a retomar (após o unlock) ou nullptr.
+    template<typename U>
+    EsperaPtr entregar_a_consumidor(U&& v)
+    {
+        while (!consumidores_.empty()) {
+            EsperaConsumidor c = consumidores_.front();
+            consumidores_.pop_front();
+            if (c.e->reivindicar()) { *c.destino = std::forward<U>(v); return c.e; }
+            // descartada: timeout já venceu
+        }
+        return nullptr;
+    }
+
+    // (mtx_ travado) Após uma remoção, insere o valor da corrotina produtora
+    // mais antiga. Retorna a espera a retomar (após o unlock) ou nullptr.
+    EsperaPtr admitir_produtor()
+    {
+        while (!produtores_.empty() && count_ < cap_) {
+            EsperaProdutor p = produtores_.front();
+            produtores_.pop_front();
+            if (p.e->reivindicar()) { inserir(std::move(*p.origem)); *p.aceito = true; return p.e; }
+        }
+        return nullptr;
+    }
+
+    // (mtx_ travado, count_ < cap_) Insere sem sobrescrever.
+    void inserir(T&& v)
+    {
+        data_[head_] = std::move(v);
+        head_ = (head_ + 1) % cap_;
+        ++count_;
+        cv_.notify_one();
+    }
+
+    // (mtx_ travado, count_ > 0) Remove o mais antigo.
+    T retirar()
+    {
+        T v = std::move(data_[tail_]);
+        tail_ = (tail_ + 1) % cap_;
+        --count_;
+        not_full_cv_.notify_one();
+        return v;
+    }
+
+    std::deque<EsperaConsumidor> consumidores_; // corrotinas em pop()/pop_for()
+    std::deque<EsperaProdutor> produtores_;     // corrotinas em push()
+
     std::vector<T> data_; // Vetor para armazenar os elementos
     size_t cap_ = 0;      // Capacidade total do buffer
     size_t head_ = 0;     // Índice onde o próximo elemento será escrito
     size_t tail_ = 0;     // Índice do elemento mais antigo (próximo a ser lido)
     size_t count_ = 0;    // Número atual de elementos no buffer
+    bool fechado_ = false; // fechar() já foi chamado
 
-    mutable std::mutex mtx_; // Mutex para sincronização
-    std::condition_variable cv_; // Variável de condição para notificar consumidores (buffer não vazio)
-    std::condition_variable not_full_cv_; // Variável de condição para notificar produtores (buffer não cheio)
+    mutable MutexAtr mtx_; // Mutex para sincronização (instrumentável, ver PerfilLocks.h)
+    CondVarAtr cv_; // Variável de condição para notificar consumidores (buffer não vazio)
+    CondVarAtr not_full_cv_; // Variável de condição para notificar produtores (buffer não cheio)
 };
\ No newline at end of file
@@ -0,0 +1,108 @@
+/*
+ * Arquivo: CaixaMensagens.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define a classe CaixaMensagens, o lado de
+ * recepção do MqttClient: as filas de mensagens recebidas por tópico e as
+ * corrotinas que esperam por elas. Ela não depende do Paho; o MqttClient só
+ * chama entregar() no callback de chegada. Assim o modelo de espera
+ * (next/next_for) pode ser testado sem broker.
+ *
+ * Características:
+ * - Filas por tópico, na ordem de chegada (try_pop, drenar_filtro com
+ * coringa '+').
+ * - co_await next(topico) / next_for(topico, timeout): suspende a corrotina
+ * até chegar uma mensagem; entregar() passa a mensagem direto à corrotina
+ * que espera há mais tempo (em vez de enfileirá-la) e a agenda no seu
+ * Executor. A espera é concluída uma única vez, pelo evento ou pelo timeout
+ * (EsperaAssincrona::reivindicar).
+ * - ao_chegar(topico, fn): ganchos curtos chamados a cada entrega, fora do
+ * lock (ex.: acordar tarefas).
+ * - Thread-safe: um mutex (q_mtx_) protege filas, esperas e ganchos.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "PerfilLocks.h" // MutexAtr (lock instrumentável)
+#include "Executor.h"    // EsperaAssincrona (awaitables)
+
+class CaixaMensagens
+{
+public:
+    explicit CaixaMensagens(const char* nome = "CaixaMensagens::q_mtx_");
+
+    CaixaMensagens(const CaixaMensagens&) = delete;
+    CaixaMensagens& operator=(const CaixaMensagens&) = delete;
+
+    // Mensagem recebida: vai para a corrotina que espera há mais tempo ou,
+    // sem espera, para a fila do tópico. Chama os ganchos do tópico.
+    void entregar(const std::string& topic, std::string payload);
+
+    // Retira a mensagem mais antiga do tópico; std::nullopt se vazio (não bloqueia).
+    std::optional<std::string> try_pop(const std::string& topic);
+
+    // Consome todas as mensagens dos tópicos que casam com o filtro MQTT
+    // (coringa '+'), exceto as do tópico "exceto". Não bloqueia.
+    std::vector<std::pair<std::string, std::string>> drenar_filtro(const std::string& filtro,
+                                                                   const std::string& exceto = "");
+
+    // Gancho chamado a cada entrega no tópico (curto, sem bloquear).
+    void ao_chegar(const std::string& topic, std::function<void()> fn);
+
+    // Awaitable de mensagem: std::optional<std::string> (nullopt no timeout).
+    class AguardaMensagem
+    {
+    public:
+        AguardaMensagem(CaixaMensagens& c, std::string topic, std::chrono::steady_clock::duration timeout, bool com_timeout)
+            : c_(c), topic_(std::move(topic)), timeout_(timeout), com_timeout_(com_timeout) {}
+        bool await_ready() { return false; }
+        bool await_suspend(std::coroutine_handle<> h);
+        std::optional<std::string> await_resume() { return std::move(valor_); }
+
+    protected:
+        CaixaMensagens& c_;
+        std::string topic_;
+        std::chrono::steady_clock::duration timeout_;
+        bool com_timeout_;
+        std::optional<std::string> valor_;
+    };
+
+    // co_await next(topico): próxima mensagem do tópico (suspende até chegar).
+    class AguardaMensagemValor : public AguardaMensagem
+    {
+    public:
+        AguardaMensagemValor(CaixaMensagens& c, std::string topic)
+            : AguardaMensagem(c, std::move(topic), {}, false) {}
+        std::string await_resume() { return std::move(*valor_); }
+    };
+
+    AguardaMensagemValor next(const std::string& topic) { return AguardaMensagemValor(*this, topic); }
+
+    template<typename Rep, typename Period>
+    AguardaMensagem next_for(const std::string& topic, const std::chrono::duration<Rep, Period>& timeout)
+    {
+        return AguardaMensagem(*this, topic,
+                               std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout), true);
+    }
+
+private:
+    // Mapa de filas por tópico: topic -> queue<message>
+    std::unordered_map<std::string, std::queue<std::string>> queues_;
+
+    // Corrotinas suspensas em next()/next_for(), por tópico
+    struct EsperaMensagem { EsperaPtr e; std::optional<std::string>* destino; };
+    std::unordered_map<std::string, std::deque<EsperaMensagem>> aguardando_;
+    std::unordered_map<std::string, std::vector<std::function<void()>>> ganchos_;
+
+    MutexAtr q_mtx_; // protege queues_, aguardando_ e ganchos_
+};
@@ -0,0 +1,82 @@
+/*
+ * Arquivo: Cenario.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define o motor de cenários: uma linha do tempo de
+ * injeções de falha, rajadas de comandos, trocas de rota e quedas do enlace,
+ * executada contra os caminhões via MQTT para campanhas de estresse
+ * repetíveis. Cada cenário produz uma linha JSON com latências e vazão, que
+ * pode ser acumulada num arquivo para comparar versões do sistema.
+ *
+ * Formato do arquivo (.cen; '#' inicia comentário):
+ *     nome falhas_frota
+ *     caminhoes 1-5
+ *     duracao 20000                       (ms; padrão: último evento + 5 s)
+ *     1000  defeito  *  eletrica=1        (payload do /sim/defeito)
+ *     3000  comando  2  rearme 10 50      (payload, repetições, intervalo ms)
+ *     5000  rota     3  routes/b.route    (publica no /route)
+ *     8000  queda    4  3000              (caminhão fica 3000 ms sem enviar)
+ * - O alvo é um id ou '*' (todos os caminhões da diretiva caminhoes).
+ * - Os eventos são ordenados por (instante, linha do arquivo): a mesma
+ * entrada gera sempre a mesma sequência de publicações.
+ *
+ * Métricas (medidas no relógio do cenário, a partir do envio):
+ * - defeito: até o /eventos do caminhão com a falha injetada.
+ * - comando: auto/man/rearme, até o /snapshot refletir o novo modo/defeito
+ * (ignorado se o snapshot já estava no estado pedido).
+ * - rota: até o /snapshot com rota_versao maior.
+ * - queda: do fim da queda até o primeiro /sensores com carimbo ("ts", época
+ * Unix) posterior ao fim; amostras antigas esvaziadas da fila não contam.
+ * Os relógios do cenário e dos caminhões devem estar sincronizados (NTP).
+ * - Expectativa não atendida em PRAZO_EXPECTATIVA_MS conta como perdida.
+ * - Vazão: mensagens de /sensores, /eventos e /snapshot recebidas por segundo
+ * e a maior lacuna entre dois /sensores de um mesmo caminhão.
+ *
+ * Modo de execução (main.cpp):
+ *     --cenario=a.cen[,b.cen] [--cenario-saida=PATH] [--cenario-rotulo=TXT]
+ * Quedas exigem caminhões iniciados com ATR_SIM_QUEDA=1 (senão /sim/queda
+ * não é assinado); a duração é limitada a 10 s no caminhão.
+ */
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class MqttClient;
+
+enum class AcaoCenario { Defeito, Comando, Rota, Queda };
+
+struct EventoCenario
+{
+    int64_t t_ms = 0;        // instante na linha do tempo do cenário
+    AcaoCenario acao = AcaoCenario::Defeito;
+    int caminhao = 0;
+    std::string argumento;   // payload, texto da rota ou duração da queda (ms)
+    size_t linha = 0;        // linha de origem (desempate e mensagens de erro)
+};
+
+struct Cenario
+{
+    std::string nome;
+    std::vector<int> caminhoes;
+    int64_t duracao_ms = 0;
+    std::vector<EventoCenario> eventos; // ordenados por (t_ms, linha)
+};
+
+// Prazo para a reação esperada de um evento.
+constexpr int64_t PRAZO_EXPECTATIVA_MS = 5000;
+
+// Lê um cenário; false com a descrição do problema em erro.
+bool carregar_cenario_texto(const std::string& texto, Cenario& c, std::string& erro);
+bool carregar_cenario(const std::string& caminho, Cenario& c, std::string& erro);
+
+struct ConfigCampanha
+{
+    std::vector<std::string> arquivos;
+    std::string saida;   // arquivo onde as linhas JSON são acrescentadas ("" = só stdout)
+    std::string rotulo;  // identifica a versão/configuração medida
+};
+
+// Executa os cenários em sequência até o fim ou até stop_flag.
+int executar_campanha(const ConfigCampanha& cfg, MqttClient& mqtt, std::atomic<bool>& stop_flag);
@@ -0,0 +1,15 @@
+/*
+ * Arquivo: ChaveValor.h
+ * Finalidade:
+ * Leitura dos payloads MQTT em texto "chave=valor" separados por vírgulas
+ * (tarefas do despacho, membros e listas da frota). Como em JsonSimples.h,
+ * os payloads são gerados pelo próprio sistema: não há escapes, e um campo
+ * sem '=' é ignorado.
+ */
+
+#pragma once
+
+#include <string>
+
+// Valor de "chave=valor" num payload separado por vírgulas; "" se ausente.
+std::string valor_chave(const std::string& pl, const std::string& chave);
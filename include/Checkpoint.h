@@ -0,0 +1,47 @@
+/*
+ * Arquivo: Checkpoint.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define a estrutura CheckpointCaminhao, que guarda
+ * o mínimo de estado necessário para um "warm start" de um caminhão: posição
+ * e orientação simuladas, modo de operação e o índice do waypoint corrente da
+ * rota. Ela é usada quando um caminhão muda de processo hospedeiro (ver
+ * HostFrota.h): o processo que sai publica o checkpoint e o novo processo o
+ * restaura, de modo que o caminhão continua de onde parou em vez de reiniciar
+ * na posição padrão.
+ *
+ * Transporte:
+ * - Tópico MQTT retido /mina/caminhoes/<id>/checkpoint.
+ * - Payload texto "x=..,y=..,hdg=..,auto=0|1,wp=..,t=.." (mesmo estilo
+ * chave=valor usado nos comandos e setpoints). t é o instante da publicação
+ * (época Unix, ms): o host que assume o caminhão o usa para distinguir o
+ * checkpoint final do dono anterior de um retido antigo.
+ *
+ * Sincronização:
+ * - O checkpoint é lido no início e escrito no fim das threads que o usam
+ * (não a cada ciclo). Quem escreve deve segurar state_mtx.
+ */
+
+#pragma once
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+struct CheckpointCaminhao
+{
+    double x = 100.0;          // Posição simulada X (padrão do simulador)
+    double y = 100.0;          // Posição simulada Y
+    double heading = 0.0;      // Orientação simulada (graus, 0..360)
+    bool automatico = false;   // Modo automático ativo?
+    size_t waypoint_idx = 0;   // Índice do waypoint corrente da rota
+    int64_t t_ms = 0;          // Instante da publicação (época Unix, ms; 0 = desconhecido)
+    bool valido = false;       // true se restaurado/preenchido de fato
+
+    // Serializa no formato chave=valor.
+    std::string serializar() const;
+
+    // Interpreta um payload chave=valor. Retorna false se faltar x/y.
+    static bool desserializar(const std::string& payload, CheckpointCaminhao& out);
+};
+
+// Tópico retido do checkpoint de um caminhão.
+std::string topico_checkpoint(int truck_id);
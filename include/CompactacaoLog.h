@@ -0,0 +1,128 @@
+/*
+ * Arquivo: CompactacaoLog.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define o serviço de compactação do log CSV
+ * detalhado (logs/logs_caminhao_detailed.csv). As amostras em taxa cheia só
+ * interessam por alguns dias; depois de 'idade' elas são agregadas em dois
+ * níveis (baldes de 1 s e de 1 min por caminhão) e o trecho bruto é
+ * descartado ou arquivado conforme a política. O disco fica limitado e as
+ * consultas de longo prazo leem os níveis agregados, muito menores.
+ *
+ * Agregados (um balde por caminhão e intervalo):
+ * - n amostras e timestamp da última;
+ * - pos_x, pos_y, ang, temp, o_acel, o_dir: mínimo, máximo, média e último;
+ * - fe, fh, e_auto, e_defeito, e_alerta_temp: quantas amostras com a flag.
+ * - Arquivos em <dir_agregados>/<nivel>/<T0>_<T1>.csv (nivel = 1s ou 1min),
+ * um por janela compactada, gravados via arquivo temporário + rename.
+ * - Amostras atrasadas (de outro processo, gravadas depois do corte) podem
+ * gerar um segundo registro do mesmo balde numa janela seguinte; a consulta
+ * combina registros repetidos (consultar_agregados).
+ *
+ * Rodada de compactação:
+ * - Alvo: horizonte = (maior timestamp indexado - idade), arredondado para
+ * baixo ao minuto; processado em janelas de até 'janela' para limitar a
+ * memória. O corte de cada janela vem do índice esparso (IndiceLog.h): todas
+ * as linhas antes dele são de antes do horizonte.
+ * - O trecho [compactado, corte) é dividido em segmentos de ~segmento_bytes
+ * agregados em paralelo por threads de baixa prioridade (nice 19 e classe
+ * de E/S ociosa); os resultados parciais são combinados no fim.
+ * - Bruto: Apagar libera o trecho com fallocate(PUNCH_HOLE) (o arquivo e os
+ * offsets não mudam, então os gravadores em O_APPEND e o índice seguem
+ * válidos); Arquivar copia o trecho para <dir_arquivo>/<T0>_<T1>.csv antes de
+ * liberar; Manter só agrega. O mesmo vale para o trecho correspondente do
+ * índice.
+ * - Estado em "<csv>.compactacao" (compactado, descartado, horizonte), gravado
+ * ao fim de cada janela: uma rodada interrompida recomeça da última janela
+ * concluída.
+ * - Retenção dos níveis: arquivos agregados cujo fim é mais antigo que a
+ * retenção do nível são apagados (0 = para sempre).
+ *
+ * Modos de execução (main.cpp):
+ * - --log-compact: serviço periódico (uma rodada a cada 'periodo').
+ * - --log-compact-once: uma rodada e sai.
+ * - --log-query=T0,T1 --log-tier=1s|1min: consulta nos níveis agregados.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+
+struct ConfigCompactacao
+{
+    enum class Bruto { Apagar, Arquivar, Manter };
+
+    std::string csv = "logs/logs_caminhao_detailed.csv";
+    std::string dir_agregados = "logs/agregados";
+    std::string dir_arquivo = "logs/arquivo";
+    int64_t idade_ms = 72LL * 3600 * 1000;          // bruto mais novo fica intacto
+    Bruto bruto = Bruto::Apagar;
+    int64_t retencao_1s_ms = 30LL * 24 * 3600 * 1000; // 0 = para sempre
+    int64_t retencao_1min_ms = 0;
+    int64_t janela_ms = 3600 * 1000;                // máximo por janela
+    unsigned paralelismo = 0;                       // 0 = metade dos núcleos
+    uint64_t segmento_bytes = 8 * 1024 * 1024;
+    std::chrono::seconds periodo{600};
+    bool uma_vez = false;
+};
+
+struct CampoAgregado
+{
+    double min = 0.0;
+    double max = 0.0;
+    double soma = 0.0;
+    double ultimo = 0.0;
+};
+
+struct Agregado
+{
+    static constexpr int NUM_CAMPOS = 6;  // pos_x, pos_y, ang, temp, o_acel, o_dir
+    static constexpr int NUM_FLAGS = 5;   // fe, fh, e_auto, e_defeito, e_alerta_temp
+
+    uint64_t n = 0;
+    int64_t ts_ultimo = 0;
+    CampoAgregado campos[NUM_CAMPOS];
+    uint64_t flags[NUM_FLAGS] = {};
+
+    void adicionar(int64_t ts, const double (&valores)[NUM_CAMPOS], const bool (&ativas)[NUM_FLAGS]);
+    void combinar(const Agregado& o);
+};
+
+// Chave dos baldes: (início do balde em ms, truck_id).
+using MapaAgregados = std::map<std::pair<int64_t, int>, Agregado>;
+
+// Agrega as linhas do CSV que começam em [inicio, fim) nos baldes de 1 s e 1 min.
+// 'inicio' pode cair no meio de uma linha (ela fica para o segmento anterior).
+uint64_t agregar_trecho(const std::string& caminho_csv, uint64_t inicio, uint64_t fim,
+                        MapaAgregados& seg1s, MapaAgregados& min1);
+
+// Linha CSV de um balde (e cabeçalho) e o inverso.
+std::string cabecalho_agregado();
+std::string serializar_agregado(int64_t balde_ms, int truck_id, const Agregado& a);
+bool ler_agregado(const std::string& linha, int64_t& balde_ms, int& truck_id, Agregado& a);
+
+struct ResultadoCompactacao
+{
+    uint64_t janelas = 0;
+    uint64_t linhas = 0;
+    uint64_t baldes_1s = 0;
+    uint64_t baldes_1min = 0;
+    uint64_t bytes_liberados = 0;
+    int64_t horizonte_ms = 0;
+};
+
+// Uma rodada completa (até alcançar a idade ou stop_flag).
+ResultadoCompactacao compactar_log(const ConfigCompactacao& cfg, const std::atomic<bool>* stop_flag = nullptr);
+
+// Baldes do nível ("1s" ou "1min") com t0 <= balde <= t1 (do caminhão, ou de
+// todos se truck_id < 0), combinados e em ordem de (balde, caminhão).
+size_t consultar_agregados(const std::string& dir_agregados, const std::string& nivel, int64_t t0, int64_t t1,
+                           int truck_id, const std::function<bool(int64_t, int, const Agregado&)>& fn);
+
+// Executa o serviço até stop_flag (ou uma rodada, se cfg.uma_vez).
+int executar_compactacao(const ConfigCompactacao& cfg, std::atomic<bool>& stop_flag);
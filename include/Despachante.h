@@ -0,0 +1,106 @@
+/*
+ * Arquivo: Despachante.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define o serviço de despacho automático de
+ * caminhões para tarefas (pontos de carga e descarga). Hoje essa atribuição é
+ * manual: o operador clica na interface e envia setpoints. O Despachante
+ * monta uma matriz de custos (tempo estimado de cada caminhão até cada tarefa
+ * aberta), resolve a atribuição ótima com o método húngaro (Hungaro.h) e emite
+ * uma rota para cada caminhão cuja tarefa mudou.
+ *
+ * Eventos que disparam a reotimização:
+ * - Nova tarefa: solução completa.
+ * - Tarefa concluída: reotimização incremental (só o caminhão liberado),
+ * desde que nenhum caminhão tenha se afastado mais que
+ * DESLOCAMENTO_REOTIMIZAR da posição usada na matriz (o custo padrão muda no
+ * máximo deslocamento / velocidade); senão, solução completa.
+ * - Periodicamente (posições mudam): solução completa; só os caminhões cuja
+ * tarefa mudou recebem rota nova.
+ *
+ * Custo:
+ * - FuncaoCusto recebe (x0, y0, x1, y1) e retorna o custo (ex.: segundos).
+ * O padrão é a distância euclidiana dividida pela velocidade de cruzeiro;
+ * com uma malha viária (MalhaViaria.h) o custo é o tempo pela malha.
+ *
+ * Modo de execução (main.cpp: --dispatcher --fleet-trucks=1-20
+ * [--road-graph=arquivo.malha]):
+ * - Posições: /mina/caminhoes/<id>/posicao, extrapoladas entre amostras
+ * (ReconstrucaoPosicao.h) a cada ciclo.
+ * - Tarefas: /mina/despacho/tarefas, payload "id=7,x=300,y=400" (abre) ou
+ * "id=7,concluida=1" (cancela/encerra manualmente).
+ * - Saídas: rota em /mina/caminhoes/<id>/route (pelas vias da malha, se
+ * houver; senão em linha reta), resumo em
+ * /mina/despacho/atribuicao e conclusões em /mina/despacho/concluidas.
+ */
+
+#pragma once
+#include <atomic>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Hungaro.h"
+#include "Route.h"
+#include "MqttClient.h"
+
+struct TarefaDespacho
+{
+    int id = 0;
+    double x = 0.0;
+    double y = 0.0;
+};
+
+class Despachante
+{
+public:
+    using FuncaoCusto = std::function<double(double x0, double y0, double x1, double y1)>;
+
+    // Velocidade de cruzeiro usada no custo padrão (px/s; ver ControleDeNavegacao).
+    static constexpr double VELOCIDADE_PADRAO = 80.0;
+    // Deslocamento (px) a partir do qual a matriz de custos deixa de valer.
+    static constexpr double DESLOCAMENTO_REOTIMIZAR = 40.0;
+
+    explicit Despachante(FuncaoCusto custo = FuncaoCusto());
+
+    void atualizar_posicao(int truck_id, double x, double y);
+    void adicionar_tarefa(const TarefaDespacho& t);
+
+    // Remove a tarefa (concluída/cancelada) e reatribui incrementalmente.
+    // Retorna os caminhões cuja tarefa mudou.
+    std::vector<int> concluir_tarefa(int tarefa_id);
+
+    // Refaz a atribuição do zero. Retorna os caminhões cuja tarefa mudou.
+    std::vector<int> reotimizar();
+
+    // Tarefa atual do caminhão (id da tarefa ou -1).
+    int tarefa_do_caminhao(int truck_id) const;
+
+    // Caminhões que chegaram (distância <= raio) ao ponto da sua tarefa.
+    std::vector<std::pair<int, int>> chegadas(double raio) const; // (caminhão, tarefa)
+
+    // Rota do caminhão até sua tarefa (vazia se ocioso).
+    Route rota_para(int truck_id) const;
+
+    // Resumo "caminhao:tarefa ..." e tempo da última solução.
+    std::string resumo() const;
+    double ultimo_tempo_ms() const { return ultimo_ms_; }
+
+private:
+    void montar_matriz();
+    std::vector<int> aplicar_resultado();
+
+    FuncaoCusto custo_;
+    std::map<int, std::pair<double, double>> posicoes_; // caminhão -> (x, y)
+    std::map<int, std::pair<double, double>> pos_matriz_; // posições usadas na matriz
+    std::vector<TarefaDespacho> tarefas_;               // ordem = colunas
+    std::vector<int> caminhoes_;                        // ordem = linhas
+    std::map<int, int> atual_;                          // caminhão -> tarefa id
+    AtribuicaoHungara solver_;
+    bool matriz_valida_ = false;
+    double ultimo_ms_ = 0.0;
+};
+
+// Executa o serviço de despacho até stop_flag; caminho_malha vazio = sem malha.
+int executar_despachante(const std::vector<int>& caminhoes, MqttClient& mqtt, std::atomic<bool>& stop_flag,
+                         const std::string& caminho_malha = std::string());
@@ -0,0 +1,65 @@
+/*
+ * Arquivo: EstadoSnapshot.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define o conteúdo do snapshot de um caminhão e
+ * as regras que decidem quando ele muda (formato e tópicos descritos em
+ * SnapshotCaminhao.h). Não depende do MQTT; o PublicadorSnapshot aplica as
+ * regras e publica o resultado.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "Route.h"
+
+struct SnapshotCaminhao
+{
+    bool automatico = false;
+    bool defeito = false;
+    bool alerta_temp = false;
+    uint32_t rota_versao = 0;
+    size_t waypoints = 0;
+    size_t waypoint = 0;
+    std::string ultima_falha;
+    uint64_t falha_ts = 0;
+
+    std::string serializar() const;
+    bool operator==(const SnapshotCaminhao& o) const = default;
+};
+
+// Tópicos retidos do snapshot e da rota corrente de um caminhão.
+std::string topico_snapshot(int truck_id);
+std::string topico_rota_atual(int truck_id);
+
+// Snapshot corrente e último publicado. Sem sincronização própria.
+class EstadoSnapshot
+{
+public:
+    void estado(bool automatico, bool defeito, bool alerta_temp);
+
+    // true se o conteúdo da rota mudou (nova versão, waypoint volta a 0).
+    bool rota(const Route& r);
+
+    void waypoint(size_t idx);
+
+    // Só o início de uma falha diferente da ativa altera ultima_falha/falha_ts;
+    // o fim dela ("") não apaga a última.
+    void falhas(const std::string& descricao, uint64_t ts);
+
+    // true se nada foi publicado ainda ou o snapshot difere do publicado.
+    bool pendente() const;
+    void marcar_publicado();
+
+    const SnapshotCaminhao& atual() const { return atual_; }
+    const std::string& rota_texto() const { return rota_texto_; }
+
+private:
+    SnapshotCaminhao atual_;
+    SnapshotCaminhao publicado_;
+    bool algum_publicado_ = false;
+    std::string falha_ativa_;
+    std::string rota_texto_;
+};
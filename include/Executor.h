@@ -0,0 +1,154 @@
+/*
+ * Arquivo: Executor.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define o modelo de execução por corrotinas (C++20)
+ * das tarefas do caminhão. Em vez de uma thread bloqueante por laço (com
+ * pop_wait_for, try_pop_message e sleep_for misturados), cada laço é uma
+ * corrotina que suspende nos pontos de espera e é retomada por um pequeno
+ * executor com poucas threads. Cada tarefa custa apenas o quadro da
+ * corrotina (alocado uma vez), sem pilha própria.
+ *
+ * Componentes:
+ * - Tarefa: tipo de retorno das corrotinas executadas pelo Executor. Começa
+ * suspensa; Executor::gerar() a agenda. O quadro é liberado ao terminar.
+ * - Executor: N threads de trabalho e fila de corrotinas prontas. Os
+ * temporizadores ficam no Reator (Reator.h, epoll + timerfd), que apenas
+ * agenda a corrotina aqui quando o prazo vence. aguardar() bloqueia até
+ * todas as tarefas terminarem.
+ * - Executor::after(periodo): awaitable de tempo (substitui sleep_for).
+ * - EsperaAssincrona: estado compartilhado de uma espera que pode ser
+ * concluída por um evento (dado no buffer, mensagem MQTT) ou pelo timeout,
+ * o que ocorrer primeiro; reivindicar() garante uma única retomada.
+ *
+ * Awaitables nos demais componentes (ver BufferCircular.h e MqttClient.h):
+ * - co_await buffer.pop() / buffer.pop_for(timeout) / buffer.push(v) /
+ * buffer.push_for(v, timeout)
+ * - co_await mqtt.next(topico) / mqtt.next_for(topico, timeout)
+ *
+ * Regras de uso:
+ * - Não manter mutex travado através de co_await (a corrotina pode voltar em
+ * outra thread).
+ * - Não usar co_await direto na condição de um if (if (!co_await b.push(v))):
+ * com o GCC 12 a corrotina gerada não executa o corpo. Guarde o resultado
+ * numa variável e teste a variável.
+ * - Tarefas que precisam encerrar com stop_flag devem usar as variantes com
+ * timeout, ou esperar em buffers que o dono fecha (BufferCircular::fechar)
+ * no desligamento; aguardar() só retorna quando todas terminam.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "PerfilLocks.h" // MutexAtr / CondVarAtr
+#include "Reator.h"
+
+class Executor;
+
+// Espera que pode ser concluída por evento ou timeout (apenas uma vez).
+struct EsperaAssincrona
+{
+    std::atomic<bool> concluida{false};
+    std::coroutine_handle<> h;
+    Executor* ex = nullptr;
+
+    // true para quem deve retomar a corrotina (o primeiro a chamar).
+    bool reivindicar() { return !concluida.exchange(true, std::memory_order_acq_rel); }
+
+    // Agenda a corrotina no seu executor.
+    void retomar();
+};
+using EsperaPtr = std::shared_ptr<EsperaAssincrona>;
+
+// Tipo de retorno das corrotinas de tarefa.
+class Tarefa
+{
+public:
+    struct promise_type
+    {
+        Executor* ex = nullptr;
+
+        Tarefa get_return_object() { return Tarefa(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; } // quadro liberado ao terminar
+        void return_void() {}
+        void unhandled_exception();
+        ~promise_type();
+    };
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    Tarefa(Tarefa&& o) noexcept : h_(o.h_) { o.h_ = nullptr; }
+    Tarefa(const Tarefa&) = delete;
+    Tarefa& operator=(const Tarefa&) = delete;
+    ~Tarefa() { if (h_) h_.destroy(); } // nunca foi gerada
+
+    handle_type liberar() { handle_type h = h_; h_ = nullptr; return h; }
+
+private:
+    explicit Tarefa(handle_type h) : h_(h) {}
+    handle_type h_;
+};
+
+class Executor
+{
+public:
+    using Relogio = std::chrono::steady_clock;
+
+    explicit Executor(Reator& reator, int n_threads = 2, const char* nome = "Executor");
+    ~Executor(); // para as threads; chame aguardar() antes se houver tarefas vivas
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    // Assume a tarefa e a agenda para execução.
+    void gerar(Tarefa t);
+
+    // Agenda uma corrotina suspensa (thread-safe; pode ser chamado de fora).
+    void agendar(std::coroutine_handle<> h);
+
+    // Executa 'fn' a partir de 'quando' (na thread do reator; deve ser curta,
+    // tipicamente só agenda uma corrotina).
+    void agendar_em(Relogio::time_point quando, std::function<void()> fn);
+
+    // Bloqueia até todas as tarefas geradas terminarem.
+    void aguardar();
+
+    size_t tarefas_vivas() const { return vivas_.load(); }
+    int n_threads() const { return static_cast<int>(threads_.size()); }
+
+    // Executor da thread atual (nullptr fora das threads de um executor).
+    static Executor* atual();
+
+    // Awaitable de tempo: co_await Executor::after(100ms);
+    struct AguardaTempo
+    {
+        Relogio::duration d;
+        bool await_ready() const noexcept { return d <= Relogio::duration::zero(); }
+        void await_suspend(std::coroutine_handle<> h);
+        void await_resume() const noexcept {}
+    };
+    static AguardaTempo after(Relogio::duration d) { return AguardaTempo{d}; }
+
+private:
+    friend struct Tarefa::promise_type;
+
+    void trabalhar();
+    void tarefa_encerrada();
+
+    Reator& reator_;
+    mutable MutexAtr mtx_;
+    CondVarAtr cv_;      // corrotina pronta ou parada
+    CondVarAtr cv_fim_;  // vivas_ chegou a zero
+    std::deque<std::coroutine_handle<>> prontas_;
+    bool parar_ = false;
+    std::atomic<size_t> vivas_{0};
+    std::vector<std::thread> threads_;
+};
@@ -0,0 +1,62 @@
+/*
+ * Arquivo: HostFrota.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define o modo "host de frota" do executável
+ * atr_mina. Em vez de simular um único caminhão, o processo passa a gerenciar
+ * um subconjunto da frota: vários hosts (no mesmo nó ou em nós diferentes)
+ * trocam uma lista de membros via MQTT e cada um assume os caminhões que o
+ * anel de hash consistente (AnelConsistente.h) lhe atribui, executando cada
+ * caminhão como um processo filho "atr_mina --truck-id=N --warm-start".
+ *
+ * Protocolo de membros (tópico /mina/frota/membros):
+ * - Cada host publica "host=<nome>" a cada heartbeat_ms.
+ * - Ao encerrar, publica "host=<nome>,saiu=1".
+ * - Um host sem heartbeat por expira_ms é considerado fora da frota.
+ *
+ * Rebalanceamento e transferência de estado:
+ * - Quando a lista de membros muda, cada host recalcula seus caminhões.
+ * - Caminhões perdidos: o filho recebe SIGINT, encerra as threads e publica
+ * o checkpoint retido (Checkpoint.h) antes de sair.
+ * - Caminhões ganhos: o host só inicia o filho (com --warm-start, que restaura
+ * posição, modo e waypoint) depois que o dono anterior o libera, para dois
+ * processos nunca guiarem o mesmo caminhão. Liberado significa: nenhum outro
+ * host o lista em /mina/frota/<host>/caminhoes, ou chegou um checkpoint
+ * publicado depois da mudança do anel. Se nada disso chega em limite_ms
+ * (dono anterior travado ou particionado), o timer assume.
+ * - carencia_ms é a espera mínima, para as listas retidas dos outros hosts
+ * chegarem antes da decisão.
+ * - Com hash consistente, apenas ~1/N dos caminhões mudam de dono quando um
+ * host entra ou sai.
+ * - Rotas: --fleet-routes=1:a.route,2:b.route dá a cada caminhão a sua (a
+ * mesma lista em todos os hosts, já que qualquer um pode assumir qualquer
+ * caminhão); os ausentes usam --route.
+ * - A lista de cada host é publicada (retida) em /mina/frota/<host>/caminhoes
+ * com os caminhões que ele detém: os atribuídos e os que ainda têm filho
+ * rodando (um caminhão perdido sai da lista quando o filho termina).
+ */
+
+#pragma once
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "AnelConsistente.h"
+#include "MqttClient.h"
+
+struct ConfigHostFrota
+{
+    std::string host_id;         // Nome único do host na frota
+    std::vector<int> caminhoes;  // Truck ids candidatos (iguais em todos os hosts)
+    std::string route;           // Rota repassada aos filhos (--route=)
+    std::map<int, std::string> rotas; // Rota por caminhão (--fleet-routes=); senão 'route'
+
+    std::string executavel;      // Binário usado para os filhos
+    int heartbeat_ms = 1000;     // Período do heartbeat
+    int expira_ms = 3500;        // Tempo sem heartbeat para remover um membro
+    int carencia_ms = 1000;      // Espera mínima antes de iniciar um caminhão recém-atribuído
+    int limite_ms = 12000;       // Sem liberação do dono anterior, inicia mesmo assim
+};
+
+// Executa o laço do host até stop_flag. Retorna o código de saída do processo.
+int executar_host_frota(const ConfigHostFrota& cfg, MqttClient& mqtt, std::atomic<bool>& stop_flag);
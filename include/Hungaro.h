@@ -0,0 +1,68 @@
+/*
+ * Arquivo: Hungaro.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define a classe AtribuicaoHungara, um resolvedor
+ * do problema de atribuição (caminhões x tarefas) de custo mínimo pelo método
+ * húngaro com potenciais (variante de caminhos aumentantes, O(n^3)).
+ *
+ * Modelo:
+ * - Linhas = caminhões, colunas = tarefas, custo[i][j] = custo (ex.: tempo
+ * estimado) para o caminhão i atender a tarefa j.
+ * - Matrizes retangulares são aceitas: se houver mais caminhões que tarefas,
+ * colunas fictícias de custo zero são acrescentadas (caminhão ocioso).
+ *
+ * Reotimização incremental:
+ * - resolver(): solução completa O(n^3).
+ * - remover_tarefa(j): quando uma tarefa termina, apenas o caminhão que a
+ * atendia fica livre. Os potenciais duais das demais linhas/colunas
+ * continuam viáveis, então basta um caminho aumentante a partir dessa linha
+ * (O(n^2)) em vez de resolver tudo de novo. Se a remoção deixar mais
+ * caminhões que tarefas, a nova coluna fictícia quebra a viabilidade dual e
+ * a solução é refeita por completo.
+ * - Qualquer mudança de custos (caminhões se movendo, tarefa nova) exige
+ * resolver() — que para 200 x 200 leva poucos milissegundos.
+ */
+
+#pragma once
+#include <vector>
+
+class AtribuicaoHungara
+{
+public:
+    // Valor usado para pares proibidos (ex.: sem caminho na malha viária).
+    static constexpr double PROIBIDO = 1e12;
+
+    AtribuicaoHungara() = default;
+
+    // Define a matriz de custos (linha-maior: custo[i * n_tarefas + j]).
+    void definir_custos(int n_caminhoes, int n_tarefas, const std::vector<double>& custo);
+
+    // Resolve do zero. Retorna o custo total da atribuição.
+    double resolver();
+
+    // Remove a tarefa j (índice atual) e reatribui só o caminhão liberado.
+    // Os índices das tarefas seguintes diminuem em 1. Retorna o custo total.
+    double remover_tarefa(int j);
+
+    // Tarefa atribuída ao caminhão i (-1 = ocioso).
+    int tarefa_de(int i) const { return i < (int)atrib_.size() ? atrib_[i] : -1; }
+
+    // Vetor caminhão -> tarefa (-1 = ocioso).
+    const std::vector<int>& atribuicao() const { return atrib_; }
+
+    int n_caminhoes() const { return n_; }
+    int n_tarefas() const { return m_; }
+
+private:
+    double c(int i, int j) const; // custo com colunas fictícias (1-based)
+    void aumentar(int linha);     // caminho aumentante a partir de 'linha' (1-based)
+    double finalizar();           // reconstrói atrib_ e calcula o custo
+
+    int n_ = 0;                 // caminhões
+    int m_ = 0;                 // tarefas reais
+    int cols_ = 0;              // colunas com fictícias (>= n_)
+    std::vector<double> custo_; // n_ x m_
+    std::vector<double> u_, v_; // potenciais (1-based, índice 0 auxiliar)
+    std::vector<int> p_;        // p_[j] = linha atribuída à coluna j (0 = livre)
+    std::vector<int> atrib_;    // resultado por caminhão
+};
@@ -0,0 +1,135 @@
+/*
+ * Arquivo: IndiceLog.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define um índice esparso de timestamps para o log
+ * CSV detalhado (logs/logs_caminhao_detailed.csv). Sem ele, descobrir o estado
+ * do caminhão 7 num certo instante exige ler o arquivo desde o início; com ele,
+ * uma busca binária no índice dá o offset a partir do qual basta ler poucas
+ * linhas.
+ *
+ * Arquivo de índice ("<csv>.idx"):
+ * - Sequência de EntradaIndiceLog binárias (24 bytes, ordem de bytes nativa),
+ * sem cabeçalho, na ordem em que foram gravadas (isto é, por offset).
+ * - Cada entrada aponta o início de uma linha do CSV: (timestamp_ms, truck_id,
+ * offset). O escritor grava uma entrada a cada 'passo' linhas do próprio
+ * caminhão ou quando mais de 'bloco' bytes foram escritos desde a última; a
+ * primeira linha de cada caminhão sempre é indexada.
+ * - Gravado de forma incremental (uma write() por entrada, com O_APPEND), de
+ * modo que vários processos de caminhão podem compartilhar o mesmo log. Uma
+ * entrada incompleta no fim do arquivo é ignorada na leitura.
+ * - Se o índice não corresponder ao CSV (CSV reescrito pela migração de
+ * cabeçalho, apagado ou truncado), o escritor o reconstrói ao abrir.
+ *
+ * Leitura (LeitorLog):
+ * - Por caminhão: os timestamps de um mesmo caminhão são crescentes, então a
+ * busca binária nas entradas dele dá o offset exato de início.
+ * - Todos os caminhões: o início é o menor dos offsets por caminhão. Como as
+ * linhas de processos diferentes podem se intercalar levemente fora de
+ * ordem, a leitura só para após FOLGA_MS além do fim do intervalo.
+ *
+ * Compactação (CompactacaoLog.h):
+ * - O trecho inicial já agregado pode ter sido descartado (buraco no arquivo,
+ * offsets preservados). inicio_dados_log() dá o offset da primeira linha que
+ * ainda existe; leitor e reconstrução do índice começam dali.
+ *
+ * Observação: os timestamps são os gravados no log (coluna timestamp_ms).
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct EntradaIndiceLog
+{
+    int64_t timestamp_ms = 0;
+    int32_t truck_id = 0;
+    uint32_t reservado = 0;
+    uint64_t offset = 0;     // início da linha no CSV
+};
+static_assert(sizeof(EntradaIndiceLog) == 24, "formato do arquivo de índice");
+
+// Caminho do índice de um CSV ("<csv>.idx").
+std::string caminho_indice(const std::string& caminho_csv);
+
+// Lê timestamp e truck_id do começo de uma linha do CSV. False para
+// cabeçalhos e linhas malformadas.
+bool campos_linha_log(const std::string& linha, int64_t& ts, int& truck_id);
+
+// Offset da primeira linha ainda presente no CSV (0 se nada foi descartado
+// pela compactação; lido de "<csv>.compactacao").
+uint64_t inicio_dados_log(const std::string& caminho_csv);
+
+// Reconstrói o índice de um CSV existente lendo-o inteiro (uma vez).
+// Retorna o número de entradas gravadas, ou -1 em caso de erro.
+long reconstruir_indice_log(const std::string& caminho_csv, uint32_t passo = 256,
+                            uint64_t bloco = 64 * 1024);
+
+// Mantém o índice enquanto o log é escrito (um por processo de caminhão).
+class EscritorIndiceLog
+{
+public:
+    // Abre (ou cria) o índice e o valida contra o CSV; reconstrói se preciso.
+    explicit EscritorIndiceLog(const std::string& caminho_csv, uint32_t passo = 256,
+                               uint64_t bloco = 64 * 1024);
+    ~EscritorIndiceLog();
+
+    EscritorIndiceLog(const EscritorIndiceLog&) = delete;
+    EscritorIndiceLog& operator=(const EscritorIndiceLog&) = delete;
+
+    // Informa uma linha de 'tamanho' bytes gravada em 'offset' no CSV.
+    // Grava uma entrada quando a linha cai no passo ou no limite de bloco.
+    void registrar(int64_t timestamp_ms, int truck_id, uint64_t offset, uint64_t tamanho);
+
+    uint64_t entradas_gravadas() const { return gravadas_; }
+
+private:
+    std::string caminho_csv_;
+    uint32_t passo_;
+    uint64_t bloco_;
+    int fd_ = -1;
+    uint64_t linhas_ = 0;            // linhas deste escritor
+    uint64_t bytes_desde_ultima_ = 0;
+    uint64_t gravadas_ = 0;
+};
+
+// Consultas pontuais e por intervalo sobre o CSV usando o índice.
+class LeitorLog
+{
+public:
+    // Folga de parada para consultas sem caminhão (linhas intercaladas).
+    static constexpr int64_t FOLGA_MS = 1000;
+
+    // Carrega o índice (se existir; sem ele as consultas leem desde o início).
+    explicit LeitorLog(const std::string& caminho_csv);
+
+    size_t entradas() const { return entradas_.size(); }
+
+    // Menor e maior timestamp indexados (false sem índice). Índice esparso:
+    // o maior fica até 'passo' linhas atrás do fim do CSV.
+    bool intervalo_indexado(int64_t& primeiro, int64_t& ultimo) const;
+
+    // Offset a partir do qual estão todas as linhas com ts >= t
+    // (do caminhão 'truck_id', ou de todos se truck_id < 0).
+    uint64_t offset_inicial(int64_t t, int truck_id = -1) const;
+
+    // Chama 'fn' para cada linha com t0 <= ts <= t1 (filtrando pelo caminhão
+    // se truck_id >= 0), em ordem de arquivo. 'fn' retorna false para parar.
+    // Retorna o número de linhas entregues.
+    size_t consultar(int64_t t0, int64_t t1, int truck_id,
+                     const std::function<bool(const std::string&)>& fn) const;
+
+    // Última linha do caminhão com ts <= t (o estado dele naquele instante).
+    std::optional<std::string> estado_em(int64_t t, int truck_id) const;
+
+private:
+    std::string caminho_csv_;
+    uint64_t tamanho_csv_ = 0;
+    uint64_t inicio_dados_ = 0;                   // antes disso: descartado
+    std::vector<EntradaIndiceLog> entradas_;      // por offset
+    std::map<int, std::vector<EntradaIndiceLog>> por_caminhao_;
+};
@@ -0,0 +1,155 @@
+/*
+ * Arquivo: IoLog.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define o backend de E/S dos logs do caminhão:
+ * - GravadorLog: uma thread de E/S dedicada que recebe as linhas de log das
+ * tarefas e as grava em lote, tirando as chamadas write() (bloqueantes) da
+ * tarefa ColetorDeDados, que também publica no MQTT.
+ * - LeitorSequencial: leitura sequencial de um arquivo grande (consultas e
+ * replay do log, ver IndiceLog.h) com vários blocos lidos antecipadamente.
+ *
+ * Backends:
+ * - io_uring (Linux >= 5.6), usado via syscalls diretas, sem liburing. O
+ * gravador usa buffers registrados (IORING_OP_WRITE_FIXED) e, a cada
+ * intervalo de fsync, encadeia um FSYNC após a escrita (IOSQE_IO_LINK). Em
+ * cada rodada, as escritas de todos os arquivos e seus fsyncs são enviadas
+ * numa única io_uring_enter(). O leitor mantém 'profundidade' leituras em voo.
+ * - Fallback síncrono (write()/pread()) quando io_uring não está disponível
+ * (kernel antigo, seccomp de container) ou com ATR_IO_URING=0.
+ *
+ * Semântica de gravação:
+ * - Os arquivos são abertos com O_APPEND: vários processos de caminhão podem
+ * compartilhar o mesmo log (modo host de frota). Cada rodada grava o lote
+ * de um arquivo numa única escrita, então as linhas de um processo nunca se
+ * misturam às de outro.
+ * - O callback opcional de escrever() recebe o offset em que a linha ficou no
+ * arquivo (usado pelo índice esparso). Ele roda na thread de E/S. Se uma
+ * escrita curta obrigou a gravar o lote em pedaços, o offset não é
+ * confiável e o callback não é chamado (o índice fica mais esparso).
+ * - descarregar() espera até tudo o que foi enfileirado estar gravado; o
+ * destrutor descarrega, faz o último fsync e fecha os arquivos.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class AnelIoUring; // definido em IoLog.cpp
+
+// true se io_uring não foi desligado por ATR_IO_URING=0.
+bool io_uring_habilitado();
+
+class GravadorLog
+{
+public:
+    struct Estatisticas
+    {
+        uint64_t linhas = 0;
+        uint64_t bytes = 0;
+        uint64_t rodadas = 0;       // lotes gravados
+        uint64_t chamadas = 0;      // syscalls de escrita/submissão
+        uint64_t fsyncs = 0;
+        uint64_t erros = 0;
+        uint64_t sem_offset = 0;    // lotes divididos, sem callbacks de offset
+    };
+
+    explicit GravadorLog(std::chrono::milliseconds intervalo_fsync = std::chrono::milliseconds(1000));
+    ~GravadorLog();
+
+    GravadorLog(const GravadorLog&) = delete;
+    GravadorLog& operator=(const GravadorLog&) = delete;
+
+    // Abre (cria se preciso) um arquivo para append. Retorna o identificador
+    // usado em escrever(), ou -1 em caso de erro.
+    int abrir(const std::string& caminho);
+
+    // Enfileira 'dados' (uma ou mais linhas completas) para o arquivo.
+    void escrever(int arquivo, std::string dados,
+                  std::function<void(uint64_t offset)> ao_gravar = {});
+
+    // Bloqueia até que tudo o que foi enfileirado até aqui esteja gravado.
+    void descarregar();
+
+    // "io_uring" ou "write".
+    const char* backend() const;
+    Estatisticas estatisticas() const;
+
+private:
+    struct Pendente
+    {
+        std::string dados;
+        std::function<void(uint64_t)> ao_gravar;
+    };
+    struct Arquivo
+    {
+        int fd = -1;
+        std::string caminho;
+        std::vector<Pendente> fila;
+    };
+
+    void laco();
+    // Grava um lote por arquivo; 'fsync' (se não nulo) marca os arquivos a sincronizar.
+    void gravar_lote(std::vector<std::vector<Pendente>>& lotes, const std::vector<bool>* fsync);
+    // Entrega os offsets das linhas de um lote que terminou em 'fim'.
+    void concluir(std::vector<Pendente>& lote, uint64_t fim);
+
+    std::unique_ptr<AnelIoUring> anel_;
+    std::vector<std::vector<char>> buffers_;    // um buffer registrado por arquivo
+    std::vector<int> fds_;                      // cópia usada pela thread de E/S
+    std::chrono::milliseconds intervalo_fsync_;
+
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    std::condition_variable cv_vazio_;
+    std::vector<Arquivo> arquivos_;
+    uint64_t enfileirados_ = 0;                 // linhas: enfileiradas x gravadas
+    uint64_t concluidos_ = 0;
+    bool sair_ = false;
+    Estatisticas est_;
+    std::thread thread_;
+};
+
+// Leitura sequencial de um arquivo a partir de um offset, linha a linha.
+class LeitorSequencial
+{
+public:
+    LeitorSequencial(const std::string& caminho, uint64_t offset,
+                     size_t bloco = 256 * 1024, unsigned profundidade = 4);
+    ~LeitorSequencial();
+
+    LeitorSequencial(const LeitorSequencial&) = delete;
+    LeitorSequencial& operator=(const LeitorSequencial&) = delete;
+
+    bool aberto() const { return fd_ >= 0; }
+
+    // Próxima linha (sem o '\n'). False no fim do arquivo.
+    bool linha(std::string& out);
+
+private:
+    bool proximo_bloco();
+    void enviar_leitura(unsigned slot);
+
+    int fd_ = -1;
+    size_t bloco_;
+    unsigned profundidade_;
+    std::unique_ptr<AnelIoUring> anel_;
+    std::vector<std::vector<char>> buffers_;
+    std::vector<int64_t> resultado_;     // bytes lidos por slot (-1: em voo)
+    uint64_t proximo_envio_ = 0;         // offset da próxima leitura a enviar
+    unsigned slot_atual_ = 0;
+    bool fim_ = false;                   // nada mais a ler
+    bool ultimo_ = false;                // o bloco em consumo é o último
+
+    const char* dados_ = nullptr;        // bloco em consumo
+    size_t tam_ = 0;
+    size_t pos_ = 0;
+    std::string resto_;                  // linha partida entre blocos
+};
@@ -0,0 +1,28 @@
+/*
+ * Arquivo: JsonSimples.h
+ * Finalidade:
+ * Este arquivo de cabeçalho reúne as funções de JSON usadas nos payloads
+ * MQTT do projeto. Os payloads são objetos pequenos e planos, gerados pelo
+ * próprio sistema, então não há um parser completo: as chaves são achadas
+ * por busca de texto ("chave") e o valor é lido logo após os dois-pontos.
+ *
+ * Limitações:
+ * - A primeira ocorrência de "chave" vence, inclusive dentro de objetos
+ * aninhados; use nomes de chave que não se repitam no payload.
+ * - texto_json não desfaz os escapes (\" continua \" no resultado).
+ */
+
+#pragma once
+
+#include <string>
+
+// Escapa um texto para uso entre aspas num JSON (aspas, barra, \n, \r e \t).
+std::string json_escapar(const std::string& s);
+
+// Valor bruto (objeto, lista, texto com aspas ou número) de uma chave; "" se ausente.
+std::string valor_json(const std::string& s, const std::string& chave);
+
+// Número/inteiro/texto de uma chave; false se ausente ou de outro tipo.
+bool numero_json(const std::string& s, const std::string& chave, double& out);
+bool inteiro_json(const std::string& s, const std::string& chave, long& out);
+bool texto_json(const std::string& s, const std::string& chave, std::string& out);
@@ -0,0 +1,98 @@
+/*
+ * Arquivo: KpiCaminhao.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define o agregador incremental de indicadores
+ * (KPIs) de um caminhão: distância percorrida, tempo em automático/manual,
+ * tempo em alerta/defeito, velocidade e temperatura (média, desvio, mínimo e
+ * máximo) e waypoints alcançados. Os relatórios de turno passam a vir do
+ * agregador, sem varrer os logs CSV.
+ *
+ * Características:
+ * - O(1) por amostra: EstatisticaCorrente usa o método de Welford (média e
+ * variância sem guardar as amostras).
+ * - Durações ponderadas pelo tempo: o intervalo entre duas amostras é
+ * atribuído ao estado da amostra anterior. Intervalos maiores que
+ * MAX_INTERVALO_MS (perda de amostras, pausa) não contam.
+ * - Distância com zona morta: o ruído da posição parada não acumula; a
+ * distância só avança quando o caminhão se afasta LIMIAR_DISTANCIA do último
+ * ponto contado. A velocidade de cada trecho entra na estatística.
+ * - Thread-safe: o coletor alimenta as amostras, o gerenciador de rota os
+ * waypoints e o main lê/publica o resumo.
+ *
+ * Publicação (main.cpp): JSON em /mina/caminhoes/<id>/kpi a cada 5 s e a
+ * cada mensagem em /mina/caminhoes/<id>/kpi/pedido; o payload "reset" zera os
+ * indicadores (início de turno) depois de publicar os do turno encerrado.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "PoliticaRitmo.h" // período de hibernação
+
+// Média, variância, mínimo e máximo incrementais (Welford).
+struct EstatisticaCorrente
+{
+    uint64_t n = 0;
+    double media = 0.0;
+    double m2 = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+
+    void adicionar(double x);
+    double variancia() const { return n > 1 ? m2 / (n - 1) : 0.0; }
+    double desvio() const;
+};
+
+struct KpiCaminhao
+{
+    uint64_t amostras = 0;
+    uint64_t ms_total = 0;
+    uint64_t ms_automatico = 0;
+    uint64_t ms_manual = 0;
+    uint64_t ms_alerta = 0;
+    uint64_t ms_defeito = 0;
+    uint64_t defeitos = 0;    // entradas em defeito
+    uint64_t waypoints = 0;   // waypoints alcançados
+    double distancia = 0.0;   // px
+    EstatisticaCorrente velocidade;  // px/s, por trecho
+    EstatisticaCorrente temperatura; // °C, por amostra
+
+    // Distância / tempo amostrado (px/s).
+    double velocidade_media() const { return ms_total ? distancia * 1000.0 / ms_total : 0.0; }
+
+    std::string serializar() const;
+};
+
+class AgregadorKpi
+{
+public:
+    // Hibernando, as amostras chegam a cada ~1 s mais o atraso do laço: o
+    // limite de lacuna fica bem acima disso.
+    static constexpr uint64_t MAX_INTERVALO_MS = 2 * PoliticaRitmo::PERIODO_HIBERNANDO_MS;
+    static constexpr double LIMIAR_DISTANCIA = 2.0; // px
+
+    // Amostra filtrada com o estado do caminhão no instante dela.
+    void amostra(uint64_t ts_ms, double x, double y, double temperatura,
+                 bool automatico, bool alerta, bool defeito);
+
+    // Chamado pelo gerenciador de rota ao avançar de waypoint.
+    void waypoint_alcancado();
+
+    KpiCaminhao atual() const;
+
+    // Zera os indicadores (novo turno) e retorna os do turno encerrado; a
+    // próxima amostra recomeça a contagem.
+    KpiCaminhao reiniciar();
+
+private:
+    mutable std::mutex mtx_;
+    KpiCaminhao kpi_;
+    bool tem_anterior_ = false;
+    uint64_t ts_anterior_ = 0;
+    bool auto_anterior_ = false, alerta_anterior_ = false, defeito_anterior_ = false;
+    double ancora_x_ = 0.0, ancora_y_ = 0.0; // último ponto contado na distância
+    uint64_t ancora_ts_ = 0;
+};
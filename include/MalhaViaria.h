@@ -0,0 +1,138 @@
+/*
+ * Arquivo: MalhaViaria.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define a malha viária da mina (estradas de
+ * transporte) e o roteamento de menor tempo sobre ela por hierarquias de
+ * contração (contraction hierarchies). As rotas deixam de ser só arquivos
+ * .route estáticos: entre quaisquer dois pontos (carga, descarga, posição do
+ * caminhão) a malha responde o tempo mínimo em microssegundos e a rota como
+ * um objeto Route, o que permite ao despacho consultar milhares de caminhos
+ * por segundo.
+ *
+ * Modelo:
+ * - Nós com id e posição (x, y) no mesmo sistema de coordenadas das rotas.
+ * - Arestas dirigidas com comprimento (px; padrão = distância entre os nós),
+ * velocidade (px/s) e capacidade (caminhões simultâneos; informativa, para
+ * regras de congestionamento). O peso é o tempo: comprimento / velocidade.
+ *
+ * Arquivo (.malha; '#' inicia comentário):
+ *   no <id> <x> <y>
+ *   via <de> <para> <velocidade> [capacidade] [comprimento]   (mão única)
+ *   via2 <a> <b> <velocidade> [capacidade] [comprimento]      (mão dupla)
+ *
+ * Pré-processamento (preparar()):
+ * - Contrai os nós em ordem de importância (diferença de arestas mais
+ * vizinhos já contraídos, com atualização preguiçosa). Ao contrair v, cada
+ * par u -> v -> w sem caminho testemunha mais curto (Dijkstra local limitado)
+ * ganha um atalho u -> w.
+ * - O resultado fica em dois grafos "para cima" em CSR: a consulta é um
+ * Dijkstra bidirecional que só sobe na hierarquia e visita poucas dezenas de
+ * nós; os atalhos guardam o nó do meio para desempacotar o caminho.
+ *
+ * Uso:
+ * - Uma consulta por vez por instância: o estado de busca é reaproveitado
+ * entre consultas (sem limpar vetores do tamanho da malha).
+ * - custo(x0, y0, x1, y1) tem a assinatura de Despachante::FuncaoCusto: liga
+ * cada ponto ao nó mais próximo em linha reta (VELOCIDADE_ACESSO) e soma o
+ * tempo na malha; infinito se não há caminho.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Route.h"
+
+struct NoMalha
+{
+    int id = 0;
+    double x = 0.0;
+    double y = 0.0;
+};
+
+struct ViaMalha
+{
+    int de = 0;               // índice interno do nó de origem
+    int para = 0;             // índice interno do nó de destino
+    double comprimento = 0.0; // px
+    double velocidade = 0.0;  // px/s
+    int capacidade = 0;       // caminhões (0 = não informada)
+    double tempo() const { return comprimento / velocidade; }
+};
+
+class MalhaViaria
+{
+public:
+    static constexpr double INFINITO = std::numeric_limits<double>::infinity();
+    // Trechos fora da malha (ponto -> nó mais próximo), px/s.
+    static constexpr double VELOCIDADE_ACESSO = 40.0;
+
+    // Carrega do arquivo/texto no formato acima e chama preparar().
+    bool loadFromFile(const std::string& path);
+    bool loadFromString(const std::string& content);
+
+    // Construção programática (índices internos são a ordem de inserção).
+    int adicionar_no(int id, double x, double y);
+    bool adicionar_via(int id_de, int id_para, double velocidade, int capacidade = 0, double comprimento = -1.0);
+
+    // Constrói a hierarquia; obrigatório após mudar nós ou vias.
+    void preparar();
+    bool preparada() const { return preparada_; }
+
+    // Tempo mínimo (s) entre dois nós (ids); INFINITO se não há caminho.
+    // caminho (opcional) recebe os ids dos nós, origem e destino inclusive.
+    double tempo(int id_de, int id_para, std::vector<int>* caminho = nullptr);
+
+    // Rota entre dois nós (waypoints nos nós, velocidade da via de chegada).
+    Route rota(int id_de, int id_para);
+
+    // Rota de um ponto qualquer a outro, entrando e saindo pelos nós mais próximos.
+    Route rota_entre(double x0, double y0, double x1, double y1);
+
+    // Tempo estimado (s) de um ponto a outro pela malha (FuncaoCusto).
+    double custo(double x0, double y0, double x1, double y1);
+
+    // Id do nó mais próximo de (x, y); -1 se a malha está vazia.
+    int no_mais_proximo(double x, double y) const;
+
+    const std::vector<NoMalha>& nos() const { return nos_; }
+    const std::vector<ViaMalha>& vias() const { return vias_; }
+    size_t atalhos() const { return atalhos_; }
+
+private:
+    struct Arco
+    {
+        int alvo;
+        double peso;
+        int meio; // nó contraído que o atalho pula; -1 = via original
+    };
+
+    int indice(int id) const;
+    double consultar(int s, int t, std::vector<int>* caminho);
+    const Arco* arco(int u, int w) const; // arco u -> w da hierarquia de menor peso
+    void desempacotar(int u, int w, int meio, std::vector<int>& saida) const;
+
+    std::vector<NoMalha> nos_;
+    std::vector<ViaMalha> vias_;
+    std::map<int, int> indice_; // id -> índice interno
+    std::map<std::pair<int, int>, size_t> via_entre_; // (de, para) -> via mais rápida
+    bool preparada_ = false;
+    size_t atalhos_ = 0;
+
+    // Hierarquia (CSR): sobe_[v] = arcos v -> w com nível(w) > nível(v);
+    // desce_[v] = arcos u -> v com nível(u) > nível(v), guardados como v <- u.
+    std::vector<uint32_t> ini_sobe_, ini_desce_;
+    std::vector<Arco> sobe_, desce_;
+
+    // Estado de busca reaproveitado: entradas valem só com versao == consulta_.
+    std::vector<double> dist_[2];
+    std::vector<int> pai_[2];
+    std::vector<int> meio_[2]; // meio do arco pai -> nó
+    std::vector<uint32_t> versao_[2];
+    std::vector<std::pair<double, int>> fila_[2];
+    uint32_t consulta_ = 0;
+};
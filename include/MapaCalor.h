@@ -0,0 +1,106 @@
+/*
+ * Arquivo: MapaCalor.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define o mapa de calor da frota: uma grade de
+ * resolução fixa sobre a área da mina (1000×1000) que acumula o tempo de
+ * permanência dos caminhões em cada célula, com decaimento exponencial em
+ * várias escalas de tempo (padrão: 1 min, 10 min e 1 h). Serve às vistas de
+ * congestionamento e ao planejamento de vias sem processar os logs em lote.
+ *
+ * Características:
+ * - Poucas somas por amostra: o decaimento é preguiçoso. Cada escala guarda
+ * os valores multiplicados por exp((t - t_base)/tau); somar w no instante t é
+ * somar w·exp((t - t_base)/tau) a uma célula. Quando o fator fica grande, a
+ * grade é rebaseada (multiplicada uma vez) e t_base avança.
+ * - Permanência: cada amostra de posição soma o intervalo desde a amostra
+ * anterior do mesmo caminhão (limitado a MAX_INTERVALO_MS) à célula atual.
+ * - Amostragem: o /posicao é suprimido em trechos previsíveis
+ * (ReconstrucaoPosicao.h), então uma mensagem não é uma amostra de
+ * permanência. AmostradorMapa reconstrói a posição de cada caminhão e
+ * alimenta o mapa num período fixo (PERIODO_MS) a partir da extrapolação.
+ * - Deltas comprimidos: codificar() envia só as células cujo valor
+ * quantizado (décimos de segundo) mudou além do limiar desde a última
+ * publicação; com completo=true envia todas as células não nulas.
+ *
+ * Formato publicado (texto):
+ *     t=<ms>;escala=<s>;celula=<px>;grade=<colunas>x<linhas>;c=<salto>:<valor>,...
+ * - Células em ordem crescente de índice (linha*colunas + coluna); salto é a
+ * diferença para o índice anterior (o primeiro é o próprio índice).
+ * - valor em décimos de segundo já decaídos; 0 = célula zerada.
+ * - Contadores de 32 bits: o valor de uma célula tende a (caminhões na
+ * célula) × tau, e com 16 bits (6553,5 s) a escala de 1 h saturava com dois
+ * caminhões parados na mesma fila. O limite (~13,6 anos de permanência) fica
+ * fora de alcance para qualquer escala e frota.
+ *
+ * O serviço MQTT que alimenta e publica o mapa está em ServicoMapaCalor.h.
+ */
+
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ReconstrucaoPosicao.h"
+
+class MapaCalor
+{
+public:
+    static constexpr uint64_t MAX_INTERVALO_MS = 1000;
+
+    MapaCalor(double largura = 1000.0, double altura = 1000.0, double celula = 10.0,
+              std::vector<double> escalas_s = {60.0, 600.0, 3600.0});
+
+    // Posição do caminhão no instante ts_ms (relógio monotônico, ms).
+    void amostra(int truck_id, double x, double y, uint64_t ts_ms);
+
+    // Permanência decaída (s) da célula no instante ts_ms.
+    double valor(size_t escala, int coluna, int linha, uint64_t ts_ms) const;
+
+    // Células alteradas desde a última codificação desta escala (ou todas as
+    // não nulas, se completo); atualiza o estado publicado. "" se nada mudou.
+    std::string codificar(size_t escala, uint64_t ts_ms, bool completo);
+
+    size_t num_escalas() const { return escalas_.size(); }
+    double escala_s(size_t escala) const { return escalas_[escala].tau_s; }
+    int colunas() const { return colunas_; }
+    int linhas() const { return linhas_; }
+
+private:
+    struct Escala
+    {
+        double tau_s;
+        uint64_t t_base = 0;          // instante de referência do fator
+        std::vector<double> soma;     // valores × exp((t - t_base)/tau)
+        std::vector<uint32_t> publicado; // último valor quantizado enviado
+    };
+
+    double fator(const Escala& e, uint64_t ts_ms) const;
+    void rebasear(Escala& e, uint64_t ts_ms);
+
+    double celula_;
+    int colunas_, linhas_;
+    std::vector<Escala> escalas_;
+    std::map<int, uint64_t> ultimo_ts_; // caminhão -> instante da última amostra
+};
+
+// Alimenta o mapa com as posições reconstruídas do /posicao, num período fixo.
+class AmostradorMapa
+{
+public:
+    static constexpr uint64_t PERIODO_MS = 100;
+    // Sem /posicao por mais que isso, o caminhão deixa de somar permanência.
+    static constexpr uint64_t EXPIRA_MS = 3000;
+
+    explicit AmostradorMapa(MapaCalor& mapa) : mapa_(mapa) {}
+
+    // Payload do /posicao recebido no instante t_ms (relógio monotônico, ms).
+    void posicao(int truck_id, const std::string& payload, uint64_t t_ms);
+
+    // Soma ao mapa a posição estimada de cada caminhão ativo no instante t_ms.
+    void amostrar(uint64_t t_ms);
+
+private:
+    MapaCalor& mapa_;
+    std::map<int, ReconstrutorPosicao> frota_;
+};
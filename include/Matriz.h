@@ -0,0 +1,87 @@
+/*
+ * Arquivo: Matriz.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define a classe de template Matriz<L, C>, uma
+ * matriz densa de dimensões fixas em tempo de compilação. Ela é usada pelo
+ * controlador preditivo (MpcVelocidade.h), onde todas as dimensões (estados,
+ * entradas, horizonte) são conhecidas de antemão.
+ *
+ * Características:
+ * - Armazenamento em std::array (linha-maior), sem alocação dinâmica: cabe na
+ * pilha e pode ser usada no laço de controle sem tocar no heap.
+ * - Dimensões verificadas pelo compilador: multiplicar Matriz<2,3> por
+ * Matriz<2,3> não compila.
+ * - Só as operações necessárias ao MPC: acesso (i, j), soma, subtração,
+ * produto, transposta, escala e identidade.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+template<int L, int C>
+class Matriz
+{
+public:
+    static_assert(L > 0 && C > 0, "dimensões devem ser positivas");
+    static constexpr int linhas = L;
+    static constexpr int colunas = C;
+
+    Matriz() { a_.fill(0.0); }
+
+    static Matriz zeros() { return Matriz(); }
+
+    static Matriz identidade()
+    {
+        static_assert(L == C, "identidade requer matriz quadrada");
+        Matriz m;
+        for (int i = 0; i < L; ++i) m(i, i) = 1.0;
+        return m;
+    }
+
+    double& operator()(int i, int j) { return a_[static_cast<size_t>(i) * C + j]; }
+    double operator()(int i, int j) const { return a_[static_cast<size_t>(i) * C + j]; }
+
+    // Acesso linear (vetores coluna: Matriz<N, 1>)
+    double& operator[](int k) { return a_[static_cast<size_t>(k)]; }
+    double operator[](int k) const { return a_[static_cast<size_t>(k)]; }
+
+    // Elementos em ordem linha-maior (laços internos sem acesso por índice)
+    double* dados() { return a_.data(); }
+    const double* dados() const { return a_.data(); }
+
+    Matriz<C, L> transposta() const
+    {
+        Matriz<C, L> t;
+        for (int i = 0; i < L; ++i)
+            for (int j = 0; j < C; ++j) t(j, i) = (*this)(i, j);
+        return t;
+    }
+
+    Matriz& operator+=(const Matriz& o) { for (size_t k = 0; k < a_.size(); ++k) a_[k] += o.a_[k]; return *this; }
+    Matriz& operator-=(const Matriz& o) { for (size_t k = 0; k < a_.size(); ++k) a_[k] -= o.a_[k]; return *this; }
+    Matriz& operator*=(double s) { for (double& v : a_) v *= s; return *this; }
+
+    friend Matriz operator+(Matriz a, const Matriz& b) { a += b; return a; }
+    friend Matriz operator-(Matriz a, const Matriz& b) { a -= b; return a; }
+    friend Matriz operator*(Matriz a, double s) { a *= s; return a; }
+    friend Matriz operator*(double s, Matriz a) { a *= s; return a; }
+
+private:
+    std::array<double, static_cast<size_t>(L) * C> a_;
+};
+
+// Produto (L x K) * (K x C) -> (L x C)
+template<int L, int K, int C>
+Matriz<L, C> operator*(const Matriz<L, K>& a, const Matriz<K, C>& b)
+{
+    Matriz<L, C> r;
+    for (int i = 0; i < L; ++i)
+        for (int k = 0; k < K; ++k) {
+            const double aik = a(i, k);
+            if (aik == 0.0) continue;
+            for (int j = 0; j < C; ++j) r(i, j) += aik * b(k, j);
+        }
+    return r;
+}
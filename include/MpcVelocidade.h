@@ -0,0 +1,218 @@
+/*
+ * Arquivo: MpcVelocidade.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define a classe de template MpcVelocidade<N>, um
+ * controlador preditivo (MPC) de horizonte curto para o controle longitudinal
+ * do caminhão. Ele é uma alternativa opcional ao PI de velocidade de
+ * ControleDeNavegacao_thread: em vez de reagir só ao erro atual, prevê os
+ * próximos N ciclos e começa a frear antes do waypoint, eliminando o
+ * sobressinal na chegada.
+ *
+ * Modelo (período Ts, estado x = [d, v]):
+ * - d = distância restante até o setpoint (px), v = velocidade (px/s).
+ * - d[k+1] = d[k] - Ts * v[k]
+ * - v[k+1] = v[k] + Ts * ganho_acel * u[k]      (u = comando -100..100, mesmo
+ * ganho "accel_scale" da simulação em TratamentoSensores_thread)
+ *
+ * Referência:
+ * - Perfil igual ao do PI: v_ref = min(v_cruzeiro, ganho_perfil * d), integrado
+ * ao longo do horizonte para obter d_ref[k] e v_ref[k].
+ *
+ * QP condensado:
+ * - X = Phi * x0 + Gama * U. Custo = sum q_d (d - d_ref)^2 + q_v (v - v_ref)^2
+ * + r u^2 + s (u[k] - u[k-1])^2, sujeito a |u| <= 100.
+ * - H = Gama' Q Gama + r I + s D'D e F = Gama' Q são constantes e calculados
+ * uma única vez no construtor; por ciclo só se calcula o termo linear
+ * f = F (Phi x0 - X_ref) - s u_anterior e0 (O(N^2)).
+ * - Solução por gradiente projetado acelerado (FISTA) com passo 1/L, onde L é
+ * o maior autovalor de H (método da potência, no construtor). A projeção na
+ * caixa [-100, 100] é trivial, então cada iterado é sempre viável.
+ * - Warm start: a solução anterior deslocada de um passo. Em regime, poucas
+ * iterações bastam.
+ *
+ * Orçamento de tempo:
+ * - max_iter limita o pior caso; como todo iterado é viável, interromper
+ * cedo só reduz otimalidade. estatisticas() informa o tempo da última e da
+ * pior solução e quantas ultrapassaram o orçamento (orcamento_us).
+ * - Todas as dimensões são parâmetros de template (Matriz<L, C>): nenhuma
+ * alocação no laço de controle.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "Matriz.h"
+#include "Relogio.h"
+
+struct ParametrosMpc
+{
+    double ts = 0.1;            // período de controle (s)
+    double ganho_acel = 0.6;    // px/s^2 por % de comando
+    double v_cruzeiro = 80.0;   // px/s
+    double ganho_perfil = 0.4;  // v_ref = ganho_perfil * d perto do alvo
+    double q_d = 1.0;           // peso do erro de distância
+    double q_v = 2.0;           // peso do erro de velocidade
+    double r = 1e-3;            // peso do esforço de controle
+    double s = 2e-3;            // peso da variação do comando
+    double u_max = 100.0;       // limite do atuador (simétrico)
+    int max_iter = 60;          // iterações máximas por ciclo
+    double tol = 0.05;          // parada: variação máxima de u (%) entre iterações
+    double orcamento_us = 1000.0;
+};
+
+struct EstatisticasMpc
+{
+    uint64_t solucoes = 0;
+    uint64_t estouros = 0;      // soluções acima de orcamento_us
+    double ultimo_us = 0.0;
+    double max_us = 0.0;
+    int ultimas_iter = 0;
+};
+
+template<int N>
+class MpcVelocidade
+{
+public:
+    static_assert(N >= 2, "horizonte deve ter pelo menos 2 passos");
+    static constexpr int NX = 2; // [d, v]
+
+    explicit MpcVelocidade(const ParametrosMpc& p = ParametrosMpc())
+        : p_(p)
+    {
+        Matriz<NX, NX> A = Matriz<NX, NX>::identidade();
+        A(0, 1) = -p_.ts;
+        Matriz<NX, 1> B;
+        B(1, 0) = p_.ts * p_.ganho_acel;
+
+        // Phi (linhas k: A^(k+1)) e Gama (bloco (k, j) = A^(k-j) B, j <= k)
+        Matriz<NX, NX> Ak = A;
+        for (int k = 0; k < N; ++k) {
+            for (int a = 0; a < NX; ++a)
+                for (int b = 0; b < NX; ++b) phi_(k * NX + a, b) = Ak(a, b);
+            Ak = A * Ak;
+        }
+        Matriz<NX, 1> AkB = B;
+        for (int d = 0; d < N; ++d) { // d = k - j
+            for (int j = 0; j + d < N; ++j)
+                for (int a = 0; a < NX; ++a) gama_(( j + d) * NX + a, j) = AkB(a, 0);
+            AkB = A * AkB;
+        }
+
+        // F = Gama' Q (Q diagonal) e H = Gama' Q Gama + r I + s D'D
+        for (int i = 0; i < N; ++i)
+            for (int k = 0; k < N * NX; ++k)
+                F_(i, k) = gama_(k, i) * (k % NX == 0 ? p_.q_d : p_.q_v);
+        H_ = F_ * gama_;
+        for (int i = 0; i < N; ++i) {
+            H_(i, i) += p_.r + 2.0 * p_.s;
+            if (i + 1 < N) { H_(i, i + 1) -= p_.s; H_(i + 1, i) -= p_.s; }
+        }
+        H_(N - 1, N - 1) -= p_.s; // D'D: último elemento só aparece uma vez
+
+        passo_ = 1.0 / maior_autovalor();
+        reiniciar(0.0);
+    }
+
+    // Reinicia o warm start com o comando atual (transferência sem solavanco).
+    void reiniciar(double u_atual)
+    {
+        u_atual = std::clamp(u_atual, -p_.u_max, p_.u_max);
+        for (int i = 0; i < N; ++i) U_[i] = u_atual;
+        u_anterior_ = u_atual;
+    }
+
+    // Calcula o comando (-u_max..u_max) para a distância e velocidade atuais.
+    double calcular(double distancia, double velocidade)
+    {
+        const int64_t t0 = Relogio::mono_ns();
+
+        // referência ao longo do horizonte
+        Matriz<N * NX, 1> erro0; // Phi x0 - X_ref
+        double x0[NX] = {distancia, velocidade};
+        double d_ref = std::max(0.0, distancia);
+        for (int k = 0; k < N; ++k) {
+            double v_ref = std::min(p_.v_cruzeiro, p_.ganho_perfil * d_ref);
+            d_ref = std::max(0.0, d_ref - p_.ts * v_ref);
+            v_ref = std::min(p_.v_cruzeiro, p_.ganho_perfil * d_ref);
+            erro0[k * NX]     = phi_(k * NX, 0) * x0[0] + phi_(k * NX, 1) * x0[1] - d_ref;
+            erro0[k * NX + 1] = phi_(k * NX + 1, 0) * x0[0] + phi_(k * NX + 1, 1) * x0[1] - v_ref;
+        }
+        Matriz<N, 1> f = F_ * erro0;
+        f[0] -= p_.s * u_anterior_;
+
+        // warm start: solução anterior deslocada
+        Matriz<N, 1> U;
+        for (int i = 0; i + 1 < N; ++i) U[i] = U_[i + 1];
+        U[N - 1] = U_[N - 1];
+
+        // FISTA com projeção na caixa
+        Matriz<N, 1> Y = U;
+        double tk = 1.0;
+        int it = 0;
+        const double* h = H_.dados();
+        const double* y = Y.dados();
+        for (; it < p_.max_iter; ++it) {
+            // g = H Y + f sobre os dados brutos: é o laço mais quente do ciclo
+            // e, sem otimização do compilador, o acesso por (i, j) domina o tempo.
+            Matriz<N, 1> Un;
+            double delta = 0.0;
+            for (int i = 0; i < N; ++i) {
+                double g = f[i];
+                const double* hi = h + i * N;
+                for (int j = 0; j < N; ++j) g += hi[j] * y[j];
+                Un[i] = std::clamp(y[i] - passo_ * g, -p_.u_max, p_.u_max);
+                delta = std::max(delta, std::abs(Un[i] - U[i]));
+            }
+            double tn = 0.5 * (1.0 + std::sqrt(1.0 + 4.0 * tk * tk));
+            for (int i = 0; i < N; ++i) Y[i] = Un[i] + ((tk - 1.0) / tn) * (Un[i] - U[i]);
+            U = Un;
+            tk = tn;
+            if (delta < p_.tol) { ++it; break; }
+        }
+        U_ = U;
+        u_anterior_ = U[0];
+
+        double us = static_cast<double>(Relogio::mono_ns() - t0) / 1e3;
+        est_.solucoes++;
+        est_.ultimo_us = us;
+        est_.max_us = std::max(est_.max_us, us);
+        est_.ultimas_iter = it;
+        if (us > p_.orcamento_us) est_.estouros++;
+        return U[0];
+    }
+
+    const EstatisticasMpc& estatisticas() const { return est_; }
+    const ParametrosMpc& parametros() const { return p_; }
+
+private:
+    // Método da potência para o maior autovalor de H (simétrica, definida positiva).
+    double maior_autovalor() const
+    {
+        Matriz<N, 1> x;
+        for (int i = 0; i < N; ++i) x[i] = 1.0;
+        double lambda = 1.0;
+        for (int it = 0; it < 200; ++it) {
+            Matriz<N, 1> y = H_ * x;
+            double norma = 0.0;
+            for (int i = 0; i < N; ++i) norma += y[i] * y[i];
+            norma = std::sqrt(norma);
+            if (norma <= 0.0) break;
+            for (int i = 0; i < N; ++i) x[i] = y[i] / norma;
+            lambda = norma;
+        }
+        return lambda * 1.01; // margem para o passo continuar estável
+    }
+
+    ParametrosMpc p_;
+    Matriz<N * NX, NX> phi_;
+    Matriz<N * NX, N> gama_;
+    Matriz<N, N * NX> F_;
+    Matriz<N, N> H_;
+    double passo_ = 0.0;
+    Matriz<N, 1> U_;
+    double u_anterior_ = 0.0;
+    EstatisticasMpc est_;
+};
@@ -22,21 +22,56 @@
  * caso a fila esteja vazia.
  * - Publicação: Oferece um método simples (publish) para enviar mensagens
  * para um tópico específico.
+ * - Corrotinas: co_await next(topico) / next_for(topico, timeout) suspendem a
+ * corrotina até chegar uma mensagem; o callback entrega a mensagem direto à
+ * corrotina que espera há mais tempo e a agenda no seu Executor. Filas e
+ * esperas ficam em CaixaMensagens.h, que não depende do Paho.
  * - Resiliência: Projetado para ser mais robusto a erros e desconexões.
+ * - MQTT v5: a sessão é aberta em v5 (clean start) quando o broker aceita,
+ * com volta automática para 3.1.1. Tópicos de telemetria registrados com
+ * configurar_topico() usam alias de tópico (o nome completo só vai na primeira
+ * publicação da conexão; depois segue um inteiro de 2 bytes), propriedades de
+ * usuário "v" (versão do esquema do payload; só na primeira publicação do
+ * tópico na conexão e nas retidas) e "seq" (sequência por tópico) e
+ * expiração de mensagem, para que amostras velhas não sejam entregues depois
+ * de uma queda. ATR_MQTT_V5=0 força 3.1.1. As propriedades custam bytes em
+ * cada mensagem: resumo_v5() informa a economia líquida no fio, não só o
+ * nome de tópico poupado.
+ * - Mensagens pré-montadas: cada tópico registrado guarda um mqtt::message
+ * pronto (tópico, QoS, propriedades fixas). publicador(topico) devolve um
+ * handle que só troca o payload e envia, sem montar o nome do tópico nem
+ * procurá-lo no mapa a cada amostra; publish() nesses tópicos usa o mesmo
+ * objeto.
+ * - Filas de prioridade: publish() não envia na thread chamadora; a mensagem
+ * entra na fila da sua classe (Critica, Controle, Telemetria, Volume) e uma
+ * thread de envio drena as filas. Critica e Controle têm prioridade estrita;
+ * Telemetria e Volume dividem o restante na proporção PESO_TELEMETRIA:1,
+ * para que /logs não fique parado atrás da telemetria. Cada fila é limitada:
+ * cheia, descarta a mensagem mais antiga (e conta). Critica é a exceção: com
+ * a fila cheia, a vaga sai de Volume ou Telemetria; só sem nada a ceder ela
+ * descarta, e cada descarte é registrado. A latência fila→envio é medida por
+ * classe (resumo_filas()).
+ * - Estado retido (ConfigTopico::estado, ex.: /snapshot): só o valor mais
+ * recente do tópico importa. Ele não ocupa as filas limitadas: fica um único
+ * pendente por tópico (uma publicação nova substitui a anterior ainda não
+ * enviada), sai logo depois de Critica, nunca é descartado e, se o envio
+ * falhar, é reenviado após REENVIO_ESTADO, a menos que já exista um mais novo.
  *
  * Componentes Internos:
  * - client_: Instância do cliente assíncrono Paho MQTT.
  * - connOpts_: Opções de conexão MQTT.
- * - queues_: Um mapa (unordered_map) que associa cada tópico a uma fila (queue)
- * de strings, armazenando as mensagens recebidas.
- * - q_mtx_: Mutex para sincronizar o acesso ao mapa queues_.
+ * - caixa_: filas de mensagens recebidas por tópico e corrotinas à espera
+ * (CaixaMensagens).
  * - Callback: Uma classe interna que herda de mqtt::callback, responsável por
- * receber as mensagens do broker MQTT e colocá-las na fila correta.
+ * receber as mensagens do broker MQTT e entregá-las a caixa_.
  * - cb_: Instância da classe Callback.
  * - connected_: Flag que indica se o cliente está conectado ao broker.
+ * - topicos_: configuração e estado v5 (alias, sequência) por tópico,
+ * protegidos por pub_mtx_; alias_max_ vem do CONNACK (Topic Alias Maximum).
  */
 
 #pragma once
+#include <functional>
 #include <string>
 #include <queue>
 #include <mutex>
@@ -45,8 +80,16 @@
 #include <thread>
 #include <atomic>
 #include <condition_variable>
+#include <chrono>
+#include <coroutine>
+#include <deque>
+#include <vector>
+#include <utility>
+#include <cstdint>
 
 #include <mqtt/async_client.h>   // Inclui a biblioteca Paho MQTT C++
+#include "PerfilLocks.h"          // MutexAtr (lock instrumentável)
+#include "CaixaMensagens.h"       // filas de recepção e awaitables
 
 /**
  * Classe MqttClient
@@ -56,6 +99,8 @@
  */
 class MqttClient
 {
+    struct EstadoTopico; // estado por tópico registrado (definido abaixo)
+
 public:
     // Construtor: Inicializa o cliente MQTT com o endereço do broker e o ID do cliente.
     MqttClient(const std::string& broker_addr,
@@ -70,22 +115,110 @@ public:
     // Retorna verdadeiro se o cliente estiver conectado ao broker.
     bool is_connected() const;
 
-    // Publica uma mensagem em um tópico específico. Retorna true se bem-sucedido.
-    bool publish(const std::string& topic, const std::string& msg);
+    // Publica uma mensagem em um tópico específico. Retorna true se a mensagem
+    // entrou na fila de envio (a classe vem do registro do tópico; Controle
+    // para tópicos não registrados).
+    // Com retained=true o broker guarda a última mensagem do tópico e a entrega
+    // imediatamente a novos assinantes (usado para checkpoints/estado).
+    bool publish(const std::string& topic, std::string msg, bool retained = false);
+
+    // Classes de envio, da mais prioritária para a menos.
+    enum class Prioridade { Critica, Controle, Telemetria, Volume };
 
     // Tenta consumir uma mensagem de um tópico. Retorna std::nullopt se a fila estiver vazia (não bloqueia).
-    std::optional<std::string> try_pop_message(const std::string& topic);
+    std::optional<std::string> try_pop_message(const std::string& topic) { return caixa_.try_pop(topic); }
+
+    // Consome todas as mensagens dos tópicos que casam com o filtro MQTT
+    // (coringa '+'), exceto as do tópico "exceto". Não bloqueia. Retorna
+    // pares (tópico, mensagem) na ordem de chegada de cada tópico.
+    std::vector<std::pair<std::string, std::string>> drenar_filtro(const std::string& filtro,
+                                                                   const std::string& exceto = "")
+    {
+        return caixa_.drenar_filtro(filtro, exceto);
+    }
 
     // Inscreve-se dinamicamente em um tópico para receber mensagens.
     void subscribe_topic(const std::string& topic);
 
+    // Tratamento v5 de um tópico publicado com frequência.
+    struct ConfigTopico
+    {
+        bool alias = true;       // usa alias de tópico (se o broker permitir)
+        uint32_t expira_s = 0;   // Message Expiry Interval; 0 = não expira
+        std::string esquema = "1"; // propriedade de usuário "v"; vazio = omite
+        Prioridade prioridade = Prioridade::Telemetria;
+        bool estado = false;     // estado retido: só o último valor, sem descarte
+    };
+
+    // Registra um tópico para publicação com mensagem pré-montada; alias e
+    // propriedades só se aplicam quando a sessão é v5. Chamar antes de
+    // publicar no tópico.
+    void configurar_topico(const std::string& topic, const ConfigTopico& cfg);
+
+    // Handle de publicação de um tópico registrado. Copiável e barato; válido
+    // enquanto o MqttClient existir.
+    class Publicador
+    {
+    public:
+        bool publicar(std::string msg, bool retained = false);
+        bool publicar(const char* dados, size_t n, bool retained = false)
+        {
+            return publicar(std::string(dados, n), retained);
+        }
+
+    private:
+        friend class MqttClient;
+        Publicador(MqttClient& c, EstadoTopico& st, Prioridade p, bool estado)
+            : c_(&c), st_(&st), prioridade_(p), estado_(estado) {}
+        MqttClient* c_;
+        EstadoTopico* st_;
+        Prioridade prioridade_; // lidos na criação (cfg muda sob pub_mtx_)
+        bool estado_;
+    };
+
+    // Publicador do tópico; registra com ConfigTopico padrão se ainda não foi.
+    Publicador publicador(const std::string& topic);
+
+    // Verdadeiro se a sessão com o broker foi aberta em MQTT v5.
+    bool usa_v5() const { return v5_; }
+
+    // Resumo das publicações v5: alias em uso e bytes no fio contra 3.1.1
+    // (economia líquida, já descontadas as propriedades).
+    std::string resumo_v5() const;
+
+    // Por classe: enviadas, descartadas, latência fila→envio média e máxima.
+    std::string resumo_filas() const;
+
+    // Suspende a thread de envio por d (queda simulada do enlace; as filas
+    // continuam recebendo e descartam pelo limite de cada classe).
+    void suspender_envio(std::chrono::milliseconds d);
+
+    // Envia tudo o que está nas filas e encerra a thread de envio
+    // (chamado por disconnect(); publicações posteriores são enviadas na hora).
+    void descarregar();
+
+    // Gancho chamado na thread do Paho a cada mensagem do tópico, antes da
+    // entrega à fila; deve ser curto e não bloquear (ex.: acordar tarefas).
+    void ao_chegar(const std::string& topic, std::function<void()> fn) { caixa_.ao_chegar(topic, std::move(fn)); }
+
+    // Awaitables de mensagem (ver CaixaMensagens.h).
+    using AguardaMensagem = CaixaMensagens::AguardaMensagem;
+    using AguardaMensagemValor = CaixaMensagens::AguardaMensagemValor;
+
+    AguardaMensagemValor next(const std::string& topic) { return caixa_.next(topic); }
+
+    template<typename Rep, typename Period>
+    AguardaMensagem next_for(const std::string& topic, const std::chrono::duration<Rep, Period>& timeout)
+    {
+        return caixa_.next_for(topic, timeout);
+    }
+
 private:
     mqtt::async_client client_; // Cliente assíncrono Paho MQTT
     mqtt::connect_options connOpts_; // Opções de conexão
 
-    // Mapa de filas por tópico: topic -> queue<message>
-    std::unordered_map<std::string, std::queue<std::string>> queues_;
-    std::mutex q_mtx_; // Mutex para proteger o acesso ao mapa queues_
+    // Mensagens recebidas e corrotinas à espera, por tópico
+    CaixaMensagens caixa_{"MqttClient::q_mtx_"};
 
     // Callback interno PAHO para tratar eventos (como chegada de mensagens)
     class Callback : public virtual mqtt::callback
@@ -101,4 +234,92 @@ private:
 
     Callback cb_; // Instância do callback
     bool connected_ = false; // Estado da conexão
+
+    // Abre a sessão v5; false se o broker recusar (o chamador tenta 3.1.1).
+    bool conectar_v5();
+
+    // Estado por tópico registrado (protegido por pub_mtx_). Os elementos
+    // nunca são removidos, então Publicador pode guardar o endereço.
+    struct EstadoTopico
+    {
+        ConfigTopico cfg;
+        mqtt::message_ptr msg;      // mensagem reaproveitada a cada publicação
+        mqtt::properties props_base; // alias (v5)
+        size_t tam_props_base = 0;   // bytes de props_base no fio
+        size_t tam_topico = 0;
+        uint16_t alias = 0;        // 0 = sem alias
+        bool alias_enviado = false; // o broker já associou nome e alias
+        bool esquema_enviado = false; // "v" já foi nesta conexão
+        uint64_t seq = 0;
+        // Estado retido pendente (cfg.estado; protegido por fila_mtx_)
+        std::string estado_pendente;
+        bool estado_retido = false;
+        bool estado_na_fila = false;
+        std::chrono::steady_clock::time_point estado_desde;
+    };
+    std::unordered_map<std::string, EstadoTopico> topicos_;
+
+    // Cria/atualiza o registro do tópico. Chamar com pub_mtx_.
+    EstadoTopico& registrar_topico(const std::string& topic, const ConfigTopico& cfg);
+
+    // Envia pela mensagem pré-montada do tópico; o payload é movido para a
+    // mensagem (o buffer do produtor chega ao Paho sem cópia intermediária).
+    bool publicar_montada(EstadoTopico& st, std::string&& payload, bool retained);
+
+    // Envio direto de tópico não registrado (thread de envio).
+    bool enviar_agora(const std::string& topic, const std::string& msg, bool retained);
+
+    // --- Filas de prioridade (protegidas por fila_mtx_) ---
+    static constexpr int NUM_PRIORIDADES = 4;
+    static constexpr int PESO_TELEMETRIA = 4; // envios de Telemetria por envio de Volume
+
+    struct ItemEnvio
+    {
+        EstadoTopico* st = nullptr; // tópico registrado, ou
+        std::string topic;          // nome do tópico não registrado
+        std::string payload;        // movido do produtor até a mensagem
+        bool retained = false;
+        bool estado = false;        // tópico de estado retido (cfg.estado)
+        std::chrono::steady_clock::time_point enfileirado;
+    };
+
+    struct EstatisticasFila
+    {
+        uint64_t enviadas = 0;
+        uint64_t falhas = 0;
+        uint64_t descartadas = 0;
+        uint64_t vagas_cedidas = 0; // Critica: vagas cedidas por Volume/Telemetria
+        uint64_t lat_total_us = 0;
+        uint64_t lat_max_us = 0;
+    };
+
+    bool enfileirar(Prioridade p, ItemEnvio item);
+    void abrir_espaco_critica(); // chamar com fila_mtx_ e Critica cheia
+    bool proximo_item(ItemEnvio& item, int& classe); // chamar com fila_mtx_
+    void laco_envio();
+
+    std::deque<ItemEnvio> filas_[NUM_PRIORIDADES];
+    // Tópicos de estado com valor pendente, na ordem da primeira publicação
+    std::deque<EstadoTopico*> estados_;
+    static constexpr auto REENVIO_ESTADO = std::chrono::milliseconds(500);
+    std::chrono::steady_clock::time_point reenviar_estados_{}; // após falha
+    EstatisticasFila est_filas_[NUM_PRIORIDADES];
+    static constexpr size_t CAPACIDADE_FILA[NUM_PRIORIDADES] = {256, 256, 512, 1024};
+    int creditos_telemetria_ = PESO_TELEMETRIA;
+    bool parar_envio_ = false;
+    std::chrono::steady_clock::time_point retomar_envio_{}; // fim da suspensão
+    mutable MutexAtr fila_mtx_;
+    CondVarAtr fila_cv_;
+    std::thread envio_; // iniciada no fim do construtor
+    mutable MutexAtr pub_mtx_;
+    bool v5_ = false;
+    uint16_t alias_max_ = 0;      // Topic Alias Maximum do CONNACK
+    uint16_t proximo_alias_ = 1;
+    uint64_t publicacoes_alias_ = 0;
+    // Bytes no fio dos PUBLISH de tópicos registrados em v5, o que os mesmos
+    // pacotes ocupariam em 3.1.1 e quanto disso são propriedades (TamanhoMqtt.h).
+    uint64_t publicacoes_v5_ = 0;
+    uint64_t bytes_v5_ = 0;
+    uint64_t bytes_como_311_ = 0;
+    uint64_t bytes_props_ = 0;
 };
\ No newline at end of file
@@ -0,0 +1,127 @@
+/*
+ * Arquivo: Orca.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define a camada local de desvio entre caminhões
+ * por obstáculos de velocidade recíprocos ótimos (ORCA). A cada ciclo de
+ * controle, cada caminhão troca a velocidade preferida (a que o leva ao
+ * setpoint) pela velocidade mais próxima dela que não colide com nenhum
+ * vizinho dentro do horizonte tau, supondo que os vizinhos façam o mesmo
+ * (metade do desvio para cada um).
+ *
+ * Formulação (por caminhão):
+ * - Para cada vizinho, o obstáculo de velocidade truncado em tau gera um
+ * semiplano permitido no espaço de velocidades (reta ORCA).
+ * - A nova velocidade é a solução de um programa linear 2D: minimizar
+ * |v - v_pref| sujeito aos semiplanos e a |v| <= v_max. Resolvido pelo
+ * algoritmo incremental (Seidel) em O(k) esperado para k vizinhos; sem
+ * alocação no laço, alguns microssegundos por caminhão.
+ * - Se o programa for inviável (caminhões já muito próximos), a solução
+ * minimiza a maior violação entre os semiplanos (programa 3D projetado), o
+ * que mantém o caminhão se afastando com segurança.
+ *
+ * Vizinhança:
+ * - GradeVizinhos é um índice espacial uniforme (células do tamanho do raio
+ * de vizinhança): montagem O(N) e consulta O(vizinhos), então o lote inteiro
+ * escala linearmente com o número de caminhões.
+ * - calcular_lote() resolve todos os agentes de uma vez (simulação de frota,
+ * testes); cada processo de caminhão usa resolver() com os vizinhos
+ * reconstruídos de /posicao (ReconstrucaoPosicao.h).
+ *
+ * Referência: van den Berg, Guy, Lin, Manocha, "Reciprocal n-Body Collision
+ * Avoidance" (2011); o programa linear segue a mesma construção.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+struct Vetor2
+{
+    double x = 0.0;
+    double y = 0.0;
+};
+
+struct AgenteOrca
+{
+    int id = 0;
+    Vetor2 pos;          // px
+    Vetor2 vel;          // velocidade atual (px/s)
+    Vetor2 vel_pref;     // velocidade desejada (px/s)
+    double raio = 10.0;  // px
+    double vel_max = 80.0;
+};
+
+struct ParametrosOrca
+{
+    double tau = 3.0;              // horizonte de colisão (s)
+    double periodo = 0.1;          // período de controle (s), usado já em colisão
+    double raio_vizinhanca = 150.0; // px
+    size_t max_vizinhos = 10;
+};
+
+struct EstatisticasOrca
+{
+    uint64_t solucoes = 0;
+    uint64_t inviaveis = 0;  // recorreram à minimização da violação
+    double max_us = 0.0;     // pior tempo de resolver()
+};
+
+// Índice espacial uniforme para consultas de vizinhança.
+class GradeVizinhos
+{
+public:
+    explicit GradeVizinhos(double celula = 150.0) : celula_(celula) {}
+
+    void montar(const std::vector<AgenteOrca>& agentes);
+
+    // Índices dos até max agentes mais próximos de agentes[i] dentro de raio.
+    void vizinhos(const std::vector<AgenteOrca>& agentes, size_t i, double raio, size_t max,
+                  std::vector<size_t>& out) const;
+
+private:
+    int64_t chave(int cx, int cy) const { return (static_cast<int64_t>(cx) << 32) ^ static_cast<uint32_t>(cy); }
+
+    double celula_;
+    std::unordered_map<int64_t, std::vector<size_t>> celulas_;
+};
+
+class Orca
+{
+public:
+    explicit Orca(const ParametrosOrca& p = ParametrosOrca()) : p_(p) {}
+
+    // Nova velocidade do agente dados os vizinhos (ponteiros válidos durante a chamada).
+    Vetor2 resolver(const AgenteOrca& agente, const std::vector<const AgenteOrca*>& vizinhos);
+
+    // Resolve todos os agentes; saida[i] é a nova velocidade de agentes[i].
+    void calcular_lote(const std::vector<AgenteOrca>& agentes, std::vector<Vetor2>& saida);
+
+    const ParametrosOrca& parametros() const { return p_; }
+    const EstatisticasOrca& estatisticas() const { return est_; }
+
+private:
+    struct Reta
+    {
+        Vetor2 ponto;
+        Vetor2 direcao;
+    };
+
+    ParametrosOrca p_;
+    EstatisticasOrca est_;
+    GradeVizinhos grade_{p_.raio_vizinhanca};
+
+    // buffers reutilizados (sem alocação em regime)
+    std::vector<Reta> retas_;
+    std::vector<Reta> projetadas_;
+    std::vector<size_t> indices_;
+    std::vector<const AgenteOrca*> ponteiros_;
+
+    static bool programa1(const std::vector<Reta>& retas, size_t n, double raio, Vetor2 otima,
+                          bool direcao, Vetor2& res);
+    static size_t programa2(const std::vector<Reta>& retas, double raio, Vetor2 otima, bool direcao,
+                            Vetor2& res);
+    void programa3(size_t inicio, double raio, Vetor2& res);
+};
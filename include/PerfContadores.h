@@ -0,0 +1,103 @@
+/*
+ * Arquivo: PerfContadores.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define um wrapper opcional para os contadores de
+ * desempenho de hardware do Linux (perf_event_open). Ele permite medir, por
+ * thread e por estágio nomeado do pipeline (ex.: "filtrar", "json_sensores",
+ * "buf_push"), os ciclos, instruções, cache misses e branch misses gastos
+ * naquele trecho de código. Assim sabemos se um estágio é limitado por cache
+ * ou por predição de desvios, e não apenas quanto tempo de relógio ele leva.
+ *
+ * Uso:
+ *     {
+ *         EstagioPerf ep("filtrar");   // lê os contadores na entrada
+ *         filtrado = filtro.filtrar(raw);
+ *     }                               // lê na saída e acumula a diferença
+ *
+ * Ativação e fallback:
+ * - A coleta só ocorre com a variável de ambiente ATR_PERF_COUNTERS=1.
+ * Sem ela, EstagioPerf custa apenas um teste de flag.
+ * - Cada thread abre seu próprio grupo de contadores na primeira medição.
+ * Se o kernel não permitir (perf_event_paranoid, container sem CAP_PERFMON,
+ * VM sem PMU, sistema não-Linux), a thread marca os contadores como
+ * indisponíveis e todos os estágios viram no-op; o relatório final informa
+ * o motivo.
+ *
+ * Relatório (PerfContadores::relatorio(), chamado no encerramento):
+ * - Por "thread/estágio": número de amostras, ciclos por amostra, IPC
+ * (instruções/ciclo) e misses por mil instruções (MPKI) de cache e desvio.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <thread>
+
+// Valores brutos lidos de um grupo de contadores.
+struct LeituraPerf
+{
+    uint64_t ciclos = 0;
+    uint64_t instrucoes = 0;
+    uint64_t cache_misses = 0;
+    uint64_t branch_misses = 0;
+};
+
+namespace PerfContadores {
+
+// true se ATR_PERF_COUNTERS=1 (avaliado uma única vez).
+bool habilitado();
+
+// Nome da thread atual usado como prefixo no relatório (ex.: "Tratamento").
+// Tarefas (corrotinas) podem migrar de thread: chame a cada retomada.
+void nomear_thread(const char* nome);
+
+// Lê os contadores da thread atual. Retorna false se indisponíveis.
+bool ler(LeituraPerf& out);
+
+// Acumula uma medição do estágio 'estagio' para a thread atual.
+void acumular(const char* estagio, const LeituraPerf& delta);
+
+// Relatório agregado por thread/estágio (texto legível).
+std::string relatorio();
+
+// Soma acumulada de "thread/estagio"; false se nunca medido.
+bool totais(const std::string& chave, LeituraPerf& soma, uint64_t& amostras);
+
+} // namespace PerfContadores
+
+// Guarda RAII que mede o trecho entre construção e destruição.
+class EstagioPerf
+{
+public:
+    explicit EstagioPerf(const char* estagio)
+        : estagio_(estagio), thread_(std::this_thread::get_id())
+    {
+        if (PerfContadores::habilitado()) ativo_ = PerfContadores::ler(inicio_);
+    }
+
+    ~EstagioPerf()
+    {
+        if (!ativo_) return;
+        // Estágio com co_await que retomou em outra thread: os contadores
+        // de grupos diferentes não são comparáveis; descarta a medição.
+        if (std::this_thread::get_id() != thread_) return;
+        LeituraPerf fim;
+        if (!PerfContadores::ler(fim)) return;
+        LeituraPerf d;
+        d.ciclos        = fim.ciclos - inicio_.ciclos;
+        d.instrucoes    = fim.instrucoes - inicio_.instrucoes;
+        d.cache_misses  = fim.cache_misses - inicio_.cache_misses;
+        d.branch_misses = fim.branch_misses - inicio_.branch_misses;
+        PerfContadores::acumular(estagio_, d);
+    }
+
+    EstagioPerf(const EstagioPerf&) = delete;
+    EstagioPerf& operator=(const EstagioPerf&) = delete;
+
+private:
+    const char* estagio_;
+    std::thread::id thread_;
+    LeituraPerf inicio_{};
+    bool ativo_ = false;
+};
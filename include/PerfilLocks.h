@@ -0,0 +1,130 @@
+/*
+ * Arquivo: PerfilLocks.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define um mutex instrumentado (MutexInstrumentado)
+ * e o registro global de estatísticas de contenção (RegistroLocks). O objetivo
+ * é medir, por lock nomeado, quantas vezes ele é adquirido, quantas dessas
+ * aquisições encontraram o lock ocupado (contenção) e a distribuição dos
+ * tempos de espera e de posse. Com esses dados sabemos qual lock remover
+ * primeiro, em vez de adivinhar.
+ *
+ * Ativação:
+ * - Tempo de compilação: a opção CMake ATR_LOCK_PROFILING define a macro de
+ * mesmo nome. Com ela, MutexAtr passa a ser MutexInstrumentado e CondVarAtr
+ * passa a ser std::condition_variable_any. Sem ela, MutexAtr é um std::mutex
+ * comum e não há nenhum custo extra.
+ * - Tempo de execução: quando compilado com instrumentação, a coleta pode ser
+ * desligada com a variável de ambiente ATR_LOCK_PROFILE=0 (padrão: ligada).
+ *
+ * Histogramas:
+ * - Escala logarítmica base 2 em nanossegundos: o bucket i conta amostras no
+ * intervalo [2^i, 2^(i+1)) ns (o bucket 0 também recebe amostras de 0 ns).
+ * - Aquisições sem contenção registram espera 0 (bucket 0), de modo que a soma
+ * do histograma de espera é igual ao número de aquisições.
+ *
+ * Exportação:
+ * - relatorio_json(): resumo compacto publicado periodicamente via MQTT em
+ * /mina/caminhoes/<id>/metricas/locks (ver main.cpp).
+ * - relatorio_texto(): tabela legível impressa no encerramento.
+ */
+
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <array>
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+
+// Estatísticas acumuladas de um lock nomeado (todas atômicas: várias
+// instâncias com o mesmo nome compartilham a mesma entrada).
+struct EstatisticasLock
+{
+    static constexpr int N_BUCKETS = 32; // 2^31 ns ~ 2 s no último bucket
+    using Histograma = std::array<std::atomic<uint64_t>, N_BUCKETS>;
+
+    std::string nome;
+    std::atomic<uint64_t> aquisicoes{0};      // Total de aquisições
+    std::atomic<uint64_t> contendidas{0};     // Aquisições que precisaram esperar
+    std::atomic<uint64_t> espera_total_ns{0}; // Soma dos tempos de espera
+    std::atomic<uint64_t> posse_total_ns{0};  // Soma dos tempos de posse
+    std::atomic<uint64_t> espera_max_ns{0};   // Maior espera observada
+    std::atomic<uint64_t> posse_max_ns{0};    // Maior posse observada
+    Histograma hist_espera{}; // Histograma de espera
+    Histograma hist_posse{};  // Histograma de posse
+
+    void registrar_espera(uint64_t ns);
+    void registrar_posse(uint64_t ns);
+
+    // Índice do bucket log2 de 'ns' (0 e 1 ns caem no bucket 0).
+    static int bucket_de(uint64_t ns);
+    // Percentil aproximado (limite superior do bucket); 0 se vazio.
+    static uint64_t percentil(const Histograma& h, double p);
+};
+
+// Registro global (singleton) das estatísticas por nome de lock.
+class RegistroLocks
+{
+public:
+    static RegistroLocks& instancia();
+
+    // Retorna a entrada do lock 'nome', criando-a se necessário.
+    // O ponteiro é estável durante toda a execução do processo.
+    EstatisticasLock* obter(const std::string& nome);
+
+    // Flag de execução (ATR_LOCK_PROFILE). Leitura relaxada no caminho quente.
+    bool ativo() const noexcept { return ativo_.load(std::memory_order_relaxed); }
+    void set_ativo(bool v) noexcept { ativo_.store(v, std::memory_order_relaxed); }
+
+    // Resumo em JSON: [{"nome":..,"aq":..,"cont":..,"espera_p50_ns":..,...}, ...]
+    std::string relatorio_json() const;
+
+    // Tabela legível (uma linha por lock) para o log de encerramento.
+    std::string relatorio_texto() const;
+
+private:
+    RegistroLocks();
+
+    mutable std::mutex mtx_; // Protege apenas a lista (não instrumentado)
+    std::vector<std::unique_ptr<EstatisticasLock>> stats_;
+    std::atomic<bool> ativo_{true};
+};
+
+// Mutex com a mesma interface de std::mutex (Lockable), que registra
+// contagem, contenção, espera e posse no RegistroLocks.
+class MutexInstrumentado
+{
+public:
+    explicit MutexInstrumentado(const char* nome = "anonimo");
+
+    MutexInstrumentado(const MutexInstrumentado&) = delete;
+    MutexInstrumentado& operator=(const MutexInstrumentado&) = delete;
+
+    // Altera o nome (deve ser chamado antes do primeiro uso concorrente).
+    void set_nome(const char* nome);
+
+    void lock();
+    void unlock();
+    bool try_lock();
+
+private:
+    std::mutex m_;
+    EstatisticasLock* st_;
+    uint64_t t_aquisicao_ns_ = 0; // Escrito/lido apenas pela thread dona
+};
+
+// Tipos usados pelo restante do sistema para os locks compartilhados.
+#ifdef ATR_LOCK_PROFILING
+using MutexAtr   = MutexInstrumentado;
+using CondVarAtr = std::condition_variable_any;
+#else
+using MutexAtr   = std::mutex;
+using CondVarAtr = std::condition_variable;
+#endif
+
+// Atribui um nome ao lock (sem efeito quando MutexAtr é std::mutex).
+inline void nomear_lock(std::mutex&, const char*) {}
+inline void nomear_lock(MutexInstrumentado& m, const char* nome) { m.set_nome(nome); }
@@ -0,0 +1,57 @@
+/*
+ * Arquivo: PoliticaRitmo.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define a decisão do regime de ritmo dos laços do
+ * caminhão (regimes e limiares descritos em RitmoAdaptativo.h). É uma função
+ * pura do estado do ciclo de controle e do tempo, sem executor nem MQTT; o
+ * RitmoCaminhao aplica o regime escolhido.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+enum class RegimeRitmo { Hibernando = 0, Reta, Normal, Atencao };
+
+const char* nome_regime(RegimeRitmo r);
+
+// Estado do ciclo de controle usado na decisão.
+struct EntradaRitmo
+{
+    bool automatico = false;
+    bool defeito = false;
+    bool comandos_ativos = false; // acelera/direita/esquerda pressionados
+    double x = 0.0, y = 0.0;      // posição filtrada (px)
+    double velocidade = 0.0;      // px/s estimada
+    double dist_alvo = -1.0;      // px até o setpoint (automático); < 0 = sem alvo
+    double dist_vizinho = -1.0;   // px até o caminhão mais próximo; < 0 = nenhum
+    double erro_rumo = 0.0;       // graus entre rumo desejado e atual
+    double dist_borda = 1e9;      // px até o limite da mina
+};
+
+class PoliticaRitmo
+{
+public:
+    static constexpr double VEL_MOVENDO = 15.0;    // px/s (acima do ruído da estimativa)
+    static constexpr double RAIO_PARADO = 5.0;     // px
+    static constexpr double RAIO_ALVO = 60.0;      // px
+    static constexpr double RAIO_VIZINHO = 150.0;  // px
+    static constexpr double RAIO_BORDA = 40.0;     // px
+    static constexpr double DIST_RETA = 150.0;     // px até o alvo
+    static constexpr double ERRO_RUMO_RETA = 5.0;  // graus
+    static constexpr double RAIO_NO_ALVO = 8.0;    // px (automático parado no alvo)
+    static constexpr uint64_t ESTAVEL_MS = 1000;
+    static constexpr uint64_t PARADO_MS = 5000;
+    static constexpr int PERIODO_HIBERNANDO_MS = 1000; // período dos laços ao hibernar
+
+    // ultimo_despertar_ms: último comando recebido (não hiberna logo depois).
+    RegimeRitmo avaliar(const EntradaRitmo& e, uint64_t agora_ms, uint64_t ultimo_despertar_ms);
+
+private:
+    double ancora_x_ = 0.0, ancora_y_ = 0.0; // centro do círculo de parado
+    uint64_t ancora_desde_ = 0;
+    bool tem_ancora_ = false;
+    bool calmo_ = false;          // condição de Reta/Hibernando vigente
+    uint64_t calmo_desde_ = 0;
+    RegimeRitmo alvo_calmo_ = RegimeRitmo::Normal;
+};
@@ -0,0 +1,115 @@
+/*
+ * Arquivo: Reator.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define a classe Reator, um laço de eventos baseado
+ * em epoll que unifica, numa única thread, tudo o que antes era tratado por
+ * mecanismos separados:
+ * - Temporizadores: um único timerfd armado para o prazo mais próximo de um
+ * heap de temporizadores (usado por Executor::after e pelos timeouts de
+ * pop_for/next_for).
+ * - Sinais: SIGINT/SIGTERM chegam por signalfd e são tratados no contexto
+ * normal da thread do reator (sem as restrições de async-signal-safety de um
+ * signal handler; pode-se usar std::cout, mutex, etc.).
+ * - Descritores quaisquer: observar_fd() registra um callback de prontidão
+ * (EPOLLIN/EPOLLOUT) para sockets ou pipes.
+ * - Acordar/encerrar: um eventfd interrompe o epoll_wait quando necessário.
+ *
+ * Encerramento imediato:
+ * - parar() (chamado, por exemplo, no callback de SIGINT) dispara na hora
+ * todos os temporizadores pendentes e passa a disparar imediatamente os
+ * novos. Assim as tarefas suspensas em after()/pop_for() acordam sem esperar
+ * o fim do período, observam stop_flag e terminam. Esperas sem prazo (um
+ * co_await buffer.push() num buffer cheio) não passam pelo reator: o dono
+ * do buffer o fecha com BufferCircular::fechar() (main.cpp, logo após
+ * aguardar_parada()).
+ * - aguardar_parada() bloqueia a thread chamadora (o main) até parar().
+ *
+ * Uso típico (main.cpp):
+ *     Reator reator;                          // antes de criar qualquer thread
+ *     reator.tratar_sinais({SIGINT, SIGTERM}, [&](int) { stop_flag = true; reator.parar(); });
+ *     reator.iniciar();                       // thread do laço epoll
+ *     ...
+ *     reator.aguardar_parada();
+ *
+ * Observação: tratar_sinais() bloqueia os sinais na thread chamadora; como as
+ * threads criadas depois herdam a máscara, ele deve ser chamado antes de
+ * qualquer outra thread (inclusive as internas do cliente MQTT).
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Reator
+{
+public:
+    using Relogio = std::chrono::steady_clock; // CLOCK_MONOTONIC no Linux
+
+    Reator();
+    ~Reator(); // encerra o laço e fecha os descritores
+
+    Reator(const Reator&) = delete;
+    Reator& operator=(const Reator&) = delete;
+
+    // Inicia a thread do laço epoll.
+    void iniciar();
+
+    // Executa 'fn' na thread do reator a partir de 'quando'. Após parar(),
+    // executa imediatamente na thread chamadora.
+    void agendar_em(Relogio::time_point quando, std::function<void()> fn);
+
+    // Executa 'fn' a cada 'periodo' até parar().
+    void a_cada(Relogio::duration periodo, std::function<void()> fn);
+
+    // Callback de prontidão para um descritor (eventos EPOLLIN/EPOLLOUT...).
+    bool observar_fd(int fd, uint32_t eventos, std::function<void(uint32_t)> cb);
+    void remover_fd(int fd);
+
+    // Entrega os sinais por signalfd. Chamar antes de criar outras threads.
+    bool tratar_sinais(std::initializer_list<int> sinais, std::function<void(int)> cb);
+
+    // Sinaliza a parada: dispara os temporizadores pendentes e libera aguardar_parada().
+    void parar();
+    bool parado() const { return parado_.load(); }
+
+    // Bloqueia até parar().
+    void aguardar_parada();
+
+private:
+    struct Temporizador
+    {
+        Relogio::time_point quando;
+        uint64_t ordem;
+        std::function<void()> fn;
+    };
+
+    void laco();
+    void rearmar_timerfd(); // com mtx_ travado
+    void disparar_vencidos(bool todos);
+
+    int epfd_ = -1;
+    int timerfd_ = -1;
+    int eventfd_ = -1;
+    int signalfd_ = -1;
+
+    std::mutex mtx_;
+    std::vector<Temporizador> timers_; // heap (menor prazo no topo)
+    uint64_t ordem_ = 0;
+    Relogio::time_point armado_{};     // prazo atualmente no timerfd
+    std::map<int, std::function<void(uint32_t)>> fds_;
+    std::function<void(int)> cb_sinal_;
+
+    std::atomic<bool> parado_{false};
+    std::atomic<bool> sair_{false};
+    std::condition_variable cv_parada_;
+    std::thread thread_;
+};
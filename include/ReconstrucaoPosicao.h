@@ -0,0 +1,104 @@
+/*
+ * Arquivo: ReconstrucaoPosicao.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define o modelo de extrapolação (dead reckoning)
+ * compartilhado entre quem publica /posicao e quem a consome. Em trechos
+ * previsíveis o caminhão deixa de publicar a cada ciclo: uma nova amostra só
+ * sai quando a posição real se afasta da predição do modelo mais que a
+ * tolerância, ou quando o intervalo máximo vence. Os receptores extrapolam a
+ * última amostra com o mesmo modelo.
+ *
+ * Modelo (velocidade e taxa de giro constantes):
+ * - Estado: x, y (px), v (px/s ao longo do rumo), rumo (graus; 0 = +x, sentido
+ * anti-horário, como em TratamentoSensores) e taxa (graus/s).
+ * - taxa ≈ 0: reta; caso contrário, arco de raio v/taxa.
+ *
+ * Garantia:
+ * - O emissor prediz a partir do estado quantizado exatamente como foi
+ * serializado, o mesmo que os receptores leem. Em cada ciclo do emissor,
+ * |posição real - predição| <= tolerância; acima disso, publica.
+ * - No receptor, a predição usa a hora de chegada, então o erro é limitado
+ * pela tolerância mais v × latência de entrega. A extrapolação é limitada a
+ * HORIZONTE_MAX_MS: sem amostras novas (caminhão parado no ar), a posição
+ * estimada congela em vez de derivar.
+ *
+ * Payload de /posicao (campos antigos preservados):
+ *     {"x":412,"y":318,"ang":37,"t":123456,"v":52.3,"rumo":36.8,"w":-4.1}
+ * - t: instante da amostra no relógio do emissor (informativo).
+ * - Sem v/rumo/w (emissor antigo), o receptor usa a posição sem extrapolar.
+ *
+ * Auxiliar Python equivalente: interface/reconstrucao_posicao.py.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+struct EstadoPosicao
+{
+    uint64_t t_ms = 0;
+    double x = 0.0;
+    double y = 0.0;
+    double v = 0.0;
+    double rumo = 0.0;
+    double taxa = 0.0;
+    bool com_modelo = false; // v/rumo/taxa presentes (payload novo)
+};
+
+// Estado daqui a dt_s segundos pelo modelo de velocidade e giro constantes.
+EstadoPosicao extrapolar(const EstadoPosicao& e, double dt_s);
+
+// Arredonda como serializar_posicao() grava (x, y inteiros; demais com 1 casa).
+EstadoPosicao quantizar(const EstadoPosicao& e);
+
+// JSON do /posicao; ang é o ângulo filtrado publicado hoje (inteiro).
+std::string serializar_posicao(const EstadoPosicao& e, int ang);
+
+// Lê o JSON do /posicao; false se não houver x/y.
+bool desserializar_posicao(const std::string& pl, EstadoPosicao& e);
+
+// Lado do emissor: decide quais amostras publicar.
+class SupressorPosicao
+{
+public:
+    // tolerancia_px <= 0 desativa a supressão (publica todas).
+    explicit SupressorPosicao(double tolerancia_px = 3.0, uint64_t intervalo_max_ms = 1000);
+
+    // true se a amostra deve ser publicada; nesse caso a versão quantizada
+    // dela passa a ser a base da predição.
+    bool avaliar(const EstadoPosicao& real);
+
+    uint64_t enviadas() const { return enviadas_; }
+    uint64_t suprimidas() const { return suprimidas_; }
+
+private:
+    double tolerancia_;
+    uint64_t intervalo_max_;
+    bool tem_base_ = false;
+    EstadoPosicao base_;
+    uint64_t enviadas_ = 0;
+    uint64_t suprimidas_ = 0;
+};
+
+// Lado do receptor: última amostra e extrapolação até o instante pedido.
+class ReconstrutorPosicao
+{
+public:
+    static constexpr uint64_t HORIZONTE_MAX_MS = 2000;
+
+    // Amostra recebida no instante t_local_ms (relógio do receptor).
+    void atualizar(const EstadoPosicao& e, uint64_t t_local_ms);
+    bool atualizar(const std::string& payload, uint64_t t_local_ms);
+
+    bool valido() const { return valido_; }
+    uint64_t recebido_em() const { return t_local_; }
+
+    // Posição estimada no instante t_local_ms.
+    EstadoPosicao em(uint64_t t_local_ms) const;
+
+private:
+    bool valido_ = false;
+    EstadoPosicao ultima_;
+    uint64_t t_local_ = 0;
+};
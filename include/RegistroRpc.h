@@ -0,0 +1,66 @@
+/*
+ * Arquivo: RegistroRpc.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define o lado puro do servidor RPC (protocolo em
+ * RpcMqtt.h): a tabela de métodos e o tratamento de um pedido, sem MQTT.
+ *
+ * Tratamento de um pedido:
+ * - Sem "resposta" ou com "prazo" vencido: nada a enviar.
+ * - Id já respondido: devolve a resposta guardada sem executar o
+ * manipulador (até MAX_RESPOSTAS_GUARDADAS ids, os mais recentes). A
+ * chave é o tópico de resposta + id (clientes distintos podem gerar o
+ * mesmo id) e o método também precisa coincidir.
+ * - Método desconhecido ou manipulador que lança exceção: resposta com
+ * "ok":false e a mensagem em "erro".
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+
+struct RespostaRpc
+{
+    bool ok = true;
+    std::string valor; // JSON do resultado (ok) ou mensagem de erro
+
+    static RespostaRpc sucesso(std::string json) { return {true, std::move(json)}; }
+    static RespostaRpc falha(std::string msg) { return {false, std::move(msg)}; }
+};
+
+class RegistroRpc
+{
+public:
+    using Manipulador = std::function<RespostaRpc(const std::string& params)>;
+
+    static constexpr size_t MAX_RESPOSTAS_GUARDADAS = 64;
+
+    void registrar(const std::string& metodo, Manipulador fn);
+
+    // Trata um pedido; retorna false se não há resposta a enviar (pedido
+    // inválido sem tópico de resposta ou vencido). agora_ms: relógio de parede.
+    bool tratar(const std::string& pedido, int64_t agora_ms, std::string& topico_resposta, std::string& resposta);
+
+    uint64_t atendidos() const { return atendidos_; }
+    uint64_t repetidos() const { return repetidos_; }
+    uint64_t vencidos() const { return vencidos_; }
+
+private:
+    using ChaveGuardada = std::pair<std::string, std::string>; // (tópico de resposta, id)
+    struct Guardada
+    {
+        std::string metodo;
+        std::string resposta;
+    };
+
+    std::map<std::string, Manipulador> metodos_;
+    std::map<ChaveGuardada, Guardada> guardadas_;
+    std::deque<ChaveGuardada> ordem_guardadas_;
+    uint64_t atendidos_ = 0;
+    uint64_t repetidos_ = 0;
+    uint64_t vencidos_ = 0;
+};
@@ -0,0 +1,125 @@
+/*
+ * Arquivo: Relogio.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define o serviço de relógio do sistema ATR: uma
+ * única fonte de tempo barata para carimbos de amostras, temporizadores e
+ * instrumentação. Antes, cada tarefa chamava steady_clock::now() várias vezes
+ * por ciclo e os carimbos das amostras (documentados como época Unix) eram na
+ * verdade milissegundos do relógio monotônico, então logs, interface e
+ * caminhões diferentes não concordavam sobre o tempo.
+ *
+ * Relógio monotônico (mono_ns):
+ * - Caminho rápido TSC (x86 com TSC invariante): rdtsc convertido para ns
+ * por multiplicação e deslocamento, ancorado no CLOCK_MONOTONIC. Custa
+ * poucos nanossegundos e não entra no kernel.
+ * - Recalibração automática a cada RECALIBRA_NS: a taxa é refeita sobre a
+ * base inteira desde a primeira calibração (erro cai com o tempo) e a
+ * âncora só avança, então mono_ns nunca volta.
+ * - Sem TSC invariante, ou com ATR_RELOGIO=vdso: clock_gettime(
+ * CLOCK_MONOTONIC), que no Linux é servido pelo vDSO.
+ * - Mesma origem do std::chrono::steady_clock (CLOCK_MONOTONIC). Continuam
+ * em steady_clock as esperas com prazo (condition_variable::wait_until,
+ * timeouts das awaitables, fsync do IoLog), que exigem um time_point da
+ * biblioteca padrão, e as medições das ferramentas de linha de comando e
+ * do host de frota.
+ *
+ * Mapeamento monotônico -> parede (unix_ns):
+ * - unix = mono + deslocamento, com o deslocamento medido entre duas
+ * leituras do CLOCK_MONOTONIC em torno de uma do CLOCK_REALTIME e refeito a
+ * cada recalibração (acompanha o ajuste do NTP).
+ * - Carimbos Unix de caminhões diferentes ficam alinhados tanto quanto os
+ * relógios de parede dos hosts (NTP/PTP).
+ *
+ * Carimbo:
+ * - Par (mono_ns, unix_ns) lido de uma vez: mono para intervalos e ordem
+ * local, unix para logs e alinhamento entre caminhões.
+ *
+ * Publicação dos parâmetros: seqlock (versão ímpar = escrita em curso), sem
+ * mutex no caminho de leitura.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+struct Carimbo
+{
+    int64_t mono_ns = 0; // CLOCK_MONOTONIC (intervalos, ordem local)
+    int64_t unix_ns = 0; // época Unix (logs, alinhamento da frota)
+
+    int64_t mono_ms() const { return mono_ns / 1000000; }
+    int64_t unix_ms() const { return unix_ns / 1000000; }
+};
+
+class Relogio
+{
+public:
+    enum class Fonte { Tsc, Vdso };
+
+    static constexpr int64_t RECALIBRA_NS = 1000000000;
+    // Carimbos de milissegundos abaixo disso (2001-09-09) não são época Unix.
+    static constexpr int64_t UNIX_MS_MINIMO = 1000000000000;
+
+    static int64_t mono_ns()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        if (fonte_.load(std::memory_order_relaxed) == FONTE_TSC) {
+            for (;;) {
+                const uint32_t v = versao_.load(std::memory_order_acquire);
+                const uint64_t base_tsc = base_tsc_.load(std::memory_order_relaxed);
+                const int64_t base_ns = base_ns_.load(std::memory_order_relaxed);
+                const uint64_t mult = mult_.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if ((v & 1) || versao_.load(std::memory_order_relaxed) != v) continue;
+                const int64_t ticks = static_cast<int64_t>(__builtin_ia32_rdtsc() - base_tsc);
+                const int64_t ns = base_ns + static_cast<int64_t>((static_cast<__int128>(ticks) * mult) >> SHIFT);
+                if (ns - base_ns > RECALIBRA_NS) recalibrar();
+                return ns;
+            }
+        }
+#endif
+        return mono_lento();
+    }
+
+    static int64_t mono_ms() { return mono_ns() / 1000000; }
+
+    // Instante de parede (ns desde a época Unix) correspondente a um mono_ns.
+    static int64_t unix_ns(int64_t mono)
+    {
+        if (fonte_.load(std::memory_order_acquire) == FONTE_NENHUMA) calibrar();
+        return mono + parede_menos_mono_.load(std::memory_order_relaxed);
+    }
+    static int64_t unix_ms() { return unix_ns(mono_ns()) / 1000000; }
+
+    static Carimbo agora()
+    {
+        Carimbo c;
+        c.mono_ns = mono_ns();
+        c.unix_ns = c.mono_ns + parede_menos_mono_.load(std::memory_order_relaxed);
+        return c;
+    }
+
+    // Calibração inicial (alguns ms); feita na primeira leitura se ninguém chamou.
+    static void calibrar();
+    // Refaz taxa e deslocamento (automático a cada RECALIBRA_NS).
+    static void recalibrar();
+
+    static Fonte fonte();
+    // Fonte, frequência do TSC e deslocamento parede - monotônico.
+    static std::string resumo();
+
+private:
+    static constexpr int FONTE_NENHUMA = 0, FONTE_TSC = 1, FONTE_VDSO = 2;
+    static constexpr int SHIFT = 32; // ns = ticks * mult >> SHIFT
+
+    static int64_t mono_lento();
+
+    static inline std::atomic<int> fonte_{FONTE_NENHUMA};
+    static inline std::atomic<uint32_t> versao_{0};
+    static inline std::atomic<uint64_t> base_tsc_{0};
+    static inline std::atomic<int64_t> base_ns_{0};
+    static inline std::atomic<uint64_t> mult_{0};
+    static inline std::atomic<int64_t> parede_menos_mono_{0};
+};
@@ -0,0 +1,103 @@
+/*
+ * Arquivo: RitmoAdaptativo.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define o ritmo adaptativo dos laços do caminhão.
+ * Em vez de rodar sensores a 50 ms e controle a 100 ms o tempo todo, o
+ * período acompanha a situação: mais rápido perto de waypoints, de outros
+ * caminhões e do limite da mina; mais lento em trechos retos; e quase parado
+ * (hibernação) com o caminhão parado em manual sem comandos. Em frotas grandes
+ * estacionadas, CPU e tráfego no broker caem na mesma proporção.
+ *
+ * Regimes (período de sensores / controle, com base 50 / 100 ms):
+ * - Atencao:    25 / 50 ms  (alvo a menos de RAIO_ALVO, vizinho a menos de
+ *   RAIO_VIZINHO ou, em movimento, borda a menos de RAIO_BORDA);
+ * - Normal:     50 / 100 ms (padrão; sempre em defeito);
+ * - Reta:      100 / 200 ms (automático com alvo distante e rumo alinhado por
+ *   ESTAVEL_MS, ou parado no alvo);
+ * - Hibernando: 1000 / 1000 ms (manual, parado, sem comandos por PARADO_MS).
+ * "Parado" é não sair de um círculo de RAIO_PARADO: a velocidade estimada
+ * por diferença de amostras filtradas tem ruído de alguns px/s.
+ *
+ * Componentes:
+ * - PoliticaRitmo (PoliticaRitmo.h): decide o regime a partir do estado do
+ * ciclo de controle, com histerese (tempo mínimo antes de Reta e de
+ * Hibernando).
+ * - RitmoCaminhao: regime corrente compartilhado pelas tarefas. pausa(base)
+ * substitui Executor::after nas esperas fixas dos laços: dura base fora da
+ * hibernação e PAUSA_HIBERNANDO nela. despertar() (comando, rota ou defeito
+ * simulado chegando, via MqttClient::ao_chegar) volta ao Normal e retoma na
+ * hora todas as pausas em curso. Setpoints não acordam: só importam no
+ * automático, que não hiberna, e o GerenciadorDeRota os republica a cada ciclo.
+ * - ATR_RITMO=0 fixa o regime Normal (comportamento anterior).
+ *
+ * Com ATR_MPC=1 o período de controle fica no Ts do modelo (100 ms) fora da
+ * hibernação: o MPC foi discretizado para ele.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Executor.h"
+#include "PoliticaRitmo.h"
+
+class RitmoCaminhao
+{
+public:
+    using Relogio = std::chrono::steady_clock;
+
+    static constexpr int PERIODO_HIBERNANDO_MS = PoliticaRitmo::PERIODO_HIBERNANDO_MS;
+    static constexpr auto PAUSA_HIBERNANDO = std::chrono::milliseconds(PERIODO_HIBERNANDO_MS);
+
+    explicit RitmoCaminhao(bool ativo = true);
+
+    bool ativo() const { return ativo_; }
+    RegimeRitmo regime() const { return regime_.load(std::memory_order_relaxed); }
+    void definir(RegimeRitmo r);
+
+    // Períodos do regime corrente a partir dos períodos base.
+    int periodo_sensor_ms(int base_ms) const;
+    int periodo_controle_ms(int base_ms) const;
+
+    // Comando chegou: Normal e retoma as pausas em curso (thread-safe).
+    void despertar();
+    uint64_t despertares() const { return despertares_.load(); }
+    int64_t ultimo_despertar_ms() const { return ultimo_despertar_ms_.load(); }
+
+    // Awaitable: co_await ritmo.pausa(40ms);
+    struct AguardaPausa
+    {
+        RitmoCaminhao& r;
+        Relogio::duration d;
+        uint64_t geracao;
+        bool await_ready() const noexcept { return d <= Relogio::duration::zero(); }
+        bool await_suspend(std::coroutine_handle<> h);
+        void await_resume() const noexcept {}
+    };
+    AguardaPausa pausa(Relogio::duration base);
+
+    // Duração que pausa(base) esperaria no regime corrente; para limitar
+    // outras esperas (ex.: co_await mqtt.next_for(topico, ritmo.espera(30ms))).
+    Relogio::duration espera(Relogio::duration base) const;
+
+    // Tempo acumulado em cada regime (ms) e trocas de regime.
+    std::string resumo() const;
+
+private:
+    const bool ativo_;
+    std::atomic<RegimeRitmo> regime_{RegimeRitmo::Normal};
+    std::atomic<uint64_t> geracao_{0};
+    std::atomic<uint64_t> despertares_{0};
+    std::atomic<int64_t> ultimo_despertar_ms_{0};
+
+    mutable MutexAtr mtx_;
+    std::vector<EsperaPtr> esperas_;
+    Relogio::time_point desde_ = Relogio::now();
+    int64_t tempo_ms_[4] = {};
+    uint64_t trocas_ = 0;
+};
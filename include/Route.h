@@ -86,4 +86,8 @@ private:
     std::vector<Waypoint> waypoints;
 };
 
+// Rota no formato texto do /route (uma linha "x y speed" por waypoint, sem
+// quebra de linha no fim).
+std::string texto_rota(const Route& r);
+
 #endif // ROUTE_H
\ No newline at end of file
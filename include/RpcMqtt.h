@@ -0,0 +1,76 @@
+/*
+ * Arquivo: RpcMqtt.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define a camada de pedido/resposta (RPC) sobre o
+ * MqttClient. Em vez de esperar a próxima republicação de um tópico (rota,
+ * estado) ou de consultar /estado em laço para confirmar um comando, o
+ * cliente pergunta e recebe a resposta só para ele, identificada pelo id de
+ * correlação. Consultas sob demanda dispensam publicações periódicas que só
+ * existiam para os clientes descobrirem o estado.
+ *
+ * Protocolo (JSON no payload; funciona em MQTT 3.1.1 e v5):
+ * - Pedido em <prefixo>/pedido (caminhão: /mina/caminhoes/<id>/rpc/pedido):
+ *     {"id":"c1","metodo":"get-state","resposta":"/mina/rpc/<cliente>/resposta",
+ *      "prazo":<ms de relógio de parede>,"params":{...}}
+ * - Resposta no tópico "resposta" do pedido:
+ *     {"id":"c1","ok":true,"resultado":<JSON>}   ou
+ *     {"id":"c1","ok":false,"erro":"..."}
+ * - "prazo" (opcional): pedidos que chegam depois dele são descartados sem
+ * resposta (o cliente já desistiu).
+ * - Repetição: o servidor guarda as últimas respostas por id; um pedido
+ * repetido (retentativa do cliente) recebe a mesma resposta sem executar o
+ * manipulador de novo, o que torna set-config seguro de repetir.
+ *
+ * Servidor (processo do caminhão):
+ * - RegistroRpc (RegistroRpc.h) associa métodos a manipuladores (params
+ * JSON -> RespostaRpc).
+ * - ServidorRpc_tarefa é uma corrotina do Executor: aguarda pedidos com
+ * co_await mqtt.next_for() (sem polling) e publica as respostas.
+ *
+ * Cliente:
+ * - ClienteRpc assina um tópico de resposta próprio e chama com timeout;
+ * respostas de outras chamadas em andamento ficam guardadas para elas
+ * (várias threads podem chamar ao mesmo tempo).
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "Executor.h"
+#include "MqttClient.h"
+#include "RegistroRpc.h"
+
+// Prefixo RPC de um caminhão.
+std::string topico_rpc(int truck_id);
+
+// Atende <prefixo>/pedido até stop_flag.
+Tarefa ServidorRpc_tarefa(std::atomic<bool>& stop_flag, MqttClient& mqtt, std::string prefixo, RegistroRpc& registro);
+
+class ClienteRpc
+{
+public:
+    ClienteRpc(MqttClient& mqtt, const std::string& id_cliente);
+
+    // Resposta completa (JSON) ou nullopt no timeout.
+    std::optional<std::string> chamar(const std::string& prefixo, const std::string& metodo,
+                                      const std::string& params_json = "{}",
+                                      std::chrono::milliseconds timeout = std::chrono::milliseconds(2000));
+
+    uint64_t timeouts() const { return timeouts_.load(); }
+
+private:
+    MqttClient& mqtt_;
+    std::string id_cliente_;
+    std::string topico_resposta_;
+    std::atomic<uint64_t> sequencia_{0};
+    std::atomic<uint64_t> timeouts_{0};
+    std::mutex mtx_;
+    std::map<std::string, std::string> chegadas_; // respostas de outras chamadas
+};
@@ -12,6 +12,9 @@
  * que indica o momento exato em que os dados foram lidos ou gerados.
  * Essencial para análise de dados, sincronização e logs. Usamos uint64_t
  * para evitar estouro (overflow) em sistemas que rodam por longos períodos.
+ * Vem de Relogio::agora() (Relogio.h): o relógio de parede lido pelo
+ * mapeamento monotônico -> Unix, então caminhões diferentes concordam até
+ * o sincronismo (NTP) dos hosts. Intervalos locais usam o monotônico.
  *
  * Sensores Principais:
  * - i_posicao_x: A posição atual do caminhão no eixo X (coordenada).
@@ -24,14 +27,31 @@
  * sistema elétrico (true = falha, false = normal).
  * - i_falha_hidraulica: Flag booleana indicando se foi detectada uma falha no
  * sistema hidráulico (true = falha, false = normal).
+ *
+ * SensorDataV2 (amostra compacta, 22 bytes):
+ * Versão empacotada usada nos buffers entre threads. Em relação à SensorData
+ * (32 bytes com padding), ela acrescenta um número de sequência e aumenta a
+ * precisão, ocupando menos espaço:
+ * - seq: número de sequência de 32 bits atribuído pela thread de sensores.
+ * Consumidores detectam perdas/duplicatas comparando com a última seq vista
+ * (ver seq_lacuna()), sem depender do timestamp.
+ * - pos_x_fp / pos_y_fp: posição em ponto fixo com 1/64 de pixel
+ * (0..1023.98, cobre o mundo 0..1000).
+ * - angulo_cdeg: orientação em centésimos de grau (0..35999).
+ * - temperatura_dc: temperatura em décimos de grau Celsius.
+ * - falhas: bits FALHA_ELETRICA e FALHA_HIDRAULICA.
+ * - versao: versão do layout (SensorDataV2::VERSAO), para logs/serialização.
+ * Os campos são privados ao formato: use os acessores (x(), y(), angulo(),
+ * temperatura(), falha_eletrica(), ...) e as conversões para_v1()/para_v2().
  */
 
 #pragma once
 #include <cstdint> // Inclui a biblioteca para tipos inteiros de tamanho fixo (uint64_t)
+#include <cmath>   // std::lround (conversão para ponto fixo)
 
 struct SensorData
 {
-    uint64_t timestamp_ms = 0; // Carimbo de tempo em milissegundos
+    uint64_t timestamp_ms = 0; // Carimbo de tempo em milissegundos (época Unix)
 
     // Sensores principais
     int i_posicao_x = 0; // Posição X atual
@@ -44,4 +64,91 @@ struct SensorData
     // Flags de falha
     bool i_falha_eletrica = false;   // Falha elétrica detectada?
     bool i_falha_hidraulica = false; // Falha hidráulica detectada?
-};
\ No newline at end of file
+};
+
+// ---------------- Amostra compacta (v2) ----------------
+
+#pragma pack(push, 1)
+struct SensorDataV2
+{
+    static constexpr uint8_t VERSAO = 2;
+    static constexpr int FP_BITS = 6;                 // 1/64 px
+    static constexpr double FP_ESCALA = 1 << FP_BITS;
+
+    enum : uint8_t {
+        FALHA_ELETRICA   = 1u << 0,
+        FALHA_HIDRAULICA = 1u << 1,
+    };
+
+    uint64_t timestamp_ms = 0;  // Carimbo de tempo em milissegundos (época Unix)
+    uint32_t seq = 0;           // Número de sequência da amostra
+    uint16_t pos_x_fp = 0;      // Posição X em 1/64 px
+    uint16_t pos_y_fp = 0;      // Posição Y em 1/64 px
+    uint16_t angulo_cdeg = 0;   // Orientação em 0.01 grau (0..35999)
+    int16_t  temperatura_dc = 0; // Temperatura em 0.1 °C
+    uint8_t  falhas = 0;        // Bits de falha (FALHA_*)
+    uint8_t  versao = VERSAO;   // Versão do layout
+
+    // Acessores em unidades de engenharia
+    double x() const { return pos_x_fp / FP_ESCALA; }
+    double y() const { return pos_y_fp / FP_ESCALA; }
+    double angulo() const { return angulo_cdeg / 100.0; }
+    double temperatura() const { return temperatura_dc / 10.0; }
+    bool falha_eletrica() const { return (falhas & FALHA_ELETRICA) != 0; }
+    bool falha_hidraulica() const { return (falhas & FALHA_HIDRAULICA) != 0; }
+
+    // Modificadores (com saturação para a faixa representável)
+    void set_x(double v) { pos_x_fp = para_fp(v); }
+    void set_y(double v) { pos_y_fp = para_fp(v); }
+    void set_angulo(double graus)
+    {
+        double a = std::fmod(graus, 360.0);
+        if (a < 0.0) a += 360.0;
+        long c = std::lround(a * 100.0);
+        angulo_cdeg = static_cast<uint16_t>(c >= 36000 ? 0 : c);
+    }
+    void set_temperatura(double c)
+    {
+        long d = std::lround(c * 10.0);
+        if (d > INT16_MAX) d = INT16_MAX;
+        if (d < INT16_MIN) d = INT16_MIN;
+        temperatura_dc = static_cast<int16_t>(d);
+    }
+    void set_falhas(bool eletrica, bool hidraulica)
+    {
+        falhas = static_cast<uint8_t>((eletrica ? FALHA_ELETRICA : 0) | (hidraulica ? FALHA_HIDRAULICA : 0));
+    }
+
+private:
+    static uint16_t para_fp(double v)
+    {
+        long f = std::lround(v * FP_ESCALA);
+        if (f < 0) f = 0;
+        if (f > UINT16_MAX) f = UINT16_MAX;
+        return static_cast<uint16_t>(f);
+    }
+};
+#pragma pack(pop)
+
+static_assert(sizeof(SensorDataV2) < 24, "SensorDataV2 deve ocupar menos de 24 bytes");
+
+// Número de amostras perdidas entre duas sequências consecutivas recebidas
+// (0 = contígua). Trata o wrap-around de 32 bits. Duplicatas/reordenação
+// (atual <= anterior) retornam 0 e devem ser descartadas pelo chamador com
+// seq_nova().
+inline uint32_t seq_lacuna(uint32_t anterior, uint32_t atual)
+{
+    uint32_t d = atual - anterior;
+    return (d == 0 || d > 0x80000000u) ? 0 : d - 1;
+}
+
+// true se 'atual' é posterior a 'anterior' (aritmética serial, RFC 1982).
+inline bool seq_nova(uint32_t anterior, uint32_t atual)
+{
+    uint32_t d = atual - anterior;
+    return d != 0 && d < 0x80000000u;
+}
+
+// Conversões entre os formatos (implementadas em SensorData.cpp).
+SensorDataV2 para_v2(const SensorData& v1, uint32_t seq);
+SensorData para_v1(const SensorDataV2& v2);
@@ -19,6 +19,10 @@
  * Ele adiciona essa leitura à janela histórica, remove a leitura mais antiga
  * se a janela exceder a ordem definida, calcula a média dos valores na janela
  * e retorna um novo objeto SensorData com os valores filtrados.
+ * - filtrar_v2(const SensorData& raw, uint32_t seq): Mesma filtragem, mas
+ * retorna a amostra compacta SensorDataV2 com a média sem truncamento
+ * (posição sub-pixel, ângulo em 0.01°, temperatura em 0.1 °C) e com o
+ * número de sequência informado.
  *
  * Membros Privados:
  * - ordem_: Armazena a ordem do filtro (tamanho da janela) definida no construtor.
@@ -40,6 +44,10 @@ public:
     // Método filtrar: Processa os dados brutos e retorna os dados filtrados.
     SensorData filtrar(const SensorData& raw);
 
+    // Método filtrar_v2: Igual a filtrar(), mas preserva a precisão da média
+    // e devolve a amostra compacta com o número de sequência 'seq'.
+    SensorDataV2 filtrar_v2(const SensorData& raw, uint32_t seq);
+
 private:
     int ordem_; // A ordem do filtro de média móvel (tamanho da janela)
     std::deque<SensorData> janela_; // Histórico recente das leituras dos sensores
@@ -0,0 +1,111 @@
+/*
+ * Arquivo: SerieTemporal.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define o armazenamento em memória das séries
+ * temporais da frota e a interpretação das consultas que chegam via MQTT.
+ * A interface e o gerente buscam o histórico recente (gráficos dos últimos N minutos) sob
+ * demanda, já reduzido, em vez de cada cliente guardar toda a telemetria ou
+ * varrer o CSV.
+ *
+ * Armazenamento:
+ * - Um anel por caminhão com capacidade fixa (padrão 15 min a 20 Hz) em
+ * estrutura de vetores (SoA): um vetor de timestamps e um vetor float por
+ * campo (x, y, ang, temp). A agregação percorre trechos contíguos de um
+ * único campo, o que o compilador vetoriza; a memória é alocada uma vez.
+ * - Timestamps em ms de relógio de parede (chegada no serviço), forçados a
+ * não decrescer por caminhão: o início de um intervalo é achado por busca
+ * binária no anel.
+ *
+ * Consulta (consultar()):
+ * - Intervalo [t0, t1] de um caminhão e lista de campos.
+ * - passo = 0: pontos brutos; passo > 0: baldes alinhados a múltiplos de
+ * passo com a agregação pedida (media, min, max, ultimo, contagem). Baldes
+ * sem amostras são omitidos.
+ * - No máximo MAX_PONTOS pontos por resposta: se o pedido passar disso, o
+ * passo é aumentado (a resposta informa o passo efetivo).
+ *
+ * Consulta via MQTT (responder_consulta_series(); serviço em ServicoSeries.h):
+ * - Pedido: {"id":"abc","truck":3,"campos":"x,temp","ultimos_ms":600000,"passo":5000,"agg":"media"}
+ *   (ou "t0"/"t1" em ms absolutos no lugar de "ultimos_ms"; sem "campos",
+ *   todos; sem "passo", bruto).
+ * - Resposta: {"id":"abc","truck":3,"agg":"media","passo":5000,"agora":..,"t":[..],"x":[..],"temp":[..]}
+ *   ou {"id":..,"erro":"..."}.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+enum class CampoSerie { X = 0, Y, Ang, Temp };
+enum class AgregacaoSerie { Media, Min, Max, Ultimo, Contagem };
+
+bool campo_serie(const std::string& nome, CampoSerie& out);
+bool agregacao_serie(const std::string& nome, AgregacaoSerie& out);
+const char* nome_campo_serie(CampoSerie c);
+const char* nome_agregacao_serie(AgregacaoSerie a);
+
+struct ResultadoSerie
+{
+    int64_t passo = 0;                        // efetivo (0 = bruto)
+    std::vector<int64_t> t;                   // início do balde ou ts da amostra
+    std::vector<std::vector<double>> valores; // um vetor por campo pedido
+};
+
+// Anel SoA de um caminhão.
+class SerieCaminhao
+{
+public:
+    static constexpr int NUM_CAMPOS = 4;
+
+    explicit SerieCaminhao(size_t capacidade);
+
+    void adicionar(int64_t ts, const float (&v)[NUM_CAMPOS]);
+
+    size_t tamanho() const { return n_; }
+    size_t capacidade() const { return ts_.size(); }
+
+    void consultar(int64_t t0, int64_t t1, const std::vector<CampoSerie>& campos, int64_t passo,
+                   AgregacaoSerie agg, size_t max_pontos, ResultadoSerie& out) const;
+
+private:
+    // posição física da i-ésima amostra mais antiga
+    size_t fisico(size_t i) const { return (inicio_ + i) % ts_.size(); }
+    // primeira amostra (lógica) com ts >= t
+    size_t buscar(int64_t t) const;
+    // chama fn(a, b) para os trechos físicos contíguos das amostras lógicas [i, j)
+    template <typename Fn> void trechos(size_t i, size_t j, Fn&& fn) const;
+
+    std::vector<int64_t> ts_;
+    std::vector<float> campos_[NUM_CAMPOS];
+    size_t inicio_ = 0;
+    size_t n_ = 0;
+};
+
+class ArmazemSeries
+{
+public:
+    static constexpr size_t MAX_PONTOS = 2000;
+
+    explicit ArmazemSeries(size_t capacidade_por_caminhao) : capacidade_(capacidade_por_caminhao) {}
+
+    void adicionar(int truck_id, int64_t ts, const float (&v)[SerieCaminhao::NUM_CAMPOS]);
+
+    // false se o caminhão não tem série.
+    bool consultar(int truck_id, int64_t t0, int64_t t1, const std::vector<CampoSerie>& campos,
+                   int64_t passo, AgregacaoSerie agg, ResultadoSerie& out) const;
+
+    size_t caminhoes() const { return series_.size(); }
+
+private:
+    size_t capacidade_;
+    std::map<int, SerieCaminhao> series_;
+};
+
+// Interpreta um pedido JSON e monta a resposta (agora = relógio de parede, ms).
+std::string responder_consulta_series(const ArmazemSeries& armazem, const std::string& pedido, int64_t agora,
+                                      std::string& id);
+
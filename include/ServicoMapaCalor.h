@@ -0,0 +1,23 @@
+/*
+ * Arquivo: ServicoMapaCalor.h
+ * Finalidade:
+ * Este arquivo de cabeçalho declara o serviço de mapa de calor da frota:
+ * alimenta o MapaCalor (MapaCalor.h) com as posições dos caminhões e publica
+ * as grades decaídas de cada escala via MQTT.
+ *
+ * Modo de execução (main.cpp: --heatmap --fleet-trucks=1-20):
+ * - Entrada: /mina/caminhoes/<id>/posicao, reconstruída por caminhão e
+ * amostrada a cada AmostradorMapa::PERIODO_MS (ver MapaCalor.h).
+ * - Saída: /mina/frota/heatmap/<escala>/delta a cada 5 s e
+ * /mina/frota/heatmap/<escala>/completo (retido) a cada minuto.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "MqttClient.h"
+
+// Executa o serviço de mapa de calor até stop_flag.
+int executar_mapa_calor(const std::vector<int>& caminhoes, MqttClient& mqtt, std::atomic<bool>& stop_flag);
@@ -0,0 +1,25 @@
+/*
+ * Arquivo: ServicoSeries.h
+ * Finalidade:
+ * Este arquivo de cabeçalho declara o serviço de séries temporais da frota:
+ * alimenta o ArmazemSeries (SerieTemporal.h) com a telemetria dos caminhões e
+ * responde às consultas de histórico da interface e do gerente via MQTT.
+ *
+ * Modo de execução (main.cpp: --timeseries --fleet-trucks=1-20):
+ * - Entrada: /mina/caminhoes/<id>/sensores ({"ang":..,"temp":..,"ts":..}),
+ * com o timestamp de chegada (relógio de parede, ms). x/y vêm do /posicao,
+ * extrapolado até a chegada da amostra (ReconstrucaoPosicao.h).
+ * - Pedido: /mina/frota/series/consulta (formato em SerieTemporal.h).
+ * - Resposta: /mina/frota/series/resposta/<id>.
+ * - ATR_SERIES_MIN: minutos mantidos por caminhão (padrão 15).
+ */
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "MqttClient.h"
+
+// Executa o serviço de séries temporais até stop_flag.
+int executar_series(const std::vector<int>& caminhoes, MqttClient& mqtt, std::atomic<bool>& stop_flag);
@@ -0,0 +1,71 @@
+/*
+ * Arquivo: SnapshotCaminhao.h
+ * Finalidade:
+ * Este arquivo de cabeçalho define o snapshot compacto do estado de um
+ * caminhão, publicado como mensagem MQTT retida. Uma interface ou gerente que
+ * se conecta depois (ex.: gestao_pygame.py) recebe o snapshot do broker logo
+ * na assinatura, sem esperar o próximo /estado nem a próxima publicação da
+ * rota.
+ *
+ * Conteúdo (JSON, mesmas chaves do /estado quando existem):
+ *     {"automatico":1,"defeito":0,"alerta_temp":0,"rota_versao":2,
+ *      "waypoints":5,"waypoint":1,"ultima_falha":"FALHA_ELETRICA","falha_ts":123}
+ * - rota_versao aumenta a cada rota diferente; a rota em si fica retida em
+ * /mina/caminhoes/<id>/rota_atual (mesmo formato texto do /route).
+ * - ultima_falha/falha_ts: descrição e instante do início da última falha
+ * ("" e 0 se nunca houve).
+ *
+ * Publicação:
+ * - Somente quando algum campo muda (não há republicação periódica); por
+ * isso /snapshot e /rota_atual são estado retido no MqttClient (último valor
+ * nunca descartado, reenviado após falha de envio). Posição
+ * e sensores ficam de fora: mudam a cada ciclo e já têm tópicos próprios.
+ * - As tarefas chamam os métodos de atualização a cada ciclo; a comparação
+ * com o último snapshot publicado (EstadoSnapshot.h) é barata e feita sob
+ * um mutex próprio.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "EstadoSnapshot.h"
+#include "MqttClient.h"
+#include "Route.h"
+
+class PublicadorSnapshot
+{
+public:
+    PublicadorSnapshot(MqttClient& mqtt, int truck_id);
+
+    // Modo e flags de estado (chamado a cada amostra pelo coletor).
+    void estado(bool automatico, bool defeito, bool alerta_temp);
+
+    // Rota corrente: nova versão (e rota retida) se o conteúdo mudou.
+    void rota(const Route& r);
+
+    // Índice do waypoint corrente.
+    void waypoint(size_t idx);
+
+    // Falhas presentes na amostra ("" se nenhuma). Só o início de uma falha
+    // diferente da ativa altera ultima_falha/falha_ts.
+    void falhas(const std::string& descricao, uint64_t ts);
+
+    SnapshotCaminhao atual() const;
+    // Rota corrente no formato texto do /route ("" se nenhuma).
+    std::string rota_texto() const;
+    uint64_t publicacoes() const;
+
+private:
+    // Publica (retido) se o snapshot difere do último publicado. Chamar com mtx_.
+    void publicar_se_mudou();
+
+    MqttClient& mqtt_;
+    const int truck_id_;
+    mutable std::mutex mtx_;
+    EstadoSnapshot regras_;
+    uint64_t publicacoes_ = 0;
+};
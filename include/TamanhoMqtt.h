@@ -0,0 +1,50 @@
+/*
+ * Arquivo: TamanhoMqtt.h
+ * Finalidade:
+ * Tamanho em bytes, no fio, de um pacote PUBLISH (MQTT 3.1.1 e v5). O
+ * MqttClient usa estas contas para informar a economia líquida das sessões
+ * v5: o nome do tópico que o alias deixa de enviar menos as propriedades
+ * que passam a ir em cada mensagem.
+ *
+ * Formato (especificação MQTT v5, seções 2.1, 2.2.2 e 3.3):
+ * - Cabeçalho fixo: 1 byte + "remaining length" (inteiro variável, 1 a 4 bytes).
+ * - Cabeçalho variável: nome do tópico (2 bytes de tamanho + texto; vazio
+ * quando só o alias vai), identificador do pacote se QoS > 0 (2 bytes) e,
+ * em v5, o tamanho das propriedades (inteiro variável) seguido delas.
+ * - Propriedades: alias de tópico 3 bytes, expiração 5 bytes, propriedade de
+ * usuário 1 + (2 + chave) + (2 + valor).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace TamanhoMqtt {
+
+constexpr size_t PROP_ALIAS = 3;  // identificador + inteiro de 2 bytes
+constexpr size_t PROP_EXPIRA = 5; // identificador + inteiro de 4 bytes
+
+// Bytes do inteiro de tamanho variável que codifica n.
+inline size_t varint(size_t n)
+{
+    size_t b = 1;
+    while (n >= 128) { n /= 128; ++b; }
+    return b;
+}
+
+// Bytes de uma propriedade de usuário (par de textos UTF-8).
+inline size_t prop_usuario(const std::string& chave, const std::string& valor)
+{
+    return 1 + 2 + chave.size() + 2 + valor.size();
+}
+
+// Bytes do PUBLISH completo. 'props' é a soma das propriedades (só v5).
+inline size_t publish(size_t topico, size_t payload, bool v5, size_t props = 0, int qos = 0)
+{
+    size_t resto = 2 + topico + (qos > 0 ? 2 : 0) + payload;
+    if (v5) resto += varint(props) + props;
+    return 1 + varint(resto) + resto;
+}
+
+} // namespace TamanhoMqtt
@@ -7,64 +7,93 @@
 #include "BufferCircular.h"
 #include "MqttClient.h"
 #include "Autuadores.h"
+#include "Checkpoint.h"
+#include "Route.h"
+#include "Executor.h"
+#include "SnapshotCaminhao.h"
+#include "KpiCaminhao.h"
+#include "RitmoAdaptativo.h"
 
 // --------------------------------------------------------------------
-// Declaração das 5 threads principais do sistema ATR
+// Declaração das tarefas (corrotinas) do sistema ATR, executadas por um
+// Executor (ver Executor.h). Os parâmetros por referência devem viver até
+// Executor::aguardar() retornar.
 // --------------------------------------------------------------------
 
-void TratamentoSensores_thread(
+Tarefa TratamentoSensores_tarefa(
     std::atomic<bool>& stop_flag,
-    BufferCircular<SensorData>& buf_nav,
-    BufferCircular<SensorData>& buf_logic,
-    BufferCircular<SensorData>& buf_falhas,
-    BufferCircular<SensorData>& buf_coletor,
+    BufferCircular<SensorDataV2>& buf_nav,
+    BufferCircular<SensorDataV2>& buf_logic,
+    BufferCircular<SensorDataV2>& buf_falhas,
+    BufferCircular<SensorDataV2>& buf_coletor,
     MqttClient& mqtt,
     EstadosCaminhao& estados,
     ComandosCaminhao& comandos,
     AtuadoresCaminhao& atuadores,
+    CheckpointCaminhao& checkpoint, // estado inicial (warm start) e final da simulação
     int ordem_media_movel,
     int periodo_ms,
+    RitmoCaminhao& ritmo,           // período dos laços (RitmoAdaptativo.h)
     int truck_id
 );
 
-void LogicaDeComando_thread(
+Tarefa LogicaDeComando_tarefa(
     std::atomic<bool>& stop_flag,
-    BufferCircular<SensorData>& buf_logic,
+    BufferCircular<SensorDataV2>& buf_logic,
     BufferCircular<std::string>& buf_cmds,
     MqttClient& mqtt,
     EstadosCaminhao& estados,
     ComandosCaminhao& comandos,
     AtuadoresCaminhao& atuadores,
+    RitmoCaminhao& ritmo,           // período dos laços (RitmoAdaptativo.h)
     int truck_id
 );
 
-void MonitoramentoDeFalhas_thread(
+Tarefa MonitoramentoDeFalhas_tarefa(
     std::atomic<bool>& stop_flag,
-    BufferCircular<SensorData>& buf_falhas,
+    BufferCircular<SensorDataV2>& buf_falhas,
     MqttClient& mqtt,
     EstadosCaminhao& estados,
+    PublicadorSnapshot& snapshot,   // última falha no snapshot retido
+    RitmoCaminhao& ritmo,           // período dos laços (RitmoAdaptativo.h)
     int truck_id
 );
 
-void ControleDeNavegacao_thread(
+Tarefa ControleDeNavegacao_tarefa(
     std::atomic<bool>& stop_flag,
-    BufferCircular<SensorData>& buf_nav,
+    BufferCircular<SensorDataV2>& buf_nav,
     MqttClient& mqtt,
     EstadosCaminhao& estados,
     ComandosCaminhao& comandos,
     AtuadoresCaminhao& atuadores,
+    RitmoCaminhao& ritmo,           // período dos laços (RitmoAdaptativo.h)
     int truck_id
 );
 
-void ColetorDeDados_thread(
+Tarefa ColetorDeDados_tarefa(
     std::atomic<bool>& stop_flag,
-    BufferCircular<SensorData>& buf_coletor,
-    BufferCircular<SensorData>& buf_logic,
+    BufferCircular<SensorDataV2>& buf_coletor,
+    BufferCircular<SensorDataV2>& buf_logic,
     BufferCircular<std::string>& buf_cmds,
     MqttClient& mqtt,
     EstadosCaminhao& estados,
     ComandosCaminhao& comandos,
     AtuadoresCaminhao& atuadores,
+    PublicadorSnapshot& snapshot,   // modo e flags de estado no snapshot retido
+    AgregadorKpi& kpi,              // indicadores alimentados por cada amostra
+    RitmoCaminhao& ritmo,           // período dos laços (RitmoAdaptativo.h)
+    int truck_id
+);
+
+// Publica os setpoints da rota e avança os waypoints conforme /posicao.
+Tarefa GerenciadorDeRota_tarefa(
+    std::atomic<bool>& stop_flag,
+    MqttClient& mqtt,
+    Route& route,
+    CheckpointCaminhao& checkpoint, // waypoint inicial (warm start) e final
+    PublicadorSnapshot& snapshot,   // versão da rota e waypoint no snapshot retido
+    AgregadorKpi& kpi,              // waypoints alcançados
+    RitmoCaminhao& ritmo,           // período dos laços (RitmoAdaptativo.h)
     int truck_id
 );
 
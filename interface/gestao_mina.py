@@ -34,6 +34,8 @@ import json
 import threading
 import paho.mqtt.client as mqtt
 
+from reconstrucao_posicao import ReconstrutorPosicao
+
 # Configuração do broker MQTT via variáveis de ambiente
 MQTT_BROKER = os.environ.get("MQTT_BROKER", "localhost")
 MQTT_PORT = int(os.environ.get("MQTT_PORT", "1883"))
@@ -45,6 +47,8 @@ class Manager:
     def __init__(self, broker, port):
         # Dicionário para armazenar o estado atual de cada caminhão (ID -> estado)
         self.trucks = {}
+        # /posicao chega esparsa (dead reckoning): posição extrapolada por caminhão
+        self.posicoes = {}
         # Próximo ID de caminhão a ser criado (começa em 2, pois o 1 é criado pelo run_all.py)
         self.next_truck_id = 2
         # Mutex para proteger o acesso ao dicionário de caminhões (thread-safe)
@@ -125,6 +129,7 @@ class Manager:
 
             # Atualiza os dados com base no tipo de mensagem recebida
             if kind == "posicao":
+                self.posicoes.setdefault(tid, ReconstrutorPosicao()).atualizar(data)
                 s.update({
                     "x": int(data.get("x", s["x"])),
                     "y": int(data.get("y", s["y"])),
@@ -208,7 +213,12 @@ class Manager:
                 if s["defeito"]:
                     status = "DEFEITO!" # Defeito tem prioridade na exibição
 
-                print(f"ID {tid}: pos=({s['x']},{s['y']}) ang={s['ang']} temp={s['temp']} | {status}")
+                x, y = s['x'], s['y']
+                rec = self.posicoes.get(tid)
+                if rec and rec.valido():
+                    x, y = (int(round(c)) for c in rec.posicao())
+
+                print(f"ID {tid}: pos=({x},{y}) ang={s['ang']} temp={s['temp']} | {status}")
 
         # Imprime o menu de comandos
         print("\nComandos:")
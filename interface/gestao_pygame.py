@@ -31,8 +31,9 @@ Funcionalidades Principais:
 Arquitetura:
 -   Classe Button: Implementa botões interativos na interface Pygame.
 -   Classe Manager: Gerencia a conexão MQTT, assina os tópicos relevantes
-    (/posicao, /estado, /sensores, /ack) e mantém um dicionário atualizado com o
-    estado de todos os caminhões.
+    (/posicao, /estado, /sensores, /snapshot retido, /ack) e mantém um dicionário
+    atualizado com o estado de todos os caminhões. A posição vem só do /posicao,
+    extrapolada até o instante do desenho (reconstrucao_posicao.py).
 -   Função run(): Loop principal do Pygame, responsável por desenhar a interface,
     processar eventos de entrada (cliques do mouse, fechamento da janela) e
     atualizar a tela.
@@ -47,6 +48,8 @@ import math
 import pygame
 import paho.mqtt.client as mqtt
 
+from reconstrucao_posicao import ReconstrutorPosicao
+
 # --- CONFIGURAÇÕES ---
 # Obtém o endereço e a porta do broker MQTT das variáveis de ambiente,
 # usando valores padrão se não estiverem definidas.
@@ -118,6 +121,8 @@ class Manager:
     def __init__(self, broker, port):
         # Dicionário para armazenar o estado de cada caminhão (ID -> estado)
         self.trucks = {}
+        # Última /posicao de cada caminhão, extrapolada ao desenhar
+        self.posicoes = {}
         # Próximo ID de caminhão a ser criado (o controle de IDs é feito aqui)
         # O ID 1 geralmente é criado na inicialização pelo run_all.py
         self.next_truck_id = 1
@@ -150,6 +155,9 @@ class Manager:
         client.subscribe('/mina/caminhoes/+/posicao')
         client.subscribe('/mina/caminhoes/+/estado')
         client.subscribe('/mina/caminhoes/+/sensores')
+        # Snapshot retido: o broker entrega na assinatura o último estado de cada
+        # caminhão (modo, defeito), sem esperar o próximo /estado
+        client.subscribe('/mina/caminhoes/+/snapshot')
         client.subscribe('/mina/gerente/add_truck/ack')
 
     def on_message(self, client, userdata, msg):
@@ -190,12 +198,24 @@ class Manager:
 
                 s = self.trucks[tid]
                 # Atualiza os campos correspondentes ao tipo de mensagem recebida
-                if kind == 'posicao' or kind == 'sensores':
+                # A posição vem só do /posicao; /sensores traz ângulo e temperatura
+                if kind == 'posicao':
+                    self.posicoes.setdefault(tid, ReconstrutorPosicao()).atualizar(data)
                     s.update({
                         'x': int(data.get('x', s.get('x', 0))),
                         'y': int(data.get('y', s.get('y', 0))),
                         'ang': int(data.get('ang', s.get('ang', 0)))
                     })
+                elif kind == 'sensores':
+                    s.update({
+                        'ang': int(data.get('ang', s.get('ang', 0))),
+                        'temp': int(data.get('temp', s.get('temp', 0)))
+                    })
+                elif kind == 'snapshot':
+                    s.update({
+                        'defeito': bool(data.get('defeito', s.get('defeito', False))),
+                        'automatico': bool(data.get('automatico', s.get('automatico', False)))
+                    })
                 elif kind == 'estado':
                     s.update({
                         'temp': int(data.get('temp', s.get('temp', 0))),
@@ -205,6 +225,14 @@ class Manager:
         except Exception:
             pass # Ignora erros de processamento de mensagem para não travar a interface
 
+    def posicao(self, tid):
+        """Posição (x, y) estimada agora: /posicao extrapolada (chamar com self.lock)."""
+        rec = self.posicoes.get(tid)
+        if rec and rec.valido():
+            return rec.posicao()
+        s = self.trucks[tid]
+        return s['x'], s['y']
+
     # --- FUNÇÕES PARA ENVIO DE COMANDOS ---
     def send_cmd(self, params):
         """Envia um comando genérico para um caminhão específico."""
@@ -343,7 +371,7 @@ def run():
                     clicked_truck = False
                     with mgr.lock:
                         for tid, s in mgr.trucks.items():
-                            tx, ty = world_to_px(s['x'], s['y'])
+                            tx, ty = world_to_px(*mgr.posicao(tid))
                             # Verifica se o clique foi dentro do raio do caminhão (20px)
                             if (mx-tx)**2 + (my-ty)**2 <= 20**2:
                                 selected_id = tid
@@ -365,9 +393,9 @@ def run():
 
         # Desenha os caminhões
         with mgr.lock:
-            items = list(mgr.trucks.items())
-        for tid, s in items:
-            px, py = world_to_px(s['x'], s['y'])
+            items = [(tid, s, mgr.posicao(tid)) for tid, s in mgr.trucks.items()]
+        for tid, s, pos in items:
+            px, py = world_to_px(*pos)
             ang = math.radians(s['ang'])
             # Define a cor com base no estado (Defeito > Automático > Manual)
             cor = (255, 140, 0) # Laranja (Manual)
@@ -18,8 +18,9 @@ Funcionalidades Principais:
 
 Arquitetura:
 -   Comunicação MQTT: O script funciona como um cliente MQTT. Ele assina os
-    tópicos de sensores (/sensores) e estado (/estado) do caminhão 1 para receber
-    atualizações e publica comandos no tópico /comandos para controlar o veículo.
+    tópicos de sensores (/sensores), posição (/posicao, extrapolada entre as
+    amostras) e estado (/estado) do caminhão 1 para receber atualizações e
+    publica comandos no tópico /comandos para controlar o veículo.
 -   Multithreading: Uma thread dedicada (mqtt_thread) gerencia a conexão e o loop
     de mensagens MQTT em segundo plano, garantindo que a interface gráfica permaneça
     responsiva.
@@ -37,11 +38,14 @@ import threading
 import time
 import sys
 
+from reconstrucao_posicao import ReconstrutorPosicao
+
 # Endereço do broker MQTT
 BROKER = "localhost"
 # Tópicos MQTT específicos para o caminhão 1
 TOPIC_CMD = "/mina/caminhoes/1/comandos"  # Para enviar comandos
 TOPIC_SENS = "/mina/caminhoes/1/sensores" # Para receber dados dos sensores
+TOPIC_POS = "/mina/caminhoes/1/posicao"   # Para receber a posição (dead reckoning)
 TOPIC_EST = "/mina/caminhoes/1/estado"    # Para receber o estado geral
 
 # =====================================================================
@@ -62,7 +66,10 @@ estado = {
     "falha_hidr": False
 }
 
-# Mutex para garantir acesso thread-safe ao dicionário 'estado'.
+# Última /posicao recebida; a posição exibida é extrapolada até o desenho.
+posicao = ReconstrutorPosicao()
+
+# Mutex para garantir acesso thread-safe ao dicionário 'estado' e à 'posicao'.
 lock_estado = threading.Lock()
 
 # =====================================================================
@@ -73,6 +80,7 @@ def on_connect(client, userdata, flags, rc):
     print(f"[MQTT] Conectado. rc={rc}")
     # Assina os tópicos para receber dados do caminhão 1
     client.subscribe(TOPIC_SENS)
+    client.subscribe(TOPIC_POS)
     client.subscribe(TOPIC_EST)
 
 def on_message(client, userdata, msg):
@@ -85,14 +93,15 @@ def on_message(client, userdata, msg):
         # Bloqueia o mutex para atualizar o estado com segurança
         with lock_estado:
             if msg.topic == TOPIC_SENS:
-                # Atualiza dados dos sensores (posição, temperatura, falhas)
-                estado["x"] = data.get("x", 0)
-                estado["y"] = data.get("y", 0)
+                # Atualiza dados dos sensores (ângulo, temperatura, falhas)
                 estado["ang"] = data.get("ang", 0)
                 estado["temp"] = data.get("temp", 0)
                 estado["falha_elet"] = data.get("falha_elet", False)
                 estado["falha_hidr"] = data.get("falha_hidr", False)
 
+            elif msg.topic == TOPIC_POS:
+                posicao.atualizar(data)
+
             elif msg.topic == TOPIC_EST:
                 # Atualiza o estado operacional e dos atuadores
                 estado["modo_auto"] = data.get("automatico", False)
@@ -201,6 +210,8 @@ def interface_local():
         # ===================== MOSTRA INFORMAÇÕES =====================
         # Lê o estado atual (com lock) e prepara as linhas de texto para exibição
         with lock_estado:
+            if posicao.valido():
+                estado["x"], estado["y"] = (int(round(c)) for c in posicao.posicao())
             text = [
                 f"Modo auto: {estado['modo_auto']}",
                 f"Defeito: {estado['defeito']}",
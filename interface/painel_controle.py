@@ -10,7 +10,9 @@ mesmo em ambientes sem suporte gráfico ou via acesso remoto (SSH).
 
 Funcionalidades Principais:
 1.  Monitoramento em Tempo Real (Display Thread):
-    - Exibe continuamente o estado dos sensores (posição, temperatura, falhas).
+    - Exibe continuamente a posição (/posicao, extrapolada entre as amostras
+      por reconstrucao_posicao.py, como em interface_local.py) e os sensores
+      (ângulo, temperatura).
     - Exibe o estado dos atuadores (aceleração, direção).
     - Exibe o último evento crítico ocorrido (ex: falha detectada).
     - Atualiza a tela limpando o console e reimprimindo os dados.
@@ -45,6 +47,8 @@ import json
 import os
 import sys
 
+from reconstrucao_posicao import ReconstrutorPosicao
+
 # Configurações de conexão
 BROKER = "localhost"
 TRUCK_ID = 1
@@ -53,6 +57,7 @@ TRUCK_ID = 1
 TOPIC_CMD = f"/mina/caminhoes/{TRUCK_ID}/comandos"
 TOPIC_SETP = f"/mina/caminhoes/{TRUCK_ID}/setpoints"
 TOPIC_SENSORES = f"/mina/caminhoes/{TRUCK_ID}/sensores"
+TOPIC_POSICAO = f"/mina/caminhoes/{TRUCK_ID}/posicao"   # dead reckoning
 TOPIC_ATUADORES = f"/mina/caminhoes/{TRUCK_ID}/atuadores"
 TOPIC_EVENTOS = f"/mina/caminhoes/{TRUCK_ID}/eventos"
 TOPIC_SIM_DEF = f"/mina/caminhoes/{TRUCK_ID}/sim/defeito"
@@ -62,6 +67,10 @@ last_sensor = {}
 last_atuadores = {}
 last_evento = None
 
+# Última /posicao recebida; a posição exibida é extrapolada até a exibição.
+posicao = ReconstrutorPosicao()
+lock_posicao = threading.Lock()
+
 # ============================================================
 # MQTT - CALLBACKS
 # ============================================================
@@ -71,6 +80,7 @@ def on_connect(client, userdata, flags, rc):
     print(f"[MQTT] Conectado ao broker ({rc})")
     # Assina os tópicos de interesse
     client.subscribe(TOPIC_SENSORES)
+    client.subscribe(TOPIC_POSICAO)
     client.subscribe(TOPIC_ATUADORES)
     client.subscribe(TOPIC_EVENTOS)
 
@@ -87,6 +97,14 @@ def on_message(client, userdata, msg):
         except:
             pass
 
+    elif msg.topic == TOPIC_POSICAO:
+        try:
+            data = json.loads(payload)
+        except:
+            return
+        with lock_posicao:
+            posicao.atualizar(data)
+
     elif msg.topic == TOPIC_ATUADORES:
         try:
             last_atuadores = json.loads(payload)
@@ -110,8 +128,16 @@ def display_thread():
         print("     PAINEL DE CONTROLE - CAMINHÃO 1    ")
         print("========================================\n")
 
-        print(">>> SENSORES:")
-        print(last_sensor if last_sensor else "Aguardando dados...")
+        print(">>> POSIÇÃO:")
+        with lock_posicao:
+            pos = posicao.posicao() if posicao.valido() else None
+        print(f"x={pos[0]:.0f}  y={pos[1]:.0f}" if pos else "Aguardando dados...")
+
+        print("\n>>> SENSORES:")
+        if last_sensor:
+            print(f"ângulo={last_sensor.get('ang', 0)}  temperatura={last_sensor.get('temp', 0)}")
+        else:
+            print("Aguardando dados...")
 
         print("\n>>> ATUADORES:")
         print(last_atuadores if last_atuadores else "Aguardando dados...")
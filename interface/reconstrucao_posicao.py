@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+"""
+Reconstrução de Posição (dead reckoning) - Auxiliar para os clientes Python
+
+O caminhão só publica /mina/caminhoes/{id}/posicao quando a posição real se
+afasta da extrapolação mais que a tolerância (ATR_DR_TOL, padrão 3 px) ou a
+cada 1 s. Este módulo aplica o mesmo modelo do lado C++
+(include/ReconstrucaoPosicao.h) para estimar a posição entre as amostras.
+
+Modelo:
+- Velocidade (v, px/s) e taxa de giro (w, graus/s) constantes a partir do
+  rumo (graus; 0 = +x, anti-horário). w ≈ 0: reta; senão, arco de raio v/w.
+- A extrapolação usa a hora de chegada e é limitada a HORIZONTE_MAX_S;
+  payloads antigos (sem v/rumo/w) são usados sem extrapolar.
+
+Erro: até a tolerância do emissor mais v × latência de entrega.
+
+Uso:
+    rec = ReconstrutorPosicao()
+    rec.atualizar(json.loads(payload))        # em on_message
+    x, y = rec.posicao()                       # ao desenhar/exibir
+"""
+
+import math
+import time
+
+HORIZONTE_MAX_S = 2.0
+
+
+def extrapolar(x, y, v, rumo, w, dt):
+    """Posição (x, y) após dt segundos pelo modelo de velocidade e giro constantes."""
+    r0 = math.radians(rumo)
+    wr = math.radians(w)
+    if abs(wr) < 1e-6:
+        return x + v * math.cos(r0) * dt, y + v * math.sin(r0) * dt
+    r1 = r0 + wr * dt
+    return (x + v / wr * (math.sin(r1) - math.sin(r0)),
+            y + v / wr * (math.cos(r0) - math.cos(r1)))
+
+
+class ReconstrutorPosicao:
+    """Última amostra de /posicao de um caminhão e extrapolação até agora."""
+
+    def __init__(self):
+        self.amostra = None
+        self.t_local = 0.0
+
+    def atualizar(self, data, t_local=None):
+        """Registra o payload decodificado; retorna False se faltar x/y."""
+        if "x" not in data or "y" not in data:
+            return False
+        self.amostra = data
+        self.t_local = time.monotonic() if t_local is None else t_local
+        return True
+
+    def valido(self):
+        return self.amostra is not None
+
+    def posicao(self, t_local=None):
+        """Posição (x, y) estimada no instante t_local (padrão: agora)."""
+        d = self.amostra
+        if d is None:
+            return None
+        x, y = float(d["x"]), float(d["y"])
+        if not all(k in d for k in ("v", "rumo", "w")):
+            return x, y
+        agora = time.monotonic() if t_local is None else t_local
+        dt = min(max(0.0, agora - self.t_local), HORIZONTE_MAX_S)
+        return extrapolar(x, y, float(d["v"]), float(d["rumo"]), float(d["w"]), dt)
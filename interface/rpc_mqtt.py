@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+"""
+RPC sobre MQTT - Auxiliar para os clientes Python
+
+Mesmo protocolo do lado C++ (include/RpcMqtt.h): o pedido vai para
+/mina/caminhoes/{id}/rpc/pedido com um id de correlação e o tópico de
+resposta deste cliente; a resposta chega só para ele.
+
+Métodos do caminhão: get-state, get-route, get-metrics e
+set-config ({"kpi_periodo_s": N}; 0 = KPI só sob pedido).
+
+Uso (com um paho.mqtt.client já conectado e com loop rodando):
+    rpc = ClienteRpc(client, "gestao")
+    # em on_message:  if rpc.tratar_mensagem(msg): return
+    r = rpc.chamar(3, "get-route")      # dict da resposta, ou None no timeout
+    if r and r["ok"]: print(r["resultado"]["rota"])
+
+chamar() bloqueia; não chame dentro do on_message (a resposta chega por ele).
+"""
+
+import itertools
+import json
+import os
+import threading
+import time
+
+
+class ClienteRpc:
+    """Chamadas com id de correlação e timeout sobre um cliente paho."""
+
+    def __init__(self, client, nome):
+        self.client = client
+        self.nome = f"{nome}_{os.getpid()}"
+        self.topico_resposta = f"/mina/rpc/{self.nome}/resposta"
+        self._seq = itertools.count(1)
+        self._pendentes = {}  # id -> [Event, resposta]
+        self._lock = threading.Lock()
+        client.subscribe(self.topico_resposta)
+
+    def tratar_mensagem(self, msg):
+        """Entrega uma resposta à chamada que espera; False se não é deste cliente."""
+        if msg.topic != self.topico_resposta:
+            return False
+        try:
+            data = json.loads(msg.payload.decode())
+        except (ValueError, UnicodeDecodeError):
+            return True
+        with self._lock:
+            espera = self._pendentes.get(data.get("id"))
+        if espera:
+            espera[1] = data
+            espera[0].set()
+        return True
+
+    def chamar(self, truck_id, metodo, params=None, timeout=2.0):
+        id_ = f"{self.nome}-{next(self._seq)}"
+        espera = [threading.Event(), None]
+        with self._lock:
+            self._pendentes[id_] = espera
+        pedido = {
+            "id": id_,
+            "metodo": metodo,
+            "resposta": self.topico_resposta,
+            "prazo": int((time.time() + timeout) * 1000),
+            "params": params or {},
+        }
+        try:
+            self.client.publish(f"/mina/caminhoes/{truck_id}/rpc/pedido", json.dumps(pedido))
+            espera[0].wait(timeout)
+            return espera[1]
+        finally:
+            with self._lock:
+                self._pendentes.pop(id_, None)
@@ -2,13 +2,18 @@
 # painel_controle.py
 #
 # Painel de Controle CLI para o Caminhão ATR.
-# Envia comandos via MQTT e exibe telemetria em tempo real.
+# Envia comandos via MQTT e exibe telemetria em tempo real. A posição vem do
+# /posicao, extrapolada entre as amostras por interface/reconstrucao_posicao.py.
 
 import paho.mqtt.client as mqtt
 import threading
 import time
 import json
 import os
+import sys
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "interface"))
+from reconstrucao_posicao import ReconstrutorPosicao
 
 BROKER = "localhost"
 TRUCK_ID = 1
@@ -16,6 +21,7 @@ TRUCK_ID = 1
 TOPIC_CMD = f"/mina/caminhoes/{TRUCK_ID}/comandos"
 TOPIC_SETP = f"/mina/caminhoes/{TRUCK_ID}/setpoints"
 TOPIC_SENSORES = f"/mina/caminhoes/{TRUCK_ID}/sensores"
+TOPIC_POSICAO = f"/mina/caminhoes/{TRUCK_ID}/posicao"
 TOPIC_ATUADORES = f"/mina/caminhoes/{TRUCK_ID}/atuadores"
 TOPIC_EVENTOS = f"/mina/caminhoes/{TRUCK_ID}/eventos"
 
@@ -23,6 +29,8 @@ TOPIC_EVENTOS = f"/mina/caminhoes/{TRUCK_ID}/eventos"
 last_sensor = {}
 last_atuadores = {}
 last_evento = None
+posicao = ReconstrutorPosicao()
+lock_posicao = threading.Lock()
 
 # ============================================================
 # MQTT - CALLBACKS
@@ -31,6 +39,7 @@ last_evento = None
 def on_connect(client, userdata, flags, rc):
     print(f"[MQTT] Conectado ao broker ({rc})")
     client.subscribe(TOPIC_SENSORES)
+    client.subscribe(TOPIC_POSICAO)
     client.subscribe(TOPIC_ATUADORES)
     client.subscribe(TOPIC_EVENTOS)
 
@@ -45,6 +54,14 @@ def on_message(client, userdata, msg):
         except:
             pass
 
+    elif msg.topic == TOPIC_POSICAO:
+        try:
+            data = json.loads(payload)
+        except:
+            return
+        with lock_posicao:
+            posicao.atualizar(data)
+
     elif msg.topic == TOPIC_ATUADORES:
         try:
             last_atuadores = json.loads(payload)
@@ -66,8 +83,16 @@ def display_thread():
         print("     PAINEL DE CONTROLE - CAMINHÃO 1    ")
         print("========================================\n")
 
-        print(">>> SENSORES:")
-        print(last_sensor if last_sensor else "Aguardando dados...")
+        print(">>> POSIÇÃO:")
+        with lock_posicao:
+            pos = posicao.posicao() if posicao.valido() else None
+        print(f"x={pos[0]:.0f}  y={pos[1]:.0f}" if pos else "Aguardando dados...")
+
+        print("\n>>> SENSORES:")
+        if last_sensor:
+            print(f"ângulo={last_sensor.get('ang', 0)}  temperatura={last_sensor.get('temp', 0)}")
+        else:
+            print("Aguardando dados...")
 
         print("\n>>> ATUADORES:")
         print(last_atuadores if last_atuadores else "Aguardando dados...")
@@ -106,6 +106,21 @@ def start_truck(truck_id: int, route: str, broker: str):
     return run_process(cmd, cwd=str(BUILD_DIR), env=env, logfile=str(logfile), tag=f"truck:{truck_id}")
 
 
+def start_fleet_host(host_name: str, trucks_spec: str, routes: dict, broker: str):
+    """Start `atr_mina` in fleet-host mode: it claims trucks from `trucks_spec`
+    by consistent hashing and runs each one as a child process. `routes` maps
+    truck id -> route file; every host gets the full map, since any host may
+    end up owning any truck."""
+    if not BIN.exists():
+        raise FileNotFoundError(f"binary not found at {BIN}; run with --build first")
+    logfile = LOG_DIR / f"fleet_{host_name}.log"
+    env = os.environ.copy()
+    env["MQTT_BROKER"] = broker
+    spec = ",".join(f"{tid}:{path}" for tid, path in sorted(routes.items()))
+    cmd = [str(BIN), f"--fleet-host={host_name}", f"--fleet-trucks={trucks_spec}", f"--fleet-routes={spec}"]
+    return run_process(cmd, cwd=str(BUILD_DIR), env=env, logfile=str(logfile), tag=f"fleet:{host_name}")
+
+
 def start_interface(broker: str, use_venv=True):
     if not INTERFACE_SCRIPT.exists():
         info("interface script not found; skipping")
@@ -186,6 +201,9 @@ def parse_args():
     p.add_argument("--start-broker", action="store_true", help="Start local mosquitto broker")
     p.add_argument("--broker", type=str, default="localhost", help="MQTT broker address (default localhost). Use 'mock' to disable broker")
     p.add_argument("--no-interface", action="store_true", help="Do not start the Python interface")
+    p.add_argument("--fleet-hosts", type=int, default=0,
+                   help="Start N fleet-host processes that shard trucks 1..num-trucks by consistent hashing "
+                        "(instead of one process per truck)")
     return p.parse_args()
 
 
@@ -444,11 +462,17 @@ def main():
         while len(route_files) < args.num_trucks:
             route_files.append(str(ROOT / "routes" / "example.route"))
 
-        # start trucks
-        for i in range(1, args.num_trucks + 1):
-            r = route_files[(i - 1) % len(route_files)]
-            start_truck(i, r, broker)
-            time.sleep(0.2)
+        # start trucks (directly, or sharded across fleet hosts); truck i gets
+        # the same route either way
+        routes = {i: route_files[(i - 1) % len(route_files)] for i in range(1, args.num_trucks + 1)}
+        if args.fleet_hosts > 0:
+            for h in range(1, args.fleet_hosts + 1):
+                start_fleet_host(f"host{h}", f"1-{args.num_trucks}", routes, broker)
+                time.sleep(0.2)
+        else:
+            for i in range(1, args.num_trucks + 1):
+                start_truck(i, routes[i], broker)
+                time.sleep(0.2)
 
         if not args.no_interface:
             start_interface(broker)
@@ -0,0 +1,104 @@
+/*
+ * Arquivo: AnelConsistente.cpp
+ * Finalidade:
+ * Implementação do anel de hash consistente definido em "AnelConsistente.h".
+ */
+
+#include "AnelConsistente.h"
+
+#include <iostream>
+#include <sstream>
+
+AnelConsistente::AnelConsistente(int vnodes)
+    : vnodes_(vnodes <= 0 ? 1 : vnodes)
+{
+}
+
+uint64_t AnelConsistente::hash(const std::string& chave)
+{
+    // FNV-1a 64 bits
+    uint64_t h = 1469598103934665603ull;
+    for (unsigned char c : chave) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    // Mistura final (splitmix64) para espalhar chaves parecidas ("host#1", "host#2")
+    h += 0x9e3779b97f4a7c15ull;
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+    return h ^ (h >> 31);
+}
+
+void AnelConsistente::adicionar_host(const std::string& host)
+{
+    if (!hosts_.insert(host).second) return;
+    for (int k = 0; k < vnodes_; ++k) {
+        // Em caso (improvável) de colisão, o menor nome vence: resultado
+        // independe da ordem de inserção.
+        uint64_t pos = hash(host + "#" + std::to_string(k));
+        auto it = anel_.find(pos);
+        if (it == anel_.end() || host < it->second) anel_[pos] = host;
+    }
+}
+
+void AnelConsistente::remover_host(const std::string& host)
+{
+    if (hosts_.erase(host) == 0) return;
+    // Reconstrói: mantém a regra de desempate das colisões.
+    std::set<std::string> restantes;
+    restantes.swap(hosts_);
+    anel_.clear();
+    for (const auto& h : restantes) adicionar_host(h);
+}
+
+void AnelConsistente::definir_hosts(const std::set<std::string>& hosts)
+{
+    if (hosts == hosts_) return;
+    hosts_.clear();
+    anel_.clear();
+    for (const auto& h : hosts) adicionar_host(h);
+}
+
+std::string AnelConsistente::dono(int truck_id) const
+{
+    if (anel_.empty()) return std::string();
+    uint64_t h = hash("truck:" + std::to_string(truck_id));
+    auto it = anel_.lower_bound(h);
+    if (it == anel_.end()) it = anel_.begin(); // dá a volta no anel
+    return it->second;
+}
+
+std::vector<int> AnelConsistente::caminhoes_de(const std::string& host, const std::vector<int>& candidatos) const
+{
+    std::vector<int> out;
+    for (int id : candidatos) {
+        if (dono(id) == host) out.push_back(id);
+    }
+    return out;
+}
+
+std::vector<int> parse_lista_caminhoes(const std::string& spec)
+{
+    std::vector<int> out;
+    std::set<int> vistos;
+    std::istringstream iss(spec);
+    std::string parte;
+    while (std::getline(iss, parte, ',')) {
+        try {
+            size_t traco = parte.find('-', 1);
+            int a, b;
+            if (traco != std::string::npos) {
+                a = std::stoi(parte.substr(0, traco));
+                b = std::stoi(parte.substr(traco + 1));
+            } else {
+                a = b = std::stoi(parte);
+            }
+            for (int id = a; id <= b; ++id) {
+                if (id > 0 && vistos.insert(id).second) out.push_back(id);
+            }
+        } catch (...) {
+            std::cerr << "[Frota] item inválido na lista de caminhões: '" << parte << "'\n";
+        }
+    }
+    return out;
+}
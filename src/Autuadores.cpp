@@ -39,6 +39,6 @@
 EstadosCaminhao ESTADO;      // Estado global do caminhão
 ComandosCaminhao COMANDO;    // Comandos globais pendentes
 AtuadoresCaminhao ATUADOR;   // Valores globais dos atuadores
-std::mutex state_mtx;        // Mutex global para sincronização adicional
+MutexAtr state_mtx;          // Mutex global para sincronização adicional
 
 // Observação: como o objeto é global, os campos atômicos já iniciam com valores padrão (false/0).
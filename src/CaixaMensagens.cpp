@@ -0,0 +1,127 @@
+/*
+ * Arquivo: CaixaMensagens.cpp
+ * Finalidade:
+ * Implementação das filas de recepção declaradas em "CaixaMensagens.h".
+ *
+ * Detalhes:
+ * - await_suspend() registra a corrotina em aguardando_ quando a fila do
+ * tópico está vazia; entregar() passa a mensagem à espera mais antiga ainda
+ * válida (o timeout pode ter vencido) em vez de enfileirá-la.
+ * - Ganchos e retomada rodam fora do lock; a corrotina roda numa thread do
+ * executor, nunca na thread que entregou a mensagem.
+ */
+
+#include "CaixaMensagens.h"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+
+namespace {
+
+// Casa um tópico com um filtro MQTT de mesmo número de níveis ('+' = qualquer nível).
+bool casa_filtro(const std::string& filtro, const std::string& topico)
+{
+    size_t i = 0, j = 0;
+    while (i <= filtro.size() && j <= topico.size()) {
+        const size_t fi = std::min(filtro.find('/', i), filtro.size());
+        const size_t fj = std::min(topico.find('/', j), topico.size());
+        if (!(fi - i == 1 && filtro[i] == '+') && filtro.compare(i, fi - i, topico, j, fj - j) != 0) return false;
+        if (fi == filtro.size() || fj == topico.size()) return fi == filtro.size() && fj == topico.size();
+        i = fi + 1;
+        j = fj + 1;
+    }
+    return false;
+}
+
+} // namespace
+
+CaixaMensagens::CaixaMensagens(const char* nome)
+{
+    nomear_lock(q_mtx_, nome);
+}
+
+void CaixaMensagens::entregar(const std::string& topic, std::string payload)
+{
+    EsperaPtr acordar;
+    std::vector<std::function<void()>> ganchos;
+    {
+        std::lock_guard<MutexAtr> lock(q_mtx_);
+        auto g = ganchos_.find(topic);
+        if (g != ganchos_.end()) ganchos = g->second;
+        // Corrotina esperando este tópico: entrega direta.
+        auto it = aguardando_.find(topic);
+        if (it != aguardando_.end()) {
+            while (!it->second.empty() && !acordar) {
+                EsperaMensagem w = it->second.front();
+                it->second.pop_front();
+                if (w.e->reivindicar()) {
+                    *w.destino = std::move(payload);
+                    acordar = w.e;
+                }
+            }
+        }
+        // O operador [] do mapa cria uma nova fila se o tópico ainda não existir.
+        if (!acordar) queues_[topic].push(std::move(payload));
+    }
+    for (auto& fn : ganchos) fn();
+    if (acordar) acordar->retomar();
+}
+
+std::optional<std::string> CaixaMensagens::try_pop(const std::string& topic)
+{
+    std::lock_guard<MutexAtr> lock(q_mtx_);
+    auto it = queues_.find(topic);
+    if (it == queues_.end() || it->second.empty()) return std::nullopt;
+    std::string m = std::move(it->second.front());
+    it->second.pop();
+    return m;
+}
+
+std::vector<std::pair<std::string, std::string>> CaixaMensagens::drenar_filtro(const std::string& filtro,
+                                                                               const std::string& exceto)
+{
+    std::vector<std::pair<std::string, std::string>> out;
+    std::lock_guard<MutexAtr> lock(q_mtx_);
+    for (auto& [topico, fila] : queues_) {
+        if (fila.empty() || topico == exceto || !casa_filtro(filtro, topico)) continue;
+        while (!fila.empty()) {
+            out.emplace_back(topico, std::move(fila.front()));
+            fila.pop();
+        }
+    }
+    return out;
+}
+
+void CaixaMensagens::ao_chegar(const std::string& topic, std::function<void()> fn)
+{
+    std::lock_guard<MutexAtr> lock(q_mtx_);
+    ganchos_[topic].push_back(std::move(fn));
+}
+
+bool CaixaMensagens::AguardaMensagem::await_suspend(std::coroutine_handle<> h)
+{
+    auto e = std::make_shared<EsperaAssincrona>();
+    e->h = h;
+    e->ex = Executor::atual();
+    if (!e->ex) throw std::logic_error("CaixaMensagens::next fora de um executor");
+    const bool com_timeout = com_timeout_; // 'this' pode morrer após o unlock
+    const auto prazo = std::chrono::steady_clock::now() + timeout_;
+    {
+        std::lock_guard<MutexAtr> lock(c_.q_mtx_);
+        auto it = c_.queues_.find(topic_);
+        if (it != c_.queues_.end() && !it->second.empty()) {
+            valor_ = std::move(it->second.front());
+            it->second.pop();
+            return false; // não suspende
+        }
+        auto& fila = c_.aguardando_[topic_];
+        // descarta esperas cujo timeout já venceu
+        while (!fila.empty() && fila.front().e->concluida.load()) fila.pop_front();
+        fila.push_back({e, &valor_});
+    }
+    if (com_timeout) {
+        e->ex->agendar_em(prazo, [e] { if (e->reivindicar()) e->retomar(); });
+    }
+    return true;
+}
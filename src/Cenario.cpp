@@ -0,0 +1,324 @@
+/*
+ * Arquivo: Cenario.cpp
+ * Finalidade:
+ * Implementação do motor de cenários declarado em "Cenario.h" (a leitura
+ * dos arquivos .cen fica em CenarioArquivo.cpp).
+ *
+ * Detalhes:
+ * - O relógio do cenário começa em zero no início de cada execução; o laço
+ * dispara os eventos vencidos, consome as mensagens recebidas e confere as
+ * expectativas pendentes a cada PASSO_MS.
+ * - Cada evento que tem reação observável registra uma Expectativa (tópico do
+ * caminhão, predicado sobre o payload, instante de referência). A primeira
+ * mensagem que satisfaz o predicado depois da referência fecha a expectativa
+ * e a latência entra na estatística do tipo do evento.
+ * - Mensagens retidas e sobras de um cenário anterior são descartadas antes
+ * do início; o /snapshot retido, porém, é lido como estado inicial.
+ */
+
+#include "Cenario.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <thread>
+
+#include "JsonSimples.h"
+#include "MqttClient.h"
+#include "Relogio.h"
+
+namespace {
+
+constexpr int PASSO_MS = 5;
+
+const char* nome_acao(AcaoCenario a)
+{
+    switch (a) {
+    case AcaoCenario::Defeito: return "defeito";
+    case AcaoCenario::Comando: return "comando";
+    case AcaoCenario::Rota:    return "rota";
+    case AcaoCenario::Queda:   return "queda";
+    }
+    return "?";
+}
+
+std::string topico_caminhao(int truck, const char* sufixo)
+{
+    return "/mina/caminhoes/" + std::to_string(truck) + sufixo;
+}
+
+std::string minusculas(std::string s)
+{
+    for (char& ch : s) ch = std::tolower((unsigned char)ch);
+    return s;
+}
+
+struct Expectativa
+{
+    AcaoCenario tipo;
+    int caminhao;
+    std::string topico;
+    std::function<bool(const std::string&)> atende;
+    int64_t t_ref;   // latência medida a partir daqui
+    int64_t prazo;
+};
+
+struct Latencias
+{
+    std::vector<double> ms;
+    uint64_t perdidas = 0;
+};
+
+struct EstadoCaminhaoCenario
+{
+    std::string snapshot;       // último /snapshot recebido
+    int64_t ultimo_sensor = -1; // instante do último /sensores
+    int64_t maior_lacuna = 0;
+};
+
+class ExecucaoCenario
+{
+public:
+    ExecucaoCenario(const Cenario& c, MqttClient& mqtt) : c_(c), mqtt_(mqtt) {}
+
+    void rodar(std::atomic<bool>& stop_flag);
+    std::string relatorio_json(const std::string& rotulo) const;
+
+private:
+    int64_t agora() const
+    {
+        return Relogio::mono_ms() - t0_;
+    }
+    void disparar(const EventoCenario& ev);
+    void consumir(int truck);
+    void receber(int truck, const std::string& topico, const std::string& pl, int64_t t);
+    void vencer_expectativas(int64_t t);
+
+    const Cenario& c_;
+    MqttClient& mqtt_;
+    int64_t t0_ = 0; // Relogio::mono_ms() no início
+    int64_t duracao_ms_ = 0;
+    std::map<int, EstadoCaminhaoCenario> caminhoes_;
+    std::vector<Expectativa> pendentes_;
+    std::map<AcaoCenario, Latencias> latencias_;
+    uint64_t enviadas_ = 0;
+    uint64_t rec_sensores_ = 0, rec_eventos_ = 0, rec_snapshot_ = 0;
+};
+
+void ExecucaoCenario::rodar(std::atomic<bool>& stop_flag)
+{
+    for (int truck : c_.caminhoes) {
+        caminhoes_[truck];
+        for (const char* suf : {"/sensores", "/eventos", "/snapshot"})
+            mqtt_.subscribe_topic(topico_caminhao(truck, suf));
+    }
+    // Espera o snapshot retido e descarta o resto do que já estava na fila.
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    for (int truck : c_.caminhoes) {
+        while (auto m = mqtt_.try_pop_message(topico_caminhao(truck, "/snapshot"))) caminhoes_[truck].snapshot = *m;
+        while (mqtt_.try_pop_message(topico_caminhao(truck, "/sensores"))) { }
+        while (mqtt_.try_pop_message(topico_caminhao(truck, "/eventos"))) { }
+    }
+
+    duracao_ms_ = c_.duracao_ms;
+    if (duracao_ms_ <= 0) {
+        duracao_ms_ = (c_.eventos.empty() ? 0 : c_.eventos.back().t_ms) + PRAZO_EXPECTATIVA_MS;
+    }
+
+    std::cout << "[Cenario] '" << c_.nome << "': " << c_.eventos.size() << " eventos, "
+              << c_.caminhoes.size() << " caminhões, " << duracao_ms_ << " ms\n";
+    t0_ = Relogio::mono_ms();
+    size_t prox = 0;
+    while (!stop_flag.load()) {
+        int64_t t = agora();
+        while (prox < c_.eventos.size() && c_.eventos[prox].t_ms <= t) disparar(c_.eventos[prox++]);
+        for (int truck : c_.caminhoes) consumir(truck);
+        vencer_expectativas(agora());
+        if (t >= duracao_ms_ && (prox == c_.eventos.size())) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(PASSO_MS));
+    }
+    duracao_ms_ = agora();
+    // O que sobrou sem resposta conta como perdido.
+    for (const auto& e : pendentes_) latencias_[e.tipo].perdidas++;
+    pendentes_.clear();
+}
+
+void ExecucaoCenario::disparar(const EventoCenario& ev)
+{
+    const int64_t t = agora();
+    const int truck = ev.caminhao;
+    auto esperar = [&](const char* suf, std::function<bool(const std::string&)> atende, int64_t t_ref) {
+        pendentes_.push_back({ev.acao, truck, topico_caminhao(truck, suf), std::move(atende),
+                              t_ref, t_ref + PRAZO_EXPECTATIVA_MS});
+    };
+    auto ja_esperando = [&](AcaoCenario tipo) {
+        return std::any_of(pendentes_.begin(), pendentes_.end(),
+                           [&](const Expectativa& e) { return e.tipo == tipo && e.caminhao == truck; });
+    };
+
+    switch (ev.acao) {
+    case AcaoCenario::Defeito: {
+        mqtt_.publish(topico_caminhao(truck, "/sim/defeito"), ev.argumento);
+        const std::string low = minusculas(ev.argumento);
+        const bool limpar = low.find("0") != std::string::npos || low.find("clear") != std::string::npos
+                            || low.find("false") != std::string::npos;
+        if (limpar) break;
+        std::string campo;
+        if (low.find("eletrica") != std::string::npos || low.find("all") != std::string::npos) campo = "\"falha_ele\":1";
+        else if (low.find("hidraulica") != std::string::npos) campo = "\"falha_hid\":1";
+        if (!campo.empty())
+            esperar("/eventos", [campo](const std::string& pl) { return pl.find(campo) != std::string::npos; }, t);
+        break;
+    }
+    case AcaoCenario::Comando: {
+        mqtt_.publish(topico_caminhao(truck, "/comandos"), ev.argumento);
+        const std::string low = minusculas(ev.argumento);
+        std::string campo;
+        if (low.find("rearme") != std::string::npos) campo = "\"defeito\":0";
+        else if (low.find("auto") != std::string::npos) campo = "\"automatico\":1";
+        else if (low.find("man") != std::string::npos) campo = "\"automatico\":0";
+        if (campo.empty() || ja_esperando(AcaoCenario::Comando)) break;
+        if (caminhoes_[truck].snapshot.find(campo) != std::string::npos) break; // já está no estado
+        esperar("/snapshot", [campo](const std::string& pl) { return pl.find(campo) != std::string::npos; }, t);
+        break;
+    }
+    case AcaoCenario::Rota: {
+        long versao = 0;
+        inteiro_json(caminhoes_[truck].snapshot, "rota_versao", versao);
+        mqtt_.publish(topico_caminhao(truck, "/route"), ev.argumento);
+        esperar("/snapshot", [versao](const std::string& pl) {
+            long v = 0;
+            return inteiro_json(pl, "rota_versao", v) && v > versao;
+        }, t);
+        break;
+    }
+    case AcaoCenario::Queda: {
+        mqtt_.publish(topico_caminhao(truck, "/sim/queda"), ev.argumento);
+        int64_t dur = 0;
+        try { dur = std::stoll(ev.argumento); } catch (...) { }
+        // Só vale amostra gerada depois do fim da queda: o que ficou retido na
+        // fila do caminhão durante a queda chega primeiro, com o "ts" antigo.
+        const long fim_unix = static_cast<long>(Relogio::unix_ms() + dur);
+        esperar("/sensores", [fim_unix](const std::string& pl) {
+            long ts = 0;
+            return inteiro_json(pl, "ts", ts) && ts >= fim_unix;
+        }, t + dur);
+        break;
+    }
+    }
+    ++enviadas_;
+}
+
+void ExecucaoCenario::consumir(int truck)
+{
+    for (const char* suf : {"/sensores", "/eventos", "/snapshot"}) {
+        const std::string topico = topico_caminhao(truck, suf);
+        while (auto m = mqtt_.try_pop_message(topico)) receber(truck, topico, *m, agora());
+    }
+}
+
+void ExecucaoCenario::receber(int truck, const std::string& topico, const std::string& pl, int64_t t)
+{
+    EstadoCaminhaoCenario& est = caminhoes_[truck];
+    if (topico.size() > 9 && topico.compare(topico.size() - 9, 9, "/sensores") == 0) {
+        ++rec_sensores_;
+        if (est.ultimo_sensor >= 0) est.maior_lacuna = std::max(est.maior_lacuna, t - est.ultimo_sensor);
+        est.ultimo_sensor = t;
+    } else if (topico.size() > 9 && topico.compare(topico.size() - 9, 9, "/snapshot") == 0) {
+        ++rec_snapshot_;
+        est.snapshot = pl;
+    } else {
+        ++rec_eventos_;
+    }
+
+    for (auto it = pendentes_.begin(); it != pendentes_.end();) {
+        if (it->caminhao == truck && it->topico == topico && t >= it->t_ref && it->atende(pl)) {
+            latencias_[it->tipo].ms.push_back(static_cast<double>(t - it->t_ref));
+            it = pendentes_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ExecucaoCenario::vencer_expectativas(int64_t t)
+{
+    for (auto it = pendentes_.begin(); it != pendentes_.end();) {
+        if (t > it->prazo) {
+            latencias_[it->tipo].perdidas++;
+            it = pendentes_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+std::string ExecucaoCenario::relatorio_json(const std::string& rotulo) const
+{
+    const double seg = std::max<int64_t>(duracao_ms_, 1) / 1000.0;
+    int64_t lacuna = 0;
+    for (const auto& [truck, est] : caminhoes_) lacuna = std::max(lacuna, est.maior_lacuna);
+
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(1);
+    ss << "{\"cenario\":\"" << c_.nome << "\",\"rotulo\":\"" << rotulo << "\""
+       << ",\"duracao_ms\":" << duracao_ms_
+       << ",\"caminhoes\":" << c_.caminhoes.size()
+       << ",\"enviadas\":" << enviadas_
+       << ",\"sensores_hz\":" << rec_sensores_ / seg
+       << ",\"eventos_hz\":" << rec_eventos_ / seg
+       << ",\"snapshots\":" << rec_snapshot_
+       << ",\"maior_lacuna_sensores_ms\":" << lacuna
+       << ",\"latencias\":{";
+    bool primeiro = true;
+    for (const auto& [tipo, lat] : latencias_) {
+        std::vector<double> v = lat.ms;
+        std::sort(v.begin(), v.end());
+        double media = 0.0;
+        for (double x : v) media += x;
+        if (!v.empty()) media /= v.size();
+        const double p95 = v.empty() ? 0.0 : v[std::min(v.size() - 1, (v.size() * 95) / 100)];
+        ss << (primeiro ? "" : ",") << "\"" << nome_acao(tipo) << "\":{"
+           << "\"n\":" << v.size()
+           << ",\"media_ms\":" << media
+           << ",\"p95_ms\":" << p95
+           << ",\"max_ms\":" << (v.empty() ? 0.0 : v.back())
+           << ",\"perdidas\":" << lat.perdidas << "}";
+        primeiro = false;
+    }
+    ss << "}}";
+    return ss.str();
+}
+
+} // namespace
+
+int executar_campanha(const ConfigCampanha& cfg, MqttClient& mqtt, std::atomic<bool>& stop_flag)
+{
+    int rc = 0;
+    for (size_t i = 0; i < cfg.arquivos.size() && !stop_flag.load(); ++i) {
+        Cenario c;
+        std::string erro;
+        if (!carregar_cenario(cfg.arquivos[i], c, erro)) {
+            std::cerr << "[Cenario] " << erro << "\n";
+            rc = 1;
+            continue;
+        }
+        ExecucaoCenario exec(c, mqtt);
+        exec.rodar(stop_flag);
+        const std::string linha = exec.relatorio_json(cfg.rotulo);
+        std::cout << linha << "\n";
+        if (!cfg.saida.empty()) {
+            std::ofstream out(cfg.saida, std::ios::app);
+            if (out) out << linha << "\n";
+            else std::cerr << "[Cenario] não foi possível gravar em '" << cfg.saida << "'\n";
+        }
+        // Intervalo para as reações do cenário anterior não vazarem no próximo.
+        if (i + 1 < cfg.arquivos.size()) std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+    return rc;
+}
@@ -0,0 +1,136 @@
+/*
+ * Arquivo: CenarioArquivo.cpp
+ * Finalidade:
+ * Leitura dos arquivos de cenário (.cen) declarada em "Cenario.h". Fica
+ * separada do motor (Cenario.cpp) para não depender do cliente MQTT.
+ *
+ * Detalhes:
+ * - Rajadas de comando são expandidas em eventos individuais e o alvo '*'
+ * vira um evento por caminhão da diretiva caminhoes.
+ * - Rotas são lidas e convertidas para o texto do /route já na carga, para
+ * que um arquivo ilegível falhe antes de a campanha começar.
+ */
+
+#include "Cenario.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "AnelConsistente.h"
+#include "Route.h"
+
+bool carregar_cenario_texto(const std::string& texto, Cenario& c, std::string& erro)
+{
+    c = Cenario();
+    std::istringstream in(texto);
+    std::string linha;
+    size_t n = 0;
+    std::vector<EventoCenario> eventos; // caminhao < 0 = todos
+    auto falhar = [&](const std::string& msg) {
+        erro = "linha " + std::to_string(n) + ": " + msg;
+        return false;
+    };
+
+    while (std::getline(in, linha)) {
+        ++n;
+        size_t hash = linha.find('#');
+        if (hash != std::string::npos) linha.resize(hash);
+        std::istringstream ls(linha);
+        std::string primeiro;
+        if (!(ls >> primeiro)) continue;
+
+        if (primeiro == "nome") {
+            ls >> c.nome;
+            continue;
+        }
+        if (primeiro == "caminhoes") {
+            std::string spec;
+            ls >> spec;
+            c.caminhoes = parse_lista_caminhoes(spec);
+            continue;
+        }
+        if (primeiro == "duracao") {
+            if (!(ls >> c.duracao_ms)) return falhar("duracao sem valor");
+            continue;
+        }
+
+        EventoCenario ev;
+        ev.linha = n;
+        try { ev.t_ms = std::stoll(primeiro); } catch (...) { return falhar("diretiva desconhecida '" + primeiro + "'"); }
+        std::string acao, alvo;
+        if (!(ls >> acao >> alvo >> ev.argumento)) return falhar("esperado: T acao alvo argumento");
+        if (alvo == "*") ev.caminhao = -1;
+        else {
+            try { ev.caminhao = std::stoi(alvo); } catch (...) { return falhar("alvo inválido '" + alvo + "'"); }
+        }
+
+        if (acao == "defeito") ev.acao = AcaoCenario::Defeito;
+        else if (acao == "comando") ev.acao = AcaoCenario::Comando;
+        else if (acao == "queda") {
+            ev.acao = AcaoCenario::Queda;
+            long ms = -1;
+            try { ms = std::stol(ev.argumento); } catch (...) { return falhar("queda sem duração"); }
+            if (ms < 0) return falhar("queda com duração negativa");
+        } else if (acao == "rota") {
+            ev.acao = AcaoCenario::Rota;
+            Route r;
+            if (!r.loadFromFile(ev.argumento) || r.size() == 0) return falhar("rota '" + ev.argumento + "' ilegível");
+            ev.argumento = texto_rota(r);
+        } else {
+            return falhar("ação desconhecida '" + acao + "'");
+        }
+
+        // Rajada: repetições e intervalo opcionais (só para comandos).
+        int repeticoes = 1;
+        int64_t intervalo = 0;
+        if (ev.acao == AcaoCenario::Comando && (ls >> repeticoes)) {
+            if (!(ls >> intervalo) || repeticoes < 1 || intervalo < 0) return falhar("rajada: repetições intervalo_ms");
+        }
+        for (int i = 0; i < repeticoes; ++i) {
+            EventoCenario r = ev;
+            r.t_ms = ev.t_ms + i * intervalo;
+            eventos.push_back(r);
+        }
+    }
+
+    // Expande '*' e inclui no cenário os caminhões citados explicitamente.
+    for (const auto& ev : eventos) {
+        if (ev.caminhao < 0) {
+            if (c.caminhoes.empty()) {
+                erro = "linha " + std::to_string(ev.linha) + ": alvo '*' sem diretiva caminhoes";
+                return false;
+            }
+            for (int truck : c.caminhoes) {
+                EventoCenario e = ev;
+                e.caminhao = truck;
+                c.eventos.push_back(e);
+            }
+        } else {
+            c.eventos.push_back(ev);
+            if (std::find(c.caminhoes.begin(), c.caminhoes.end(), ev.caminhao) == c.caminhoes.end())
+                c.caminhoes.push_back(ev.caminhao);
+        }
+    }
+    std::stable_sort(c.eventos.begin(), c.eventos.end(), [](const EventoCenario& a, const EventoCenario& b) {
+        return a.t_ms < b.t_ms;
+    });
+    if (c.nome.empty()) c.nome = "cenario";
+    return true;
+}
+
+bool carregar_cenario(const std::string& caminho, Cenario& c, std::string& erro)
+{
+    std::ifstream f(caminho);
+    if (!f) {
+        erro = "não foi possível abrir '" + caminho + "'";
+        return false;
+    }
+    std::ostringstream ss;
+    ss << f.rdbuf();
+    if (!carregar_cenario_texto(ss.str(), c, erro)) {
+        erro = caminho + ": " + erro;
+        return false;
+    }
+    return true;
+}
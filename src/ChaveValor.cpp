@@ -0,0 +1,21 @@
+/*
+ * Arquivo: ChaveValor.cpp
+ * Finalidade:
+ * Implementação da leitura chave=valor declarada em "ChaveValor.h".
+ */
+
+#include "ChaveValor.h"
+
+#include <sstream>
+
+std::string valor_chave(const std::string& pl, const std::string& chave)
+{
+    std::istringstream iss(pl);
+    std::string campo;
+    while (std::getline(iss, campo, ',')) {
+        size_t eq = campo.find('=');
+        if (eq == std::string::npos) continue;
+        if (campo.compare(0, eq, chave) == 0) return campo.substr(eq + 1);
+    }
+    return std::string();
+}
@@ -0,0 +1,57 @@
+/*
+ * Arquivo: Checkpoint.cpp
+ * Finalidade:
+ * Implementação da (de)serialização do CheckpointCaminhao definido em
+ * "Checkpoint.h". O formato é texto chave=valor separado por vírgulas,
+ * tolerante a espaços e a chaves desconhecidas (compatível com versões
+ * futuras que acrescentem campos).
+ */
+
+#include "Checkpoint.h"
+#include <sstream>
+#include <cstdlib>
+
+std::string CheckpointCaminhao::serializar() const
+{
+    std::ostringstream ss;
+    ss.precision(6);
+    ss << std::fixed
+       << "x=" << x << ",y=" << y << ",hdg=" << heading
+       << ",auto=" << (automatico ? 1 : 0)
+       << ",wp=" << waypoint_idx;
+    if (t_ms > 0) ss << ",t=" << t_ms;
+    return ss.str();
+}
+
+bool CheckpointCaminhao::desserializar(const std::string& payload, CheckpointCaminhao& out)
+{
+    CheckpointCaminhao ck;
+    bool tem_x = false, tem_y = false;
+    std::istringstream iss(payload);
+    std::string campo;
+    while (std::getline(iss, campo, ',')) {
+        size_t eq = campo.find('=');
+        if (eq == std::string::npos) continue;
+        std::string k = campo.substr(0, eq);
+        std::string v = campo.substr(eq + 1);
+        // remove espaços nas pontas da chave
+        while (!k.empty() && isspace((unsigned char)k.back())) k.pop_back();
+        while (!k.empty() && isspace((unsigned char)k.front())) k.erase(k.begin());
+        const char* pv = v.c_str();
+        if (k == "x")         { ck.x = std::strtod(pv, nullptr); tem_x = true; }
+        else if (k == "y")    { ck.y = std::strtod(pv, nullptr); tem_y = true; }
+        else if (k == "hdg")  { ck.heading = std::strtod(pv, nullptr); }
+        else if (k == "auto") { ck.automatico = std::atoi(pv) != 0; }
+        else if (k == "wp")   { ck.waypoint_idx = static_cast<size_t>(std::strtoul(pv, nullptr, 10)); }
+        else if (k == "t")    { ck.t_ms = std::strtoll(pv, nullptr, 10); }
+    }
+    if (!tem_x || !tem_y) return false;
+    ck.valido = true;
+    out = ck;
+    return true;
+}
+
+std::string topico_checkpoint(int truck_id)
+{
+    return "/mina/caminhoes/" + std::to_string(truck_id) + "/checkpoint";
+}
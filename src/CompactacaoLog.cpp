@@ -0,0 +1,514 @@
+/*
+ * Arquivo: CompactacaoLog.cpp
+ * Finalidade:
+ * Implementação da compactação do log CSV detalhado declarada em
+ * "CompactacaoLog.h".
+ *
+ * Detalhes:
+ * - Os segmentos são cortados em offsets arbitrários: cada um começa na
+ * primeira linha que inicia dentro dele e termina a última linha que inicia
+ * antes do fim (mesma regra do leitor_em de IndiceLog.cpp).
+ * - A liberação usa blocos inteiros (BLOCO_FS): o resto do bloco parcial antes
+ * do corte fica no disco, mas logicamente já foi descartado.
+ * - Falha ao arquivar interrompe a rodada antes de liberar qualquer byte.
+ */
+
+#include "CompactacaoLog.h"
+#include "IndiceLog.h"
+#include "IoLog.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr int64_t MS_1S = 1000;
+constexpr int64_t MS_1MIN = 60 * 1000;
+constexpr uint64_t BLOCO_FS = 4096;
+constexpr int64_t FOLGA_CONSULTA_MS = 60 * 1000; // amostras atrasadas em janelas seguintes
+constexpr int NUM_COLUNAS = 13;
+
+const char* const NOMES_CAMPOS[Agregado::NUM_CAMPOS] = {"pos_x", "pos_y", "ang", "temp", "o_acel", "o_dir"};
+const char* const NOMES_FLAGS[Agregado::NUM_FLAGS] = {"fe", "fh", "auto", "defeito", "alerta"};
+// Colunas do CSV detalhado (ver ColetorDeDados_tarefa).
+constexpr int COLUNAS_CAMPOS[Agregado::NUM_CAMPOS] = {2, 3, 4, 5, 8, 9};
+constexpr int COLUNAS_FLAGS[Agregado::NUM_FLAGS] = {6, 7, 10, 11, 12};
+
+struct EstadoCompactacao
+{
+    uint64_t compactado = 0;   // linhas antes disso já foram agregadas
+    uint64_t descartado = 0;   // linhas antes disso não existem mais
+    bool tem_horizonte = false;
+    int64_t horizonte = 0;     // fim (exclusivo) da última janela
+};
+
+std::string caminho_estado(const std::string& csv)
+{
+    return csv + ".compactacao";
+}
+
+EstadoCompactacao ler_estado(const std::string& csv)
+{
+    EstadoCompactacao e;
+    std::ifstream fin(caminho_estado(csv));
+    std::string linha;
+    while (std::getline(fin, linha)) {
+        size_t eq = linha.find('=');
+        if (eq == std::string::npos) continue;
+        const std::string k = linha.substr(0, eq);
+        try {
+            if (k == "compactado") e.compactado = std::stoull(linha.substr(eq + 1));
+            else if (k == "descartado") e.descartado = std::stoull(linha.substr(eq + 1));
+            else if (k == "horizonte") { e.horizonte = std::stoll(linha.substr(eq + 1)); e.tem_horizonte = true; }
+        } catch (...) { }
+    }
+    return e;
+}
+
+bool gravar_estado(const std::string& csv, const EstadoCompactacao& e)
+{
+    const std::string tmp = caminho_estado(csv) + ".tmp";
+    {
+        std::ofstream fout(tmp, std::ios::trunc);
+        fout << "compactado=" << e.compactado << "\n"
+             << "descartado=" << e.descartado << "\n"
+             << "horizonte=" << e.horizonte << "\n";
+        if (!fout) return false;
+    }
+    std::error_code ec;
+    fs::rename(tmp, caminho_estado(csv), ec);
+    return !ec;
+}
+
+int64_t piso(int64_t t, int64_t passo)
+{
+    const int64_t r = t % passo;
+    return r < 0 ? t - r - passo : t - r;
+}
+
+// Interpreta uma linha do CSV detalhado (13 colunas).
+bool ler_linha(const std::string& linha, int64_t& ts, int& truck,
+               double (&valores)[Agregado::NUM_CAMPOS], bool (&ativas)[Agregado::NUM_FLAGS])
+{
+    if (!campos_linha_log(linha, ts, truck)) return false;
+    double col[NUM_COLUNAS];
+    const char* p = linha.c_str();
+    for (int i = 0; i < NUM_COLUNAS; ++i) {
+        char* fim = nullptr;
+        col[i] = std::strtod(p, &fim);
+        if (fim == p) return false;
+        if (i + 1 < NUM_COLUNAS) {
+            if (*fim != ',') return false;
+            p = fim + 1;
+        }
+    }
+    for (int i = 0; i < Agregado::NUM_CAMPOS; ++i) valores[i] = col[COLUNAS_CAMPOS[i]];
+    for (int i = 0; i < Agregado::NUM_FLAGS; ++i) ativas[i] = col[COLUNAS_FLAGS[i]] != 0.0;
+    return true;
+}
+
+void combinar_mapa(MapaAgregados& destino, const MapaAgregados& origem)
+{
+    for (const auto& [k, a] : origem) destino[k].combinar(a);
+}
+
+// Threads da compactação: nice 19 e classe de E/S ociosa (best-effort).
+void baixar_prioridade()
+{
+#ifdef __linux__
+    ::setpriority(PRIO_PROCESS, static_cast<id_t>(::syscall(SYS_gettid)), 19);
+    constexpr int IOPRIO_WHO_PROCESS = 1;
+    constexpr int IOPRIO_CLASS_IDLE = 3;
+    constexpr int IOPRIO_CLASS_SHIFT = 13;
+    ::syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT);
+#endif
+}
+
+// Agrega [inicio, fim) em segmentos paralelos; retorna o número de linhas.
+uint64_t agregar_paralelo(const ConfigCompactacao& cfg, uint64_t inicio, uint64_t fim,
+                          MapaAgregados& seg1s, MapaAgregados& min1)
+{
+    std::vector<std::pair<uint64_t, uint64_t>> segmentos;
+    const uint64_t passo = std::max<uint64_t>(cfg.segmento_bytes, BLOCO_FS);
+    for (uint64_t a = inicio; a < fim; a += passo) segmentos.emplace_back(a, std::min(fim, a + passo));
+    if (segmentos.empty()) return 0;
+
+    unsigned n_threads = cfg.paralelismo ? cfg.paralelismo : std::max(1u, std::thread::hardware_concurrency() / 2);
+    n_threads = static_cast<unsigned>(std::min<size_t>(n_threads, segmentos.size()));
+
+    struct Parcial
+    {
+        MapaAgregados seg1s, min1;
+        uint64_t linhas = 0;
+    };
+    std::vector<Parcial> parciais(segmentos.size());
+    std::atomic<size_t> proximo{0};
+    auto trabalhador = [&] {
+        baixar_prioridade();
+        for (size_t i = proximo++; i < segmentos.size(); i = proximo++) {
+            parciais[i].linhas = agregar_trecho(cfg.csv, segmentos[i].first, segmentos[i].second,
+                                                parciais[i].seg1s, parciais[i].min1);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < n_threads; ++t) threads.emplace_back(trabalhador);
+    for (auto& t : threads) t.join();
+
+    uint64_t linhas = 0;
+    for (const Parcial& p : parciais) {
+        combinar_mapa(seg1s, p.seg1s);
+        combinar_mapa(min1, p.min1);
+        linhas += p.linhas;
+    }
+    return linhas;
+}
+
+bool gravar_nivel(const std::string& dir, int64_t t0, int64_t t1, const MapaAgregados& m)
+{
+    if (m.empty()) return true;
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    const std::string final = dir + "/" + std::to_string(t0) + "_" + std::to_string(t1) + ".csv";
+    const std::string tmp = final + ".tmp";
+    {
+        std::ofstream fout(tmp, std::ios::trunc);
+        fout << cabecalho_agregado() << "\n";
+        for (const auto& [k, a] : m) fout << serializar_agregado(k.first, k.second, a) << "\n";
+        if (!fout) return false;
+    }
+    fs::rename(tmp, final, ec);
+    return !ec;
+}
+
+// Copia [inicio, fim) do CSV para o arquivo (com cabeçalho).
+bool arquivar_trecho(const ConfigCompactacao& cfg, uint64_t inicio, uint64_t fim, int64_t t0, int64_t t1)
+{
+    std::error_code ec;
+    fs::create_directories(cfg.dir_arquivo, ec);
+    const std::string final = cfg.dir_arquivo + "/" + std::to_string(t0) + "_" + std::to_string(t1) + ".csv";
+    const std::string tmp = final + ".tmp";
+    int in = ::open(cfg.csv.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) return false;
+    std::ofstream fout(tmp, std::ios::trunc | std::ios::binary);
+    if (inicio > 0) fout << "timestamp_ms,truck_id,pos_x,pos_y,ang,temp,fe,fh,o_acel,o_dir,e_auto,e_defeito,e_alerta_temp\n";
+    std::vector<char> buf(1 << 20);
+    bool ok = true;
+    for (uint64_t pos = inicio; pos < fim && ok;) {
+        const size_t n = static_cast<size_t>(std::min<uint64_t>(buf.size(), fim - pos));
+        ssize_t r = ::pread(in, buf.data(), n, static_cast<off_t>(pos));
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) { ok = false; break; }
+        fout.write(buf.data(), r);
+        pos += static_cast<uint64_t>(r);
+    }
+    ::close(in);
+    fout.close();
+    if (!ok || !fout) return false;
+    fs::rename(tmp, final, ec);
+    return !ec;
+}
+
+// Libera os blocos inteiros de [inicio, fim); retorna os bytes liberados.
+uint64_t liberar_trecho(const std::string& caminho, uint64_t inicio, uint64_t fim)
+{
+    const uint64_t a = inicio - inicio % BLOCO_FS;
+    const uint64_t b = fim - fim % BLOCO_FS;
+    if (b <= a) return 0;
+    int fd = ::open(caminho.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) return 0;
+    uint64_t liberados = b - a;
+#ifdef FALLOC_FL_PUNCH_HOLE
+    if (::fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, static_cast<off_t>(a),
+                    static_cast<off_t>(b - a)) != 0) {
+        std::cerr << "[Compactacao] fallocate(PUNCH_HOLE) em " << caminho << ": "
+                  << std::strerror(errno) << " (espaço não liberado)\n";
+        liberados = 0;
+    }
+#else
+    liberados = 0;
+#endif
+    ::close(fd);
+    return liberados;
+}
+
+// Libera o começo do índice: entradas até a primeira que aponta para o corte ou além.
+void liberar_indice(const std::string& csv, uint64_t corte)
+{
+    const std::string idx = caminho_indice(csv);
+    std::ifstream fin(idx, std::ios::binary);
+    if (!fin) return;
+    EntradaIndiceLog e;
+    uint64_t pos = 0;
+    while (fin.read(reinterpret_cast<char*>(&e), sizeof(e))) {
+        if (e.offset >= corte) break;
+        pos += sizeof(e);
+    }
+    fin.close();
+    liberar_trecho(idx, 0, pos);
+}
+
+void aplicar_retencao(const std::string& dir, int64_t retencao_ms, int64_t agora)
+{
+    if (retencao_ms <= 0) return;
+    std::error_code ec;
+    for (const auto& ent : fs::directory_iterator(dir, ec)) {
+        const std::string nome = ent.path().stem().string();
+        const size_t sep = nome.find('_');
+        if (ent.path().extension() != ".csv" || sep == std::string::npos) continue;
+        try {
+            if (std::stoll(nome.substr(sep + 1)) < agora - retencao_ms) fs::remove(ent.path(), ec);
+        } catch (...) { }
+    }
+}
+
+} // namespace
+
+void Agregado::adicionar(int64_t ts, const double (&valores)[NUM_CAMPOS], const bool (&ativas)[NUM_FLAGS])
+{
+    const bool primeiro = n == 0;
+    ++n;
+    for (int i = 0; i < NUM_CAMPOS; ++i) {
+        CampoAgregado& c = campos[i];
+        const double v = valores[i];
+        if (primeiro) {
+            c.min = c.max = v;
+        } else {
+            c.min = std::min(c.min, v);
+            c.max = std::max(c.max, v);
+        }
+        c.soma += v;
+        if (primeiro || ts >= ts_ultimo) c.ultimo = v;
+    }
+    for (int i = 0; i < NUM_FLAGS; ++i) flags[i] += ativas[i] ? 1 : 0;
+    if (primeiro || ts >= ts_ultimo) ts_ultimo = ts;
+}
+
+void Agregado::combinar(const Agregado& o)
+{
+    if (o.n == 0) return;
+    if (n == 0) {
+        *this = o;
+        return;
+    }
+    const bool o_mais_novo = o.ts_ultimo >= ts_ultimo;
+    for (int i = 0; i < NUM_CAMPOS; ++i) {
+        campos[i].min = std::min(campos[i].min, o.campos[i].min);
+        campos[i].max = std::max(campos[i].max, o.campos[i].max);
+        campos[i].soma += o.campos[i].soma;
+        if (o_mais_novo) campos[i].ultimo = o.campos[i].ultimo;
+    }
+    for (int i = 0; i < NUM_FLAGS; ++i) flags[i] += o.flags[i];
+    n += o.n;
+    if (o_mais_novo) ts_ultimo = o.ts_ultimo;
+}
+
+uint64_t agregar_trecho(const std::string& caminho_csv, uint64_t inicio, uint64_t fim,
+                        MapaAgregados& seg1s, MapaAgregados& min1)
+{
+    LeitorSequencial fin(caminho_csv, inicio == 0 ? 0 : inicio - 1);
+    if (!fin.aberto()) return 0;
+    uint64_t pos = inicio == 0 ? 0 : inicio - 1;
+    std::string linha;
+    if (inicio > 0) {
+        // resto da linha que começou no segmento anterior (vazia se inicio já é início de linha)
+        if (!fin.linha(linha)) return 0;
+        pos += linha.size() + 1;
+    }
+
+    uint64_t n = 0;
+    int64_t ts;
+    int truck;
+    double valores[Agregado::NUM_CAMPOS];
+    bool ativas[Agregado::NUM_FLAGS];
+    while (pos < fim && fin.linha(linha)) {
+        pos += linha.size() + 1;
+        if (!ler_linha(linha, ts, truck, valores, ativas)) continue;
+        seg1s[{piso(ts, MS_1S), truck}].adicionar(ts, valores, ativas);
+        min1[{piso(ts, MS_1MIN), truck}].adicionar(ts, valores, ativas);
+        ++n;
+    }
+    return n;
+}
+
+std::string cabecalho_agregado()
+{
+    std::ostringstream ss;
+    ss << "balde_ms,truck_id,n,ts_ultimo";
+    for (const char* c : NOMES_CAMPOS) ss << "," << c << "_min," << c << "_max," << c << "_media," << c << "_ultimo";
+    for (const char* f : NOMES_FLAGS) ss << ",n_" << f;
+    return ss.str();
+}
+
+std::string serializar_agregado(int64_t balde_ms, int truck_id, const Agregado& a)
+{
+    std::ostringstream ss;
+    ss << std::setprecision(10) << balde_ms << "," << truck_id << "," << a.n << "," << a.ts_ultimo;
+    for (const CampoAgregado& c : a.campos) {
+        ss << "," << c.min << "," << c.max << ","
+           << std::fixed << std::setprecision(2) << (a.n ? c.soma / a.n : 0.0)
+           << std::defaultfloat << std::setprecision(10) << "," << c.ultimo;
+    }
+    for (uint64_t f : a.flags) ss << "," << f;
+    return ss.str();
+}
+
+bool ler_agregado(const std::string& linha, int64_t& balde_ms, int& truck_id, Agregado& a)
+{
+    if (!campos_linha_log(linha, balde_ms, truck_id)) return false;
+    constexpr int N = 4 + 4 * Agregado::NUM_CAMPOS + Agregado::NUM_FLAGS;
+    double col[N];
+    const char* p = linha.c_str();
+    for (int i = 0; i < N; ++i) {
+        char* fim = nullptr;
+        col[i] = std::strtod(p, &fim);
+        if (fim == p) return false;
+        if (i + 1 < N) {
+            if (*fim != ',') return false;
+            p = fim + 1;
+        }
+    }
+    a = Agregado();
+    a.n = static_cast<uint64_t>(col[2]);
+    a.ts_ultimo = static_cast<int64_t>(col[3]);
+    for (int i = 0; i < Agregado::NUM_CAMPOS; ++i) {
+        const double* c = &col[4 + 4 * i];
+        a.campos[i] = {c[0], c[1], c[2] * a.n, c[3]};
+    }
+    for (int i = 0; i < Agregado::NUM_FLAGS; ++i) a.flags[i] = static_cast<uint64_t>(col[4 + 4 * Agregado::NUM_CAMPOS + i]);
+    return true;
+}
+
+ResultadoCompactacao compactar_log(const ConfigCompactacao& cfg, const std::atomic<bool>* stop_flag)
+{
+    ResultadoCompactacao r;
+    LeitorLog leitor(cfg.csv);
+    int64_t primeiro = 0, ultimo = 0;
+    if (!leitor.intervalo_indexado(primeiro, ultimo)) {
+        std::cerr << "[Compactacao] " << cfg.csv << " sem índice (use --log-reindex)\n";
+        return r;
+    }
+
+    EstadoCompactacao est = ler_estado(cfg.csv);
+    const int64_t alvo = piso(ultimo - cfg.idade_ms, MS_1MIN);
+    const int64_t janela = std::max(MS_1MIN, piso(cfg.janela_ms, MS_1MIN));
+    int64_t t0 = est.tem_horizonte ? est.horizonte : piso(primeiro, MS_1MIN);
+    r.horizonte_ms = t0;
+
+    while (t0 < alvo && !(stop_flag && stop_flag->load())) {
+        const int64_t t1 = std::min(alvo, t0 + janela);
+        const uint64_t corte = std::max(est.compactado, leitor.offset_inicial(t1));
+
+        MapaAgregados seg1s, min1;
+        r.linhas += agregar_paralelo(cfg, est.compactado, corte, seg1s, min1);
+        if (!gravar_nivel(cfg.dir_agregados + "/1s", t0, t1, seg1s)
+            || !gravar_nivel(cfg.dir_agregados + "/1min", t0, t1, min1)) {
+            std::cerr << "[Compactacao] falha ao gravar os agregados de " << t0 << "_" << t1 << "\n";
+            break;
+        }
+        r.baldes_1s += seg1s.size();
+        r.baldes_1min += min1.size();
+
+        const uint64_t descartado_antes = est.descartado;
+        const bool liberar = cfg.bruto != ConfigCompactacao::Bruto::Manter && corte > est.descartado;
+        if (liberar && cfg.bruto == ConfigCompactacao::Bruto::Arquivar
+            && !arquivar_trecho(cfg, est.compactado, corte, t0, t1)) {
+            std::cerr << "[Compactacao] falha ao arquivar " << t0 << "_" << t1 << "; bruto mantido\n";
+            break;
+        }
+        est.compactado = corte;
+        est.horizonte = t1;
+        est.tem_horizonte = true;
+        if (liberar) est.descartado = corte;
+        // O estado com o novo início é gravado antes da liberação: leitores
+        // nunca posicionam dentro do buraco.
+        if (!gravar_estado(cfg.csv, est)) {
+            std::cerr << "[Compactacao] falha ao gravar o estado\n";
+            break;
+        }
+        if (liberar) {
+            r.bytes_liberados += liberar_trecho(cfg.csv, descartado_antes, corte);
+            liberar_indice(cfg.csv, corte);
+        }
+        r.janelas++;
+        r.horizonte_ms = t1;
+        t0 = t1;
+    }
+
+    aplicar_retencao(cfg.dir_agregados + "/1s", cfg.retencao_1s_ms, ultimo);
+    aplicar_retencao(cfg.dir_agregados + "/1min", cfg.retencao_1min_ms, ultimo);
+    return r;
+}
+
+size_t consultar_agregados(const std::string& dir_agregados, const std::string& nivel, int64_t t0, int64_t t1,
+                           int truck_id, const std::function<bool(int64_t, int, const Agregado&)>& fn)
+{
+    MapaAgregados m;
+    std::error_code ec;
+    for (const auto& ent : fs::directory_iterator(dir_agregados + "/" + nivel, ec)) {
+        const std::string nome = ent.path().stem().string();
+        const size_t sep = nome.find('_');
+        if (ent.path().extension() != ".csv" || sep == std::string::npos) continue;
+        int64_t a = 0, b = 0;
+        try {
+            a = std::stoll(nome.substr(0, sep));
+            b = std::stoll(nome.substr(sep + 1));
+        } catch (...) { continue; }
+        if (b < t0 || a > t1 + FOLGA_CONSULTA_MS) continue;
+
+        std::ifstream fin(ent.path());
+        std::string linha;
+        int64_t balde;
+        int truck;
+        Agregado ag;
+        while (std::getline(fin, linha)) {
+            if (!ler_agregado(linha, balde, truck, ag)) continue;
+            if (balde < t0 || balde > t1 || (truck_id >= 0 && truck != truck_id)) continue;
+            m[{balde, truck}].combinar(ag);
+        }
+    }
+    size_t n = 0;
+    for (const auto& [k, a] : m) {
+        ++n;
+        if (!fn(k.first, k.second, a)) break;
+    }
+    return n;
+}
+
+int executar_compactacao(const ConfigCompactacao& cfg, std::atomic<bool>& stop_flag)
+{
+    const char* politicas[] = {"apagar", "arquivar", "manter"};
+    std::cout << "[Compactacao] " << cfg.csv << ": idade " << cfg.idade_ms / 3600000.0 << " h, bruto="
+              << politicas[static_cast<int>(cfg.bruto)] << ", agregados em " << cfg.dir_agregados << "\n";
+    while (!stop_flag.load()) {
+        auto inicio = std::chrono::steady_clock::now();
+        ResultadoCompactacao r = compactar_log(cfg, &stop_flag);
+        if (r.janelas > 0) {
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          std::chrono::steady_clock::now() - inicio).count();
+            std::cout << "[Compactacao] " << r.janelas << " janela(s) até " << r.horizonte_ms << ": "
+                      << r.linhas << " linhas -> " << r.baldes_1s << " baldes de 1 s, " << r.baldes_1min
+                      << " de 1 min; " << r.bytes_liberados / 1024 << " KiB liberados em " << ms << " ms\n";
+        }
+        if (cfg.uma_vez) break;
+        for (auto s = std::chrono::seconds(0); s < cfg.periodo && !stop_flag.load(); s += std::chrono::seconds(1))
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+    return 0;
+}
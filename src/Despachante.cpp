@@ -0,0 +1,266 @@
+/*
+ * Arquivo: Despachante.cpp
+ * Finalidade:
+ * Implementação do serviço de despacho definido em "Despachante.h".
+ *
+ * Detalhes:
+ * - Linhas da matriz = caminhões com posição conhecida (ordem crescente de
+ * id); colunas = tarefas abertas (ordem de chegada).
+ * - Conclusão de tarefa usa AtribuicaoHungara::remover_tarefa() quando a
+ * matriz ainda corresponde às posições atuais (cada caminhão a no máximo
+ * DESLOCAMENTO_REOTIMIZAR da posição da matriz); caso contrário, refaz a
+ * solução completa. As posições chegam a cada ~100 ms: invalidar a cada
+ * atualização faria o caminho incremental nunca rodar.
+ * - Só os caminhões cuja tarefa mudou recebem uma rota nova, evitando
+ * reiniciar a navegação de quem já está a caminho.
+ */
+
+#include "Despachante.h"
+#include "ChaveValor.h"
+#include "MalhaViaria.h"
+#include "ReconstrucaoPosicao.h"
+#include "Relogio.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+const std::string TOPICO_TAREFAS = "/mina/despacho/tarefas";
+const std::string TOPICO_ATRIBUICAO = "/mina/despacho/atribuicao";
+const std::string TOPICO_CONCLUIDAS = "/mina/despacho/concluidas";
+
+double custo_padrao(double x0, double y0, double x1, double y1)
+{
+    return std::hypot(x1 - x0, y1 - y0) / Despachante::VELOCIDADE_PADRAO;
+}
+
+} // namespace
+
+Despachante::Despachante(FuncaoCusto custo)
+    : custo_(custo ? std::move(custo) : FuncaoCusto(custo_padrao))
+{
+}
+
+void Despachante::atualizar_posicao(int truck_id, double x, double y)
+{
+    posicoes_[truck_id] = {x, y};
+    auto it = pos_matriz_.find(truck_id);
+    if (it == pos_matriz_.end()
+        || std::hypot(x - it->second.first, y - it->second.second) > DESLOCAMENTO_REOTIMIZAR) {
+        matriz_valida_ = false;
+    }
+}
+
+void Despachante::adicionar_tarefa(const TarefaDespacho& t)
+{
+    for (auto& e : tarefas_) {
+        if (e.id == t.id) { e = t; matriz_valida_ = false; return; }
+    }
+    tarefas_.push_back(t);
+    matriz_valida_ = false;
+}
+
+void Despachante::montar_matriz()
+{
+    caminhoes_.clear();
+    for (const auto& p : posicoes_) caminhoes_.push_back(p.first);
+    const int n = static_cast<int>(caminhoes_.size());
+    const int m = static_cast<int>(tarefas_.size());
+    std::vector<double> custo(static_cast<size_t>(n) * m);
+    for (int i = 0; i < n; ++i) {
+        const auto& pos = posicoes_[caminhoes_[i]];
+        for (int j = 0; j < m; ++j) {
+            double c = custo_(pos.first, pos.second, tarefas_[j].x, tarefas_[j].y);
+            custo[static_cast<size_t>(i) * m + j] = std::isfinite(c) ? c : AtribuicaoHungara::PROIBIDO;
+        }
+    }
+    solver_.definir_custos(n, m, custo);
+    pos_matriz_ = posicoes_;
+    matriz_valida_ = true;
+}
+
+std::vector<int> Despachante::aplicar_resultado()
+{
+    std::vector<int> mudaram;
+    std::map<int, int> novo;
+    for (int i = 0; i < static_cast<int>(caminhoes_.size()); ++i) {
+        int j = solver_.tarefa_de(i);
+        // pares proibidos contam como ociosos
+        bool valido = j >= 0 && j < static_cast<int>(tarefas_.size()) &&
+                      custo_(posicoes_[caminhoes_[i]].first, posicoes_[caminhoes_[i]].second,
+                             tarefas_[j].x, tarefas_[j].y) < AtribuicaoHungara::PROIBIDO;
+        novo[caminhoes_[i]] = valido ? tarefas_[j].id : -1;
+    }
+    for (const auto& [truck, tarefa] : novo) {
+        auto it = atual_.find(truck);
+        int antes = it == atual_.end() ? -1 : it->second;
+        if (antes != tarefa) mudaram.push_back(truck);
+    }
+    atual_.swap(novo);
+    return mudaram;
+}
+
+std::vector<int> Despachante::reotimizar()
+{
+    const int64_t t0 = Relogio::mono_ns();
+    montar_matriz();
+    solver_.resolver();
+    ultimo_ms_ = static_cast<double>(Relogio::mono_ns() - t0) / 1e6;
+    return aplicar_resultado();
+}
+
+std::vector<int> Despachante::concluir_tarefa(int tarefa_id)
+{
+    auto it = std::find_if(tarefas_.begin(), tarefas_.end(),
+                           [&](const TarefaDespacho& t) { return t.id == tarefa_id; });
+    if (it == tarefas_.end()) return {};
+    int j = static_cast<int>(it - tarefas_.begin());
+
+    if (!matriz_valida_) {
+        tarefas_.erase(it);
+        return reotimizar();
+    }
+    const int64_t t0 = Relogio::mono_ns();
+    tarefas_.erase(it);
+    solver_.remover_tarefa(j);
+    ultimo_ms_ = static_cast<double>(Relogio::mono_ns() - t0) / 1e6;
+    return aplicar_resultado();
+}
+
+int Despachante::tarefa_do_caminhao(int truck_id) const
+{
+    auto it = atual_.find(truck_id);
+    return it == atual_.end() ? -1 : it->second;
+}
+
+std::vector<std::pair<int, int>> Despachante::chegadas(double raio) const
+{
+    std::vector<std::pair<int, int>> out;
+    for (const auto& [truck, tarefa] : atual_) {
+        if (tarefa < 0) continue;
+        auto pos = posicoes_.find(truck);
+        if (pos == posicoes_.end()) continue;
+        for (const auto& t : tarefas_) {
+            if (t.id == tarefa && std::hypot(t.x - pos->second.first, t.y - pos->second.second) <= raio)
+                out.emplace_back(truck, tarefa);
+        }
+    }
+    return out;
+}
+
+Route Despachante::rota_para(int truck_id) const
+{
+    Route r;
+    int tarefa = tarefa_do_caminhao(truck_id);
+    auto pos = posicoes_.find(truck_id);
+    if (tarefa < 0 || pos == posicoes_.end()) return r;
+    for (const auto& t : tarefas_) {
+        if (t.id != tarefa) continue;
+        r.addWaypoint(Waypoint(pos->second.first, pos->second.second));
+        r.addWaypoint(Waypoint(t.x, t.y));
+        break;
+    }
+    return r;
+}
+
+std::string Despachante::resumo() const
+{
+    std::ostringstream ss;
+    ss << "tarefas=" << tarefas_.size() << ",tempo_ms=" << ultimo_ms_ << ",atrib=";
+    bool primeiro = true;
+    for (const auto& [truck, tarefa] : atual_) {
+        if (tarefa < 0) continue;
+        ss << (primeiro ? "" : " ") << truck << ":" << tarefa;
+        primeiro = false;
+    }
+    return ss.str();
+}
+
+int executar_despachante(const std::vector<int>& caminhoes, MqttClient& mqtt, std::atomic<bool>& stop_flag,
+                         const std::string& caminho_malha)
+{
+    const double RAIO_CHEGADA = 12.0; // mesmo raio do gerenciador de rota
+    std::cout << "[Despachante] atendendo " << caminhoes.size() << " caminhões\n";
+    mqtt.subscribe_topic(TOPICO_TAREFAS);
+    for (int id : caminhoes) mqtt.subscribe_topic("/mina/caminhoes/" + std::to_string(id) + "/posicao");
+
+    MalhaViaria malha;
+    const bool usar_malha = !caminho_malha.empty() && malha.loadFromFile(caminho_malha) && !malha.nos().empty();
+    if (usar_malha) {
+        std::cout << "[Despachante] malha " << caminho_malha << ": " << malha.nos().size() << " nós, "
+                  << malha.vias().size() << " vias, " << malha.atalhos() << " atalhos\n";
+    } else if (!caminho_malha.empty()) {
+        std::cerr << "[Despachante] malha indisponível; usando linha reta\n";
+    }
+    Despachante desp(usar_malha ? Despachante::FuncaoCusto([&malha](double x0, double y0, double x1, double y1) {
+                                      return malha.custo(x0, y0, x1, y1);
+                                  })
+                                : Despachante::FuncaoCusto());
+    std::map<int, ReconstrutorPosicao> posicoes;
+    constexpr uint64_t PERIODO_REOTIMIZAR_MS = 2000;
+    uint64_t prox_periodica = Relogio::mono_ms() + PERIODO_REOTIMIZAR_MS;
+
+    auto emitir = [&](const std::vector<int>& mudaram) {
+        for (int truck : mudaram) {
+            Route r = desp.rota_para(truck);
+            if (r.size() == 0) continue; // ocioso: mantém a rota atual
+            if (usar_malha) {
+                Route pela_malha = malha.rota_entre(r[0].x, r[0].y, r[1].x, r[1].y);
+                if (pela_malha.size() > 0) r = pela_malha;
+            }
+            mqtt.publish("/mina/caminhoes/" + std::to_string(truck) + "/route", texto_rota(r));
+        }
+        mqtt.publish(TOPICO_ATRIBUICAO, desp.resumo(), true);
+    };
+
+    while (!stop_flag.load()) {
+        bool tarefa_nova = false;
+        std::vector<int> concluidas;
+
+        while (auto m = mqtt.try_pop_message(TOPICO_TAREFAS)) {
+            try {
+                int id = std::stoi(valor_chave(*m, "id"));
+                if (valor_chave(*m, "concluida") == "1") {
+                    concluidas.push_back(id);
+                } else {
+                    desp.adicionar_tarefa({id, std::stod(valor_chave(*m, "x")), std::stod(valor_chave(*m, "y"))});
+                    tarefa_nova = true;
+                }
+            } catch (...) {
+                std::cerr << "[Despachante] tarefa inválida: '" << *m << "'\n";
+            }
+        }
+        // /posicao é suprimida em trechos previsíveis: a posição usada na
+        // matriz e nas chegadas é a extrapolada até agora, não a última recebida
+        const uint64_t agora_ms = Relogio::mono_ms();
+        for (int id : caminhoes) {
+            ReconstrutorPosicao& rec = posicoes[id];
+            while (auto m = mqtt.try_pop_message("/mina/caminhoes/" + std::to_string(id) + "/posicao"))
+                rec.atualizar(*m, agora_ms);
+            if (rec.valido()) {
+                const EstadoPosicao p = rec.em(agora_ms);
+                desp.atualizar_posicao(id, p.x, p.y);
+            }
+        }
+
+        // chegadas concluem a tarefa automaticamente
+        for (const auto& [truck, tarefa] : desp.chegadas(RAIO_CHEGADA)) {
+            mqtt.publish(TOPICO_CONCLUIDAS, "id=" + std::to_string(tarefa) + ",caminhao=" + std::to_string(truck));
+            concluidas.push_back(tarefa);
+        }
+
+        if (tarefa_nova || agora_ms >= prox_periodica) {
+            emitir(desp.reotimizar());
+            prox_periodica = agora_ms + PERIODO_REOTIMIZAR_MS;
+        }
+        for (int id : concluidas) emitir(desp.concluir_tarefa(id));
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    return 0;
+}
@@ -0,0 +1,80 @@
+/*
+ * Arquivo: EstadoSnapshot.cpp
+ * Finalidade:
+ * Implementação do snapshot e das regras de mudança declarados em
+ * "EstadoSnapshot.h".
+ */
+
+#include "EstadoSnapshot.h"
+#include "JsonSimples.h"
+
+#include <sstream>
+
+std::string SnapshotCaminhao::serializar() const
+{
+    std::ostringstream ss;
+    ss << "{"
+       << "\"automatico\":" << (automatico ? 1 : 0) << ","
+       << "\"defeito\":" << (defeito ? 1 : 0) << ","
+       << "\"alerta_temp\":" << (alerta_temp ? 1 : 0) << ","
+       << "\"rota_versao\":" << rota_versao << ","
+       << "\"waypoints\":" << waypoints << ","
+       << "\"waypoint\":" << waypoint << ","
+       << "\"ultima_falha\":\"" << json_escapar(ultima_falha) << "\","
+       << "\"falha_ts\":" << falha_ts
+       << "}";
+    return ss.str();
+}
+
+std::string topico_snapshot(int truck_id)
+{
+    return "/mina/caminhoes/" + std::to_string(truck_id) + "/snapshot";
+}
+
+std::string topico_rota_atual(int truck_id)
+{
+    return "/mina/caminhoes/" + std::to_string(truck_id) + "/rota_atual";
+}
+
+void EstadoSnapshot::estado(bool automatico, bool defeito, bool alerta_temp)
+{
+    atual_.automatico = automatico;
+    atual_.defeito = defeito;
+    atual_.alerta_temp = alerta_temp;
+}
+
+bool EstadoSnapshot::rota(const Route& r)
+{
+    std::string texto = texto_rota(r);
+    if (texto == rota_texto_) return false;
+    rota_texto_ = std::move(texto);
+    atual_.rota_versao += 1;
+    atual_.waypoints = r.size();
+    atual_.waypoint = 0;
+    return true;
+}
+
+void EstadoSnapshot::waypoint(size_t idx)
+{
+    atual_.waypoint = idx;
+}
+
+void EstadoSnapshot::falhas(const std::string& descricao, uint64_t ts)
+{
+    if (descricao == falha_ativa_) return;
+    falha_ativa_ = descricao;
+    if (descricao.empty()) return; // falha encerrada: ultima_falha permanece
+    atual_.ultima_falha = descricao;
+    atual_.falha_ts = ts;
+}
+
+bool EstadoSnapshot::pendente() const
+{
+    return !algum_publicado_ || !(atual_ == publicado_);
+}
+
+void EstadoSnapshot::marcar_publicado()
+{
+    publicado_ = atual_;
+    algum_publicado_ = true;
+}
@@ -0,0 +1,138 @@
+/*
+ * Arquivo: Executor.cpp
+ * Finalidade:
+ * Implementação do executor de corrotinas declarado em "Executor.h".
+ *
+ * Laço de cada thread de trabalho:
+ * 1. Retoma uma corrotina pronta (fora do lock).
+ * 2. Sem trabalho: dorme na variável de condição até ser notificada; threads
+ * ociosas não acordam periodicamente.
+ * Corrotinas retomadas por outras threads (reator, callback MQTT, produtor de
+ * buffer) apenas entram na fila de prontas; nunca rodam na thread que as
+ * acordou.
+ */
+
+#include "Executor.h"
+
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+thread_local Executor* t_executor = nullptr;
+
+} // namespace
+
+// ---------------- EsperaAssincrona / Tarefa ----------------
+
+void EsperaAssincrona::retomar()
+{
+    ex->agendar(h);
+}
+
+void Tarefa::promise_type::unhandled_exception()
+{
+    try {
+        throw;
+    } catch (const std::exception& e) {
+        std::cerr << "[Executor] tarefa encerrada por exceção: " << e.what() << "\n";
+    } catch (...) {
+        std::cerr << "[Executor] tarefa encerrada por exceção desconhecida\n";
+    }
+}
+
+Tarefa::promise_type::~promise_type()
+{
+    if (ex) ex->tarefa_encerrada();
+}
+
+// ---------------- Executor ----------------
+
+Executor::Executor(Reator& reator, int n_threads, const char* nome)
+    : reator_(reator)
+{
+    nomear_lock(mtx_, nome);
+    if (n_threads < 1) n_threads = 1;
+    for (int i = 0; i < n_threads; ++i) threads_.emplace_back(&Executor::trabalhar, this);
+}
+
+Executor::~Executor()
+{
+    {
+        std::lock_guard<MutexAtr> lk(mtx_);
+        parar_ = true;
+    }
+    cv_.notify_all();
+    for (auto& t : threads_) {
+        if (t.joinable()) t.join();
+    }
+}
+
+Executor* Executor::atual()
+{
+    return t_executor;
+}
+
+void Executor::gerar(Tarefa t)
+{
+    auto h = t.liberar();
+    if (!h) return;
+    h.promise().ex = this;
+    vivas_.fetch_add(1);
+    agendar(h);
+}
+
+void Executor::agendar(std::coroutine_handle<> h)
+{
+    // Notifica sob o lock: a corrotina agendada pode ser a última e, ao
+    // terminar, liberar o destrutor do Executor enquanto a thread do reator
+    // ainda estaria dentro de notify_one().
+    std::lock_guard<MutexAtr> lk(mtx_);
+    prontas_.push_back(h);
+    cv_.notify_one();
+}
+
+void Executor::agendar_em(Relogio::time_point quando, std::function<void()> fn)
+{
+    reator_.agendar_em(quando, std::move(fn));
+}
+
+void Executor::aguardar()
+{
+    std::unique_lock<MutexAtr> lk(mtx_);
+    cv_fim_.wait(lk, [this] { return vivas_.load() == 0; });
+}
+
+void Executor::tarefa_encerrada()
+{
+    if (vivas_.fetch_sub(1) == 1) {
+        std::lock_guard<MutexAtr> lk(mtx_);
+        cv_fim_.notify_all();
+    }
+}
+
+void Executor::AguardaTempo::await_suspend(std::coroutine_handle<> h)
+{
+    Executor* ex = Executor::atual();
+    if (!ex) throw std::logic_error("Executor::after fora de um executor");
+    ex->agendar_em(Relogio::now() + d, [ex, h] { ex->agendar(h); });
+}
+
+void Executor::trabalhar()
+{
+    t_executor = this;
+    std::unique_lock<MutexAtr> lk(mtx_);
+    while (true) {
+        if (!prontas_.empty()) {
+            std::coroutine_handle<> h = prontas_.front();
+            prontas_.pop_front();
+            lk.unlock();
+            h.resume();
+            lk.lock();
+            continue;
+        }
+        if (parar_) break;
+        cv_.wait(lk);
+    }
+    t_executor = nullptr;
+}
@@ -0,0 +1,288 @@
+/*
+ * Arquivo: HostFrota.cpp
+ * Finalidade:
+ * Implementação do modo host de frota definido em "HostFrota.h".
+ *
+ * Laço principal (a cada 200 ms):
+ * 1. Consome mensagens de /mina/frota/membros e atualiza o instante do último
+ * heartbeat de cada host; remove hosts que saíram ou expiraram.
+ * 2. Publica o próprio heartbeat quando chega a hora.
+ * 3. Atualiza o anel com a lista de membros (incluindo este host) e calcula o
+ * conjunto desejado de caminhões.
+ * 4. Para os filhos de caminhões que deixaram de ser deste host e inicia os
+ * que passaram a ser, assim que o dono anterior os libera (HostFrota.h).
+ * 5. Recolhe filhos encerrados (waitpid não bloqueante) e reinicia caminhões
+ * que ainda deveriam estar rodando.
+ * 6. Republica a lista retida quando o conjunto de caminhões detidos muda.
+ *
+ * A comparação do checkpoint com o instante da mudança do anel usa o relógio
+ * de parede (Relogio.h) dos dois hosts: depende do NTP, com a folga de
+ * carencia_ms; o timer limite_ms cobre o resto.
+ */
+
+#include "HostFrota.h"
+#include "AnelConsistente.h"
+#include "ChaveValor.h"
+#include "Checkpoint.h"
+#include "Relogio.h"
+
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const std::string TOPICO_MEMBROS = "/mina/frota/membros";
+const std::string FILTRO_LISTAS = "/mina/frota/+/caminhoes";
+const std::string FILTRO_CHECKPOINTS = "/mina/caminhoes/+/checkpoint";
+
+// Processo filho de um caminhão.
+struct Filho
+{
+    pid_t pid = -1;
+    bool parando = false;            // SIGINT já enviado
+    Clock::time_point parada_em{};   // instante do SIGINT
+};
+
+// Caminhão atribuído a este host, aguardando a liberação do dono anterior.
+struct Pendente
+{
+    int64_t mudanca_unix_ms = 0;     // instante da atribuição (relógio de parede)
+    Clock::time_point nao_antes{};   // fim da carência
+    Clock::time_point limite{};      // inicia mesmo sem liberação
+};
+
+// Segmento 'nivel' do tópico (0 = "mina"): host em /mina/frota/<host>/...,
+// truck id em /mina/caminhoes/<id>/...
+std::string segmento(const std::string& topico, int nivel)
+{
+    size_t ini = 0;
+    for (int i = 0; i <= nivel; ++i) {
+        ini = topico.find('/', ini);
+        if (ini == std::string::npos) return std::string();
+        ++ini;
+    }
+    return topico.substr(ini, topico.find('/', ini) - ini);
+}
+
+pid_t iniciar_filho(const ConfigHostFrota& cfg, int truck_id)
+{
+    std::string a_id = "--truck-id=" + std::to_string(truck_id);
+    auto rota = cfg.rotas.find(truck_id);
+    const std::string& route = rota != cfg.rotas.end() ? rota->second : cfg.route;
+    std::string a_route = "--route=" + route;
+    std::string a_warm = "--warm-start";
+
+    pid_t pid = ::fork();
+    if (pid == 0) {
+        // A máscara de sinais é herdada pelo execv: desbloqueia SIGINT/SIGTERM
+        // (o pai os bloqueia para recebê-los pelo signalfd do reator).
+        sigset_t mask;
+        sigemptyset(&mask);
+        sigaddset(&mask, SIGINT);
+        sigaddset(&mask, SIGTERM);
+        ::sigprocmask(SIG_UNBLOCK, &mask, nullptr);
+        std::vector<char*> argv;
+        argv.push_back(const_cast<char*>(cfg.executavel.c_str()));
+        argv.push_back(const_cast<char*>(a_id.c_str()));
+        if (!route.empty()) argv.push_back(const_cast<char*>(a_route.c_str()));
+        argv.push_back(const_cast<char*>(a_warm.c_str()));
+        argv.push_back(nullptr);
+        ::execv(cfg.executavel.c_str(), argv.data());
+        _exit(127); // execv falhou
+    }
+    return pid;
+}
+
+} // namespace
+
+int executar_host_frota(const ConfigHostFrota& cfg, MqttClient& mqtt, std::atomic<bool>& stop_flag)
+{
+    std::cout << "[HostFrota] host '" << cfg.host_id << "' com " << cfg.caminhoes.size()
+              << " caminhões candidatos\n";
+    mqtt.subscribe_topic(TOPICO_MEMBROS);
+    mqtt.subscribe_topic(FILTRO_LISTAS);
+    mqtt.subscribe_topic(FILTRO_CHECKPOINTS);
+
+    AnelConsistente anel;
+    std::map<std::string, Clock::time_point> membros; // host -> último heartbeat
+    std::map<int, Filho> filhos;                       // truck id -> processo
+    std::map<int, Pendente> pendentes;                 // truck id -> espera da liberação
+    std::map<std::string, std::set<int>> detidos;      // host -> caminhões na lista retida
+    std::map<int, int64_t> checkpoint_em;              // truck id -> t do último checkpoint
+    std::set<int> desejados;
+    std::set<int> publicados;
+    bool publicou = false;
+    Clock::time_point prox_heartbeat{};
+
+    // Caminhões detidos: atribuídos ou com filho ainda rodando.
+    auto publica_lista = [&]() {
+        std::set<int> meus = desejados;
+        for (const auto& f : filhos) meus.insert(f.first);
+        if (publicou && meus == publicados) return;
+        std::ostringstream ss;
+        ss << "host=" << cfg.host_id << ",caminhoes=";
+        bool primeiro = true;
+        for (int id : meus) { ss << (primeiro ? "" : " ") << id; primeiro = false; }
+        mqtt.publish("/mina/frota/" + cfg.host_id + "/caminhoes", ss.str(), true);
+        publicados.swap(meus);
+        publicou = true;
+    };
+    auto pendente = [&](int id, Clock::time_point agora) {
+        Pendente p;
+        p.mudanca_unix_ms = Relogio::unix_ms();
+        p.nao_antes = agora + std::chrono::milliseconds(cfg.carencia_ms);
+        p.limite = agora + std::chrono::milliseconds(cfg.limite_ms);
+        pendentes[id] = p;
+    };
+    auto detido_por_outro = [&](int id) {
+        for (const auto& [h, ids] : detidos) {
+            if (h != cfg.host_id && ids.count(id)) return true;
+        }
+        return false;
+    };
+
+    while (!stop_flag.load()) {
+        auto agora = Clock::now();
+
+        // 1) membros
+        while (auto m = mqtt.try_pop_message(TOPICO_MEMBROS)) {
+            std::string h = valor_chave(*m, "host");
+            if (h.empty() || h == cfg.host_id) continue;
+            if (valor_chave(*m, "saiu") == "1") membros.erase(h);
+            else membros[h] = agora;
+        }
+        for (auto& [topico, pl] : mqtt.drenar_filtro(FILTRO_LISTAS)) {
+            std::set<int> ids;
+            std::istringstream iss(valor_chave(pl, "caminhoes"));
+            int id;
+            while (iss >> id) ids.insert(id);
+            detidos[segmento(topico, 2)].swap(ids);
+        }
+        for (auto& [topico, pl] : mqtt.drenar_filtro(FILTRO_CHECKPOINTS)) {
+            CheckpointCaminhao ck;
+            try {
+                if (CheckpointCaminhao::desserializar(pl, ck)) checkpoint_em[std::stoi(segmento(topico, 2))] = ck.t_ms;
+            } catch (...) { }
+        }
+        for (auto it = membros.begin(); it != membros.end();) {
+            if (agora - it->second > std::chrono::milliseconds(cfg.expira_ms)) {
+                std::cerr << "[HostFrota] membro expirou: " << it->first << "\n";
+                it = membros.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        // 2) heartbeat
+        if (agora >= prox_heartbeat) {
+            mqtt.publish(TOPICO_MEMBROS, "host=" + cfg.host_id);
+            prox_heartbeat = agora + std::chrono::milliseconds(cfg.heartbeat_ms);
+        }
+
+        // 3) anel e caminhões desejados
+        std::set<std::string> hosts{cfg.host_id};
+        for (const auto& m : membros) hosts.insert(m.first);
+        if (hosts != anel.hosts()) {
+            anel.definir_hosts(hosts);
+            auto meus = anel.caminhoes_de(cfg.host_id, cfg.caminhoes);
+            std::set<int> novos(meus.begin(), meus.end());
+            std::cout << "[HostFrota] membros=" << hosts.size() << ", caminhões deste host: "
+                      << novos.size() << "\n";
+            for (int id : novos) {
+                if (!desejados.count(id) && !filhos.count(id)) pendente(id, agora);
+            }
+            for (int id : desejados) {
+                if (!novos.count(id)) pendentes.erase(id);
+            }
+            desejados.swap(novos);
+        }
+
+        // 4a) para filhos que não pertencem mais a este host
+        for (auto& [id, f] : filhos) {
+            if (!desejados.count(id) && !f.parando) {
+                std::cout << "[HostFrota] liberando caminhão " << id << " (pid " << f.pid << ")\n";
+                ::kill(f.pid, SIGINT); // o filho publica o checkpoint ao encerrar
+                f.parando = true;
+                f.parada_em = agora;
+            } else if (f.parando && agora - f.parada_em > std::chrono::seconds(10)) {
+                ::kill(f.pid, SIGKILL); // não encerrou a tempo
+            }
+        }
+
+        // 4b) inicia os recém-atribuídos liberados pelo dono anterior
+        for (auto it = pendentes.begin(); it != pendentes.end();) {
+            const int id = it->first;
+            const Pendente& p = it->second;
+            const char* motivo = nullptr;
+            if (!filhos.count(id) && agora >= p.nao_antes) {
+                if (!detido_por_outro(id)) motivo = "liberado";
+                else if (checkpoint_em.count(id) && checkpoint_em[id] >= p.mudanca_unix_ms) motivo = "checkpoint";
+                else if (agora >= p.limite) motivo = "sem liberação no limite";
+            }
+            if (motivo) {
+                pid_t pid = iniciar_filho(cfg, it->first);
+                if (pid > 0) {
+                    std::cout << "[HostFrota] assumindo caminhão " << it->first << " (" << motivo
+                              << ", pid " << pid << ")\n";
+                    filhos[it->first].pid = pid;
+                } else {
+                    std::cerr << "[HostFrota] fork falhou para o caminhão " << it->first << "\n";
+                }
+                it = pendentes.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        // 5) recolhe filhos encerrados
+        for (auto it = filhos.begin(); it != filhos.end();) {
+            int status = 0;
+            pid_t r = ::waitpid(it->second.pid, &status, WNOHANG);
+            if (r == it->second.pid) {
+                int id = it->first;
+                it = filhos.erase(it);
+                if (desejados.count(id)) {
+                    std::cerr << "[HostFrota] caminhão " << id << " encerrou inesperadamente; reiniciando\n";
+                    pendente(id, agora);
+                }
+            } else {
+                ++it;
+            }
+        }
+
+        // 6) lista retida (um caminhão perdido só sai dela quando o filho termina)
+        publica_lista();
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    // Encerramento: para todos os filhos (cada um publica seu checkpoint) e sai da frota.
+    std::cout << "[HostFrota] encerrando " << filhos.size() << " caminhão(ões)\n";
+    for (auto& [id, f] : filhos) {
+        if (!f.parando) ::kill(f.pid, SIGINT);
+    }
+    auto limite = Clock::now() + std::chrono::seconds(10);
+    for (auto& [id, f] : filhos) {
+        int status = 0;
+        while (::waitpid(f.pid, &status, WNOHANG) == 0) {
+            if (Clock::now() > limite) { ::kill(f.pid, SIGKILL); ::waitpid(f.pid, &status, 0); break; }
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }
+    mqtt.publish(TOPICO_MEMBROS, "host=" + cfg.host_id + ",saiu=1");
+    desejados.clear();
+    filhos.clear();
+    publica_lista();
+    return 0;
+}
@@ -0,0 +1,132 @@
+/*
+ * Arquivo: Hungaro.cpp
+ * Finalidade:
+ * Implementação do método húngaro com potenciais declarado em "Hungaro.h".
+ *
+ * Algoritmo (por linha, como um Dijkstra sobre custos reduzidos):
+ * - Cada linha livre é inserida a partir da coluna auxiliar 0. A cada passo
+ * escolhe-se a coluna não visitada de menor custo reduzido (minv), ajustam-se
+ * os potenciais pelo mínimo encontrado e segue-se até uma coluna livre.
+ * - O caminho é então invertido (aumentado), atribuindo a linha nova.
+ * - Invariantes: custo reduzido c(i,j) - u[i] - v[j] >= 0 para todo par, e
+ * igual a zero nos pares atribuídos; colunas livres mantêm v = 0. Essas
+ * invariantes são o que permite a reotimização incremental em
+ * remover_tarefa().
+ */
+
+#include "Hungaro.h"
+
+#include <limits>
+#include <stdexcept>
+
+namespace {
+constexpr double INF = std::numeric_limits<double>::infinity();
+}
+
+void AtribuicaoHungara::definir_custos(int n_caminhoes, int n_tarefas, const std::vector<double>& custo)
+{
+    if (n_caminhoes < 0 || n_tarefas < 0 || custo.size() != size_t(n_caminhoes) * size_t(n_tarefas))
+        throw std::invalid_argument("AtribuicaoHungara: dimensões inválidas");
+    n_ = n_caminhoes;
+    m_ = n_tarefas;
+    cols_ = std::max(n_, m_);
+    custo_ = custo;
+    u_.assign(n_ + 1, 0.0);
+    v_.assign(cols_ + 1, 0.0);
+    p_.assign(cols_ + 1, 0);
+    atrib_.assign(n_, -1);
+}
+
+double AtribuicaoHungara::c(int i, int j) const
+{
+    // Colunas além de m_ são fictícias: caminhão ocioso com custo zero.
+    return j <= m_ ? custo_[size_t(i - 1) * m_ + (j - 1)] : 0.0;
+}
+
+void AtribuicaoHungara::aumentar(int linha)
+{
+    std::vector<double> minv(cols_ + 1, INF);
+    std::vector<int> way(cols_ + 1, 0);
+    std::vector<char> usado(cols_ + 1, 0);
+
+    p_[0] = linha;
+    int j0 = 0;
+    do {
+        usado[j0] = 1;
+        int i0 = p_[j0];
+        double delta = INF;
+        int j1 = 0;
+        for (int j = 1; j <= cols_; ++j) {
+            if (usado[j]) continue;
+            double cur = c(i0, j) - u_[i0] - v_[j];
+            if (cur < minv[j]) { minv[j] = cur; way[j] = j0; }
+            if (minv[j] < delta) { delta = minv[j]; j1 = j; }
+        }
+        for (int j = 0; j <= cols_; ++j) {
+            if (usado[j]) { u_[p_[j]] += delta; v_[j] -= delta; }
+            else minv[j] -= delta;
+        }
+        j0 = j1;
+    } while (p_[j0] != 0);
+
+    // Inverte o caminho aumentante
+    do {
+        int j1 = way[j0];
+        p_[j0] = p_[j1];
+        j0 = j1;
+    } while (j0 != 0);
+}
+
+double AtribuicaoHungara::finalizar()
+{
+    atrib_.assign(n_, -1);
+    double total = 0.0;
+    for (int j = 1; j <= cols_; ++j) {
+        int i = p_[j];
+        if (i == 0 || j > m_) continue; // livre ou fictícia
+        atrib_[i - 1] = j - 1;
+        total += c(i, j);
+    }
+    return total;
+}
+
+double AtribuicaoHungara::resolver()
+{
+    u_.assign(n_ + 1, 0.0);
+    v_.assign(cols_ + 1, 0.0);
+    p_.assign(cols_ + 1, 0);
+    for (int i = 1; i <= n_; ++i) aumentar(i);
+    return finalizar();
+}
+
+double AtribuicaoHungara::remover_tarefa(int j)
+{
+    if (j < 0 || j >= m_) throw std::out_of_range("AtribuicaoHungara: tarefa inexistente");
+    const int col = j + 1;
+    const int liberada = p_[col];
+
+    // Remove a coluna da matriz de custos.
+    std::vector<double> novo;
+    novo.reserve(size_t(n_) * (m_ - 1));
+    for (int i = 0; i < n_; ++i)
+        for (int k = 0; k < m_; ++k)
+            if (k != j) novo.push_back(custo_[size_t(i) * m_ + k]);
+    custo_.swap(novo);
+    --m_;
+
+    // Se passar a haver mais caminhões que tarefas, surge uma coluna fictícia
+    // nova (custo 0) que violaria u[i] + v[j] <= c(i,j): resolve do zero.
+    if (n_ > m_) {
+        cols_ = std::max(n_, m_);
+        return resolver();
+    }
+
+    // Remove a coluna dos potenciais/atribuição preservando as demais.
+    v_.erase(v_.begin() + col);
+    p_.erase(p_.begin() + col);
+    cols_ = m_;
+
+    // Só o caminhão que atendia a tarefa removida precisa ser reinserido.
+    if (liberada != 0) aumentar(liberada);
+    return finalizar();
+}
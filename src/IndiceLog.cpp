@@ -0,0 +1,375 @@
+/*
+ * Arquivo: IndiceLog.cpp
+ * Finalidade:
+ * Implementação do índice esparso do log CSV declarado em "IndiceLog.h".
+ *
+ * Detalhes:
+ * - O escritor segura um flock() exclusivo no índice apenas durante a
+ * validação/reconstrução na abertura, para que caminhões iniciados ao mesmo
+ * tempo (modo host de frota) não reconstruam o mesmo arquivo em paralelo.
+ * - Cada append de entrada segura um flock() compartilhado: escritores não
+ * se bloqueiam entre si, mas esperam uma reconstrução em curso (que trunca e
+ * reescreve o arquivo) em vez de perder a entrada ou intercalá-la.
+ * - A validação confere a última entrada: o offset dela tem de estar dentro
+ * do CSV e a linha nesse offset tem de ter o mesmo timestamp e caminhão.
+ * - Trecho descartado pela compactação: a reconstrução começa em
+ * inicio_dados_log() e o leitor ignora entradas anteriores a ele (as do
+ * trecho liberado do índice são lidas como zeros).
+ * - O leitor, ao posicionar num offset, confere que ele é início de linha;
+ * se não for, avança até a próxima linha. As consultas leem o CSV com o
+ * LeitorSequencial (IoLog.h), que mantém vários blocos lidos à frente.
+ */
+
+#include "IndiceLog.h"
+#include "IoLog.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Decide, linha a linha, quando gravar uma entrada (mesma regra no escritor
+// e na reconstrução).
+struct ContadorIndice
+{
+    uint64_t linhas = 0;
+    uint64_t bytes_desde_ultima = 0;
+
+    bool proxima(uint64_t tamanho, uint32_t passo, uint64_t bloco)
+    {
+        bool indexa = (linhas % passo) == 0 || bytes_desde_ultima >= bloco;
+        ++linhas;
+        if (indexa) bytes_desde_ultima = 0;
+        bytes_desde_ultima += tamanho;
+        return indexa;
+    }
+};
+
+uint64_t tamanho_arquivo(const std::string& caminho)
+{
+    struct stat st;
+    if (::stat(caminho.c_str(), &st) != 0) return 0;
+    return static_cast<uint64_t>(st.st_size);
+}
+
+bool escreve_tudo(int fd, const void* dados, size_t n)
+{
+    const char* p = static_cast<const char*>(dados);
+    while (n > 0) {
+        ssize_t w = ::write(fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += w;
+        n -= static_cast<size_t>(w);
+    }
+    return true;
+}
+
+// Leitor posicionado no início da primeira linha em ou após 'offset': lê a
+// partir do byte anterior e descarta até o primeiro '\n' (linha vazia se o
+// offset já era início de linha).
+std::unique_ptr<LeitorSequencial> leitor_em(const std::string& caminho, uint64_t offset)
+{
+    auto r = std::make_unique<LeitorSequencial>(caminho, offset == 0 ? 0 : offset - 1);
+    if (offset > 0) {
+        std::string descartada;
+        r->linha(descartada);
+    }
+    return r;
+}
+
+// Reescreve o índice aberto em 'fd' a partir do CSV inteiro.
+long reconstruir_em(int fd, const std::string& caminho_csv, uint32_t passo, uint64_t bloco)
+{
+    if (::ftruncate(fd, 0) != 0) return -1;
+    const uint64_t inicio = inicio_dados_log(caminho_csv);
+    auto fin_ptr = leitor_em(caminho_csv, inicio);
+    LeitorSequencial& fin = *fin_ptr;
+    if (!fin.aberto()) return 0;
+
+    std::map<int, ContadorIndice> contadores;
+    std::vector<EntradaIndiceLog> lote;
+    lote.reserve(1024);
+    long total = 0;
+    uint64_t offset = inicio;
+    std::string linha;
+    while (fin.linha(linha)) {
+        uint64_t tam = linha.size() + 1;
+        int64_t ts;
+        int tr;
+        if (campos_linha_log(linha, ts, tr) && contadores[tr].proxima(tam, passo, bloco)) {
+            EntradaIndiceLog e;
+            e.timestamp_ms = ts;
+            e.truck_id = tr;
+            e.offset = offset;
+            lote.push_back(e);
+            if (lote.size() == 1024) {
+                if (!escreve_tudo(fd, lote.data(), lote.size() * sizeof(EntradaIndiceLog))) return -1;
+                total += static_cast<long>(lote.size());
+                lote.clear();
+            }
+        }
+        offset += tam;
+    }
+    if (!lote.empty()) {
+        if (!escreve_tudo(fd, lote.data(), lote.size() * sizeof(EntradaIndiceLog))) return -1;
+        total += static_cast<long>(lote.size());
+    }
+    return total;
+}
+
+// true se a última entrada do índice em 'fd' confere com o CSV.
+bool indice_confere(int fd, const std::string& caminho_csv)
+{
+    struct stat st;
+    if (::fstat(fd, &st) != 0) return false;
+    uint64_t tam_idx = static_cast<uint64_t>(st.st_size);
+    uint64_t tam_csv = tamanho_arquivo(caminho_csv);
+    if (tam_idx < sizeof(EntradaIndiceLog)) {
+        // Índice vazio só confere com um CSV sem linhas de dados.
+        std::ifstream fin(caminho_csv, std::ios::binary);
+        fin.seekg(static_cast<std::streamoff>(inicio_dados_log(caminho_csv)));
+        std::string linha;
+        int64_t ts;
+        int tr;
+        while (std::getline(fin, linha)) {
+            if (campos_linha_log(linha, ts, tr)) return false;
+        }
+        return true;
+    }
+    if (tam_idx % sizeof(EntradaIndiceLog) != 0) {
+        // Entrada incompleta no fim (escrita interrompida): descarta-a.
+        tam_idx -= tam_idx % sizeof(EntradaIndiceLog);
+        if (::ftruncate(fd, static_cast<off_t>(tam_idx)) != 0) return false;
+    }
+    EntradaIndiceLog ultima;
+    off_t pos = static_cast<off_t>(tam_idx - sizeof(EntradaIndiceLog));
+    if (::pread(fd, &ultima, sizeof(ultima), pos) != static_cast<ssize_t>(sizeof(ultima))) return false;
+    if (ultima.offset >= tam_csv) return false;
+
+    std::ifstream fin(caminho_csv, std::ios::binary);
+    fin.seekg(static_cast<std::streamoff>(ultima.offset));
+    std::string linha;
+    int64_t ts;
+    int tr;
+    if (!std::getline(fin, linha) || !campos_linha_log(linha, ts, tr)) return false;
+    return ts == ultima.timestamp_ms && tr == ultima.truck_id;
+}
+
+} // namespace
+
+std::string caminho_indice(const std::string& caminho_csv)
+{
+    return caminho_csv + ".idx";
+}
+
+uint64_t inicio_dados_log(const std::string& caminho_csv)
+{
+    std::ifstream fin(caminho_csv + ".compactacao");
+    std::string linha;
+    while (std::getline(fin, linha)) {
+        if (linha.rfind("descartado=", 0) != 0) continue;
+        try { return std::stoull(linha.substr(11)); } catch (...) { return 0; }
+    }
+    return 0;
+}
+
+bool campos_linha_log(const std::string& linha, int64_t& ts, int& truck_id)
+{
+    if (linha.empty() || linha[0] < '0' || linha[0] > '9') return false; // cabeçalho
+    const char* p = linha.c_str();
+    char* fim = nullptr;
+    errno = 0;
+    long long t = std::strtoll(p, &fim, 10);
+    if (fim == p || *fim != ',' || errno != 0) return false;
+    p = fim + 1;
+    long id = std::strtol(p, &fim, 10);
+    if (fim == p || (*fim != ',' && *fim != '\0')) return false;
+    ts = static_cast<int64_t>(t);
+    truck_id = static_cast<int>(id);
+    return true;
+}
+
+long reconstruir_indice_log(const std::string& caminho_csv, uint32_t passo, uint64_t bloco)
+{
+    int fd = ::open(caminho_indice(caminho_csv).c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) return -1;
+    ::flock(fd, LOCK_EX);
+    long n = reconstruir_em(fd, caminho_csv, std::max<uint32_t>(1, passo), bloco);
+    ::flock(fd, LOCK_UN);
+    ::close(fd);
+    return n;
+}
+
+// ---------------- EscritorIndiceLog ----------------
+
+EscritorIndiceLog::EscritorIndiceLog(const std::string& caminho_csv, uint32_t passo, uint64_t bloco)
+    : caminho_csv_(caminho_csv), passo_(std::max<uint32_t>(1, passo)), bloco_(bloco)
+{
+    std::string caminho = caminho_indice(caminho_csv);
+    fd_ = ::open(caminho.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        std::cerr << "[IndiceLog] não foi possível abrir " << caminho << ": "
+                  << std::strerror(errno) << " (log segue sem índice)\n";
+        return;
+    }
+    ::flock(fd_, LOCK_EX);
+    try {
+        if (!indice_confere(fd_, caminho_csv_)) {
+            long n = reconstruir_em(fd_, caminho_csv_, passo_, bloco_);
+            std::cerr << "[IndiceLog] índice reconstruído: " << n << " entradas\n";
+        }
+    } catch (...) {
+        std::cerr << "[IndiceLog] falha ao validar o índice\n";
+    }
+    ::flock(fd_, LOCK_UN);
+}
+
+EscritorIndiceLog::~EscritorIndiceLog()
+{
+    if (fd_ >= 0) ::close(fd_);
+}
+
+void EscritorIndiceLog::registrar(int64_t timestamp_ms, int truck_id, uint64_t offset, uint64_t tamanho)
+{
+    if (fd_ < 0) return;
+    bool indexa = (linhas_ % passo_) == 0 || bytes_desde_ultima_ >= bloco_;
+    ++linhas_;
+    if (indexa) bytes_desde_ultima_ = 0;
+    bytes_desde_ultima_ += tamanho;
+    if (!indexa) return;
+
+    EntradaIndiceLog e;
+    e.timestamp_ms = timestamp_ms;
+    e.truck_id = truck_id;
+    e.offset = offset;
+    // Uma única write() com O_APPEND: entradas de processos diferentes não se
+    // misturam. LOCK_SH: espera uma reconstrução (LOCK_EX) de outro processo.
+    ::flock(fd_, LOCK_SH);
+    if (escreve_tudo(fd_, &e, sizeof(e))) ++gravadas_;
+    ::flock(fd_, LOCK_UN);
+}
+
+// ---------------- LeitorLog ----------------
+
+LeitorLog::LeitorLog(const std::string& caminho_csv)
+    : caminho_csv_(caminho_csv), tamanho_csv_(tamanho_arquivo(caminho_csv)),
+      inicio_dados_(inicio_dados_log(caminho_csv))
+{
+    std::ifstream fin(caminho_indice(caminho_csv), std::ios::binary);
+    if (!fin) return;
+    uint64_t tam = tamanho_arquivo(caminho_indice(caminho_csv));
+    entradas_.resize(tam / sizeof(EntradaIndiceLog));
+    fin.read(reinterpret_cast<char*>(entradas_.data()),
+             static_cast<std::streamsize>(entradas_.size() * sizeof(EntradaIndiceLog)));
+    entradas_.resize(static_cast<size_t>(fin.gcount()) / sizeof(EntradaIndiceLog));
+
+    // Entradas além do fim do CSV (índice à frente de um CSV truncado) ou no
+    // trecho descartado pela compactação são descartadas.
+    entradas_.erase(std::remove_if(entradas_.begin(), entradas_.end(),
+                                   [this](const EntradaIndiceLog& e) {
+                                       return e.offset >= tamanho_csv_ || e.offset < inicio_dados_;
+                                   }),
+                    entradas_.end());
+    std::stable_sort(entradas_.begin(), entradas_.end(),
+                     [](const EntradaIndiceLog& a, const EntradaIndiceLog& b) { return a.offset < b.offset; });
+    for (const auto& e : entradas_) por_caminhao_[e.truck_id].push_back(e);
+}
+
+bool LeitorLog::intervalo_indexado(int64_t& primeiro, int64_t& ultimo) const
+{
+    if (entradas_.empty()) return false;
+    primeiro = ultimo = entradas_.front().timestamp_ms;
+    for (const auto& e : entradas_) {
+        primeiro = std::min(primeiro, e.timestamp_ms);
+        ultimo = std::max(ultimo, e.timestamp_ms);
+    }
+    return true;
+}
+
+uint64_t LeitorLog::offset_inicial(int64_t t, int truck_id) const
+{
+    if (entradas_.empty()) return inicio_dados_;
+
+    auto inicio_de = [t](const std::vector<EntradaIndiceLog>& v) {
+        // Última entrada com ts < t: todas as linhas anteriores a ela são mais antigas.
+        auto it = std::lower_bound(v.begin(), v.end(), t,
+                                   [](const EntradaIndiceLog& e, int64_t x) { return e.timestamp_ms < x; });
+        return it == v.begin() ? v.front().offset : std::prev(it)->offset;
+    };
+
+    if (truck_id >= 0) {
+        auto it = por_caminhao_.find(truck_id);
+        // A primeira linha de cada caminhão é sempre indexada: sem entradas, não há linhas dele.
+        if (it == por_caminhao_.end()) return tamanho_csv_;
+        return inicio_de(it->second);
+    }
+    uint64_t menor = tamanho_csv_;
+    for (const auto& [id, v] : por_caminhao_) menor = std::min(menor, inicio_de(v));
+    return menor;
+}
+
+size_t LeitorLog::consultar(int64_t t0, int64_t t1, int truck_id,
+                            const std::function<bool(const std::string&)>& fn) const
+{
+    auto fin = leitor_em(caminho_csv_, offset_inicial(t0, truck_id));
+    if (!fin->aberto()) return 0;
+
+    size_t n = 0;
+    std::string linha;
+    while (fin->linha(linha)) {
+        int64_t ts;
+        int tr;
+        if (!campos_linha_log(linha, ts, tr)) continue;
+        if (truck_id >= 0 && tr != truck_id) continue;
+        if (ts > t1) {
+            if (truck_id >= 0 || ts > t1 + FOLGA_MS) break;
+            continue;
+        }
+        if (ts < t0) continue;
+        ++n;
+        if (!fn(linha)) break;
+    }
+    return n;
+}
+
+std::optional<std::string> LeitorLog::estado_em(int64_t t, int truck_id) const
+{
+    uint64_t inicio = inicio_dados_;
+    auto it = por_caminhao_.find(truck_id);
+    if (!entradas_.empty()) {
+        if (it == por_caminhao_.end()) return std::nullopt;
+        const auto& v = it->second;
+        // Última entrada com ts <= t.
+        auto up = std::upper_bound(v.begin(), v.end(), t,
+                                   [](int64_t x, const EntradaIndiceLog& e) { return x < e.timestamp_ms; });
+        if (up == v.begin()) return std::nullopt;
+        inicio = std::prev(up)->offset;
+    }
+
+    auto fin = leitor_em(caminho_csv_, inicio);
+    if (!fin->aberto()) return std::nullopt;
+
+    std::optional<std::string> ultima;
+    std::string linha;
+    while (fin->linha(linha)) {
+        int64_t ts;
+        int tr;
+        if (!campos_linha_log(linha, ts, tr) || tr != truck_id) continue;
+        if (ts > t) break;
+        ultima = linha;
+    }
+    return ultima;
+}
@@ -0,0 +1,625 @@
+/*
+ * Arquivo: IoLog.cpp
+ * Finalidade:
+ * Implementação do GravadorLog e do LeitorSequencial declarados em "IoLog.h",
+ * e de um wrapper mínimo de io_uring (AnelIoUring) sobre as syscalls
+ * io_uring_setup/io_uring_enter/io_uring_register e os anéis mapeados.
+ *
+ * Detalhes:
+ * - O offset das linhas vem da posição do arquivo após a escrita: as escritas
+ * usam offset -1 (posição corrente, IORING_FEAT_RW_CUR_POS) num descritor
+ * O_APPEND, então após a conclusão a posição é o fim do nosso lote. Por isso
+ * há no máximo uma escrita em voo por arquivo; a profundidade vem de vários
+ * arquivos e fsyncs na mesma submissão.
+ * - Escrita curta ou com erro no io_uring é completada com write() síncrono.
+ * Um lote gravado em mais de uma escrita não tem offsets confiáveis (outro
+ * processo pode gravar entre elas), então seus callbacks não são chamados.
+ * - Leituras em voo são sempre colhidas antes de liberar os buffers.
+ */
+
+#include "IoLog.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t TAM_BUFFER_ESCRITA = 64 * 1024;
+constexpr unsigned MAX_BUFFERS_ESCRITA = 8;
+constexpr unsigned PROFUNDIDADE_ESCRITA = 64;
+
+uint64_t dados_usuario(size_t arquivo, bool fsync)
+{
+    return (static_cast<uint64_t>(arquivo) << 1) | (fsync ? 1u : 0u);
+}
+
+// 'escritas' soma as write() que gravaram algo.
+bool escreve_tudo(int fd, const char* p, size_t n, unsigned& escritas)
+{
+    while (n > 0) {
+        ssize_t w = ::write(fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (w > 0) ++escritas;
+        p += w;
+        n -= static_cast<size_t>(w);
+    }
+    return true;
+}
+
+} // namespace
+
+bool io_uring_habilitado()
+{
+    static const bool h = [] {
+        const char* env = std::getenv("ATR_IO_URING");
+        return !(env && std::strcmp(env, "0") == 0);
+    }();
+    return h;
+}
+
+// ---------------- AnelIoUring ----------------
+
+#ifdef __linux__
+class AnelIoUring
+{
+public:
+    explicit AnelIoUring(unsigned entradas)
+    {
+        io_uring_params p;
+        std::memset(&p, 0, sizeof(p));
+        fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entradas, &p));
+        if (fd_ < 0) return;
+        if (!(p.features & IORING_FEAT_RW_CUR_POS)) { fechar(); return; }
+
+        sq_tam_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_tam_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        unico_ = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (unico_) sq_tam_ = cq_tam_ = std::max(sq_tam_, cq_tam_);
+
+        sq_ptr_ = ::mmap(nullptr, sq_tam_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         fd_, IORING_OFF_SQ_RING);
+        if (sq_ptr_ == MAP_FAILED) { sq_ptr_ = nullptr; fechar(); return; }
+        if (unico_) {
+            cq_ptr_ = sq_ptr_;
+        } else {
+            cq_ptr_ = ::mmap(nullptr, cq_tam_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                             fd_, IORING_OFF_CQ_RING);
+            if (cq_ptr_ == MAP_FAILED) { cq_ptr_ = nullptr; fechar(); return; }
+        }
+        sqes_tam_ = p.sq_entries * sizeof(io_uring_sqe);
+        void* s = ::mmap(nullptr, sqes_tam_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         fd_, IORING_OFF_SQES);
+        if (s == MAP_FAILED) { fechar(); return; }
+        sqes_ = static_cast<io_uring_sqe*>(s);
+
+        char* sq = static_cast<char*>(sq_ptr_);
+        char* cq = static_cast<char*>(cq_ptr_);
+        sq_head_ = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        sq_entradas_ = p.sq_entries;
+        sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+        cauda_local_ = *sq_tail_;
+    }
+
+    ~AnelIoUring() { fechar(); }
+
+    bool ok() const { return fd_ >= 0; }
+
+    bool registrar_buffers(const std::vector<std::vector<char>>& bufs)
+    {
+        std::vector<iovec> iov(bufs.size());
+        for (size_t i = 0; i < bufs.size(); ++i) {
+            iov[i].iov_base = const_cast<char*>(bufs[i].data());
+            iov[i].iov_len = bufs[i].size();
+        }
+        return ::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS,
+                         iov.data(), static_cast<unsigned>(iov.size())) == 0;
+    }
+
+    // SQE livre (zerado), ou nullptr se o anel de submissão estiver cheio.
+    io_uring_sqe* obter_sqe()
+    {
+        unsigned cabeca = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+        if (cauda_local_ - cabeca >= sq_entradas_) return nullptr;
+        unsigned idx = cauda_local_ & sq_mask_;
+        io_uring_sqe* sqe = &sqes_[idx];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sq_array_[idx] = idx;
+        ++cauda_local_;
+        ++a_enviar_;
+        return sqe;
+    }
+
+    // Envia os SQEs preenchidos e espera 'esperar' conclusões.
+    // Retorna false em erro da syscall.
+    bool submeter(unsigned esperar)
+    {
+        __atomic_store_n(sq_tail_, cauda_local_, __ATOMIC_RELEASE);
+        unsigned n = a_enviar_;
+        while (true) {
+            long r = ::syscall(__NR_io_uring_enter, fd_, n, esperar,
+                               esperar ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+            if (r >= 0) {
+                n -= std::min<unsigned>(n, static_cast<unsigned>(r));
+                a_enviar_ = n;
+                if (n == 0) return true;
+                continue;
+            }
+            if (errno == EINTR) continue;
+            return false;
+        }
+    }
+
+    // Espera ao menos uma conclusão sem enviar nada.
+    void esperar()
+    {
+        while (::syscall(__NR_io_uring_enter, fd_, 0u, 1u, IORING_ENTER_GETEVENTS, nullptr, 0) < 0
+               && errno == EINTR) {}
+    }
+
+    bool proximo_cqe(io_uring_cqe& out)
+    {
+        unsigned cabeca = *cq_head_;
+        if (cabeca == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) return false;
+        out = cqes_[cabeca & cq_mask_];
+        __atomic_store_n(cq_head_, cabeca + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+private:
+    void fechar()
+    {
+        if (sqes_) ::munmap(sqes_, sqes_tam_);
+        if (cq_ptr_ && !unico_) ::munmap(cq_ptr_, cq_tam_);
+        if (sq_ptr_) ::munmap(sq_ptr_, sq_tam_);
+        sqes_ = nullptr;
+        sq_ptr_ = cq_ptr_ = nullptr;
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+    }
+
+    int fd_ = -1;
+    bool unico_ = false;
+    void* sq_ptr_ = nullptr;
+    void* cq_ptr_ = nullptr;
+    size_t sq_tam_ = 0, cq_tam_ = 0, sqes_tam_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    unsigned *sq_head_ = nullptr, *sq_tail_ = nullptr, *sq_array_ = nullptr;
+    unsigned sq_mask_ = 0, sq_entradas_ = 0;
+    unsigned *cq_head_ = nullptr, *cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+    unsigned cauda_local_ = 0;
+    unsigned a_enviar_ = 0;
+};
+#else
+class AnelIoUring
+{
+public:
+    explicit AnelIoUring(unsigned) {}
+    bool ok() const { return false; }
+};
+#endif
+
+// ---------------- GravadorLog ----------------
+
+GravadorLog::GravadorLog(std::chrono::milliseconds intervalo_fsync)
+    : intervalo_fsync_(intervalo_fsync)
+{
+#ifdef __linux__
+    if (io_uring_habilitado()) {
+        auto anel = std::make_unique<AnelIoUring>(PROFUNDIDADE_ESCRITA);
+        if (anel->ok()) {
+            buffers_.assign(MAX_BUFFERS_ESCRITA, std::vector<char>(TAM_BUFFER_ESCRITA));
+            if (!anel->registrar_buffers(buffers_)) buffers_.clear(); // segue com escritas comuns
+            anel_ = std::move(anel);
+        } else {
+            std::cerr << "[IoLog] io_uring indisponível (" << std::strerror(errno)
+                      << "); usando write()\n";
+        }
+    }
+#endif
+    thread_ = std::thread(&GravadorLog::laco, this);
+}
+
+GravadorLog::~GravadorLog()
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        sair_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+    for (auto& a : arquivos_) if (a.fd >= 0) ::close(a.fd);
+}
+
+int GravadorLog::abrir(const std::string& caminho)
+{
+    int fd = ::open(caminho.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "[IoLog] não foi possível abrir " << caminho << ": " << std::strerror(errno) << "\n";
+        return -1;
+    }
+    std::lock_guard<std::mutex> lk(mtx_);
+    arquivos_.push_back(Arquivo{fd, caminho, {}});
+    return static_cast<int>(arquivos_.size() - 1);
+}
+
+void GravadorLog::escrever(int arquivo, std::string dados, std::function<void(uint64_t)> ao_gravar)
+{
+    if (dados.empty()) return;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (arquivo < 0 || static_cast<size_t>(arquivo) >= arquivos_.size()) return;
+        arquivos_[arquivo].fila.push_back(Pendente{std::move(dados), std::move(ao_gravar)});
+        ++enfileirados_;
+    }
+    cv_.notify_one();
+}
+
+void GravadorLog::descarregar()
+{
+    std::unique_lock<std::mutex> lk(mtx_);
+    uint64_t alvo = enfileirados_;
+    cv_.notify_one();
+    cv_vazio_.wait(lk, [&] { return concluidos_ >= alvo || sair_; });
+}
+
+const char* GravadorLog::backend() const
+{
+    return anel_ ? "io_uring" : "write";
+}
+
+GravadorLog::Estatisticas GravadorLog::estatisticas() const
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    return est_;
+}
+
+void GravadorLog::laco()
+{
+    auto prox_fsync = std::chrono::steady_clock::now() + intervalo_fsync_;
+    std::vector<bool> sujos;
+    while (true) {
+        std::vector<int> fds;
+        std::vector<std::vector<Pendente>> lotes;
+        bool sair;
+        {
+            std::unique_lock<std::mutex> lk(mtx_);
+            cv_.wait_until(lk, prox_fsync, [&] {
+                if (sair_) return true;
+                for (const auto& a : arquivos_) if (!a.fila.empty()) return true;
+                return false;
+            });
+            sair = sair_;
+            for (auto& a : arquivos_) {
+                fds.push_back(a.fd);
+                lotes.emplace_back();
+                lotes.back().swap(a.fila);
+            }
+        }
+        sujos.resize(fds.size(), false);
+
+        size_t n_linhas = 0;
+        for (size_t i = 0; i < lotes.size(); ++i) {
+            if (!lotes[i].empty()) { sujos[i] = true; n_linhas += lotes[i].size(); }
+        }
+        bool fsync = sair || std::chrono::steady_clock::now() >= prox_fsync;
+        bool algum_sujo = std::find(sujos.begin(), sujos.end(), true) != sujos.end();
+
+        if (n_linhas > 0 || (fsync && algum_sujo)) {
+            fds_ = fds;
+            gravar_lote(lotes, fsync ? &sujos : nullptr);
+        }
+        if (fsync) {
+            std::fill(sujos.begin(), sujos.end(), false);
+            prox_fsync = std::chrono::steady_clock::now() + intervalo_fsync_;
+        }
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            concluidos_ += n_linhas;
+        }
+        cv_vazio_.notify_all();
+        if (sair) break;
+    }
+}
+
+void GravadorLog::gravar_lote(std::vector<std::vector<Pendente>>& lotes, const std::vector<bool>* fsync)
+{
+    // Junta cada lote num único bloco contíguo (uma escrita por arquivo).
+    std::vector<std::string> juntos(lotes.size());   // lotes fora dos buffers registrados
+    std::vector<const char*> ptr(lotes.size(), nullptr);
+    std::vector<size_t> tam(lotes.size(), 0);
+    uint64_t linhas = 0, bytes = 0;
+    for (size_t i = 0; i < lotes.size(); ++i) {
+        for (const auto& p : lotes[i]) tam[i] += p.dados.size();
+        if (tam[i] == 0) continue;
+        linhas += lotes[i].size();
+        bytes += tam[i];
+        if (anel_ && i < buffers_.size() && tam[i] <= TAM_BUFFER_ESCRITA) {
+            char* dst = buffers_[i].data();
+            for (const auto& p : lotes[i]) { std::memcpy(dst, p.dados.data(), p.dados.size()); dst += p.dados.size(); }
+            ptr[i] = buffers_[i].data();
+        } else {
+            juntos[i].reserve(tam[i]);
+            for (const auto& p : lotes[i]) juntos[i] += p.dados;
+            ptr[i] = juntos[i].data();
+        }
+    }
+
+    uint64_t chamadas = 0, fsyncs = 0, erros = 0, sem_offset = 0;
+    std::vector<uint64_t> gravados(lotes.size(), 0);
+    std::vector<bool> ok(lotes.size(), false);
+
+#ifdef __linux__
+    if (anel_) {
+        unsigned enviados = 0;
+        for (size_t i = 0; i < lotes.size(); ++i) {
+            bool com_fsync = fsync && (*fsync)[i];
+            io_uring_sqe* sqe = nullptr;
+            if (ptr[i] && (sqe = anel_->obter_sqe())) {
+                bool fixo = ptr[i] == (i < buffers_.size() ? buffers_[i].data() : nullptr);
+                sqe->opcode = fixo ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+                sqe->fd = fds_[i];
+                sqe->off = static_cast<uint64_t>(-1); // posição corrente (fim, por O_APPEND)
+                sqe->addr = reinterpret_cast<uint64_t>(ptr[i]);
+                sqe->len = static_cast<uint32_t>(tam[i]);
+                if (fixo) sqe->buf_index = static_cast<uint16_t>(i);
+                sqe->user_data = dados_usuario(i, false);
+                if (com_fsync) sqe->flags |= IOSQE_IO_LINK; // fsync só após esta escrita
+                ++enviados;
+            }
+            if (com_fsync) {
+                io_uring_sqe* fs = anel_->obter_sqe();
+                if (fs) {
+                    fs->opcode = IORING_OP_FSYNC;
+                    fs->fd = fds_[i];
+                    fs->fsync_flags = IORING_FSYNC_DATASYNC;
+                    fs->user_data = dados_usuario(i, true);
+                    ++enviados;
+                } else {
+                    if (sqe) sqe->flags &= ~IOSQE_IO_LINK;
+                    ::fdatasync(fds_[i]);
+                    ++fsyncs;
+                    ++chamadas;
+                }
+            }
+        }
+        if (enviados > 0) {
+            bool sub = anel_->submeter(enviados);
+            ++chamadas;
+            unsigned colhidos = 0;
+            io_uring_cqe cqe;
+            while (sub && colhidos < enviados) {
+                if (!anel_->proximo_cqe(cqe)) { anel_->esperar(); ++chamadas; continue; }
+                ++colhidos;
+                size_t i = static_cast<size_t>(cqe.user_data >> 1);
+                if (cqe.user_data & 1) {
+                    if (cqe.res < 0) {
+                        // Escrita anterior falhou (link cancelado) ou fsync com erro.
+                        ::fdatasync(fds_[i]);
+                        ++chamadas;
+                    }
+                    ++fsyncs;
+                } else if (cqe.res >= 0) {
+                    gravados[i] = static_cast<uint64_t>(cqe.res);
+                    ok[i] = gravados[i] == tam[i];
+                } else {
+                    ++erros; // refeita abaixo com write()
+                }
+            }
+            if (!sub) {
+                std::cerr << "[IoLog] io_uring_enter falhou: " << std::strerror(errno) << "\n";
+                ++erros;
+            }
+        }
+    }
+#endif
+
+    for (size_t i = 0; i < lotes.size(); ++i) {
+        if (!ptr[i]) {
+            continue;
+        }
+        unsigned escritas = gravados[i] > 0 ? 1 : 0;
+        if (!ok[i]) {
+            // Fallback (ou resto de uma escrita curta no io_uring).
+            if (!escreve_tudo(fds_[i], ptr[i] + gravados[i], tam[i] - gravados[i], escritas)) {
+                std::cerr << "[IoLog] erro ao gravar log: " << std::strerror(errno) << "\n";
+                ++erros;
+            }
+            ++chamadas;
+        }
+        bool precisa_offset = std::any_of(lotes[i].begin(), lotes[i].end(),
+                                          [](const Pendente& p) { return static_cast<bool>(p.ao_gravar); });
+        if (precisa_offset && escritas > 1) {
+            // Lote dividido: o fim não diz onde começou o primeiro pedaço.
+            ++sem_offset;
+        } else if (precisa_offset) {
+            off_t fim = ::lseek(fds_[i], 0, SEEK_CUR);
+            ++chamadas;
+            if (fim >= static_cast<off_t>(tam[i])) concluir(lotes[i], static_cast<uint64_t>(fim));
+        }
+    }
+    if (!anel_ && fsync) {
+        for (size_t i = 0; i < fds_.size(); ++i) {
+            if ((*fsync)[i]) { ::fdatasync(fds_[i]); ++fsyncs; ++chamadas; }
+        }
+    }
+
+    std::lock_guard<std::mutex> lk(mtx_);
+    est_.linhas += linhas;
+    est_.bytes += bytes;
+    est_.rodadas += 1;
+    est_.chamadas += chamadas;
+    est_.fsyncs += fsyncs;
+    est_.erros += erros;
+    est_.sem_offset += sem_offset;
+}
+
+void GravadorLog::concluir(std::vector<Pendente>& lote, uint64_t fim)
+{
+    uint64_t total = 0;
+    for (const auto& p : lote) total += p.dados.size();
+    uint64_t offset = fim - total;
+    for (auto& p : lote) {
+        if (p.ao_gravar) {
+            try { p.ao_gravar(offset); } catch (...) { }
+        }
+        offset += p.dados.size();
+    }
+}
+
+// ---------------- LeitorSequencial ----------------
+
+LeitorSequencial::LeitorSequencial(const std::string& caminho, uint64_t offset,
+                                   size_t bloco, unsigned profundidade)
+    : bloco_(std::max<size_t>(bloco, 4096)), profundidade_(std::max(1u, profundidade)),
+      proximo_envio_(offset)
+{
+    fd_ = ::open(caminho.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) return;
+#ifdef __linux__
+    if (io_uring_habilitado() && profundidade_ > 1) {
+        auto anel = std::make_unique<AnelIoUring>(profundidade_);
+        if (anel->ok()) {
+            buffers_.assign(profundidade_, std::vector<char>(bloco_));
+            if (anel->registrar_buffers(buffers_)) {
+                anel_ = std::move(anel);
+                resultado_.assign(profundidade_, -1);
+                for (unsigned s = 0; s < profundidade_; ++s) enviar_leitura(s);
+                anel_->submeter(0);
+                return;
+            }
+        }
+    }
+#endif
+    profundidade_ = 1;
+    buffers_.assign(1, std::vector<char>(bloco_));
+}
+
+LeitorSequencial::~LeitorSequencial()
+{
+#ifdef __linux__
+    if (anel_) {
+        // O kernel ainda pode escrever nos buffers: colhe as leituras em voo.
+        auto em_voo = [this] { return std::count(resultado_.begin(), resultado_.end(), -1); };
+        io_uring_cqe cqe;
+        while (em_voo() > 0) {
+            if (anel_->proximo_cqe(cqe)) resultado_[cqe.user_data] = std::max(cqe.res, 0);
+            else anel_->esperar();
+        }
+    }
+#endif
+    if (fd_ >= 0) ::close(fd_);
+}
+
+void LeitorSequencial::enviar_leitura(unsigned slot)
+{
+#ifdef __linux__
+    io_uring_sqe* sqe = anel_->obter_sqe();
+    if (!sqe) { resultado_[slot] = 0; return; }
+    sqe->opcode = IORING_OP_READ_FIXED;
+    sqe->fd = fd_;
+    sqe->off = proximo_envio_;
+    sqe->addr = reinterpret_cast<uint64_t>(buffers_[slot].data());
+    sqe->len = static_cast<uint32_t>(bloco_);
+    sqe->buf_index = static_cast<uint16_t>(slot);
+    sqe->user_data = slot;
+    resultado_[slot] = -1;
+    proximo_envio_ += bloco_;
+#else
+    (void)slot;
+#endif
+}
+
+bool LeitorSequencial::proximo_bloco()
+{
+    if (fd_ < 0 || fim_) return false;
+
+    if (!anel_) {
+        ssize_t n;
+        do {
+            n = ::pread(fd_, buffers_[0].data(), bloco_, static_cast<off_t>(proximo_envio_));
+        } while (n < 0 && errno == EINTR);
+        if (n <= 0) { fim_ = true; return false; }
+        proximo_envio_ += static_cast<uint64_t>(n);
+        dados_ = buffers_[0].data();
+        tam_ = static_cast<size_t>(n);
+        pos_ = 0;
+        return true;
+    }
+
+#ifdef __linux__
+    if (dados_) {
+        // Terminou o bloco anterior: o slot dele volta para a fila de leitura.
+        enviar_leitura(slot_atual_);
+        anel_->submeter(0);
+        slot_atual_ = (slot_atual_ + 1) % profundidade_;
+        dados_ = nullptr;
+    }
+    io_uring_cqe cqe;
+    while (resultado_[slot_atual_] < 0) {
+        if (anel_->proximo_cqe(cqe)) {
+            resultado_[cqe.user_data] = cqe.res < 0 ? 0 : cqe.res;
+        } else {
+            anel_->esperar();
+        }
+    }
+    int64_t n = resultado_[slot_atual_];
+    if (n <= 0) { fim_ = true; return false; }
+    if (static_cast<size_t>(n) < bloco_) ultimo_ = true; // arquivo regular: leitura curta só no fim
+    dados_ = buffers_[slot_atual_].data();
+    tam_ = static_cast<size_t>(n);
+    pos_ = 0;
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool LeitorSequencial::linha(std::string& out)
+{
+    while (true) {
+        if (pos_ < tam_) {
+            const char* ini = dados_ + pos_;
+            const char* nl = static_cast<const char*>(std::memchr(ini, '\n', tam_ - pos_));
+            if (nl) {
+                out.assign(resto_);
+                out.append(ini, static_cast<size_t>(nl - ini));
+                resto_.clear();
+                pos_ += static_cast<size_t>(nl - ini) + 1;
+                return true;
+            }
+            resto_.append(ini, tam_ - pos_);
+            pos_ = tam_;
+        }
+        if (ultimo_ || !proximo_bloco()) {
+            ultimo_ = true;
+            tam_ = pos_ = 0;
+            if (resto_.empty()) return false;
+            out.swap(resto_); // última linha sem '\n'
+            resto_.clear();
+            return true;
+        }
+    }
+}
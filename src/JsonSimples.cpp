@@ -0,0 +1,98 @@
+/*
+ * Arquivo: JsonSimples.cpp
+ * Finalidade:
+ * Implementação das funções de JSON declaradas em "JsonSimples.h".
+ */
+
+#include "JsonSimples.h"
+
+#include <algorithm>
+
+namespace {
+
+// Posição logo após os dois-pontos da chave; npos se ausente.
+size_t inicio_valor(const std::string& s, const std::string& chave)
+{
+    size_t pos = s.find("\"" + chave + "\"");
+    if (pos == std::string::npos) return std::string::npos;
+    pos = s.find(':', pos);
+    return pos == std::string::npos ? pos : pos + 1;
+}
+
+} // namespace
+
+std::string json_escapar(const std::string& s)
+{
+    std::string out;
+    out.reserve(s.size());
+    for (char c : s) {
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default: out += c;
+        }
+    }
+    return out;
+}
+
+std::string valor_json(const std::string& s, const std::string& chave)
+{
+    size_t pos = inicio_valor(s, chave);
+    if (pos == std::string::npos) return std::string();
+    while (pos < s.size() && (s[pos] == ' ' || s[pos] == '\t')) ++pos;
+    if (pos >= s.size()) return std::string();
+
+    size_t fim = pos;
+    if (s[pos] == '{' || s[pos] == '[') {
+        // objeto/lista: até o fechamento correspondente (ignora o conteúdo de textos)
+        int nivel = 0;
+        bool em_texto = false;
+        for (; fim < s.size(); ++fim) {
+            const char c = s[fim];
+            if (em_texto) {
+                if (c == '\\') ++fim;
+                else if (c == '"') em_texto = false;
+            } else if (c == '"') {
+                em_texto = true;
+            } else if (c == '{' || c == '[') {
+                ++nivel;
+            } else if ((c == '}' || c == ']') && --nivel == 0) {
+                ++fim;
+                break;
+            }
+        }
+    } else if (s[pos] == '"') {
+        for (fim = pos + 1; fim < s.size() && s[fim] != '"'; ++fim) {
+            if (s[fim] == '\\') ++fim;
+        }
+        ++fim;
+    } else {
+        while (fim < s.size() && s[fim] != ',' && s[fim] != '}' && s[fim] != ']') ++fim;
+    }
+    return s.substr(pos, std::min(fim, s.size()) - pos);
+}
+
+bool numero_json(const std::string& s, const std::string& chave, double& out)
+{
+    const size_t pos = inicio_valor(s, chave);
+    if (pos == std::string::npos) return false;
+    try { out = std::stod(s.substr(pos)); return true; } catch (...) { return false; }
+}
+
+bool inteiro_json(const std::string& s, const std::string& chave, long& out)
+{
+    const size_t pos = inicio_valor(s, chave);
+    if (pos == std::string::npos) return false;
+    try { out = std::stol(s.substr(pos)); return true; } catch (...) { return false; }
+}
+
+bool texto_json(const std::string& s, const std::string& chave, std::string& out)
+{
+    const std::string v = valor_json(s, chave);
+    if (v.size() < 2 || v.front() != '"' || v.back() != '"') return false;
+    out = v.substr(1, v.size() - 2);
+    return true;
+}
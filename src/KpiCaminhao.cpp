@@ -0,0 +1,128 @@
+/*
+ * Arquivo: KpiCaminhao.cpp
+ * Finalidade:
+ * Implementação do agregador de indicadores declarado em "KpiCaminhao.h".
+ */
+
+#include "KpiCaminhao.h"
+
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+void EstatisticaCorrente::adicionar(double x)
+{
+    ++n;
+    if (n == 1) {
+        min = max = x;
+    } else {
+        if (x < min) min = x;
+        if (x > max) max = x;
+    }
+    const double delta = x - media;
+    media += delta / n;
+    m2 += delta * (x - media);
+}
+
+double EstatisticaCorrente::desvio() const
+{
+    return std::sqrt(variancia());
+}
+
+namespace {
+
+void json_estatistica(std::ostringstream& ss, const char* nome, const EstatisticaCorrente& e)
+{
+    ss << "\"" << nome << "\":{"
+       << "\"n\":" << e.n << ","
+       << "\"media\":" << e.media << ","
+       << "\"desvio\":" << e.desvio() << ","
+       << "\"min\":" << e.min << ","
+       << "\"max\":" << e.max << "}";
+}
+
+} // namespace
+
+std::string KpiCaminhao::serializar() const
+{
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    ss << "{"
+       << "\"amostras\":" << amostras << ","
+       << "\"ms_total\":" << ms_total << ","
+       << "\"ms_automatico\":" << ms_automatico << ","
+       << "\"ms_manual\":" << ms_manual << ","
+       << "\"ms_alerta\":" << ms_alerta << ","
+       << "\"ms_defeito\":" << ms_defeito << ","
+       << "\"defeitos\":" << defeitos << ","
+       << "\"waypoints\":" << waypoints << ","
+       << "\"distancia\":" << distancia << ","
+       << "\"velocidade_media\":" << velocidade_media() << ",";
+    json_estatistica(ss, "velocidade", velocidade);
+    ss << ",";
+    json_estatistica(ss, "temperatura", temperatura);
+    ss << "}";
+    return ss.str();
+}
+
+void AgregadorKpi::amostra(uint64_t ts_ms, double x, double y, double temperatura,
+                           bool automatico, bool alerta, bool defeito)
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    kpi_.amostras++;
+    kpi_.temperatura.adicionar(temperatura);
+    if (defeito && (!tem_anterior_ || !defeito_anterior_)) kpi_.defeitos++;
+
+    if (!tem_anterior_) {
+        ancora_x_ = x;
+        ancora_y_ = y;
+        ancora_ts_ = ts_ms;
+    } else if (ts_ms > ts_anterior_) {
+        // O intervalo pertence ao estado da amostra anterior.
+        const uint64_t dt = ts_ms - ts_anterior_;
+        if (dt <= MAX_INTERVALO_MS) {
+            kpi_.ms_total += dt;
+            (auto_anterior_ ? kpi_.ms_automatico : kpi_.ms_manual) += dt;
+            if (alerta_anterior_) kpi_.ms_alerta += dt;
+            if (defeito_anterior_) kpi_.ms_defeito += dt;
+        } else {
+            ancora_ts_ = ts_ms; // trecho com lacuna não entra na velocidade
+        }
+
+        const double d = std::hypot(x - ancora_x_, y - ancora_y_);
+        if (d >= LIMIAR_DISTANCIA) {
+            kpi_.distancia += d;
+            if (ts_ms > ancora_ts_) kpi_.velocidade.adicionar(d * 1000.0 / (ts_ms - ancora_ts_));
+            ancora_x_ = x;
+            ancora_y_ = y;
+            ancora_ts_ = ts_ms;
+        }
+    }
+
+    tem_anterior_ = true;
+    ts_anterior_ = ts_ms;
+    auto_anterior_ = automatico;
+    alerta_anterior_ = alerta;
+    defeito_anterior_ = defeito;
+}
+
+void AgregadorKpi::waypoint_alcancado()
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    kpi_.waypoints++;
+}
+
+KpiCaminhao AgregadorKpi::atual() const
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    return kpi_;
+}
+
+KpiCaminhao AgregadorKpi::reiniciar()
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    KpiCaminhao encerrado = kpi_;
+    kpi_ = KpiCaminhao();
+    tem_anterior_ = false;
+    return encerrado;
+}
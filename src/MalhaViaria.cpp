@@ -0,0 +1,448 @@
+/*
+ * Arquivo: MalhaViaria.cpp
+ * Finalidade:
+ * Implementação da malha viária e das hierarquias de contração declaradas em
+ * "MalhaViaria.h".
+ *
+ * Detalhes:
+ * - Durante a contração o grafo restante fica em listas de adjacência
+ * (saída e entrada) com vias paralelas fundidas na de menor tempo; os arcos
+ * de v para nós ainda não contraídos, no momento em que v é contraído, são
+ * exatamente os arcos "para cima" da hierarquia.
+ * - A busca testemunha para em TESTEMUNHA_MAX_NOS nós assentados; se não
+ * achar caminho alternativo, o atalho é criado (pode sobrar atalho, nunca
+ * faltar: a consulta continua exata).
+ * - As filas de prioridade são heaps binários sobre vetores membros, para a
+ * consulta não alocar. A consulta usa stall-on-demand: não expande nós
+ * alcançáveis por menos a partir de um nó mais alto já visitado.
+ */
+
+#include "MalhaViaria.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <sstream>
+
+namespace {
+
+constexpr int TESTEMUNHA_MAX_NOS = 500;
+constexpr double EPS = 1e-9;
+
+using ItemFila = std::pair<double, int>;
+using MaiorPrimeiro = std::greater<ItemFila>;
+
+} // namespace
+
+int MalhaViaria::indice(int id) const
+{
+    auto it = indice_.find(id);
+    return it == indice_.end() ? -1 : it->second;
+}
+
+int MalhaViaria::adicionar_no(int id, double x, double y)
+{
+    auto it = indice_.find(id);
+    if (it != indice_.end()) {
+        nos_[it->second] = {id, x, y};
+        return it->second;
+    }
+    const int i = static_cast<int>(nos_.size());
+    nos_.push_back({id, x, y});
+    indice_[id] = i;
+    preparada_ = false;
+    return i;
+}
+
+bool MalhaViaria::adicionar_via(int id_de, int id_para, double velocidade, int capacidade, double comprimento)
+{
+    const int a = indice(id_de), b = indice(id_para);
+    if (a < 0 || b < 0 || a == b || !(velocidade > 0.0)) return false;
+    ViaMalha v;
+    v.de = a;
+    v.para = b;
+    v.velocidade = velocidade;
+    v.capacidade = capacidade;
+    v.comprimento = comprimento >= 0.0 ? comprimento : std::hypot(nos_[b].x - nos_[a].x, nos_[b].y - nos_[a].y);
+    auto it = via_entre_.find({a, b});
+    if (it == via_entre_.end() || v.tempo() < vias_[it->second].tempo()) via_entre_[{a, b}] = vias_.size();
+    vias_.push_back(v);
+    preparada_ = false;
+    return true;
+}
+
+bool MalhaViaria::loadFromFile(const std::string& path)
+{
+    std::ifstream ifs(path);
+    if (!ifs.is_open()) {
+        std::cerr << "[Malha] não foi possível abrir " << path << "\n";
+        return false;
+    }
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+    return loadFromString(ss.str());
+}
+
+bool MalhaViaria::loadFromString(const std::string& content)
+{
+    nos_.clear();
+    vias_.clear();
+    indice_.clear();
+    via_entre_.clear();
+
+    // nós primeiro: as vias podem aparecer antes dos nós que ligam
+    std::vector<std::pair<int, std::string>> linhas_via;
+    std::istringstream in(content);
+    std::string linha;
+    int n_linha = 0;
+    while (std::getline(in, linha)) {
+        ++n_linha;
+        const size_t com = linha.find('#');
+        if (com != std::string::npos) linha.erase(com);
+        std::istringstream iss(linha);
+        std::string tipo;
+        if (!(iss >> tipo)) continue;
+        if (tipo == "no") {
+            int id;
+            double x, y;
+            if (iss >> id >> x >> y) adicionar_no(id, x, y);
+            else std::cerr << "[Malha] linha " << n_linha << " inválida: '" << linha << "'\n";
+        } else if (tipo == "via" || tipo == "via2") {
+            linhas_via.emplace_back(n_linha, linha);
+        } else {
+            std::cerr << "[Malha] linha " << n_linha << ": tipo desconhecido '" << tipo << "'\n";
+        }
+    }
+    for (const auto& [n, l] : linhas_via) {
+        std::istringstream iss(l);
+        std::string tipo;
+        int de, para, cap = 0;
+        double vel, comp = -1.0;
+        iss >> tipo;
+        if (!(iss >> de >> para >> vel)) {
+            std::cerr << "[Malha] linha " << n << " inválida: '" << l << "'\n";
+            continue;
+        }
+        if (!(iss >> cap)) cap = 0;
+        else if (!(iss >> comp)) comp = -1.0;
+        bool ok = adicionar_via(de, para, vel, cap, comp);
+        if (ok && tipo == "via2") ok = adicionar_via(para, de, vel, cap, comp);
+        if (!ok) std::cerr << "[Malha] linha " << n << ": via inválida (nó desconhecido ou velocidade <= 0)\n";
+    }
+    preparar();
+    return true;
+}
+
+void MalhaViaria::preparar()
+{
+    const int n = static_cast<int>(nos_.size());
+    std::vector<std::vector<Arco>> saida(n), entrada(n); // entrada[w]: alvo = origem u
+
+    // Insere/encurta o arco u -> w do grafo restante; true se mudou algo.
+    auto ligar = [&](int u, int w, double peso, int meio) {
+        for (Arco& a : saida[u]) {
+            if (a.alvo != w) continue;
+            if (peso >= a.peso) return false;
+            a.peso = peso;
+            a.meio = meio;
+            for (Arco& b : entrada[w]) {
+                if (b.alvo == u) { b.peso = peso; b.meio = meio; }
+            }
+            return true;
+        }
+        saida[u].push_back({w, peso, meio});
+        entrada[w].push_back({u, peso, meio});
+        return true;
+    };
+    for (const auto& [par, i] : via_entre_) ligar(par.first, par.second, vias_[i].tempo(), -1);
+
+    std::vector<char> contraido(n, 0);
+    std::vector<int> vizinhos_contraidos(n, 0);
+
+    // Busca testemunha: distâncias a partir de u no grafo restante sem 'pulado'.
+    std::vector<double> dist_t(n, INFINITO);
+    std::vector<int> tocados;
+    std::vector<ItemFila> fila;
+    auto testemunha = [&](int u, int pulado, double limite) {
+        for (int v : tocados) dist_t[v] = INFINITO;
+        tocados.clear();
+        fila.clear();
+        dist_t[u] = 0.0;
+        tocados.push_back(u);
+        fila.push_back({0.0, u});
+        int assentados = 0;
+        while (!fila.empty() && assentados < TESTEMUNHA_MAX_NOS) {
+            std::pop_heap(fila.begin(), fila.end(), MaiorPrimeiro());
+            const auto [d, v] = fila.back();
+            fila.pop_back();
+            if (d > dist_t[v]) continue;
+            if (d > limite) break;
+            ++assentados;
+            for (const Arco& a : saida[v]) {
+                if (contraido[a.alvo] || a.alvo == pulado) continue;
+                const double nd = d + a.peso;
+                if (nd < dist_t[a.alvo]) {
+                    if (dist_t[a.alvo] == INFINITO) tocados.push_back(a.alvo);
+                    dist_t[a.alvo] = nd;
+                    fila.push_back({nd, a.alvo});
+                    std::push_heap(fila.begin(), fila.end(), MaiorPrimeiro());
+                }
+            }
+        }
+    };
+
+    // Atalhos necessários para contrair v (aplica se 'aplicar').
+    auto contrair = [&](int v, bool aplicar) {
+        int atalhos = 0;
+        double maior_saida = 0.0;
+        for (const Arco& s : saida[v]) {
+            if (!contraido[s.alvo]) maior_saida = std::max(maior_saida, s.peso);
+        }
+        for (const Arco& e : entrada[v]) {
+            const int u = e.alvo;
+            if (contraido[u]) continue;
+            testemunha(u, v, e.peso + maior_saida);
+            for (const Arco& s : saida[v]) {
+                const int w = s.alvo;
+                if (contraido[w] || w == u) continue;
+                const double via_v = e.peso + s.peso;
+                if (dist_t[w] <= via_v + EPS) continue;
+                ++atalhos;
+                if (aplicar && ligar(u, w, via_v, v)) ++atalhos_;
+            }
+        }
+        return atalhos;
+    };
+    auto prioridade = [&](int v) {
+        int grau = 0;
+        for (const Arco& a : saida[v]) grau += !contraido[a.alvo];
+        for (const Arco& a : entrada[v]) grau += !contraido[a.alvo];
+        return static_cast<double>(contrair(v, false) - grau + vizinhos_contraidos[v]);
+    };
+
+    std::priority_queue<ItemFila, std::vector<ItemFila>, MaiorPrimeiro> ordem;
+    for (int v = 0; v < n; ++v) ordem.push({prioridade(v), v});
+
+    std::vector<std::vector<Arco>> sobe(n), desce(n);
+    atalhos_ = 0;
+    while (!ordem.empty()) {
+        const int v = ordem.top().second;
+        ordem.pop();
+        if (contraido[v]) continue;
+        // atualização preguiçosa: se piorou além do próximo, volta para a fila
+        const double p = prioridade(v);
+        if (!ordem.empty() && p > ordem.top().first) {
+            ordem.push({p, v});
+            continue;
+        }
+        contrair(v, true);
+        for (const Arco& a : saida[v]) {
+            if (contraido[a.alvo]) continue;
+            sobe[v].push_back(a);
+            ++vizinhos_contraidos[a.alvo];
+        }
+        for (const Arco& a : entrada[v]) {
+            if (contraido[a.alvo]) continue;
+            desce[v].push_back(a);
+            ++vizinhos_contraidos[a.alvo];
+        }
+        contraido[v] = 1;
+    }
+
+    auto compactar = [n](const std::vector<std::vector<Arco>>& listas, std::vector<uint32_t>& ini,
+                         std::vector<Arco>& arcos) {
+        ini.assign(n + 1, 0);
+        arcos.clear();
+        for (int v = 0; v < n; ++v) {
+            ini[v] = static_cast<uint32_t>(arcos.size());
+            arcos.insert(arcos.end(), listas[v].begin(), listas[v].end());
+        }
+        ini[n] = static_cast<uint32_t>(arcos.size());
+    };
+    compactar(sobe, ini_sobe_, sobe_);
+    compactar(desce, ini_desce_, desce_);
+
+    for (int l = 0; l < 2; ++l) {
+        dist_[l].assign(n, INFINITO);
+        pai_[l].assign(n, -1);
+        meio_[l].assign(n, -1);
+        versao_[l].assign(n, 0);
+    }
+    consulta_ = 0;
+    preparada_ = true;
+}
+
+const MalhaViaria::Arco* MalhaViaria::arco(int u, int w) const
+{
+    const Arco* melhor = nullptr;
+    for (uint32_t i = ini_sobe_[u]; i < ini_sobe_[u + 1]; ++i) {
+        if (sobe_[i].alvo == w && (!melhor || sobe_[i].peso < melhor->peso)) melhor = &sobe_[i];
+    }
+    for (uint32_t i = ini_desce_[w]; i < ini_desce_[w + 1]; ++i) {
+        if (desce_[i].alvo == u && (!melhor || desce_[i].peso < melhor->peso)) melhor = &desce_[i];
+    }
+    return melhor;
+}
+
+void MalhaViaria::desempacotar(int u, int w, int meio, std::vector<int>& saida) const
+{
+    if (meio < 0) {
+        saida.push_back(w);
+        return;
+    }
+    const Arco* a = arco(u, meio);
+    const Arco* b = arco(meio, w);
+    desempacotar(u, meio, a ? a->meio : -1, saida);
+    desempacotar(meio, w, b ? b->meio : -1, saida);
+}
+
+double MalhaViaria::consultar(int s, int t, std::vector<int>* caminho)
+{
+    if (s == t) {
+        if (caminho) caminho->assign(1, s);
+        return 0.0;
+    }
+    if (++consulta_ == 0) { // volta do contador: invalida tudo
+        for (auto& v : versao_) std::fill(v.begin(), v.end(), 0);
+        consulta_ = 1;
+    }
+    auto dist = [this](int l, int v) { return versao_[l][v] == consulta_ ? dist_[l][v] : INFINITO; };
+    auto marcar = [this](int l, int v, double d, int pai, int meio) {
+        versao_[l][v] = consulta_;
+        dist_[l][v] = d;
+        pai_[l][v] = pai;
+        meio_[l][v] = meio;
+        fila_[l].push_back({d, v});
+        std::push_heap(fila_[l].begin(), fila_[l].end(), MaiorPrimeiro());
+    };
+    fila_[0].clear();
+    fila_[1].clear();
+    marcar(0, s, 0.0, -1, -1);
+    marcar(1, t, 0.0, -1, -1);
+
+    double melhor = INFINITO;
+    int encontro = -1;
+    // l = 0: para frente a partir de s pelos arcos que sobem;
+    // l = 1: para trás a partir de t pelos arcos que descem (invertidos).
+    for (int l = 0; !fila_[0].empty() || !fila_[1].empty(); l ^= 1) {
+        auto& f = fila_[l];
+        if (f.empty()) continue;
+        if (f.front().first >= melhor) {
+            f.clear();
+            continue;
+        }
+        std::pop_heap(f.begin(), f.end(), MaiorPrimeiro());
+        const auto [d, v] = f.back();
+        f.pop_back();
+        if (d > dist(l, v)) continue;
+        const double total = d + dist(l ^ 1, v);
+        if (total < melhor) {
+            melhor = total;
+            encontro = v;
+        }
+        const std::vector<uint32_t>& ini = l == 0 ? ini_sobe_ : ini_desce_;
+        const std::vector<Arco>& arcos = l == 0 ? sobe_ : desce_;
+        // stall-on-demand: um nó mais alto já alcançado chega a v por menos,
+        // então v não está num caminho ótimo desta busca e não é expandido
+        const std::vector<uint32_t>& ini_op = l == 0 ? ini_desce_ : ini_sobe_;
+        const std::vector<Arco>& arcos_op = l == 0 ? desce_ : sobe_;
+        bool parado = false;
+        for (uint32_t i = ini_op[v]; i < ini_op[v + 1] && !parado; ++i) {
+            parado = dist(l, arcos_op[i].alvo) + arcos_op[i].peso < d;
+        }
+        if (parado) continue;
+        for (uint32_t i = ini[v]; i < ini[v + 1]; ++i) {
+            const Arco& a = arcos[i];
+            const double nd = d + a.peso;
+            if (nd < dist(l, a.alvo)) marcar(l, a.alvo, nd, v, a.meio);
+        }
+    }
+    if (encontro < 0 || !caminho) return melhor;
+
+    // s -> encontro pelos pais da busca direta, encontro -> t pelos da reversa
+    std::vector<int> subida;
+    for (int v = encontro; v != s; v = pai_[0][v]) subida.push_back(v);
+    caminho->assign(1, s);
+    int u = s;
+    for (auto it = subida.rbegin(); it != subida.rend(); ++it) {
+        desempacotar(u, *it, meio_[0][*it], *caminho);
+        u = *it;
+    }
+    for (int v = encontro; v != t; v = pai_[1][v]) desempacotar(v, pai_[1][v], meio_[1][v], *caminho);
+    return melhor;
+}
+
+double MalhaViaria::tempo(int id_de, int id_para, std::vector<int>* caminho)
+{
+    if (!preparada_) preparar();
+    const int s = indice(id_de), t = indice(id_para);
+    if (s < 0 || t < 0) return INFINITO;
+    const double r = consultar(s, t, caminho);
+    if (caminho) {
+        for (int& v : *caminho) v = nos_[v].id;
+    }
+    return r;
+}
+
+Route MalhaViaria::rota(int id_de, int id_para)
+{
+    Route r;
+    std::vector<int> caminho;
+    if (tempo(id_de, id_para, &caminho) == INFINITO) return r;
+    int ant = -1;
+    for (int id : caminho) {
+        const int i = indice(id);
+        double vel = 0.0;
+        if (ant >= 0) {
+            auto it = via_entre_.find({ant, i});
+            if (it != via_entre_.end()) vel = vias_[it->second].velocidade;
+        }
+        r.addWaypoint(Waypoint(nos_[i].x, nos_[i].y, vel));
+        ant = i;
+    }
+    return r;
+}
+
+Route MalhaViaria::rota_entre(double x0, double y0, double x1, double y1)
+{
+    const int a = no_mais_proximo(x0, y0), b = no_mais_proximo(x1, y1);
+    if (a < 0 || b < 0) return Route();
+    Route meio = rota(a, b);
+    Route r;
+    if (meio.size() == 0) return r;
+    auto acrescentar = [&r](const Waypoint& wp) {
+        if (r.size() > 0 && r[r.size() - 1].x == wp.x && r[r.size() - 1].y == wp.y) return;
+        r.addWaypoint(wp);
+    };
+    acrescentar(Waypoint(x0, y0));
+    for (size_t i = 0; i < meio.size(); ++i) acrescentar(meio[i]);
+    acrescentar(Waypoint(x1, y1, VELOCIDADE_ACESSO));
+    return r;
+}
+
+double MalhaViaria::custo(double x0, double y0, double x1, double y1)
+{
+    const int a = no_mais_proximo(x0, y0), b = no_mais_proximo(x1, y1);
+    if (a < 0 || b < 0) return INFINITO;
+    const NoMalha& na = nos_[indice(a)];
+    const NoMalha& nb = nos_[indice(b)];
+    return std::hypot(na.x - x0, na.y - y0) / VELOCIDADE_ACESSO + tempo(a, b)
+           + std::hypot(x1 - nb.x, y1 - nb.y) / VELOCIDADE_ACESSO;
+}
+
+int MalhaViaria::no_mais_proximo(double x, double y) const
+{
+    int melhor = -1;
+    double melhor_d2 = INFINITO;
+    for (const NoMalha& no : nos_) {
+        const double d2 = (no.x - x) * (no.x - x) + (no.y - y) * (no.y - y);
+        if (d2 < melhor_d2) {
+            melhor_d2 = d2;
+            melhor = no.id;
+        }
+    }
+    return melhor;
+}
@@ -0,0 +1,133 @@
+/*
+ * Arquivo: MapaCalor.cpp
+ * Finalidade:
+ * Implementação do mapa de calor da frota declarado em "MapaCalor.h".
+ *
+ * Detalhes:
+ * - O rebase acontece quando o fator passa de FATOR_MAX (≈ e^13.8); com
+ * valores em double, a precisão relativa se mantém entre rebases.
+ * - Limiar dos deltas: uma célula só é reenviada se o valor quantizado mudou
+ * ao menos LIMIAR_ABS décimos e LIMIAR_REL do valor publicado; o decaimento
+ * lento de células antigas não gera tráfego a cada ciclo. Os quadros
+ * completos periódicos corrigem o desvio acumulado no assinante.
+ */
+
+#include "MapaCalor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace {
+
+constexpr double FATOR_MAX = 1e6;
+constexpr int LIMIAR_ABS = 1;        // décimos de segundo
+constexpr double LIMIAR_REL = 0.05;
+
+} // namespace
+
+MapaCalor::MapaCalor(double largura, double altura, double celula, std::vector<double> escalas_s)
+    : celula_(celula),
+      colunas_(static_cast<int>(std::ceil(largura / celula))),
+      linhas_(static_cast<int>(std::ceil(altura / celula)))
+{
+    const size_t n = static_cast<size_t>(colunas_) * linhas_;
+    for (double tau : escalas_s) {
+        Escala e;
+        e.tau_s = tau;
+        e.soma.assign(n, 0.0);
+        e.publicado.assign(n, 0);
+        escalas_.push_back(std::move(e));
+    }
+}
+
+double MapaCalor::fator(const Escala& e, uint64_t ts_ms) const
+{
+    const double dt_s = (static_cast<double>(ts_ms) - static_cast<double>(e.t_base)) / 1000.0;
+    return std::exp(dt_s / e.tau_s);
+}
+
+void MapaCalor::rebasear(Escala& e, uint64_t ts_ms)
+{
+    const double inv = 1.0 / fator(e, ts_ms);
+    for (double& v : e.soma) v *= inv;
+    e.t_base = ts_ms;
+}
+
+void MapaCalor::amostra(int truck_id, double x, double y, uint64_t ts_ms)
+{
+    auto it = ultimo_ts_.find(truck_id);
+    const bool primeira = it == ultimo_ts_.end();
+    uint64_t dt_ms = 0;
+    if (!primeira && ts_ms > it->second) dt_ms = std::min(ts_ms - it->second, MAX_INTERVALO_MS);
+    ultimo_ts_[truck_id] = ts_ms;
+    if (dt_ms == 0) return;
+
+    const int cx = std::clamp(static_cast<int>(x / celula_), 0, colunas_ - 1);
+    const int cy = std::clamp(static_cast<int>(y / celula_), 0, linhas_ - 1);
+    const size_t idx = static_cast<size_t>(cy) * colunas_ + cx;
+    const double w = dt_ms / 1000.0;
+    for (Escala& e : escalas_) {
+        double f = fator(e, ts_ms);
+        if (f > FATOR_MAX) {
+            rebasear(e, ts_ms);
+            f = 1.0;
+        }
+        e.soma[idx] += w * f;
+    }
+}
+
+double MapaCalor::valor(size_t escala, int coluna, int linha, uint64_t ts_ms) const
+{
+    const Escala& e = escalas_.at(escala);
+    return e.soma[static_cast<size_t>(linha) * colunas_ + coluna] / fator(e, ts_ms);
+}
+
+std::string MapaCalor::codificar(size_t escala, uint64_t ts_ms, bool completo)
+{
+    Escala& e = escalas_.at(escala);
+    if (fator(e, ts_ms) > FATOR_MAX) rebasear(e, ts_ms);
+    const double inv = 1.0 / fator(e, ts_ms);
+
+    std::ostringstream cel;
+    long anterior = 0;
+    size_t n = 0;
+    for (size_t i = 0; i < e.soma.size(); ++i) {
+        const double v = e.soma[i] * inv * 10.0;
+        const uint32_t q = static_cast<uint32_t>(std::min(4294967295.0, std::round(v)));
+        const uint32_t p = e.publicado[i];
+        bool enviar;
+        if (completo) {
+            e.publicado[i] = q; // o quadro completo substitui a grade inteira
+            enviar = q != 0;
+        } else {
+            const int64_t dif = std::abs(static_cast<int64_t>(q) - static_cast<int64_t>(p));
+            enviar = dif >= LIMIAR_ABS && (q == 0 || dif >= LIMIAR_REL * p);
+        }
+        if (!enviar) continue;
+        cel << (n ? "," : "") << (static_cast<long>(i) - anterior) << ":" << q;
+        anterior = static_cast<long>(i);
+        e.publicado[i] = q;
+        ++n;
+    }
+    if (n == 0 && !completo) return std::string();
+
+    std::ostringstream ss;
+    ss << "t=" << ts_ms << ";escala=" << e.tau_s << ";celula=" << celula_
+       << ";grade=" << colunas_ << "x" << linhas_ << ";c=" << cel.str();
+    return ss.str();
+}
+
+void AmostradorMapa::posicao(int truck_id, const std::string& payload, uint64_t t_ms)
+{
+    frota_[truck_id].atualizar(payload, t_ms);
+}
+
+void AmostradorMapa::amostrar(uint64_t t_ms)
+{
+    for (const auto& [id, rec] : frota_) {
+        if (!rec.valido() || t_ms - rec.recebido_em() > EXPIRA_MS) continue;
+        const EstadoPosicao e = rec.em(t_ms);
+        mapa_.amostra(id, e.x, e.y, t_ms);
+    }
+}
@@ -10,32 +10,51 @@
  * Funcionalidades Implementadas:
  * - Conexão/Desconexão: Gerencia a conexão com o broker MQTT, incluindo
  * um modo "MOCK" para testes sem broker real.
- * - Publicação: Método publish() para enviar mensagens de forma síncrona
- * (espera o envio ser confirmado).
+ * - Publicação: Método publish() coloca a mensagem na fila da sua classe de
+ * prioridade; a thread de envio a entrega ao Paho e espera o envio.
  * - Assinatura: Método subscribe_topic() para se inscrever em tópicos e
  * receber mensagens.
  * - Recepção de Mensagens (Callback): Implementa a classe interna Callback,
  * cujo método message_arrived() é chamado automaticamente pela biblioteca
  * Paho quando uma nova mensagem chega.
- * - Armazenamento Seguro: As mensagens recebidas são armazenadas em filas
- * internas (std::unordered_map<std::string, std::queue<std::string>> queues_),
- * protegidas por um mutex (q_mtx_) para garantir que múltiplas threads possam
- * ler (consumir) e o callback possa escrever (produzir) mensagens simultaneamente
- * sem causar condições de corrida.
- * - Consumo Não Bloqueante: O método try_pop_message() permite que as threads
- * verifiquem se há mensagens em um tópico específico e as retirem da fila
- * de forma segura e sem bloquear a execução caso a fila esteja vazia.
+ * - Armazenamento Seguro: message_arrived() entrega cada mensagem a caixa_
+ * (CaixaMensagens.h), que guarda as filas por tópico sob o seu próprio mutex
+ * e passa a mensagem direto à corrotina em next()/next_for() que espera há
+ * mais tempo. try_pop_message(), drenar_filtro() e os awaitables só delegam.
+ * - MQTT v5: conectar_v5() abre a sessão em v5 e lê o Topic Alias Maximum do
+ * CONNACK. publish() monta a mensagem com as propriedades do tópico
+ * configurado; a decisão "nome completo ou só alias" e o envio ficam sob
+ * pub_mtx_, para que nenhuma publicação com alias saia antes da que associa o
+ * alias ao nome. Os alias valem só para a conexão corrente.
+ * - Mensagem pré-montada: tópicos registrados (configurar_topico/publicador)
+ * guardam um mqtt::message criado uma vez; publicar_montada() troca apenas o
+ * payload e as propriedades variáveis antes de enviar.
+ * - Filas de prioridade: publish()/Publicador movem o payload para a fila da
+ * classe do tópico, e a thread de envio o move para a mensagem do tópico
+ * (binary_ref): a string montada pelo produtor é o buffer que o Paho lê. Só
+ * as propriedades v5 são refeitas a cada envio (a seq muda). laco_envio()
+ * (thread envio_) escolhe o próximo item com proximo_item() e envia fora de
+ * fila_mtx_, medindo a latência desde o enfileiramento até o fim do envio.
  */
 
 #include "MqttClient.h"
+#include "TamanhoMqtt.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
 
 // Construtor: Inicializa o cliente e tenta conectar ao broker.
 MqttClient::MqttClient(const std::string& broker_addr,
                        const std::string& client_id)
-    : client_(broker_addr, client_id), // Inicializa o cliente Paho
+    : client_(broker_addr, client_id, mqtt::create_options(MQTTVERSION_5)), // Cliente Paho apto a v5
       cb_(this) // Inicializa o callback com um ponteiro para este objeto MqttClient
 {
+    nomear_lock(pub_mtx_, "MqttClient::pub_mtx_");
+    nomear_lock(fila_mtx_, "MqttClient::fila_mtx_");
+
     // Configurações de conexão: sessão limpa (não lembra de assinaturas anteriores)
     connOpts_.set_clean_session(true);
 
@@ -51,9 +70,15 @@ MqttClient::MqttClient(const std::string& broker_addr,
         // Tenta conectar ao broker real.
         try {
             std::cout << "[MQTT] Conectando ao broker " << broker_addr << "...\n";
-            // A chamada connect() é assíncrona, o wait() faz ela bloquear até terminar.
-            client_.connect(connOpts_)->wait();
-            std::cout << "[MQTT] Conectado.\n";
+            const char* env_v5 = std::getenv("ATR_MQTT_V5");
+            const bool tentar_v5 = !(env_v5 && std::string(env_v5) == "0");
+            if (tentar_v5 && conectar_v5()) {
+                std::cout << "[MQTT] Conectado (v5, alias de tópico até " << alias_max_ << ").\n";
+            } else {
+                // A chamada connect() é assíncrona, o wait() faz ela bloquear até terminar.
+                client_.connect(connOpts_)->wait();
+                std::cout << "[MQTT] Conectado (3.1.1).\n";
+            }
             connected_ = true;
         }
         catch (const mqtt::exception& e) {
@@ -62,11 +87,15 @@ MqttClient::MqttClient(const std::string& broker_addr,
             // Em um sistema real, poderia haver lógica de reconexão aqui.
         }
     }
+
+    // Thread de envio das filas de prioridade (encerrada em descarregar()).
+    envio_ = std::thread([this] { laco_envio(); });
 }
 
 // Destrutor: Garante a desconexão limpa ao destruir o objeto.
 MqttClient::~MqttClient()
 {
+    descarregar();
     try {
         if (connected_) client_.disconnect()->wait();
     } catch (...) {} // Ignora exceções no destrutor
@@ -75,6 +104,7 @@ MqttClient::~MqttClient()
 // Desconecta explicitamente do broker.
 void MqttClient::disconnect()
 {
+    descarregar(); // o que já foi publicado sai antes da desconexão
     try {
         if (connected_) {
             client_.disconnect()->wait();
@@ -89,20 +119,367 @@ bool MqttClient::is_connected() const
     return connected_;
 }
 
+// Tenta a sessão v5 (clean start). O broker informa no CONNACK quantos alias
+// de tópico aceita; sem a propriedade o máximo é 0 (alias desativados).
+bool MqttClient::conectar_v5()
+{
+    try {
+        mqtt::connect_options opts(MQTTVERSION_5);
+        opts.set_clean_start(true);
+        auto tok = client_.connect(opts);
+        tok->wait();
+        const auto rsp = tok->get_connect_response();
+        if (rsp.get_mqtt_version() < MQTTVERSION_5) return true; // broker rebaixou: segue como 3.1.1
+        const auto& props = rsp.get_properties();
+        if (props.contains(mqtt::property::TOPIC_ALIAS_MAXIMUM))
+            alias_max_ = mqtt::get<uint16_t>(props, mqtt::property::TOPIC_ALIAS_MAXIMUM);
+        v5_ = true;
+        return true;
+    } catch (const mqtt::exception& e) {
+        std::cerr << "[MQTT] Broker recusou v5 (" << e.what() << "), usando 3.1.1\n";
+        return false;
+    }
+}
+
+MqttClient::EstadoTopico& MqttClient::registrar_topico(const std::string& topic, const ConfigTopico& cfg)
+{
+    EstadoTopico& st = topicos_[topic];
+    st.cfg = cfg;
+    st.tam_topico = topic.size();
+    if (v5_ && cfg.alias && st.alias == 0 && proximo_alias_ <= alias_max_)
+        st.alias = proximo_alias_++;
+    st.props_base = mqtt::properties();
+    st.tam_props_base = 0;
+    if (v5_ && st.alias != 0) {
+        st.props_base.add(mqtt::property(mqtt::property::TOPIC_ALIAS, st.alias));
+        st.tam_props_base = TamanhoMqtt::PROP_ALIAS;
+    }
+    if (!st.msg) st.msg = mqtt::make_message(topic, "", 0, 0, false);
+    return st;
+}
+
+void MqttClient::configurar_topico(const std::string& topic, const ConfigTopico& cfg)
+{
+    std::lock_guard<MutexAtr> lock(pub_mtx_);
+    registrar_topico(topic, cfg);
+}
+
+MqttClient::Publicador MqttClient::publicador(const std::string& topic)
+{
+    std::lock_guard<MutexAtr> lock(pub_mtx_);
+    auto it = topicos_.find(topic);
+    EstadoTopico& st = it != topicos_.end() ? it->second : registrar_topico(topic, ConfigTopico{});
+    return Publicador(*this, st, st.cfg.prioridade, st.cfg.estado);
+}
+
+std::string MqttClient::resumo_v5() const
+{
+    std::lock_guard<MutexAtr> lock(pub_mtx_);
+    const int64_t liquida = static_cast<int64_t>(bytes_como_311_) - static_cast<int64_t>(bytes_v5_);
+    std::ostringstream ss;
+    ss << "[MQTT] v5: " << (proximo_alias_ - 1) << " alias em uso (máx " << alias_max_ << "), "
+       << publicacoes_alias_ << " publicações só com alias\n"
+       << "  " << publicacoes_v5_ << " publicações em tópicos registrados: " << bytes_v5_
+       << " bytes no fio (3.1.1: " << bytes_como_311_ << "), dos quais " << bytes_props_
+       << " de propriedades; economia líquida " << liquida << " bytes";
+    if (bytes_como_311_ > 0)
+        ss << " (" << std::fixed << std::setprecision(1) << 100.0 * liquida / bytes_como_311_ << "%)";
+    return ss.str();
+}
+
 // Publica uma mensagem em um tópico.
 // Retorna true se bem-sucedido, false caso contrário.
-bool MqttClient::publish(const std::string& topic, const std::string& msg)
+bool MqttClient::publish(const std::string& topic, std::string msg, bool retained)
+{
+    EstadoTopico* st = nullptr;
+    Prioridade p = Prioridade::Controle;
+    bool estado = false;
+    {
+        // cfg pode ser reescrita por configurar_topico(): lida sob o lock
+        std::lock_guard<MutexAtr> lock(pub_mtx_);
+        auto it = topicos_.find(topic);
+        if (it != topicos_.end()) {
+            st = &it->second;
+            p = st->cfg.prioridade;
+            estado = st->cfg.estado;
+        }
+    }
+    ItemEnvio item;
+    item.st = st;
+    if (!st) item.topic = topic;
+    item.payload = std::move(msg);
+    item.retained = retained;
+    item.estado = estado;
+    return enfileirar(p, std::move(item));
+}
+
+bool MqttClient::Publicador::publicar(std::string msg, bool retained)
+{
+    ItemEnvio item;
+    item.st = st_;
+    item.payload = std::move(msg);
+    item.retained = retained;
+    item.estado = estado_;
+    return c_->enfileirar(prioridade_, std::move(item));
+}
+
+bool MqttClient::enviar_agora(const std::string& topic, const std::string& msg, bool retained)
 {
     try {
         // Publica a mensagem. O wait() garante que a função só retorne após o envio.
-        // QoS padrão (0) é usado aqui implicitamente.
-        client_.publish(topic, msg)->wait();
+        // QoS 0; a flag retained pede ao broker para guardar a última mensagem.
+        client_.publish(topic, msg.data(), msg.size(), 0, retained)->wait();
         return true;
     } catch (...) {
         return false;
     }
 }
 
+bool MqttClient::enfileirar(Prioridade p, ItemEnvio item)
+{
+    const int c = static_cast<int>(p);
+    {
+        std::lock_guard<MutexAtr> lk(fila_mtx_);
+        if (!parar_envio_ && item.estado) {
+            // Estado retido: substitui o valor pendente do tópico, sem limite
+            // de fila (um por tópico) e sem descarte.
+            EstadoTopico& st = *item.st;
+            st.estado_pendente = std::move(item.payload);
+            st.estado_retido = item.retained;
+            if (!st.estado_na_fila) {
+                st.estado_na_fila = true;
+                st.estado_desde = std::chrono::steady_clock::now();
+                estados_.push_back(&st);
+            }
+            fila_cv_.notify_one();
+            return true;
+        }
+        if (!parar_envio_) {
+            item.enfileirado = std::chrono::steady_clock::now();
+            auto& fila = filas_[c];
+            if (fila.size() >= CAPACIDADE_FILA[c]) {
+                if (p == Prioridade::Critica) {
+                    abrir_espaco_critica();
+                } else {
+                    // Fila cheia: a mensagem mais antiga é a que menos vale.
+                    fila.pop_front();
+                    if (est_filas_[c].descartadas++ == 0)
+                        std::cerr << "[MQTT] Fila " << c << " cheia, descartando as mensagens mais antigas\n";
+                }
+            }
+            fila.push_back(std::move(item));
+            fila_cv_.notify_one();
+            return true;
+        }
+    }
+    // Thread de envio já encerrada (desligamento): envia na hora.
+    return item.st ? publicar_montada(*item.st, std::move(item.payload), item.retained)
+                   : enviar_agora(item.topic, item.payload, item.retained);
+}
+
+void MqttClient::abrir_espaco_critica()
+{
+    // Eventos de segurança não são descartados para dar lugar a outros: a
+    // vaga sai de Volume e, sem Volume, de Telemetria. O total enfileirado
+    // continua limitado pela soma das capacidades.
+    for (Prioridade v : {Prioridade::Volume, Prioridade::Telemetria}) {
+        auto& fila = filas_[static_cast<int>(v)];
+        if (fila.empty()) continue;
+        fila.pop_front();
+        ++est_filas_[static_cast<int>(v)].descartadas;
+        ++est_filas_[static_cast<int>(Prioridade::Critica)].vagas_cedidas;
+        return;
+    }
+    // Nada a ceder: Critica descarta o evento mais antigo, sempre com aviso.
+    const int c = static_cast<int>(Prioridade::Critica);
+    filas_[c].pop_front();
+    std::cerr << "[MQTT] Fila critica cheia: evento mais antigo descartado (total "
+              << ++est_filas_[c].descartadas << ")\n";
+}
+
+bool MqttClient::proximo_item(ItemEnvio& item, int& classe)
+{
+    const int CRI = static_cast<int>(Prioridade::Critica);
+    const int CTL = static_cast<int>(Prioridade::Controle);
+    const int TEL = static_cast<int>(Prioridade::Telemetria);
+    const int VOL = static_cast<int>(Prioridade::Volume);
+    classe = -1;
+    if (!filas_[CRI].empty()) {
+        classe = CRI;
+    } else if (!estados_.empty() && (parar_envio_ || std::chrono::steady_clock::now() >= reenviar_estados_)) {
+        // estados retidos logo após Critica; contados como Controle
+        EstadoTopico* st = estados_.front();
+        estados_.pop_front();
+        st->estado_na_fila = false;
+        item = ItemEnvio{};
+        item.st = st;
+        item.payload = std::move(st->estado_pendente);
+        item.retained = st->estado_retido;
+        item.estado = true;
+        item.enfileirado = st->estado_desde;
+        classe = CTL;
+        return true;
+    } else if (!filas_[CTL].empty()) {
+        classe = CTL;
+    }
+    if (classe < 0) {
+        const bool tel = !filas_[TEL].empty();
+        const bool vol = !filas_[VOL].empty();
+        if (tel && (!vol || creditos_telemetria_ > 0)) {
+            classe = TEL;
+            if (creditos_telemetria_ > 0) --creditos_telemetria_;
+        } else if (vol) {
+            classe = VOL;
+            creditos_telemetria_ = PESO_TELEMETRIA;
+        }
+    }
+    if (classe < 0) return false;
+    item = std::move(filas_[classe].front());
+    filas_[classe].pop_front();
+    return true;
+}
+
+void MqttClient::laco_envio()
+{
+    std::unique_lock<MutexAtr> lk(fila_mtx_);
+    for (;;) {
+        if (!parar_envio_ && std::chrono::steady_clock::now() < retomar_envio_) {
+            fila_cv_.wait_until(lk, retomar_envio_);
+            continue;
+        }
+        ItemEnvio item;
+        int classe;
+        if (!proximo_item(item, classe)) {
+            if (parar_envio_) break; // filas vazias: descarregado
+            if (!estados_.empty()) fila_cv_.wait_until(lk, reenviar_estados_); // reenvio após falha
+            else fila_cv_.wait(lk);
+            continue;
+        }
+        lk.unlock();
+        std::string copia_estado;
+        if (item.estado) copia_estado = item.payload; // o envio move o payload
+        const bool ok = item.st
+            ? publicar_montada(*item.st, std::move(item.payload), item.retained)
+            : enviar_agora(item.topic, item.payload, item.retained);
+        const auto lat = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - item.enfileirado).count();
+        lk.lock();
+        EstatisticasFila& e = est_filas_[classe];
+        if (ok) ++e.enviadas; else ++e.falhas;
+        if (!ok && item.estado && !parar_envio_) {
+            // Estado retido não se perde numa falha: volta como pendente,
+            // a menos que uma publicação mais nova já o tenha substituído.
+            EstadoTopico& st = *item.st;
+            if (!st.estado_na_fila) {
+                st.estado_pendente = std::move(copia_estado);
+                st.estado_retido = item.retained;
+                st.estado_na_fila = true;
+                st.estado_desde = item.enfileirado;
+                estados_.push_back(&st);
+            }
+            reenviar_estados_ = std::chrono::steady_clock::now() + REENVIO_ESTADO;
+        }
+        e.lat_total_us += static_cast<uint64_t>(lat);
+        e.lat_max_us = std::max<uint64_t>(e.lat_max_us, static_cast<uint64_t>(lat));
+    }
+}
+
+void MqttClient::suspender_envio(std::chrono::milliseconds d)
+{
+    {
+        std::lock_guard<MutexAtr> lk(fila_mtx_);
+        retomar_envio_ = std::chrono::steady_clock::now() + d;
+    }
+    std::cerr << "[MQTT] Envio suspenso por " << d.count() << " ms\n";
+    fila_cv_.notify_all();
+}
+
+void MqttClient::descarregar()
+{
+    {
+        std::lock_guard<MutexAtr> lk(fila_mtx_);
+        parar_envio_ = true;
+    }
+    fila_cv_.notify_all();
+    if (envio_.joinable()) envio_.join();
+}
+
+std::string MqttClient::resumo_filas() const
+{
+    static const char* nomes[NUM_PRIORIDADES] = {"critica", "controle", "telemetria", "volume"};
+    std::lock_guard<MutexAtr> lk(fila_mtx_);
+    std::ostringstream ss;
+    ss << "[MQTT] Filas de envio:";
+    for (int c = 0; c < NUM_PRIORIDADES; ++c) {
+        const EstatisticasFila& e = est_filas_[c];
+        const uint64_t n = e.enviadas + e.falhas;
+        ss << "\n  " << std::left << std::setw(10) << nomes[c] << std::right
+           << " enviadas=" << e.enviadas << " falhas=" << e.falhas
+           << " descartadas=" << e.descartadas
+           << " lat_media_us=" << (n ? e.lat_total_us / n : 0)
+           << " lat_max_us=" << e.lat_max_us;
+        if (c == static_cast<int>(Prioridade::Critica)) ss << " vagas_cedidas=" << e.vagas_cedidas;
+    }
+    return ss.str();
+}
+
+// A mensagem do tópico é reaproveitada: troca-se só o payload (movido, sem
+// cópia) e a sequência em v5. O Paho copia o pacote para a sua fila dentro de publish(), então a
+// mensagem pode ser alterada de novo assim que publish() retorna; por isso a
+// troca e o envio ficam sob pub_mtx_.
+bool MqttClient::publicar_montada(EstadoTopico& st, std::string&& payload, bool retained)
+{
+    mqtt::delivery_token_ptr tok;
+    try {
+        std::lock_guard<MutexAtr> lock(pub_mtx_);
+        st.msg->set_payload(mqtt::binary_ref(std::move(payload)));
+        st.msg->set_retained(retained);
+        const bool so_alias = st.alias != 0 && st.alias_enviado;
+        const size_t tam_payload = st.msg->get_payload().size();
+        if (v5_) {
+            mqtt::properties props = st.props_base;
+            size_t tam_props = st.tam_props_base;
+            // A versão do esquema é estática: vai na primeira publicação do
+            // tópico na conexão (a que associa o alias) e nas retidas, que o
+            // broker entrega sozinhas a quem assina depois. Ausente = mesma
+            // versão já anunciada.
+            if (!st.cfg.esquema.empty() && (!st.esquema_enviado || retained)) {
+                props.add(mqtt::property(mqtt::property::USER_PROPERTY, "v", st.cfg.esquema));
+                tam_props += TamanhoMqtt::prop_usuario("v", st.cfg.esquema);
+            }
+            const std::string seq = std::to_string(++st.seq);
+            props.add(mqtt::property(mqtt::property::USER_PROPERTY, "seq", seq));
+            tam_props += TamanhoMqtt::prop_usuario("seq", seq);
+            // A mensagem retida representa o estado atual: não expira.
+            if (st.cfg.expira_s > 0 && !retained) {
+                props.add(mqtt::property(mqtt::property::MESSAGE_EXPIRY_INTERVAL,
+                                         static_cast<int>(st.cfg.expira_s)));
+                tam_props += TamanhoMqtt::PROP_EXPIRA;
+            }
+            st.msg->set_properties(props);
+
+            // Contas de bytes no fio: o mesmo PUBLISH em 3.1.1 leva o nome
+            // completo e nenhuma propriedade.
+            ++publicacoes_v5_;
+            bytes_v5_ += TamanhoMqtt::publish(so_alias ? 0 : st.tam_topico, tam_payload, true, tam_props);
+            bytes_como_311_ += TamanhoMqtt::publish(st.tam_topico, tam_payload, false);
+            bytes_props_ += TamanhoMqtt::varint(tam_props) + tam_props;
+        }
+        tok = client_.publish(st.msg);
+        st.esquema_enviado = true;
+        if (so_alias) {
+            ++publicacoes_alias_;
+        } else if (st.alias != 0) {
+            // Alias associado: daqui em diante o nome vai vazio.
+            st.alias_enviado = true;
+            st.msg->set_topic("");
+        }
+    } catch (...) {
+        return false;
+    }
+    try { tok->wait(); return true; } catch (...) { return false; }
+}
+
 // Inscreve-se em um tópico para receber mensagens.
 void MqttClient::subscribe_topic(const std::string& topic)
 {
@@ -117,34 +494,10 @@ void MqttClient::subscribe_topic(const std::string& topic)
     }
 }
 
-// Tenta consumir uma mensagem de um tópico específico.
-// Retorna std::nullopt se a fila estiver vazia, não bloqueia a thread chamadora.
-std::optional<std::string> MqttClient::try_pop_message(const std::string& topic)
-{
-    // Bloqueia o mutex para acesso seguro ao mapa de filas.
-    std::lock_guard<std::mutex> lock(q_mtx_);
-    // Procura a fila correspondente ao tópico.
-    auto it = queues_.find(topic);
-    // Se o tópico não existe no mapa ou a fila está vazia, retorna nullopt.
-    if (it == queues_.end()) return std::nullopt;
-    if (it->second.empty()) return std::nullopt;
-
-    // Pega a mensagem da frente da fila.
-    std::string m = it->second.front();
-    // Remove a mensagem da fila.
-    it->second.pop();
-    // Retorna a mensagem.
-    return m;
-}
-
 // --- Implementação da classe interna Callback ---
 
 // Este método é chamado automaticamente pela biblioteca Paho quando uma mensagem chega.
 void MqttClient::Callback::message_arrived(mqtt::const_message_ptr msg)
 {
-    // Bloqueia o mutex do objeto pai (MqttClient) para acesso seguro às filas.
-    std::lock_guard<std::mutex> lock(parent_->q_mtx_);
-    // Insere a mensagem na fila correspondente ao seu tópico.
-    // O operador [] do mapa cria uma nova fila se o tópico ainda não existir.
-    parent_->queues_[msg->get_topic()].push(msg->get_payload_str());
-}
\ No newline at end of file
+    parent_->caixa_.entregar(msg->get_topic(), msg->get_payload_str());
+}
@@ -0,0 +1,234 @@
+/*
+ * Arquivo: Orca.cpp
+ * Finalidade:
+ * Implementação do desvio recíproco entre caminhões declarado em "Orca.h".
+ *
+ * Convenção das retas: o lado permitido fica à esquerda da direção, isto é,
+ * v satisfaz a reta quando det(direcao, ponto - v) <= 0.
+ */
+
+#include "Orca.h"
+#include "Relogio.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double EPS = 1e-9;
+
+Vetor2 operator+(Vetor2 a, Vetor2 b) { return {a.x + b.x, a.y + b.y}; }
+Vetor2 operator-(Vetor2 a, Vetor2 b) { return {a.x - b.x, a.y - b.y}; }
+Vetor2 operator-(Vetor2 a) { return {-a.x, -a.y}; }
+Vetor2 operator*(double k, Vetor2 a) { return {k * a.x, k * a.y}; }
+double operator*(Vetor2 a, Vetor2 b) { return a.x * b.x + a.y * b.y; }
+double det(Vetor2 a, Vetor2 b) { return a.x * b.y - a.y * b.x; }
+double norma2(Vetor2 a) { return a * a; }
+double norma(Vetor2 a) { return std::sqrt(a * a); }
+Vetor2 unitario(Vetor2 a)
+{
+    const double n = norma(a);
+    return n > EPS ? (1.0 / n) * a : Vetor2{};
+}
+
+} // namespace
+
+void GradeVizinhos::montar(const std::vector<AgenteOrca>& agentes)
+{
+    for (auto& [k, v] : celulas_) v.clear(); // mantém a capacidade das células
+    for (size_t i = 0; i < agentes.size(); ++i) {
+        const int cx = static_cast<int>(std::floor(agentes[i].pos.x / celula_));
+        const int cy = static_cast<int>(std::floor(agentes[i].pos.y / celula_));
+        celulas_[chave(cx, cy)].push_back(i);
+    }
+}
+
+void GradeVizinhos::vizinhos(const std::vector<AgenteOrca>& agentes, size_t i, double raio, size_t max,
+                             std::vector<size_t>& out) const
+{
+    out.clear();
+    const Vetor2 p = agentes[i].pos;
+    const int alcance = static_cast<int>(std::ceil(raio / celula_));
+    const int cx = static_cast<int>(std::floor(p.x / celula_));
+    const int cy = static_cast<int>(std::floor(p.y / celula_));
+    const double raio2 = raio * raio;
+    for (int dx = -alcance; dx <= alcance; ++dx) {
+        for (int dy = -alcance; dy <= alcance; ++dy) {
+            auto it = celulas_.find(chave(cx + dx, cy + dy));
+            if (it == celulas_.end()) continue;
+            for (size_t j : it->second) {
+                if (j != i && norma2(agentes[j].pos - p) <= raio2) out.push_back(j);
+            }
+        }
+    }
+    if (out.size() > max) {
+        std::nth_element(out.begin(), out.begin() + max, out.end(), [&](size_t a, size_t b) {
+            return norma2(agentes[a].pos - p) < norma2(agentes[b].pos - p);
+        });
+        out.resize(max);
+    }
+}
+
+// Otimiza sobre a reta n, restrita pelas retas 0..n-1 e pelo disco de raio.
+bool Orca::programa1(const std::vector<Reta>& retas, size_t n, double raio, Vetor2 otima,
+                     bool direcao, Vetor2& res)
+{
+    const Reta& r = retas[n];
+    const double produto = r.ponto * r.direcao;
+    const double discriminante = produto * produto + raio * raio - norma2(r.ponto);
+    if (discriminante < 0.0) return false; // a reta não cruza o disco
+
+    const double raiz = std::sqrt(discriminante);
+    double t_esq = -produto - raiz;
+    double t_dir = -produto + raiz;
+
+    for (size_t i = 0; i < n; ++i) {
+        const double denominador = det(r.direcao, retas[i].direcao);
+        const double numerador = det(retas[i].direcao, r.ponto - retas[i].ponto);
+        if (std::abs(denominador) <= EPS) {
+            if (numerador < 0.0) return false; // paralelas, lado proibido
+            continue;
+        }
+        const double t = numerador / denominador;
+        if (denominador >= 0.0) t_dir = std::min(t_dir, t);
+        else t_esq = std::max(t_esq, t);
+        if (t_esq > t_dir) return false;
+    }
+
+    if (direcao) {
+        res = r.ponto + ((otima * r.direcao > 0.0) ? t_dir : t_esq) * r.direcao;
+    } else {
+        const double t = r.direcao * (otima - r.ponto);
+        res = r.ponto + std::clamp(t, t_esq, t_dir) * r.direcao;
+    }
+    return true;
+}
+
+// Programa linear 2D incremental; retorna o índice da reta que o tornou
+// inviável, ou retas.size() em caso de sucesso.
+size_t Orca::programa2(const std::vector<Reta>& retas, double raio, Vetor2 otima, bool direcao,
+                       Vetor2& res)
+{
+    if (direcao) res = raio * otima;
+    else if (norma2(otima) > raio * raio) res = raio * unitario(otima);
+    else res = otima;
+
+    for (size_t i = 0; i < retas.size(); ++i) {
+        if (det(retas[i].direcao, retas[i].ponto - res) > 0.0) {
+            const Vetor2 anterior = res;
+            if (!programa1(retas, i, raio, otima, direcao, res)) {
+                res = anterior;
+                return i;
+            }
+        }
+    }
+    return retas.size();
+}
+
+// Inviável: minimiza a maior violação a partir da reta "inicio".
+void Orca::programa3(size_t inicio, double raio, Vetor2& res)
+{
+    double distancia = 0.0;
+    for (size_t i = inicio; i < retas_.size(); ++i) {
+        if (det(retas_[i].direcao, retas_[i].ponto - res) <= distancia) continue;
+
+        projetadas_.clear();
+        for (size_t j = 0; j < i; ++j) {
+            Reta reta;
+            const double determinante = det(retas_[i].direcao, retas_[j].direcao);
+            if (std::abs(determinante) <= EPS) {
+                if (retas_[i].direcao * retas_[j].direcao > 0.0) continue; // mesmo sentido
+                reta.ponto = 0.5 * (retas_[i].ponto + retas_[j].ponto);
+            } else {
+                reta.ponto = retas_[i].ponto
+                             + (det(retas_[j].direcao, retas_[i].ponto - retas_[j].ponto) / determinante)
+                                   * retas_[i].direcao;
+            }
+            reta.direcao = unitario(retas_[j].direcao - retas_[i].direcao);
+            projetadas_.push_back(reta);
+        }
+
+        const Vetor2 anterior = res;
+        const Vetor2 normal{-retas_[i].direcao.y, retas_[i].direcao.x};
+        if (programa2(projetadas_, raio, normal, true, res) < projetadas_.size()) {
+            res = anterior; // só por erro numérico; mantém o melhor conhecido
+        }
+        distancia = det(retas_[i].direcao, retas_[i].ponto - res);
+    }
+}
+
+Vetor2 Orca::resolver(const AgenteOrca& a, const std::vector<const AgenteOrca*>& vizinhos)
+{
+    const int64_t t0 = Relogio::mono_ns();
+    const double inv_tau = 1.0 / p_.tau;
+
+    retas_.clear();
+    for (const AgenteOrca* o : vizinhos) {
+        const Vetor2 pos_rel = o->pos - a.pos;
+        const Vetor2 vel_rel = a.vel - o->vel;
+        const double dist2 = norma2(pos_rel);
+        const double raio_comb = a.raio + o->raio;
+        const double raio_comb2 = raio_comb * raio_comb;
+
+        Reta reta;
+        Vetor2 u;
+        if (dist2 > raio_comb2) {
+            // sem colisão: vetor de vel_rel até o cone truncado em tau
+            const Vetor2 w = vel_rel - inv_tau * pos_rel;
+            const double w2 = norma2(w);
+            const double produto = w * pos_rel;
+            if (produto < 0.0 && produto * produto > raio_comb2 * w2) {
+                // projeta no círculo de corte
+                const double w_norma = std::sqrt(w2);
+                const Vetor2 w_unit = (1.0 / w_norma) * w;
+                reta.direcao = {w_unit.y, -w_unit.x};
+                u = (raio_comb * inv_tau - w_norma) * w_unit;
+            } else {
+                // projeta numa das pernas do cone
+                const double perna = std::sqrt(dist2 - raio_comb2);
+                if (det(pos_rel, w) > 0.0) {
+                    reta.direcao = (1.0 / dist2) * Vetor2{pos_rel.x * perna - pos_rel.y * raio_comb,
+                                                          pos_rel.x * raio_comb + pos_rel.y * perna};
+                } else {
+                    reta.direcao = -((1.0 / dist2) * Vetor2{pos_rel.x * perna + pos_rel.y * raio_comb,
+                                                            -pos_rel.x * raio_comb + pos_rel.y * perna});
+                }
+                u = (vel_rel * reta.direcao) * reta.direcao - vel_rel;
+            }
+        } else {
+            // já em colisão: separa dentro de um período de controle
+            const double inv_periodo = 1.0 / p_.periodo;
+            const Vetor2 w = vel_rel - inv_periodo * pos_rel;
+            const double w_norma = norma(w);
+            const Vetor2 w_unit = unitario(w);
+            reta.direcao = {w_unit.y, -w_unit.x};
+            u = (raio_comb * inv_periodo - w_norma) * w_unit;
+        }
+        reta.ponto = a.vel + 0.5 * u; // metade do desvio para cada lado
+        retas_.push_back(reta);
+    }
+
+    Vetor2 res;
+    const size_t falha = programa2(retas_, a.vel_max, a.vel_pref, false, res);
+    if (falha < retas_.size()) {
+        programa3(falha, a.vel_max, res);
+        est_.inviaveis++;
+    }
+
+    const double us = static_cast<double>(Relogio::mono_ns() - t0) / 1e3;
+    est_.solucoes++;
+    est_.max_us = std::max(est_.max_us, us);
+    return res;
+}
+
+void Orca::calcular_lote(const std::vector<AgenteOrca>& agentes, std::vector<Vetor2>& saida)
+{
+    saida.resize(agentes.size());
+    grade_.montar(agentes);
+    for (size_t i = 0; i < agentes.size(); ++i) {
+        grade_.vizinhos(agentes, i, p_.raio_vizinhanca, p_.max_vizinhos, indices_);
+        ponteiros_.clear();
+        for (size_t j : indices_) ponteiros_.push_back(&agentes[j]);
+        saida[i] = resolver(agentes[i], ponteiros_);
+    }
+}
@@ -0,0 +1,278 @@
+/*
+ * Arquivo: PerfContadores.cpp
+ * Finalidade:
+ * Implementação do wrapper de contadores de hardware declarado em
+ * "PerfContadores.h".
+ *
+ * Detalhes:
+ * - Cada thread abre (na primeira leitura) um grupo perf com quatro eventos:
+ * ciclos (líder), instruções, cache misses e branch misses. O grupo é lido
+ * com uma única chamada read() (PERF_FORMAT_GROUP), de forma que os quatro
+ * valores são consistentes entre si.
+ * - O líder é criado com 'pinned' para evitar multiplexação: se a PMU não
+ * comportar o grupo, a leitura falha e a thread cai no fallback (no-op),
+ * em vez de produzir valores escalados imprecisos.
+ * - As acumulações são por par (thread, estágio). Cada thread guarda um cache
+ * local dos ponteiros para suas entradas, então o mutex do registro só é
+ * usado na primeira medição de cada estágio.
+ */
+
+#include "PerfContadores.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr int N_EVENTOS = 4;
+
+// Acumulador de um par (thread, estágio).
+struct AcumEstagio
+{
+    std::string chave; // "thread/estagio"
+    std::atomic<uint64_t> amostras{0};
+    std::atomic<uint64_t> ciclos{0};
+    std::atomic<uint64_t> instrucoes{0};
+    std::atomic<uint64_t> cache_misses{0};
+    std::atomic<uint64_t> branch_misses{0};
+};
+
+struct RegistroPerf
+{
+    std::mutex mtx;
+    std::vector<std::unique_ptr<AcumEstagio>> estagios;
+    std::atomic<int> threads_ok{0};
+    std::atomic<int> threads_falha{0};
+    std::atomic<int> primeiro_erro{0};
+
+    AcumEstagio* obter(const std::string& chave)
+    {
+        std::lock_guard<std::mutex> lg(mtx);
+        for (auto& e : estagios) {
+            if (e->chave == chave) return e.get();
+        }
+        estagios.push_back(std::make_unique<AcumEstagio>());
+        estagios.back()->chave = chave;
+        return estagios.back().get();
+    }
+};
+
+RegistroPerf& registro()
+{
+    static RegistroPerf r;
+    return r;
+}
+
+// Estado por thread: descritores do grupo e cache de estágios.
+struct GrupoThread
+{
+    int fds[N_EVENTOS] = {-1, -1, -1, -1};
+    bool tentado = false;
+    bool ok = false;
+    std::string nome = "thread";
+    std::vector<std::pair<const char*, AcumEstagio*>> cache;
+
+    ~GrupoThread()
+    {
+#ifdef __linux__
+        for (int fd : fds) if (fd >= 0) ::close(fd);
+#endif
+    }
+};
+
+thread_local GrupoThread g_grupo;
+
+#ifdef __linux__
+int abre_evento(uint64_t config, int group_fd)
+{
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1; // permitido com perf_event_paranoid <= 2
+    attr.exclude_hv = 1;
+    if (group_fd == -1) {
+        attr.disabled = 1;
+        attr.pinned = 1;
+    }
+    return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0 /*esta thread*/, -1, group_fd, 0));
+}
+#endif
+
+// Abre o grupo da thread atual (uma única tentativa por thread).
+bool abre_grupo(GrupoThread& g)
+{
+    g.tentado = true;
+#ifdef __linux__
+    static const uint64_t configs[N_EVENTOS] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES,
+    };
+    for (int i = 0; i < N_EVENTOS; ++i) {
+        g.fds[i] = abre_evento(configs[i], i == 0 ? -1 : g.fds[0]);
+        if (g.fds[i] < 0) {
+            int err = errno;
+            int zero = 0;
+            registro().primeiro_erro.compare_exchange_strong(zero, err);
+            for (int j = 0; j < i; ++j) { ::close(g.fds[j]); g.fds[j] = -1; }
+            registro().threads_falha.fetch_add(1);
+            return false;
+        }
+    }
+    ::ioctl(g.fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ::ioctl(g.fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    g.ok = true;
+    registro().threads_ok.fetch_add(1);
+    return true;
+#else
+    registro().threads_falha.fetch_add(1);
+    return false;
+#endif
+}
+
+} // namespace
+
+namespace PerfContadores {
+
+bool habilitado()
+{
+    static const bool h = [] {
+        const char* env = std::getenv("ATR_PERF_COUNTERS");
+        return env && std::strcmp(env, "1") == 0;
+    }();
+    return h;
+}
+
+void nomear_thread(const char* nome)
+{
+    if (g_grupo.nome == nome) return; // chamado a cada iteração pelas tarefas
+    g_grupo.nome = nome;
+    g_grupo.cache.clear(); // chaves dependem do nome da thread
+}
+
+bool ler(LeituraPerf& out)
+{
+    GrupoThread& g = g_grupo;
+    if (!g.tentado) abre_grupo(g);
+    if (!g.ok) return false;
+#ifdef __linux__
+    // Formato PERF_FORMAT_GROUP: { u64 nr; u64 values[nr]; }
+    uint64_t buf[1 + N_EVENTOS];
+    ssize_t n = ::read(g.fds[0], buf, sizeof(buf));
+    if (n != static_cast<ssize_t>(sizeof(buf)) || buf[0] != N_EVENTOS) {
+        // Grupo não escalonável (PMU ocupada) ou erro: desiste nesta thread.
+        g.ok = false;
+        registro().threads_ok.fetch_sub(1);
+        registro().threads_falha.fetch_add(1);
+        return false;
+    }
+    out.ciclos        = buf[1];
+    out.instrucoes    = buf[2];
+    out.cache_misses  = buf[3];
+    out.branch_misses = buf[4];
+    return true;
+#else
+    (void)out;
+    return false;
+#endif
+}
+
+void acumular(const char* estagio, const LeituraPerf& d)
+{
+    GrupoThread& g = g_grupo;
+    AcumEstagio* a = nullptr;
+    for (auto& c : g.cache) {
+        if (c.first == estagio) { a = c.second; break; }
+    }
+    if (!a) {
+        a = registro().obter(g.nome + "/" + estagio);
+        g.cache.emplace_back(estagio, a);
+    }
+    a->amostras.fetch_add(1, std::memory_order_relaxed);
+    a->ciclos.fetch_add(d.ciclos, std::memory_order_relaxed);
+    a->instrucoes.fetch_add(d.instrucoes, std::memory_order_relaxed);
+    a->cache_misses.fetch_add(d.cache_misses, std::memory_order_relaxed);
+    a->branch_misses.fetch_add(d.branch_misses, std::memory_order_relaxed);
+}
+
+bool totais(const std::string& chave, LeituraPerf& soma, uint64_t& amostras)
+{
+    RegistroPerf& r = registro();
+    std::lock_guard<std::mutex> lg(r.mtx);
+    for (const auto& e : r.estagios) {
+        if (e->chave != chave) continue;
+        amostras = e->amostras.load();
+        soma.ciclos = e->ciclos.load();
+        soma.instrucoes = e->instrucoes.load();
+        soma.cache_misses = e->cache_misses.load();
+        soma.branch_misses = e->branch_misses.load();
+        return true;
+    }
+    return false;
+}
+
+std::string relatorio()
+{
+    RegistroPerf& r = registro();
+    std::ostringstream ss;
+    if (!habilitado()) {
+        ss << "contadores de hardware desabilitados (use ATR_PERF_COUNTERS=1)\n";
+        return ss.str();
+    }
+    if (r.threads_ok.load() == 0 && r.threads_falha.load() > 0) {
+        int err = r.primeiro_erro.load();
+        ss << "contadores de hardware indisponíveis"
+           << (err ? std::string(" (") + std::strerror(err) + ")" : std::string())
+           << "; verifique /proc/sys/kernel/perf_event_paranoid\n";
+        return ss.str();
+    }
+
+    std::lock_guard<std::mutex> lg(r.mtx);
+    ss << std::left << std::setw(32) << "thread/estagio"
+       << std::right << std::setw(10) << "amostras"
+       << std::setw(14) << "ciclos/amost"
+       << std::setw(8) << "IPC"
+       << std::setw(12) << "cache_MPKI"
+       << std::setw(12) << "branch_MPKI" << "\n";
+    for (const auto& ep : r.estagios) {
+        const AcumEstagio& e = *ep;
+        uint64_t n = e.amostras.load();
+        if (n == 0) continue;
+        double cic = static_cast<double>(e.ciclos.load());
+        double ins = static_cast<double>(e.instrucoes.load());
+        double ipc = cic > 0.0 ? ins / cic : 0.0;
+        double cmpki = ins > 0.0 ? 1000.0 * static_cast<double>(e.cache_misses.load()) / ins : 0.0;
+        double bmpki = ins > 0.0 ? 1000.0 * static_cast<double>(e.branch_misses.load()) / ins : 0.0;
+        ss << std::left << std::setw(32) << e.chave
+           << std::right << std::setw(10) << n
+           << std::setw(14) << std::fixed << std::setprecision(0) << cic / static_cast<double>(n)
+           << std::setw(8) << std::setprecision(2) << ipc
+           << std::setw(12) << std::setprecision(2) << cmpki
+           << std::setw(12) << std::setprecision(2) << bmpki << "\n";
+    }
+    if (r.threads_falha.load() > 0) {
+        ss << "(" << r.threads_falha.load() << " thread(s) sem contadores disponíveis)\n";
+    }
+    return ss.str();
+}
+
+} // namespace PerfContadores
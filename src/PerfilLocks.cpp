@@ -0,0 +1,220 @@
+/*
+ * Arquivo: PerfilLocks.cpp
+ * Finalidade:
+ * Implementação do MutexInstrumentado e do RegistroLocks declarados em
+ * "PerfilLocks.h".
+ *
+ * Caminho quente (lock):
+ * - Primeiro tenta try_lock(). Se conseguir, a aquisição não teve contenção e
+ * só custa um incremento atômico e uma leitura do relógio.
+ * - Se falhar, mede o tempo bloqueado em lock() e contabiliza a contenção.
+ * - O instante da aquisição é guardado no próprio mutex (só a thread dona o
+ * lê/escreve) para calcular o tempo de posse em unlock().
+ *
+ * Relatórios:
+ * - Percentis (p50/p99) são estimados pelo limite superior do bucket do
+ * histograma logarítmico, o que basta para comparar locks entre si.
+ */
+
+#include "PerfilLocks.h"
+#include "Relogio.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+
+namespace {
+
+uint64_t agora_ns()
+{
+    return static_cast<uint64_t>(Relogio::mono_ns());
+}
+
+void atualiza_max(std::atomic<uint64_t>& m, uint64_t v)
+{
+    uint64_t cur = m.load(std::memory_order_relaxed);
+    while (v > cur && !m.compare_exchange_weak(cur, v, std::memory_order_relaxed)) {}
+}
+
+} // namespace
+
+// ---------------- EstatisticasLock ----------------
+
+int EstatisticasLock::bucket_de(uint64_t ns)
+{
+    int b = 0;
+    while (ns > 1 && b < N_BUCKETS - 1) { ns >>= 1; ++b; }
+    return b;
+}
+
+uint64_t EstatisticasLock::percentil(const Histograma& h, double p)
+{
+    uint64_t total = 0;
+    for (const auto& b : h) total += b.load(std::memory_order_relaxed);
+    if (total == 0) return 0;
+    uint64_t alvo = static_cast<uint64_t>(p * static_cast<double>(total));
+    uint64_t acc = 0;
+    for (int i = 0; i < N_BUCKETS; ++i) {
+        acc += h[i].load(std::memory_order_relaxed);
+        if (acc > alvo) return (uint64_t{1} << (i + 1));
+    }
+    return uint64_t{1} << N_BUCKETS;
+}
+
+void EstatisticasLock::registrar_espera(uint64_t ns)
+{
+    espera_total_ns.fetch_add(ns, std::memory_order_relaxed);
+    hist_espera[bucket_de(ns)].fetch_add(1, std::memory_order_relaxed);
+    atualiza_max(espera_max_ns, ns);
+}
+
+void EstatisticasLock::registrar_posse(uint64_t ns)
+{
+    posse_total_ns.fetch_add(ns, std::memory_order_relaxed);
+    hist_posse[bucket_de(ns)].fetch_add(1, std::memory_order_relaxed);
+    atualiza_max(posse_max_ns, ns);
+}
+
+// ---------------- RegistroLocks ----------------
+
+RegistroLocks::RegistroLocks()
+{
+    // ATR_LOCK_PROFILE=0 desliga a coleta sem precisar recompilar.
+    const char* env = std::getenv("ATR_LOCK_PROFILE");
+    if (env && std::strcmp(env, "0") == 0) ativo_.store(false);
+}
+
+RegistroLocks& RegistroLocks::instancia()
+{
+    static RegistroLocks reg;
+    return reg;
+}
+
+EstatisticasLock* RegistroLocks::obter(const std::string& nome)
+{
+    std::lock_guard<std::mutex> lg(mtx_);
+    for (auto& s : stats_) {
+        if (s->nome == nome) return s.get();
+    }
+    stats_.push_back(std::make_unique<EstatisticasLock>());
+    stats_.back()->nome = nome;
+    return stats_.back().get();
+}
+
+std::string RegistroLocks::relatorio_json() const
+{
+    std::lock_guard<std::mutex> lg(mtx_);
+    std::ostringstream ss;
+    ss << "[";
+    bool primeiro = true;
+    for (const auto& sp : stats_) {
+        const EstatisticasLock& s = *sp;
+        uint64_t aq = s.aquisicoes.load(std::memory_order_relaxed);
+        if (aq == 0) continue; // nomes provisórios (ex.: "anonimo") nunca usados
+        if (!primeiro) ss << ",";
+        primeiro = false;
+        ss << "{"
+           << "\"nome\":\"" << s.nome << "\","
+           << "\"aq\":" << aq << ","
+           << "\"cont\":" << s.contendidas.load(std::memory_order_relaxed) << ","
+           << "\"espera_total_ns\":" << s.espera_total_ns.load(std::memory_order_relaxed) << ","
+           << "\"espera_p50_ns\":" << EstatisticasLock::percentil(s.hist_espera, 0.50) << ","
+           << "\"espera_p99_ns\":" << EstatisticasLock::percentil(s.hist_espera, 0.99) << ","
+           << "\"espera_max_ns\":" << s.espera_max_ns.load(std::memory_order_relaxed) << ","
+           << "\"posse_total_ns\":" << s.posse_total_ns.load(std::memory_order_relaxed) << ","
+           << "\"posse_p50_ns\":" << EstatisticasLock::percentil(s.hist_posse, 0.50) << ","
+           << "\"posse_p99_ns\":" << EstatisticasLock::percentil(s.hist_posse, 0.99) << ","
+           << "\"posse_max_ns\":" << s.posse_max_ns.load(std::memory_order_relaxed)
+           << "}";
+    }
+    ss << "]";
+    return ss.str();
+}
+
+std::string RegistroLocks::relatorio_texto() const
+{
+    std::lock_guard<std::mutex> lg(mtx_);
+    std::ostringstream ss;
+    ss << std::left << std::setw(24) << "lock"
+       << std::right << std::setw(12) << "aquisicoes"
+       << std::setw(10) << "cont(%)"
+       << std::setw(14) << "esp_p99(ns)"
+       << std::setw(14) << "esp_max(ns)"
+       << std::setw(14) << "pos_p99(ns)"
+       << std::setw(14) << "pos_max(ns)" << "\n";
+    for (const auto& sp : stats_) {
+        const EstatisticasLock& s = *sp;
+        uint64_t aq = s.aquisicoes.load(std::memory_order_relaxed);
+        if (aq == 0) continue;
+        uint64_t ct = s.contendidas.load(std::memory_order_relaxed);
+        double pct = aq ? 100.0 * static_cast<double>(ct) / static_cast<double>(aq) : 0.0;
+        ss << std::left << std::setw(24) << s.nome
+           << std::right << std::setw(12) << aq
+           << std::setw(10) << std::fixed << std::setprecision(2) << pct
+           << std::setw(14) << EstatisticasLock::percentil(s.hist_espera, 0.99)
+           << std::setw(14) << s.espera_max_ns.load(std::memory_order_relaxed)
+           << std::setw(14) << EstatisticasLock::percentil(s.hist_posse, 0.99)
+           << std::setw(14) << s.posse_max_ns.load(std::memory_order_relaxed) << "\n";
+    }
+    return ss.str();
+}
+
+// ---------------- MutexInstrumentado ----------------
+
+MutexInstrumentado::MutexInstrumentado(const char* nome)
+    : st_(RegistroLocks::instancia().obter(nome))
+{
+}
+
+void MutexInstrumentado::set_nome(const char* nome)
+{
+    st_ = RegistroLocks::instancia().obter(nome);
+}
+
+void MutexInstrumentado::lock()
+{
+    if (!RegistroLocks::instancia().ativo()) {
+        m_.lock();
+        t_aquisicao_ns_ = 0; // unlock() não contabiliza posse
+        return;
+    }
+    if (m_.try_lock()) {
+        // Sem contenção: espera nula
+        t_aquisicao_ns_ = agora_ns();
+        st_->aquisicoes.fetch_add(1, std::memory_order_relaxed);
+        st_->registrar_espera(0);
+        return;
+    }
+    uint64_t t0 = agora_ns();
+    m_.lock();
+    uint64_t t1 = agora_ns();
+    t_aquisicao_ns_ = t1;
+    st_->aquisicoes.fetch_add(1, std::memory_order_relaxed);
+    st_->contendidas.fetch_add(1, std::memory_order_relaxed);
+    st_->registrar_espera(t1 - t0);
+}
+
+bool MutexInstrumentado::try_lock()
+{
+    if (!m_.try_lock()) return false;
+    if (RegistroLocks::instancia().ativo()) {
+        t_aquisicao_ns_ = agora_ns();
+        st_->aquisicoes.fetch_add(1, std::memory_order_relaxed);
+        st_->registrar_espera(0);
+    } else {
+        t_aquisicao_ns_ = 0;
+    }
+    return true;
+}
+
+void MutexInstrumentado::unlock()
+{
+    // Calcula a posse antes de liberar (depois, o campo pertence a outra thread).
+    if (t_aquisicao_ns_ != 0) {
+        uint64_t posse = agora_ns() - t_aquisicao_ns_;
+        t_aquisicao_ns_ = 0;
+        st_->registrar_posse(posse);
+    }
+    m_.unlock();
+}
@@ -0,0 +1,65 @@
+/*
+ * Arquivo: PoliticaRitmo.cpp
+ * Finalidade:
+ * Implementação da escolha de regime declarada em "PoliticaRitmo.h".
+ */
+
+#include "PoliticaRitmo.h"
+
+#include <cmath>
+
+const char* nome_regime(RegimeRitmo r)
+{
+    switch (r) {
+    case RegimeRitmo::Hibernando: return "hibernando";
+    case RegimeRitmo::Reta: return "reta";
+    case RegimeRitmo::Normal: return "normal";
+    case RegimeRitmo::Atencao: return "atencao";
+    }
+    return "?";
+}
+
+RegimeRitmo PoliticaRitmo::avaliar(const EntradaRitmo& e, uint64_t agora, uint64_t ultimo_despertar)
+{
+    if (!tem_ancora_ || std::hypot(e.x - ancora_x_, e.y - ancora_y_) > RAIO_PARADO) {
+        ancora_x_ = e.x;
+        ancora_y_ = e.y;
+        ancora_desde_ = agora;
+        tem_ancora_ = true;
+    }
+    const bool parado = agora - ancora_desde_ >= PARADO_MS;
+    const bool movendo = e.velocidade > VEL_MOVENDO;
+
+    if (e.defeito) {
+        calmo_ = false;
+        return RegimeRitmo::Normal;
+    }
+
+    const bool atencao = (e.dist_alvo > RAIO_NO_ALVO && e.dist_alvo <= RAIO_ALVO)
+                         || (e.dist_vizinho >= 0.0 && e.dist_vizinho <= RAIO_VIZINHO)
+                         || (movendo && e.dist_borda <= RAIO_BORDA);
+    if (atencao) {
+        calmo_ = false;
+        return RegimeRitmo::Atencao;
+    }
+
+    RegimeRitmo calmo = RegimeRitmo::Normal;
+    if (!e.automatico) {
+        if (!e.comandos_ativos && parado && agora - ultimo_despertar >= PARADO_MS) calmo = RegimeRitmo::Hibernando;
+    } else if ((e.dist_alvo > DIST_RETA && std::abs(e.erro_rumo) <= ERRO_RUMO_RETA)
+               || (e.dist_alvo >= 0.0 && e.dist_alvo <= RAIO_NO_ALVO && !movendo)) {
+        calmo = RegimeRitmo::Reta;
+    }
+    if (calmo == RegimeRitmo::Normal) {
+        calmo_ = false;
+        return RegimeRitmo::Normal;
+    }
+    if (!calmo_ || alvo_calmo_ != calmo) {
+        calmo_ = true;
+        alvo_calmo_ = calmo;
+        calmo_desde_ = agora;
+    }
+    // a hibernação já exigiu PARADO_MS parado; a reta precisa se manter estável
+    if (calmo == RegimeRitmo::Reta && agora - calmo_desde_ < ESTAVEL_MS) return RegimeRitmo::Normal;
+    return calmo;
+}
@@ -0,0 +1,235 @@
+/*
+ * Arquivo: Reator.cpp
+ * Finalidade:
+ * Implementação do laço de eventos declarado em "Reator.h".
+ *
+ * Detalhes:
+ * - O timerfd usa tempo absoluto (TFD_TIMER_ABSTIME) em CLOCK_MONOTONIC, a
+ * mesma base de std::chrono::steady_clock. Ele só é rearmado quando o prazo
+ * mais próximo do heap muda; timerfd_settime() é thread-safe e acorda o
+ * epoll_wait por conta própria, então agendar de outra thread não precisa do
+ * eventfd.
+ * - Os callbacks (temporizadores, descritores, sinais) rodam na thread do
+ * reator, fora do mutex; devem ser curtos (tipicamente apenas agendam uma
+ * corrotina no Executor).
+ */
+
+#include "Reator.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace {
+
+bool depois(const auto& a, const auto& b)
+{
+    return a.quando != b.quando ? a.quando > b.quando : a.ordem > b.ordem;
+}
+
+itimerspec para_itimerspec(Reator::Relogio::time_point t)
+{
+    itimerspec its{};
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+    if (ns <= 0) ns = 1; // zero desarmaria o timer
+    its.it_value.tv_sec = static_cast<time_t>(ns / 1000000000);
+    its.it_value.tv_nsec = static_cast<long>(ns % 1000000000);
+    return its;
+}
+
+} // namespace
+
+Reator::Reator()
+{
+    epfd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    timerfd_ = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    eventfd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epfd_ < 0 || timerfd_ < 0 || eventfd_ < 0) {
+        std::cerr << "[Reator] falha ao criar descritores: " << std::strerror(errno) << "\n";
+        return;
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = timerfd_;
+    ::epoll_ctl(epfd_, EPOLL_CTL_ADD, timerfd_, &ev);
+    ev.data.fd = eventfd_;
+    ::epoll_ctl(epfd_, EPOLL_CTL_ADD, eventfd_, &ev);
+}
+
+Reator::~Reator()
+{
+    sair_.store(true);
+    if (eventfd_ >= 0) {
+        uint64_t um = 1;
+        (void)!::write(eventfd_, &um, sizeof(um));
+    }
+    if (thread_.joinable()) thread_.join();
+    for (int fd : {signalfd_, eventfd_, timerfd_, epfd_}) {
+        if (fd >= 0) ::close(fd);
+    }
+}
+
+void Reator::iniciar()
+{
+    if (!thread_.joinable()) thread_ = std::thread(&Reator::laco, this);
+}
+
+void Reator::agendar_em(Relogio::time_point quando, std::function<void()> fn)
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        // parado_ é lido sob o mutex: ou o temporizador entra no heap antes do
+        // disparo geral de parar(), ou é executado aqui mesmo.
+        if (!parado_.load()) {
+            timers_.push_back(Temporizador{quando, ordem_++, std::move(fn)});
+            std::push_heap(timers_.begin(), timers_.end(), [](const auto& a, const auto& b) { return depois(a, b); });
+            rearmar_timerfd();
+            return;
+        }
+    }
+    fn();
+}
+
+void Reator::a_cada(Relogio::duration periodo, std::function<void()> fn)
+{
+    agendar_em(Relogio::now() + periodo, [this, periodo, fn]() {
+        if (parado_.load()) return;
+        fn();
+        a_cada(periodo, fn);
+    });
+}
+
+bool Reator::observar_fd(int fd, uint32_t eventos, std::function<void(uint32_t)> cb)
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        fds_[fd] = std::move(cb);
+    }
+    epoll_event ev{};
+    ev.events = eventos;
+    ev.data.fd = fd;
+    if (::epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev) < 0 && ::epoll_ctl(epfd_, EPOLL_CTL_MOD, fd, &ev) < 0) {
+        std::cerr << "[Reator] epoll_ctl(" << fd << "): " << std::strerror(errno) << "\n";
+        return false;
+    }
+    return true;
+}
+
+void Reator::remover_fd(int fd)
+{
+    ::epoll_ctl(epfd_, EPOLL_CTL_DEL, fd, nullptr);
+    std::lock_guard<std::mutex> lk(mtx_);
+    fds_.erase(fd);
+}
+
+bool Reator::tratar_sinais(std::initializer_list<int> sinais, std::function<void(int)> cb)
+{
+    sigset_t mask;
+    sigemptyset(&mask);
+    for (int s : sinais) sigaddset(&mask, s);
+    // Bloqueia a entrega assíncrona; os sinais ficam pendentes e são lidos pelo signalfd.
+    if (::pthread_sigmask(SIG_BLOCK, &mask, nullptr) != 0) return false;
+    signalfd_ = ::signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (signalfd_ < 0) {
+        std::cerr << "[Reator] signalfd: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    cb_sinal_ = std::move(cb);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = signalfd_;
+    return ::epoll_ctl(epfd_, EPOLL_CTL_ADD, signalfd_, &ev) == 0;
+}
+
+void Reator::parar()
+{
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        if (parado_.exchange(true)) return;
+    }
+    cv_parada_.notify_all();
+    disparar_vencidos(true); // acorda agora quem está em after()/pop_for()
+}
+
+void Reator::aguardar_parada()
+{
+    std::unique_lock<std::mutex> lk(mtx_);
+    cv_parada_.wait(lk, [this] { return parado_.load(); });
+}
+
+void Reator::rearmar_timerfd()
+{
+    if (timers_.empty()) return; // um disparo extra é inofensivo
+    Relogio::time_point prox = timers_.front().quando;
+    if (armado_ != Relogio::time_point{} && armado_ <= prox) return;
+    itimerspec its = para_itimerspec(prox);
+    ::timerfd_settime(timerfd_, TFD_TIMER_ABSTIME, &its, nullptr);
+    armado_ = prox;
+}
+
+void Reator::disparar_vencidos(bool todos)
+{
+    auto agora = Relogio::now();
+    while (true) {
+        std::function<void()> fn;
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            if (timers_.empty() || (!todos && timers_.front().quando > agora)) {
+                armado_ = Relogio::time_point{};
+                rearmar_timerfd();
+                return;
+            }
+            std::pop_heap(timers_.begin(), timers_.end(), [](const auto& a, const auto& b) { return depois(a, b); });
+            fn = std::move(timers_.back().fn);
+            timers_.pop_back();
+        }
+        fn();
+    }
+}
+
+void Reator::laco()
+{
+    epoll_event eventos[16];
+    while (!sair_.load()) {
+        int n = ::epoll_wait(epfd_, eventos, 16, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "[Reator] epoll_wait: " << std::strerror(errno) << "\n";
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            int fd = eventos[i].data.fd;
+            if (fd == timerfd_) {
+                uint64_t expiracoes;
+                (void)!::read(timerfd_, &expiracoes, sizeof(expiracoes));
+                disparar_vencidos(false);
+            } else if (fd == eventfd_) {
+                uint64_t v;
+                (void)!::read(eventfd_, &v, sizeof(v));
+            } else if (fd == signalfd_) {
+                signalfd_siginfo si;
+                while (::read(signalfd_, &si, sizeof(si)) == static_cast<ssize_t>(sizeof(si))) {
+                    if (cb_sinal_) cb_sinal_(static_cast<int>(si.ssi_signo));
+                }
+            } else {
+                std::function<void(uint32_t)> cb;
+                {
+                    std::lock_guard<std::mutex> lk(mtx_);
+                    auto it = fds_.find(fd);
+                    if (it != fds_.end()) cb = it->second;
+                }
+                if (cb) cb(eventos[i].events);
+            }
+        }
+    }
+}
@@ -0,0 +1,130 @@
+/*
+ * Arquivo: ReconstrucaoPosicao.cpp
+ * Finalidade:
+ * Implementação do modelo de extrapolação de posição declarado em
+ * "ReconstrucaoPosicao.h".
+ */
+
+#include "ReconstrucaoPosicao.h"
+#include "JsonSimples.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+constexpr double GRAUS_PARA_RAD = M_PI / 180.0;
+
+double uma_casa(double v)
+{
+    return std::round(v * 10.0) / 10.0;
+}
+
+} // namespace
+
+EstadoPosicao extrapolar(const EstadoPosicao& e, double dt_s)
+{
+    EstadoPosicao r = e;
+    r.t_ms = e.t_ms + static_cast<uint64_t>(std::max(0.0, dt_s) * 1000.0);
+    if (!e.com_modelo || dt_s <= 0.0) return r;
+
+    const double r0 = e.rumo * GRAUS_PARA_RAD;
+    const double w = e.taxa * GRAUS_PARA_RAD;
+    if (std::abs(w) < 1e-6) {
+        r.x = e.x + e.v * std::cos(r0) * dt_s;
+        r.y = e.y + e.v * std::sin(r0) * dt_s;
+    } else {
+        const double r1 = r0 + w * dt_s;
+        r.x = e.x + e.v / w * (std::sin(r1) - std::sin(r0));
+        r.y = e.y + e.v / w * (std::cos(r0) - std::cos(r1));
+    }
+    r.rumo = e.rumo + e.taxa * dt_s;
+    return r;
+}
+
+EstadoPosicao quantizar(const EstadoPosicao& e)
+{
+    EstadoPosicao q = e;
+    q.x = std::round(e.x);
+    q.y = std::round(e.y);
+    q.v = uma_casa(e.v);
+    q.rumo = uma_casa(e.rumo);
+    q.taxa = uma_casa(e.taxa);
+    return q;
+}
+
+std::string serializar_posicao(const EstadoPosicao& e, int ang)
+{
+    const EstadoPosicao q = quantizar(e);
+    std::ostringstream ss;
+    ss << "{"
+       << "\"x\":" << static_cast<long>(q.x) << ","
+       << "\"y\":" << static_cast<long>(q.y) << ","
+       << "\"ang\":" << ang << ","
+       << "\"t\":" << q.t_ms << ",";
+    ss << std::fixed << std::setprecision(1)
+       << "\"v\":" << q.v << ","
+       << "\"rumo\":" << q.rumo << ","
+       << "\"w\":" << q.taxa
+       << "}";
+    return ss.str();
+}
+
+bool desserializar_posicao(const std::string& pl, EstadoPosicao& e)
+{
+    EstadoPosicao r;
+    if (!numero_json(pl, "x", r.x) || !numero_json(pl, "y", r.y)) return false;
+    double t = 0.0;
+    if (numero_json(pl, "t", t)) r.t_ms = static_cast<uint64_t>(t);
+    r.com_modelo = numero_json(pl, "v", r.v) && numero_json(pl, "rumo", r.rumo) && numero_json(pl, "w", r.taxa);
+    e = r;
+    return true;
+}
+
+SupressorPosicao::SupressorPosicao(double tolerancia_px, uint64_t intervalo_max_ms)
+    : tolerancia_(tolerancia_px), intervalo_max_(intervalo_max_ms)
+{
+}
+
+bool SupressorPosicao::avaliar(const EstadoPosicao& real)
+{
+    bool publicar = !tem_base_ || tolerancia_ <= 0.0 || real.t_ms < base_.t_ms
+                    || real.t_ms - base_.t_ms >= intervalo_max_;
+    if (!publicar) {
+        const EstadoPosicao pred = extrapolar(base_, (real.t_ms - base_.t_ms) / 1000.0);
+        publicar = std::hypot(real.x - pred.x, real.y - pred.y) > tolerancia_;
+    }
+    if (!publicar) {
+        ++suprimidas_;
+        return false;
+    }
+    base_ = quantizar(real);
+    base_.com_modelo = true;
+    tem_base_ = true;
+    ++enviadas_;
+    return true;
+}
+
+void ReconstrutorPosicao::atualizar(const EstadoPosicao& e, uint64_t t_local_ms)
+{
+    ultima_ = e;
+    t_local_ = t_local_ms;
+    valido_ = true;
+}
+
+bool ReconstrutorPosicao::atualizar(const std::string& payload, uint64_t t_local_ms)
+{
+    EstadoPosicao e;
+    if (!desserializar_posicao(payload, e)) return false;
+    atualizar(e, t_local_ms);
+    return true;
+}
+
+EstadoPosicao ReconstrutorPosicao::em(uint64_t t_local_ms) const
+{
+    if (!valido_ || t_local_ms <= t_local_) return ultima_;
+    const uint64_t dt = std::min(t_local_ms - t_local_, HORIZONTE_MAX_MS);
+    return extrapolar(ultima_, dt / 1000.0);
+}
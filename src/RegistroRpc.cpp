@@ -0,0 +1,81 @@
+/*
+ * Arquivo: RegistroRpc.cpp
+ * Finalidade:
+ * Implementação do registro de métodos RPC declarado em "RegistroRpc.h".
+ *
+ * Detalhes:
+ * - O registro só é usado pela corrotina do servidor (uma por processo),
+ * então não tem mutex; os manipuladores leem estado compartilhado pelos
+ * mecanismos já existentes (atômicos, snapshot, KPI).
+ */
+
+#include "RegistroRpc.h"
+#include "JsonSimples.h"
+
+#include <exception>
+#include <sstream>
+
+void RegistroRpc::registrar(const std::string& metodo, Manipulador fn)
+{
+    metodos_[metodo] = std::move(fn);
+}
+
+bool RegistroRpc::tratar(const std::string& pedido, int64_t agora_ms, std::string& topico_resposta,
+                         std::string& resposta)
+{
+    topico_resposta.clear();
+    texto_json(pedido, "resposta", topico_resposta);
+    if (topico_resposta.empty()) return false; // ninguém para responder
+
+    std::string id;
+    texto_json(pedido, "id", id);
+    long prazo = 0;
+    if (inteiro_json(pedido, "prazo", prazo) && prazo < agora_ms) { ++vencidos_; return false; }
+
+    std::string metodo;
+    texto_json(pedido, "metodo", metodo);
+
+    const ChaveGuardada chave{topico_resposta, id};
+    if (!id.empty()) {
+        auto it = guardadas_.find(chave);
+        if (it != guardadas_.end() && it->second.metodo == metodo) {
+            ++repetidos_;
+            resposta = it->second.resposta;
+            return true;
+        }
+    }
+    std::string params = valor_json(pedido, "params");
+    if (params.empty()) params = "{}";
+
+    RespostaRpc r;
+    auto m = metodos_.find(metodo);
+    if (m == metodos_.end()) {
+        r = RespostaRpc::falha("metodo desconhecido: " + metodo);
+    } else {
+        try {
+            r = m->second(params);
+        } catch (const std::exception& e) {
+            r = RespostaRpc::falha(std::string("excecao: ") + e.what());
+        } catch (...) {
+            r = RespostaRpc::falha("excecao desconhecida");
+        }
+    }
+
+    std::ostringstream ss;
+    ss << "{\"id\":\"" << json_escapar(id) << "\",\"ok\":" << (r.ok ? "true" : "false");
+    if (r.ok) ss << ",\"resultado\":" << (r.valor.empty() ? "null" : r.valor) << "}";
+    else ss << ",\"erro\":\"" << json_escapar(r.valor) << "\"}";
+    resposta = ss.str();
+    ++atendidos_;
+
+    if (!id.empty()) {
+        // Mesmo id com outro método substitui a entrada sem mudar sua posição.
+        if (guardadas_.insert_or_assign(chave, Guardada{metodo, resposta}).second)
+            ordem_guardadas_.push_back(chave);
+        if (ordem_guardadas_.size() > MAX_RESPOSTAS_GUARDADAS) {
+            guardadas_.erase(ordem_guardadas_.front());
+            ordem_guardadas_.pop_front();
+        }
+    }
+    return true;
+}
@@ -0,0 +1,213 @@
+/*
+ * Arquivo: Relogio.cpp
+ * Finalidade:
+ * Implementação da calibração e do caminho lento do serviço de relógio
+ * declarado em "Relogio.h".
+ *
+ * Detalhes:
+ * - Cada par (TSC, CLOCK_MONOTONIC) é o de menor intervalo entre algumas
+ * tentativas, para a preempção entre as duas leituras não entrar na taxa.
+ * - A taxa (mult) é calculada em 128 bits: a base da recalibração cresce
+ * sem limite e (ns << SHIFT) estoura 64 bits depois de ~4 s.
+ * - A recalibração usa um atomic_flag como try-lock: quem chega enquanto
+ * outra thread recalibra segue com os parâmetros atuais. Não usa MutexAtr
+ * porque o perfil de locks (PerfilLocks.h) mede o tempo com este relógio.
+ */
+
+#include "Relogio.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace {
+
+constexpr int64_t CALIBRACAO_INICIAL_NS = 5000000; // 5 ms
+constexpr int TENTATIVAS = 5;
+
+std::mutex mtx_calibrar;                    // só a calibração inicial
+std::atomic_flag recalibrando = ATOMIC_FLAG_INIT;
+uint64_t ancora_tsc = 0;                    // primeira calibração (base longa)
+int64_t ancora_ns = 0;
+std::atomic<int64_t> ultima_recalibracao{0}; // fonte vDSO
+
+int64_t ler(clockid_t c)
+{
+    timespec ts;
+    clock_gettime(c, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+uint64_t ler_tsc()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+bool tsc_invariante()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned a, b, c, d;
+    if (!__get_cpuid(0x80000000, &a, &b, &c, &d) || a < 0x80000007) return false;
+    if (!__get_cpuid(0x80000007, &a, &b, &c, &d)) return false;
+    return (d & (1u << 8)) != 0;
+#else
+    return false;
+#endif
+}
+
+// Par (tsc, mono) com o menor intervalo entre as leituras do TSC.
+void par_tsc_mono(uint64_t& tsc, int64_t& mono)
+{
+    uint64_t melhor = UINT64_MAX;
+    for (int i = 0; i < TENTATIVAS; ++i) {
+        const uint64_t t0 = ler_tsc();
+        const int64_t m = ler(CLOCK_MONOTONIC);
+        const uint64_t t1 = ler_tsc();
+        if (t1 - t0 < melhor) {
+            melhor = t1 - t0;
+            tsc = t0 + (t1 - t0) / 2;
+            mono = m;
+        }
+    }
+}
+
+// CLOCK_REALTIME - CLOCK_MONOTONIC, pela leitura mais justa entre tentativas.
+int64_t medir_parede_menos_mono()
+{
+    int64_t melhor = INT64_MAX, r = 0;
+    for (int i = 0; i < TENTATIVAS; ++i) {
+        const int64_t m0 = ler(CLOCK_MONOTONIC);
+        const int64_t p = ler(CLOCK_REALTIME);
+        const int64_t m1 = ler(CLOCK_MONOTONIC);
+        if (m1 - m0 < melhor) {
+            melhor = m1 - m0;
+            r = p - (m0 + (m1 - m0) / 2);
+        }
+    }
+    return r;
+}
+
+uint64_t calcular_mult(uint64_t tsc0, int64_t ns0, uint64_t tsc1, int64_t ns1, int shift)
+{
+    if (tsc1 <= tsc0 || ns1 <= ns0) return 0;
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(ns1 - ns0) << shift) / (tsc1 - tsc0));
+}
+
+} // namespace
+
+void Relogio::calibrar()
+{
+    std::lock_guard<std::mutex> lk(mtx_calibrar);
+    if (fonte_.load(std::memory_order_acquire) != FONTE_NENHUMA) return;
+
+    parede_menos_mono_.store(medir_parede_menos_mono(), std::memory_order_relaxed);
+    const char* env = std::getenv("ATR_RELOGIO");
+    const bool forcar_vdso = env && std::string(env) == "vdso";
+    if (forcar_vdso || !tsc_invariante()) {
+        ultima_recalibracao.store(ler(CLOCK_MONOTONIC), std::memory_order_relaxed);
+        fonte_.store(FONTE_VDSO, std::memory_order_release);
+        return;
+    }
+
+    uint64_t tsc0, tsc1;
+    int64_t ns0, ns1;
+    par_tsc_mono(tsc0, ns0);
+    while (ler(CLOCK_MONOTONIC) - ns0 < CALIBRACAO_INICIAL_NS) { }
+    par_tsc_mono(tsc1, ns1);
+    const uint64_t mult = calcular_mult(tsc0, ns0, tsc1, ns1, SHIFT);
+    if (mult == 0) { // TSC parado/para trás: não confiável
+        fonte_.store(FONTE_VDSO, std::memory_order_release);
+        return;
+    }
+    ancora_tsc = tsc0;
+    ancora_ns = ns0;
+    versao_.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    base_tsc_.store(tsc1, std::memory_order_relaxed);
+    base_ns_.store(ns1, std::memory_order_relaxed);
+    mult_.store(mult, std::memory_order_relaxed);
+    versao_.store(2, std::memory_order_release);
+    fonte_.store(FONTE_TSC, std::memory_order_release);
+}
+
+void Relogio::recalibrar()
+{
+    const int fonte = fonte_.load(std::memory_order_acquire);
+    if (fonte == FONTE_NENHUMA) {
+        calibrar();
+        return;
+    }
+    if (recalibrando.test_and_set(std::memory_order_acquire)) return;
+
+    if (fonte == FONTE_TSC) {
+        uint64_t tsc;
+        int64_t ns;
+        par_tsc_mono(tsc, ns);
+        const uint64_t mult_antigo = mult_.load(std::memory_order_relaxed);
+        const uint64_t base_tsc = base_tsc_.load(std::memory_order_relaxed);
+        const int64_t atual = base_ns_.load(std::memory_order_relaxed)
+                              + static_cast<int64_t>((static_cast<__int128>(static_cast<int64_t>(tsc - base_tsc))
+                                                      * mult_antigo) >> SHIFT);
+        const uint64_t mult = calcular_mult(ancora_tsc, ancora_ns, tsc, ns, SHIFT);
+        if (mult != 0) {
+            // adiantado, segura a âncora (nunca volta); atrasado, salta para o monotônico
+            const uint32_t v = versao_.load(std::memory_order_relaxed);
+            versao_.store(v + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            base_tsc_.store(tsc, std::memory_order_relaxed);
+            base_ns_.store(std::max(atual, ns), std::memory_order_relaxed);
+            mult_.store(mult, std::memory_order_relaxed);
+            versao_.store(v + 2, std::memory_order_release);
+        }
+    } else {
+        ultima_recalibracao.store(ler(CLOCK_MONOTONIC), std::memory_order_relaxed);
+    }
+    parede_menos_mono_.store(medir_parede_menos_mono(), std::memory_order_relaxed);
+    recalibrando.clear(std::memory_order_release);
+}
+
+int64_t Relogio::mono_lento()
+{
+    int fonte = fonte_.load(std::memory_order_acquire);
+    if (fonte == FONTE_NENHUMA) {
+        calibrar();
+        fonte = fonte_.load(std::memory_order_acquire);
+    }
+    if (fonte == FONTE_TSC) return mono_ns();
+    const int64_t ns = ler(CLOCK_MONOTONIC);
+    if (ns - ultima_recalibracao.load(std::memory_order_relaxed) > RECALIBRA_NS) recalibrar();
+    return ns;
+}
+
+Relogio::Fonte Relogio::fonte()
+{
+    if (fonte_.load(std::memory_order_acquire) == FONTE_NENHUMA) calibrar();
+    return fonte_.load(std::memory_order_relaxed) == FONTE_TSC ? Fonte::Tsc : Fonte::Vdso;
+}
+
+std::string Relogio::resumo()
+{
+    std::ostringstream ss;
+    ss << "[Relogio] fonte ";
+    if (fonte() == Fonte::Tsc) {
+        const double ghz = static_cast<double>(uint64_t{1} << SHIFT) / mult_.load(std::memory_order_relaxed);
+        ss << "tsc (" << std::fixed << std::setprecision(4) << ghz << " GHz)";
+    } else {
+        ss << "vdso (clock_gettime)";
+    }
+    ss << std::fixed << std::setprecision(3) << ", parede - monotônico = "
+       << parede_menos_mono_.load(std::memory_order_relaxed) / 1e9 << " s";
+    return ss.str();
+}
@@ -0,0 +1,120 @@
+/*
+ * Arquivo: RitmoAdaptativo.cpp
+ * Finalidade:
+ * Implementação do ritmo adaptativo declarado em "RitmoAdaptativo.h".
+ *
+ * Detalhes:
+ * - pausa() guarda a geração de despertar no momento em que é criada: um
+ * despertar entre a criação e a suspensão faz a pausa terminar na hora.
+ * - As esperas pendentes ficam em esperas_ até o despertar ou o timeout;
+ * EsperaAssincrona::reivindicar() garante uma única retomada.
+ */
+
+#include "RitmoAdaptativo.h"
+#include "Relogio.h"
+
+#include <algorithm>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+RitmoCaminhao::RitmoCaminhao(bool ativo)
+    : ativo_(ativo)
+{
+    nomear_lock(mtx_, "RitmoCaminhao::mtx_");
+}
+
+void RitmoCaminhao::definir(RegimeRitmo r)
+{
+    if (!ativo_ || r == regime_.load(std::memory_order_relaxed)) return;
+    std::lock_guard<MutexAtr> lk(mtx_);
+    const RegimeRitmo anterior = regime_.load(std::memory_order_relaxed);
+    if (r == anterior) return;
+    const auto agora = Relogio::now();
+    tempo_ms_[static_cast<int>(anterior)] +=
+        std::chrono::duration_cast<std::chrono::milliseconds>(agora - desde_).count();
+    desde_ = agora;
+    regime_.store(r, std::memory_order_relaxed);
+    ++trocas_;
+}
+
+int RitmoCaminhao::periodo_sensor_ms(int base_ms) const
+{
+    switch (regime()) {
+    case RegimeRitmo::Hibernando: return std::max(base_ms, PERIODO_HIBERNANDO_MS);
+    case RegimeRitmo::Reta: return base_ms * 2;
+    case RegimeRitmo::Atencao: return std::max(1, base_ms / 2);
+    default: return base_ms;
+    }
+}
+
+int RitmoCaminhao::periodo_controle_ms(int base_ms) const
+{
+    return periodo_sensor_ms(base_ms); // mesma escala
+}
+
+void RitmoCaminhao::despertar()
+{
+    ultimo_despertar_ms_.store(::Relogio::mono_ms());
+    despertares_++;
+    definir(RegimeRitmo::Normal);
+
+    std::vector<EsperaPtr> acordar;
+    {
+        std::lock_guard<MutexAtr> lk(mtx_);
+        geracao_++;
+        acordar.swap(esperas_);
+    }
+    for (const EsperaPtr& e : acordar) {
+        if (e->reivindicar()) e->retomar();
+    }
+}
+
+RitmoCaminhao::Relogio::duration RitmoCaminhao::espera(Relogio::duration base) const
+{
+    if (regime() == RegimeRitmo::Hibernando) return std::max<Relogio::duration>(base, PAUSA_HIBERNANDO);
+    return base;
+}
+
+RitmoCaminhao::AguardaPausa RitmoCaminhao::pausa(Relogio::duration base)
+{
+    return AguardaPausa{*this, espera(base), geracao_.load()};
+}
+
+bool RitmoCaminhao::AguardaPausa::await_suspend(std::coroutine_handle<> h)
+{
+    auto e = std::make_shared<EsperaAssincrona>();
+    e->h = h;
+    e->ex = Executor::atual();
+    if (!e->ex) throw std::logic_error("RitmoCaminhao::pausa fora de um executor");
+    Executor* ex = e->ex;
+    const auto prazo = Relogio::now() + d; // 'this' pode morrer após o unlock
+    {
+        std::lock_guard<MutexAtr> lk(r.mtx_);
+        if (r.geracao_.load() != geracao) return false; // despertou antes de suspender
+        auto& v = r.esperas_;
+        v.erase(std::remove_if(v.begin(), v.end(), [](const EsperaPtr& w) { return w->concluida.load(); }), v.end());
+        v.push_back(e);
+    }
+    ex->agendar_em(prazo, [e] { if (e->reivindicar()) e->retomar(); });
+    return true;
+}
+
+std::string RitmoCaminhao::resumo() const
+{
+    std::lock_guard<MutexAtr> lk(mtx_);
+    int64_t tempo[4];
+    std::copy(tempo_ms_, tempo_ms_ + 4, tempo);
+    tempo[static_cast<int>(regime())] +=
+        std::chrono::duration_cast<std::chrono::milliseconds>(Relogio::now() - desde_).count();
+    int64_t total = 0;
+    for (int64_t t : tempo) total += t;
+    std::ostringstream ss;
+    ss << "[Ritmo] " << (ativo_ ? "" : "(desativado) ");
+    for (int i = 3; i >= 0; --i) {
+        ss << nome_regime(static_cast<RegimeRitmo>(i)) << " "
+           << (total > 0 ? 100 * tempo[i] / total : 0) << "%" << (i ? ", " : "");
+    }
+    ss << "; " << trocas_ << " trocas, " << despertares_.load() << " despertares";
+    return ss.str();
+}
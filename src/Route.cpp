@@ -117,4 +117,15 @@ bool Route::saveToFile(const std::string& path) const {
         ofs << wp.x << " " << wp.y << " " << wp.speed << "\n";
     }
     return true;
-}
\ No newline at end of file
+}
+
+// Serializa a rota no mesmo formato lido por loadFromString.
+std::string texto_rota(const Route& r) {
+    std::ostringstream out;
+    for (size_t i = 0; i < r.size(); ++i) {
+        const Waypoint& wp = r[i];
+        out << wp.x << " " << wp.y << " " << wp.speed;
+        if (i + 1 < r.size()) out << "\n";
+    }
+    return out.str();
+}
@@ -0,0 +1,87 @@
+/*
+ * Arquivo: RpcMqtt.cpp
+ * Finalidade:
+ * Implementação da camada de pedido/resposta sobre MQTT declarada em
+ * "RpcMqtt.h".
+ *
+ * Detalhes:
+ * - O cliente espera com polling curto (2 ms) da fila do seu tópico de
+ * resposta: é usado fora do Executor (linha de comando, ferramentas).
+ */
+
+#include "RpcMqtt.h"
+#include "JsonSimples.h"
+#include "Relogio.h"
+
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t MAX_CHEGADAS = 256;
+
+} // namespace
+
+std::string topico_rpc(int truck_id)
+{
+    return "/mina/caminhoes/" + std::to_string(truck_id) + "/rpc";
+}
+
+Tarefa ServidorRpc_tarefa(std::atomic<bool>& stop_flag, MqttClient& mqtt, std::string prefixo, RegistroRpc& registro)
+{
+    const std::string topico = prefixo + "/pedido";
+    mqtt.subscribe_topic(topico);
+    while (!stop_flag.load()) {
+        // o timeout só serve para observar stop_flag
+        auto pedido = co_await mqtt.next_for(topico, std::chrono::milliseconds(500));
+        if (!pedido) continue;
+        std::string destino, resposta;
+        if (registro.tratar(*pedido, Relogio::unix_ms(), destino, resposta)) mqtt.publish(destino, resposta);
+    }
+    std::cout << "[RPC] " << registro.atendidos() << " pedidos atendidos, " << registro.repetidos()
+              << " repetidos, " << registro.vencidos() << " vencidos\n";
+}
+
+ClienteRpc::ClienteRpc(MqttClient& mqtt, const std::string& id_cliente)
+    : mqtt_(mqtt),
+      id_cliente_(id_cliente + "_" + std::to_string(::getpid())),
+      topico_resposta_("/mina/rpc/" + id_cliente_ + "/resposta")
+{
+    mqtt_.subscribe_topic(topico_resposta_);
+}
+
+std::optional<std::string> ClienteRpc::chamar(const std::string& prefixo, const std::string& metodo,
+                                              const std::string& params_json, std::chrono::milliseconds timeout)
+{
+    const std::string id = id_cliente_ + "-" + std::to_string(++sequencia_);
+    std::ostringstream ss;
+    ss << "{\"id\":\"" << id << "\",\"metodo\":\"" << json_escapar(metodo) << "\",\"resposta\":\""
+       << topico_resposta_ << "\",\"prazo\":" << Relogio::unix_ms() + timeout.count()
+       << ",\"params\":" << (params_json.empty() ? "{}" : params_json) << "}";
+    mqtt_.publish(prefixo + "/pedido", ss.str());
+
+    const auto prazo = std::chrono::steady_clock::now() + timeout;
+    while (std::chrono::steady_clock::now() < prazo) {
+        {
+            std::lock_guard<std::mutex> lk(mtx_);
+            auto it = chegadas_.find(id);
+            if (it != chegadas_.end()) {
+                std::string r = std::move(it->second);
+                chegadas_.erase(it);
+                return r;
+            }
+            while (auto m = mqtt_.try_pop_message(topico_resposta_)) {
+                std::string outro;
+                texto_json(*m, "id", outro);
+                if (outro == id) return *m;
+                if (chegadas_.size() >= MAX_CHEGADAS) chegadas_.clear(); // respostas órfãs (timeouts)
+                chegadas_[outro] = std::move(*m);
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    timeouts_++;
+    return std::nullopt;
+}
@@ -1,29 +1,45 @@
 /*
  * Arquivo: SensorData.cpp
  * Finalidade:
- * Este arquivo de implementação (.cpp) existe para complementar o arquivo de
- * cabeçalho "SensorData.h". No entanto, como a estrutura SensorData definida
- * no cabeçalho contém apenas membros de dados simples (inteiros e booleanos)
- * e não possui métodos ou construtores complexos que exijam implementação
- * separada, este arquivo permanece vazio (ou quase vazio).
+ * Este arquivo de implementação (.cpp) complementa o arquivo de cabeçalho
+ * "SensorData.h". A estrutura SensorData é um "Plain Old Data" (POD) struct,
+ * servindo apenas como contêiner de dados, e não possui lógica própria.
  *
- * Por que este arquivo existe?
- * 1. Padrão de Projeto: Em projetos C++ maiores, é uma boa prática manter um
- * arquivo .cpp correspondente para cada arquivo .h que define uma classe ou
- * estrutura, mesmo que o .cpp esteja vazio inicialmente. Isso facilita a
- * adição futura de implementações de métodos sem alterar a estrutura de
- * arquivos do projeto.
- * 2. Compilação: Em alguns sistemas de build, a presença do arquivo .cpp pode
- * ser necessária para garantir que a unidade de tradução correspondente seja
- * criada, embora neste caso específico da estrutura SensorData, isso não
- * seja estritamente necessário para o funcionamento do programa.
- *
- * Conclusão:
- * A estrutura SensorData é um "Plain Old Data" (POD) struct, servindo apenas
- * como um contêiner de dados. Portanto, não há lógica de implementação a ser
- * colocada neste arquivo. O comentário "// Estrutura simples; nada a implementar aqui."
- * serve para indicar explicitamente essa intenção e evitar confusões futuras.
+ * Conversões v1 <-> v2:
+ * A amostra compacta SensorDataV2 (ver SensorData.h) é o formato usado nos
+ * buffers entre threads. As funções abaixo convertem entre os dois formatos:
+ * - para_v2(): empacota uma SensorData atribuindo o número de sequência.
+ * Posição e ângulo são convertidos para ponto fixo com saturação.
+ * - para_v1(): desempacota para a SensorData original, arredondando posição,
+ * ângulo e temperatura para inteiros (formato esperado pelos logs CSV e
+ * pelos payloads JSON já existentes).
  */
 
 #include "SensorData.h"
-// Estrutura simples; nada a implementar aqui.
\ No newline at end of file
+
+SensorDataV2 para_v2(const SensorData& v1, uint32_t seq)
+{
+    SensorDataV2 v2;
+    v2.timestamp_ms = v1.timestamp_ms;
+    v2.seq = seq;
+    v2.set_x(v1.i_posicao_x);
+    v2.set_y(v1.i_posicao_y);
+    v2.set_angulo(v1.i_angulo_x);
+    v2.set_temperatura(v1.i_temperatura);
+    v2.set_falhas(v1.i_falha_eletrica, v1.i_falha_hidraulica);
+    return v2;
+}
+
+SensorData para_v1(const SensorDataV2& v2)
+{
+    SensorData v1;
+    v1.timestamp_ms = v2.timestamp_ms;
+    v1.i_posicao_x = static_cast<int>(std::lround(v2.x()));
+    v1.i_posicao_y = static_cast<int>(std::lround(v2.y()));
+    int ang = static_cast<int>(std::lround(v2.angulo()));
+    v1.i_angulo_x = ang >= 360 ? ang - 360 : ang;
+    v1.i_temperatura = static_cast<int>(std::lround(v2.temperatura()));
+    v1.i_falha_eletrica = v2.falha_eletrica();
+    v1.i_falha_hidraulica = v2.falha_hidraulica();
+    return v1;
+}
@@ -80,4 +80,32 @@ SensorData Sensores::filtrar(const SensorData& raw)
     out.i_falha_hidraulica = raw.i_falha_hidraulica;
 
     return out; // Retorna o objeto com os dados filtrados.
-}
\ No newline at end of file
+}
+
+// Método filtrar_v2: Mesma janela de média móvel, mas a média é mantida em
+// ponto flutuante e empacotada em ponto fixo (sem truncar para inteiro).
+SensorDataV2 Sensores::filtrar_v2(const SensorData& raw, uint32_t seq)
+{
+    janela_.push_back(raw);
+    if ((int)janela_.size() > ordem_)
+        janela_.pop_front();
+
+    const double n = static_cast<double>(janela_.size());
+    int64_t sx = 0, sy = 0, sang = 0, st = 0;
+    for (const auto& s : janela_) {
+        sx += s.i_posicao_x;
+        sy += s.i_posicao_y;
+        sang += s.i_angulo_x;
+        st += s.i_temperatura;
+    }
+
+    SensorDataV2 out;
+    out.timestamp_ms = raw.timestamp_ms;
+    out.seq = seq;
+    out.set_x(static_cast<double>(sx) / n);
+    out.set_y(static_cast<double>(sy) / n);
+    out.set_angulo(static_cast<double>(sang) / n);
+    out.set_temperatura(static_cast<double>(st) / n);
+    out.set_falhas(raw.i_falha_eletrica, raw.i_falha_hidraulica);
+    return out;
+}
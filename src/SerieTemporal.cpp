@@ -0,0 +1,272 @@
+/*
+ * Arquivo: SerieTemporal.cpp
+ * Finalidade:
+ * Implementação do armazenamento de séries temporais e das consultas
+ * declarados em "SerieTemporal.h".
+ *
+ * Detalhes:
+ * - O anel é lido em no máximo dois trechos físicos contíguos (antes e
+ * depois da volta); soma, mínimo e máximo usam 8 acumuladores independentes
+ * por trecho, o que permite a vetorização sem reordenar operações em ponto
+ * flutuante (sem -ffast-math).
+ * - Os limites dos baldes são achados por busca binária: o custo de uma
+ * consulta é O(baldes·log n + amostras lidas).
+ */
+
+#include "SerieTemporal.h"
+#include "JsonSimples.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+namespace {
+
+constexpr int LANES = 8;
+
+const char* const NOMES_CAMPOS[SerieCaminhao::NUM_CAMPOS] = {"x", "y", "ang", "temp"};
+const char* const NOMES_AGREGACOES[] = {"media", "min", "max", "ultimo", "contagem"};
+
+int64_t piso(int64_t t, int64_t passo)
+{
+    const int64_t r = t % passo;
+    return r < 0 ? t - r - passo : t - r;
+}
+
+double soma_trecho(const float* p, size_t n)
+{
+    double acc[LANES] = {};
+    size_t k = 0;
+    for (; k + LANES <= n; k += LANES)
+        for (int l = 0; l < LANES; ++l) acc[l] += p[k + l];
+    double s = 0.0;
+    for (int l = 0; l < LANES; ++l) s += acc[l];
+    for (; k < n; ++k) s += p[k];
+    return s;
+}
+
+template <typename Cmp>
+float extremo_trecho(const float* p, size_t n, float inicial, Cmp melhor)
+{
+    float acc[LANES];
+    std::fill(acc, acc + LANES, inicial);
+    size_t k = 0;
+    for (; k + LANES <= n; k += LANES)
+        for (int l = 0; l < LANES; ++l) acc[l] = melhor(p[k + l], acc[l]) ? p[k + l] : acc[l];
+    float r = inicial;
+    for (int l = 0; l < LANES; ++l) r = melhor(acc[l], r) ? acc[l] : r;
+    for (; k < n; ++k) r = melhor(p[k], r) ? p[k] : r;
+    return r;
+}
+
+} // namespace
+
+bool campo_serie(const std::string& nome, CampoSerie& out)
+{
+    for (int i = 0; i < SerieCaminhao::NUM_CAMPOS; ++i) {
+        if (nome == NOMES_CAMPOS[i]) { out = static_cast<CampoSerie>(i); return true; }
+    }
+    return false;
+}
+
+bool agregacao_serie(const std::string& nome, AgregacaoSerie& out)
+{
+    for (int i = 0; i < 5; ++i) {
+        if (nome == NOMES_AGREGACOES[i]) { out = static_cast<AgregacaoSerie>(i); return true; }
+    }
+    return false;
+}
+
+const char* nome_campo_serie(CampoSerie c) { return NOMES_CAMPOS[static_cast<int>(c)]; }
+const char* nome_agregacao_serie(AgregacaoSerie a) { return NOMES_AGREGACOES[static_cast<int>(a)]; }
+
+SerieCaminhao::SerieCaminhao(size_t capacidade)
+    : ts_(std::max<size_t>(1, capacidade))
+{
+    for (auto& c : campos_) c.resize(ts_.size());
+}
+
+void SerieCaminhao::adicionar(int64_t ts, const float (&v)[NUM_CAMPOS])
+{
+    if (n_ > 0) ts = std::max(ts, ts_[fisico(n_ - 1)]); // não decrescente
+    size_t p;
+    if (n_ < ts_.size()) {
+        p = fisico(n_++);
+    } else {
+        p = inicio_; // sobrescreve a mais antiga
+        inicio_ = (inicio_ + 1) % ts_.size();
+    }
+    ts_[p] = ts;
+    for (int c = 0; c < NUM_CAMPOS; ++c) campos_[c][p] = v[c];
+}
+
+size_t SerieCaminhao::buscar(int64_t t) const
+{
+    size_t lo = 0, hi = n_;
+    while (lo < hi) {
+        const size_t m = lo + (hi - lo) / 2;
+        if (ts_[fisico(m)] < t) lo = m + 1;
+        else hi = m;
+    }
+    return lo;
+}
+
+template <typename Fn>
+void SerieCaminhao::trechos(size_t i, size_t j, Fn&& fn) const
+{
+    if (i >= j) return;
+    const size_t a = fisico(i);
+    const size_t len = j - i;
+    const size_t primeiro = std::min(len, ts_.size() - a);
+    fn(a, a + primeiro);
+    if (len > primeiro) fn(size_t{0}, len - primeiro);
+}
+
+void SerieCaminhao::consultar(int64_t t0, int64_t t1, const std::vector<CampoSerie>& campos, int64_t passo,
+                              AgregacaoSerie agg, size_t max_pontos, ResultadoSerie& out) const
+{
+    out = ResultadoSerie();
+    out.valores.resize(campos.size());
+    const size_t i = buscar(t0);
+    const size_t j = t1 == std::numeric_limits<int64_t>::max() ? n_ : buscar(t1 + 1);
+    if (i >= j) {
+        out.passo = passo;
+        return;
+    }
+
+    const int64_t primeiro = ts_[fisico(i)];
+    const int64_t ultimo = ts_[fisico(j - 1)];
+    max_pontos = std::max<size_t>(max_pontos, 3);
+    if (passo <= 0 && j - i > max_pontos) passo = 1; // bruto demais: passa a agregar
+    if (passo > 0) {
+        const int64_t minimo = (ultimo - primeiro + 1 + static_cast<int64_t>(max_pontos) - 3)
+                               / static_cast<int64_t>(max_pontos - 2);
+        passo = std::max(passo, minimo);
+    }
+    out.passo = std::max<int64_t>(passo, 0);
+
+    if (passo <= 0) {
+        out.t.reserve(j - i);
+        trechos(i, j, [&](size_t a, size_t b) { out.t.insert(out.t.end(), ts_.begin() + a, ts_.begin() + b); });
+        for (size_t c = 0; c < campos.size(); ++c) {
+            const auto& v = campos_[static_cast<int>(campos[c])];
+            out.valores[c].reserve(j - i);
+            trechos(i, j, [&](size_t a, size_t b) { out.valores[c].insert(out.valores[c].end(), v.begin() + a, v.begin() + b); });
+        }
+        return;
+    }
+
+    for (size_t k = i; k < j;) {
+        const int64_t balde = piso(ts_[fisico(k)], passo);
+        const size_t fim = std::min(j, buscar(balde + passo));
+        out.t.push_back(balde);
+        for (size_t c = 0; c < campos.size(); ++c) {
+            const float* v = campos_[static_cast<int>(campos[c])].data();
+            double r = 0.0;
+            switch (agg) {
+            case AgregacaoSerie::Contagem:
+                r = static_cast<double>(fim - k);
+                break;
+            case AgregacaoSerie::Ultimo:
+                r = v[fisico(fim - 1)];
+                break;
+            case AgregacaoSerie::Media: {
+                double s = 0.0;
+                trechos(k, fim, [&](size_t a, size_t b) { s += soma_trecho(v + a, b - a); });
+                r = s / static_cast<double>(fim - k);
+                break;
+            }
+            case AgregacaoSerie::Min: {
+                float m = std::numeric_limits<float>::infinity();
+                trechos(k, fim, [&](size_t a, size_t b) {
+                    m = extremo_trecho(v + a, b - a, m, [](float x, float y) { return x < y; });
+                });
+                r = m;
+                break;
+            }
+            case AgregacaoSerie::Max: {
+                float m = -std::numeric_limits<float>::infinity();
+                trechos(k, fim, [&](size_t a, size_t b) {
+                    m = extremo_trecho(v + a, b - a, m, [](float x, float y) { return x > y; });
+                });
+                r = m;
+                break;
+            }
+            }
+            out.valores[c].push_back(r);
+        }
+        k = fim;
+    }
+}
+
+void ArmazemSeries::adicionar(int truck_id, int64_t ts, const float (&v)[SerieCaminhao::NUM_CAMPOS])
+{
+    auto it = series_.find(truck_id);
+    if (it == series_.end()) it = series_.emplace(truck_id, SerieCaminhao(capacidade_)).first;
+    it->second.adicionar(ts, v);
+}
+
+bool ArmazemSeries::consultar(int truck_id, int64_t t0, int64_t t1, const std::vector<CampoSerie>& campos,
+                              int64_t passo, AgregacaoSerie agg, ResultadoSerie& out) const
+{
+    auto it = series_.find(truck_id);
+    if (it == series_.end()) return false;
+    it->second.consultar(t0, t1, campos, passo, agg, MAX_PONTOS, out);
+    return true;
+}
+
+std::string responder_consulta_series(const ArmazemSeries& armazem, const std::string& pedido, int64_t agora,
+                                      std::string& id)
+{
+    id.clear();
+    texto_json(pedido, "id", id);
+    auto erro = [&](const std::string& msg) {
+        return "{\"id\":\"" + id + "\",\"erro\":\"" + msg + "\"}";
+    };
+
+    double truck = 0;
+    if (!numero_json(pedido, "truck", truck)) return erro("falta truck");
+
+    std::string lista = "x,y,ang,temp";
+    texto_json(pedido, "campos", lista);
+    std::vector<CampoSerie> campos;
+    std::stringstream ls(lista);
+    for (std::string nome; std::getline(ls, nome, ',');) {
+        CampoSerie c;
+        if (!campo_serie(nome, c)) return erro("campo desconhecido: " + nome);
+        campos.push_back(c);
+    }
+    if (campos.empty()) return erro("sem campos");
+
+    AgregacaoSerie agg = AgregacaoSerie::Media;
+    std::string nome_agg;
+    if (texto_json(pedido, "agg", nome_agg) && !agregacao_serie(nome_agg, agg)) return erro("agg desconhecida: " + nome_agg);
+
+    double v = 0;
+    int64_t t0 = std::numeric_limits<int64_t>::min();
+    int64_t t1 = std::numeric_limits<int64_t>::max();
+    if (numero_json(pedido, "ultimos_ms", v)) t0 = agora - static_cast<int64_t>(v);
+    if (numero_json(pedido, "t0", v)) t0 = static_cast<int64_t>(v);
+    if (numero_json(pedido, "t1", v)) t1 = static_cast<int64_t>(v);
+    int64_t passo = 0;
+    if (numero_json(pedido, "passo", v)) passo = static_cast<int64_t>(v);
+
+    ResultadoSerie r;
+    if (!armazem.consultar(static_cast<int>(truck), t0, t1, campos, passo, agg, r)) return erro("caminhão sem série");
+
+    std::ostringstream ss;
+    ss << "{\"id\":\"" << id << "\",\"truck\":" << static_cast<int>(truck) << ",\"agg\":\""
+       << (r.passo > 0 ? nome_agregacao_serie(agg) : "bruto") << "\",\"passo\":" << r.passo
+       << ",\"agora\":" << agora << ",\"t\":[";
+    for (size_t k = 0; k < r.t.size(); ++k) ss << (k ? "," : "") << r.t[k];
+    ss << "]";
+    ss.precision(7);
+    for (size_t c = 0; c < campos.size(); ++c) {
+        ss << ",\"" << nome_campo_serie(campos[c]) << "\":[";
+        for (size_t k = 0; k < r.valores[c].size(); ++k) ss << (k ? "," : "") << r.valores[c][k];
+        ss << "]";
+    }
+    ss << "}";
+    return ss.str();
+}
@@ -0,0 +1,60 @@
+/*
+ * Arquivo: ServicoMapaCalor.cpp
+ * Finalidade:
+ * Implementação do serviço de mapa de calor declarado em "ServicoMapaCalor.h".
+ */
+
+#include "ServicoMapaCalor.h"
+#include "MapaCalor.h"
+#include "Relogio.h"
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+int executar_mapa_calor(const std::vector<int>& caminhoes, MqttClient& mqtt, std::atomic<bool>& stop_flag)
+{
+    const int64_t PERIODO_DELTA_MS = 5000;
+    const int DELTAS_POR_COMPLETO = 12; // quadro completo a cada minuto
+
+    std::cout << "[MapaCalor] acompanhando " << caminhoes.size() << " caminhões\n";
+    for (int id : caminhoes) mqtt.subscribe_topic("/mina/caminhoes/" + std::to_string(id) + "/posicao");
+
+    MapaCalor mapa;
+    AmostradorMapa amostrador(mapa);
+    const int64_t t0 = Relogio::mono_ms();
+    auto agora_ms = [&] { return static_cast<uint64_t>(Relogio::mono_ms() - t0); };
+    int64_t prox_delta = t0 + PERIODO_DELTA_MS;
+    int64_t prox_amostra = t0;
+    int publicacoes = 0;
+
+    while (!stop_flag.load()) {
+        for (int id : caminhoes) {
+            while (auto m = mqtt.try_pop_message("/mina/caminhoes/" + std::to_string(id) + "/posicao"))
+                amostrador.posicao(id, *m, agora_ms());
+        }
+        // A permanência vem da posição estimada no período fixo, não de cada
+        // mensagem: em trechos retos o /posicao é suprimido.
+        amostrador.amostrar(agora_ms());
+
+        if (Relogio::mono_ms() >= prox_delta) {
+            const bool completo = publicacoes % DELTAS_POR_COMPLETO == 0;
+            const uint64_t t = agora_ms();
+            for (size_t s = 0; s < mapa.num_escalas(); ++s) {
+                std::string pl = mapa.codificar(s, t, completo);
+                if (pl.empty()) continue;
+                const std::string base = "/mina/frota/heatmap/" + std::to_string(static_cast<int>(mapa.escala_s(s)));
+                if (completo) mqtt.publish(base + "/completo", pl, true);
+                else mqtt.publish(base + "/delta", pl);
+            }
+            ++publicacoes;
+            prox_delta += PERIODO_DELTA_MS;
+        }
+
+        prox_amostra += AmostradorMapa::PERIODO_MS;
+        const int64_t agora = Relogio::mono_ms();
+        if (prox_amostra < agora) prox_amostra = agora; // atrasado: não acumula ciclos
+        std::this_thread::sleep_for(std::chrono::milliseconds(prox_amostra - agora));
+    }
+    return 0;
+}
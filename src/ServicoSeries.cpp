@@ -0,0 +1,70 @@
+/*
+ * Arquivo: ServicoSeries.cpp
+ * Finalidade:
+ * Implementação do serviço de séries temporais declarado em "ServicoSeries.h".
+ */
+
+#include "ServicoSeries.h"
+#include "JsonSimples.h"
+#include "ReconstrucaoPosicao.h"
+#include "SerieTemporal.h"
+#include "Relogio.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <thread>
+
+int executar_series(const std::vector<int>& caminhoes, MqttClient& mqtt, std::atomic<bool>& stop_flag)
+{
+    const std::string TOPICO_CONSULTA = "/mina/frota/series/consulta";
+    const int AMOSTRAS_POR_MIN = 20 * 60; // TratamentoSensores publica a 20 Hz
+
+    double minutos = 15.0;
+    if (const char* env = std::getenv("ATR_SERIES_MIN")) {
+        try { minutos = std::max(0.1, std::stod(env)); } catch (...) { }
+    }
+    ArmazemSeries armazem(static_cast<size_t>(minutos * AMOSTRAS_POR_MIN));
+
+    std::cout << "[Series] acompanhando " << caminhoes.size() << " caminhões, " << minutos << " min cada\n";
+    for (int id : caminhoes) {
+        mqtt.subscribe_topic("/mina/caminhoes/" + std::to_string(id) + "/sensores");
+        mqtt.subscribe_topic("/mina/caminhoes/" + std::to_string(id) + "/posicao");
+    }
+    mqtt.subscribe_topic(TOPICO_CONSULTA);
+
+    std::map<int, ReconstrutorPosicao> posicoes;
+    uint64_t amostras = 0, consultas = 0;
+    while (!stop_flag.load()) {
+        for (int id : caminhoes) {
+            const std::string base = "/mina/caminhoes/" + std::to_string(id);
+            ReconstrutorPosicao& rec = posicoes[id];
+            while (auto p = mqtt.try_pop_message(base + "/posicao")) rec.atualizar(*p, Relogio::mono_ms());
+            while (auto m = mqtt.try_pop_message(base + "/sensores")) {
+                if (!rec.valido()) continue; // sem posição ainda
+                const EstadoPosicao pos = rec.em(Relogio::mono_ms());
+                const double x = pos.x, y = pos.y;
+                double ang, temp;
+                if (!numero_json(*m, "ang", ang)) ang = 0.0;
+                if (!numero_json(*m, "temp", temp)) temp = 0.0;
+                const float v[SerieCaminhao::NUM_CAMPOS] = {static_cast<float>(x), static_cast<float>(y),
+                                                            static_cast<float>(ang), static_cast<float>(temp)};
+                armazem.adicionar(id, Relogio::unix_ms(), v);
+                ++amostras;
+            }
+        }
+
+        while (auto pedido = mqtt.try_pop_message(TOPICO_CONSULTA)) {
+            std::string id;
+            const std::string resposta = responder_consulta_series(armazem, *pedido, Relogio::unix_ms(), id);
+            mqtt.publish("/mina/frota/series/resposta/" + (id.empty() ? std::string("sem_id") : id), resposta);
+            ++consultas;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    std::cout << "[Series] " << amostras << " amostras, " << consultas << " consultas\n";
+    return 0;
+}
@@ -0,0 +1,89 @@
+/*
+ * Arquivo: SnapshotCaminhao.cpp
+ * Finalidade:
+ * Implementação do snapshot retido declarado em "SnapshotCaminhao.h".
+ * Cada atualização altera o snapshot corrente (EstadoSnapshot) e o compara
+ * com o último publicado; só há publicação (retida, QoS 0) quando eles
+ * diferem. Os dois tópicos são registrados como estado retido (MqttClient::ConfigTopico):
+ * "publicado" quer dizer entregue ao MqttClient, que não descarta o valor
+ * pendente e o reenvia após falha.
+ */
+
+#include "SnapshotCaminhao.h"
+
+#include <iostream>
+
+PublicadorSnapshot::PublicadorSnapshot(MqttClient& mqtt, int truck_id)
+    : mqtt_(mqtt), truck_id_(truck_id)
+{
+    // Só há publicação quando algo muda: um snapshot descartado numa fila
+    // cheia ou perdido numa queda não seria reenviado. Como estado retido,
+    // o MqttClient guarda o último valor até conseguir enviá-lo.
+    MqttClient::ConfigTopico cfg;
+    cfg.alias = false;
+    cfg.prioridade = MqttClient::Prioridade::Controle;
+    cfg.estado = true;
+    mqtt_.configurar_topico(topico_snapshot(truck_id_), cfg);
+    mqtt_.configurar_topico(topico_rota_atual(truck_id_), cfg);
+}
+
+void PublicadorSnapshot::estado(bool automatico, bool defeito, bool alerta_temp)
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    regras_.estado(automatico, defeito, alerta_temp);
+    publicar_se_mudou();
+}
+
+void PublicadorSnapshot::rota(const Route& r)
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (!regras_.rota(r)) return;
+    // A rota vai antes do snapshot: quem vê a versão nova já encontra a rota retida.
+    try { mqtt_.publish(topico_rota_atual(truck_id_), regras_.rota_texto(), true); } catch (...) { }
+    publicar_se_mudou();
+}
+
+void PublicadorSnapshot::waypoint(size_t idx)
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    regras_.waypoint(idx);
+    publicar_se_mudou();
+}
+
+void PublicadorSnapshot::falhas(const std::string& descricao, uint64_t ts)
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    regras_.falhas(descricao, ts);
+    publicar_se_mudou();
+}
+
+SnapshotCaminhao PublicadorSnapshot::atual() const
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    return regras_.atual();
+}
+
+std::string PublicadorSnapshot::rota_texto() const
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    return regras_.rota_texto();
+}
+
+uint64_t PublicadorSnapshot::publicacoes() const
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    return publicacoes_;
+}
+
+void PublicadorSnapshot::publicar_se_mudou()
+{
+    if (!regras_.pendente()) return;
+    try {
+        if (mqtt_.publish(topico_snapshot(truck_id_), regras_.atual().serializar(), true)) {
+            regras_.marcar_publicado();
+            ++publicacoes_;
+        }
+    } catch (...) {
+        std::cerr << "[Snapshot] falha ao publicar snapshot\n";
+    }
+}
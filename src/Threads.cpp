@@ -1,40 +1,51 @@
 /*
  * Arquivo: Threads.cpp
  * Finalidade:
- * Este arquivo contém a implementação das cinco funções principais que são
- * executadas como threads no sistema embarcado do caminhão autônomo. Ele
+ * Este arquivo contém a implementação das funções principais que são
+ * executadas como tarefas (corrotinas C++20, ver Executor.h) no sistema
+ * embarcado do caminhão autônomo. Ele
  * concentra toda a lógica operacional do sistema, incluindo a simulação da
  * física e sensores, o processamento de comandos, o controle de navegação
  * (piloto automático), o monitoramento de falhas e a coleta de dados. As
  * threads interagem entre si e com o mundo externo através de buffers
  * circulares e do cliente MQTT, implementando a arquitetura de software do
- * projeto.
+ * projeto. As esperas (buffers, temporização) usam co_await, então algumas
+ * poucas threads do Executor atendem todas as tarefas. Os tópicos que
+ * cadenciam uma tarefa são esperados com co_await mqtt.next_for(): /comandos
+ * na Lógica e /route no Gerenciador de Rota. Os laços cadenciados pelas
+ * amostras (Tratamento, Controle, Coletor) drenam seus tópicos laterais
+ * (/sim/..., /setpoints, /posicao, /comandos) com try_pop_message uma vez por
+ * ciclo, sem esperar por eles.
  *
- * Resumo das Threads:
- * 1. TratamentoSensores_thread: Simula a dinâmica física do caminhão (movimento,
+ * Resumo das Tarefas:
+ * 1. TratamentoSensores_tarefa: Simula a dinâmica física do caminhão (movimento,
  * aceleração), gera dados de sensores com ruído, aplica filtragem de média
  * móvel e distribui os dados processados para as outras threads via buffers.
  * Também trata a injeção de defeitos simulados.
- * 2. LogicaDeComando_thread: Processa comandos recebidos via MQTT (ex: mudança
+ * 2. LogicaDeComando_tarefa: Processa comandos recebidos via MQTT (ex: mudança
  * de modo auto/manual, rearme de falhas, setpoints diretos) e atualiza o
  * estado global do caminhão.
- * 3. MonitoramentoDeFalhas_thread: Analisa os dados dos sensores para detectar
+ * 3. MonitoramentoDeFalhas_tarefa: Analisa os dados dos sensores para detectar
  * condições críticas (temperatura alta, falhas elétricas/hidráulicas),
  * atualiza o estado de defeito e publica eventos de alerta/falha via MQTT.
- * 4. ControleDeNavegacao_thread: Implementa a lógica de controle. No modo manual,
+ * 4. ControleDeNavegacao_tarefa: Implementa a lógica de controle. No modo manual,
  * aplica os comandos incrementais do operador. No modo automático, usa um
  * controlador proporcional (P) para direção e proporcional-integral (PI)
  * para velocidade para seguir o setpoint atual da rota, garantindo uma
- * transição suave entre os modos. Publica os valores dos atuadores via MQTT.
- * 5. ColetorDeDados_thread: Responsável pela telemetria e registro. Lê os dados
- * do caminhão, grava logs em arquivos de texto e CSV, e publica as informações
+ * transição suave entre os modos. Com ATR_MPC=1 a velocidade passa a ser
+ * controlada pelo MPC de MpcVelocidade.h. Publica os atuadores via MQTT.
+ * 5. ColetorDeDados_tarefa: Responsável pela telemetria e registro. Lê os dados
+ * do caminhão, grava logs em arquivos de texto e CSV (pela thread de E/S do
+ * GravadorLog, IoLog.h), e publica as informações
  * de estado, posição e eventos via MQTT para as interfaces externas. Também
  * atua como um ponto central para receber comandos da interface local e
- * encaminhá-los para a thread de lógica.
+ * encaminhá-los para a tarefa de lógica.
+ * 6. GerenciadorDeRota_tarefa: Publica os setpoints da rota e avança os
+ * waypoints conforme a posição publicada.
  */
 
 // src/Threads.cpp
-// Versão "Acadêmica" — Threads do Sistema ATR (Tratamento, Lógica, Falhas, Navegação, Coletor).
+// Versão "Acadêmica" — Tarefas do Sistema ATR (Tratamento, Lógica, Falhas, Navegação, Coletor, Rota).
 // Requer headers: Threads.h, Autuadores.h, Sensores.h, SensorData.h, BufferCircular.h, MqttClient.h
 
 #include "Threads.h"
@@ -43,6 +54,13 @@
 #include "SensorData.h"
 #include "BufferCircular.h"
 #include "MqttClient.h"
+#include "PerfContadores.h"
+#include "MpcVelocidade.h"
+#include "IndiceLog.h"
+#include "IoLog.h"
+#include "ReconstrucaoPosicao.h"
+#include "Orca.h"
+#include "Relogio.h"
 
 #include <thread>
 #include <chrono>
@@ -50,24 +68,20 @@
 #include <sstream>
 #include <iostream>
 #include <random>
+#include <algorithm>
 #include <cmath>
 #include <string>
 #include <atomic>
 #include <filesystem>
+#include <cstdlib>
+#include <map>
+#include <vector>
 
 namespace fs = std::filesystem;
 
 using namespace std;
 using namespace std::chrono_literals;
 
-// -------------------------------------------
-// util: timestamp em ms (steady clock)
-// -------------------------------------------
-static int64_t now_ms() {
-    using namespace std::chrono;
-    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
-}
-
 // -------------------------------------------
 // Helper: extrai inteiro de strings simples
 // aceita formatos: "x=123" ou "\"x\":123" ou "x= 123"
@@ -93,28 +107,31 @@ static bool extract_int_arg(const std::string &s, const std::string &key, int &o
 }
 
 // -------------------------------------------
-// THREAD 1: TratamentoSensores + Simulação
+// TAREFA 1: TratamentoSensores + Simulação
 // - simula dinâmica (px,py,heading,velocity)
 // - gera SensorData com ruído
 // - aplica filtro média móvel (classe Sensores)
 // - empurra buffers circulares usados pelas demais threads
 // - publica /sensores e /posicao quando há nova leitura filtrada
 // -------------------------------------------
-void TratamentoSensores_thread(
+Tarefa TratamentoSensores_tarefa(
     std::atomic<bool>& stop_flag,
-    BufferCircular<SensorData>& buf_nav,
-    BufferCircular<SensorData>& buf_logic,
-    BufferCircular<SensorData>& buf_falhas,
-    BufferCircular<SensorData>& buf_coletor,
+    BufferCircular<SensorDataV2>& buf_nav,
+    BufferCircular<SensorDataV2>& buf_logic,
+    BufferCircular<SensorDataV2>& buf_falhas,
+    BufferCircular<SensorDataV2>& buf_coletor,
     MqttClient& mqtt,
     EstadosCaminhao& /*estados*/,         
     ComandosCaminhao& /*comandos*/,
     AtuadoresCaminhao& atuadores,
+    CheckpointCaminhao& checkpoint,
     int ordem_media_movel,
     int periodo_ms,
+    RitmoCaminhao& ritmo,
     int truck_id
 ) {
     Sensores filtro(ordem_media_movel);
+    PerfContadores::nomear_thread("Tratamento");
 
     // RNG (ruído)
     std::mt19937 rng((unsigned)std::chrono::steady_clock::now().time_since_epoch().count());
@@ -122,45 +139,61 @@ void TratamentoSensores_thread(
     std::normal_distribution<double> noise_ang(0.0, 1.2);   // ângulo
     std::normal_distribution<double> noise_temp(0.0, 1.2);  // temperatura
 
-    // estado do mundo (0..1000)
-    double px = 100.0;
-    double py = 100.0;
-    double heading = 0.0;   // graus
+    // estado do mundo (0..1000); parte do checkpoint quando houver warm start
+    double px, py, heading;
+    {
+        std::lock_guard<MutexAtr> lk(state_mtx);
+        px = checkpoint.x;
+        py = checkpoint.y;
+        heading = checkpoint.heading; // graus
+    }
     double velocity = 0.0;  // unidades (px/s)
-    double last_time = static_cast<double>(now_ms());
+    int64_t last_ns = Relogio::mono_ns();
 
-    // para evitar publicar repetidamente a mesma leitura
-    uint64_t last_published_ts = 0;
+    // número de sequência das amostras (SensorDataV2::seq)
+    uint32_t seq = 0;
 
     // parâmetros dinâmicos (acadêmicos -> balanceados)
     const double accel_scale = 0.6;   // conversão de comando % -> px/s^2
     const double heading_gain = 1.8;  // rapidez de alinhamento do heading
     const double max_vel = 160.0;
     const double min_vel = -30.0;
+    const long QUEDA_MAX_MS = 10000; // teto de uma queda simulada (/sim/queda)
+
+    // Mensagens pré-montadas dos tópicos publicados a cada amostra
+    const std::string base_topico = "/mina/caminhoes/" + std::to_string(truck_id);
+    MqttClient::Publicador pub_sens = mqtt.publicador(base_topico + "/sensores");
+    MqttClient::Publicador pub_pos = mqtt.publicador(base_topico + "/posicao");
+
+    // /posicao por dead reckoning: só publica quando a posição filtrada se
+    // afasta da extrapolação dos receptores (ReconstrucaoPosicao.h) mais que
+    // ATR_DR_TOL px (padrão 3; 0 = publica todo ciclo) ou a cada 1 s.
+    double tolerancia_dr = 3.0;
+    if (const char* env_dr = std::getenv("ATR_DR_TOL")) {
+        try { tolerancia_dr = std::stod(env_dr); } catch (...) { }
+    }
+    SupressorPosicao supressor(tolerancia_dr);
 
     while (!stop_flag.load()) {
-        double tnow = static_cast<double>(now_ms());
-        double dt_ms = tnow - last_time;
-        if (dt_ms <= 0.0) dt_ms = static_cast<double>(periodo_ms);
-        double dt = dt_ms / 1000.0;
-        last_time = tnow;
+        PerfContadores::nomear_thread("Tratamento"); // a tarefa pode ter migrado de thread
+        // um carimbo por ciclo: monotônico para a física, Unix para a amostra
+        const Carimbo agora = Relogio::agora();
+        double dt = (agora.mono_ns - last_ns) / 1e9;
+        if (dt <= 0.0) dt = periodo_ms / 1000.0;
+        last_ns = agora.mono_ns;
 
         // leitura snapshot dos atuadores
         int o_acel = atuadores.o_aceleracao.load(); // -100..100
         int o_dir  = atuadores.o_direcao.load();    // -180..180
 
-        // checa pedidos de injeção de defeito (feito pela interface de simulação)
-        auto maybe_def = mqtt.try_pop_message("/mina/caminhoes/" + std::to_string(truck_id) + "/sim/defeito");
-        if (maybe_def) {
-            std::string pl = *maybe_def;
-            std::string low = pl;
-            for (char &c : low) c = std::tolower((unsigned char)c);
-            // payload esperado: "eletrica=1" ou "hidraulica=1" ou "clear"
-            if (low.find("eletrica") != std::string::npos && (low.find("1") != std::string::npos || low.find("true") != std::string::npos)) {
-                // set flag temporária na próxima amostra
-                // vamos gravar em atuadores (mais simples): usar campos de comando não utilizados
-                // trataremos via sinalização local -> aplicamos diretamente no raw gerado abaixo
-            }
+        // queda simulada do enlace de saída (motor de cenários): "ms" sem envio.
+        // O tópico só é assinado com ATR_SIM_QUEDA=1 (main.cpp); duração
+        // negativa ou inválida é ignorada e a máxima é QUEDA_MAX_MS.
+        if (auto queda = mqtt.try_pop_message(base_topico + "/sim/queda")) {
+            long ms = -1;
+            try { ms = std::stol(*queda); } catch (...) { }
+            if (ms >= 0) mqtt.suspender_envio(std::chrono::milliseconds(std::min(ms, QUEDA_MAX_MS)));
+            else std::cerr << "[Tratamento] /sim/queda ignorada: duração inválida '" << *queda << "'\n";
         }
         // dinâmica: aceleração proporcional ao comando
         double accel = static_cast<double>(o_acel) * accel_scale;
@@ -189,6 +222,7 @@ void TratamentoSensores_thread(
 
         // posição
         double rad = heading * M_PI / 180.0;
+        const double px_ant = px, py_ant = py;
         px += velocity * cos(rad) * dt;
         py += velocity * sin(rad) * dt;
         // clamp mundo
@@ -196,10 +230,12 @@ void TratamentoSensores_thread(
         if (px > 1000.0) px = 1000.0;
         if (py < 0.0) py = 0.0;
         if (py > 1000.0) py = 1000.0;
+        // velocidade efetiva ao longo do rumo (encostado no limite, não anda)
+        const double vel_efetiva = ((px - px_ant) * cos(rad) + (py - py_ant) * sin(rad)) / dt;
 
         // gera raw com ruído
         SensorData raw{};
-        raw.timestamp_ms = static_cast<uint64_t>(now_ms());
+        raw.timestamp_ms = static_cast<uint64_t>(agora.unix_ms());
         raw.i_posicao_x = static_cast<int>(std::round(px + noise_pos(rng)));
         raw.i_posicao_y = static_cast<int>(std::round(py + noise_pos(rng)));
         // ângulo: manter 0..359
@@ -213,9 +249,11 @@ void TratamentoSensores_thread(
         raw.i_falha_hidraulica = false;
 
         // Aplicar qualquer injeção de defeito solicitada via tópicos de simulação
-        auto maybe_def2 = mqtt.try_pop_message("/mina/caminhoes/" + std::to_string(truck_id) + "/sim/defeito");
-        if (maybe_def2) {
-            std::string pl = *maybe_def2;
+        // (interface ou motor de cenários). Payload: "eletrica=1", "hidraulica=1",
+        // "all=1" ou as versões =0/clear; vale para a amostra deste ciclo.
+        auto maybe_def = mqtt.try_pop_message(base_topico + "/sim/defeito");
+        if (maybe_def) {
+            std::string pl = *maybe_def;
             std::string low = pl;
             for (char &c : low) c = std::tolower((unsigned char)c);
             if (low.find("eletrica") != std::string::npos) {
@@ -242,74 +280,105 @@ void TratamentoSensores_thread(
             }
         }
 
-        // filtra
-        SensorData filtrado = filtro.filtrar(raw);
-
-        // empurra buffers (somente quando há nova leitura filtrada)
-        // Usamos timestamp para decidir se é nova leitura
-        if (filtrado.timestamp_ms != last_published_ts) {
-            // push bloqueante: espera até haver espaço para evitar perda de dados
-            buf_nav.push_wait(filtrado);
-            buf_logic.push_wait(filtrado);
-            buf_falhas.push_wait(filtrado);
-            buf_coletor.push_wait(filtrado);
+        // filtra: a amostra compacta recebe o próximo número de sequência
+        // (cada ciclo gera uma leitura nova; consumidores detectam lacunas pela seq)
+        SensorDataV2 amostra;
+        {
+            EstagioPerf ep("filtrar");
+            amostra = filtro.filtrar_v2(raw, ++seq);
+        }
+        // versão inteira usada nos payloads JSON existentes
+        SensorData filtrado = para_v1(amostra);
+
+        // push que suspende enquanto cheio, para evitar perda de dados. O
+        // estágio mede só a inserção: a espera por espaço fica fora dele (os
+        // ciclos de outras corrotinas no worker não são do "buf_push").
+        for (BufferCircular<SensorDataV2>* b : {&buf_nav, &buf_logic, &buf_falhas, &buf_coletor}) {
+            bool inserido;
+            {
+                EstagioPerf ep("buf_push");
+                inserido = b->try_push(amostra);
+            }
+            if (!inserido) {
+                inserido = co_await b->push(amostra);
+                PerfContadores::nomear_thread("Tratamento"); // pode ter retomado em outra thread
+                if (!inserido) break; // buffer fechado: encerrando
+            }
+        }
 
-            // publish sensores JSON
+        // formata JSON de sensores e posição (medido separadamente do publish)
+        std::string json_sens, json_pos;
+        {
+            EstagioPerf ep("json_sensores");
             std::ostringstream ss;
+            // posição só no /posicao (suprimido por dead reckoning); repetir
+            // x/y aqui a cada ciclo anularia a economia
             ss << "{"
-               << "\"x\":" << filtrado.i_posicao_x << ","
-               << "\"y\":" << filtrado.i_posicao_y << ","
                << "\"ang\":" << filtrado.i_angulo_x << ","
-               << "\"temp\":" << filtrado.i_temperatura
+               << "\"temp\":" << filtrado.i_temperatura << ","
+               << "\"ts\":" << amostra.timestamp_ms
                << "}";
-            std::string topic_sens = "/mina/caminhoes/" + std::to_string(truck_id) + "/sensores";
-            mqtt.publish(topic_sens, ss.str());
-
-            // publish position simplified (para a interface)
-            std::ostringstream sp;
-            sp << "{"
-               << "\"x\":" << filtrado.i_posicao_x << ","
-               << "\"y\":" << filtrado.i_posicao_y << ","
-               << "\"ang\":" << filtrado.i_angulo_x
-               << "}";
-            std::string topic_pos = "/mina/caminhoes/" + std::to_string(truck_id) + "/posicao";
-            mqtt.publish(topic_pos, sp.str());
-
-            last_published_ts = filtrado.timestamp_ms;
+            json_sens = ss.str();
+
+            // posição filtrada com o estado do modelo de extrapolação
+            EstadoPosicao estado;
+            estado.t_ms = amostra.timestamp_ms;
+            estado.x = amostra.x();
+            estado.y = amostra.y();
+            estado.v = vel_efetiva;
+            estado.rumo = heading;
+            estado.taxa = hdg_rate;
+            if (supressor.avaliar(estado)) json_pos = serializar_posicao(estado, filtrado.i_angulo_x);
         }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(periodo_ms));
+        // publish sensores JSON
+        pub_sens.publicar(json_sens);
+
+        // publish position (só quando o desvio da predição exige)
+        if (!json_pos.empty()) pub_pos.publicar(json_pos);
+
+        co_await ritmo.pausa(std::chrono::milliseconds(ritmo.periodo_sensor_ms(periodo_ms)));
     }
+
+    std::cout << "[Tratamento] /posicao: " << supressor.enviadas() << " enviadas, "
+              << supressor.suprimidas() << " suprimidas (tolerância " << tolerancia_dr << " px)\n";
+
+    // estado final da simulação para o checkpoint (publicado pelo main)
+    std::lock_guard<MutexAtr> lk(state_mtx);
+    checkpoint.x = px;
+    checkpoint.y = py;
+    checkpoint.heading = heading;
+    checkpoint.valido = true;
 }
 
 // -------------------------------------------
-// THREAD 2: Lógica de Comando
+// TAREFA 2: Lógica de Comando
 // - lê tópico /comandos e atualiza flags em ComandosCaminhao / EstadosCaminhao
 // - aceita setpoints diretos e rearmar
 // -------------------------------------------
-void LogicaDeComando_thread(
+Tarefa LogicaDeComando_tarefa(
     std::atomic<bool>& stop_flag,
-    BufferCircular<SensorData>& buf_logic,
+    BufferCircular<SensorDataV2>& buf_logic,
     BufferCircular<std::string>& buf_cmds,
     MqttClient& mqtt,
     EstadosCaminhao& estados,
     ComandosCaminhao& comandos,
     AtuadoresCaminhao& /*atuadores*/,
+    RitmoCaminhao& ritmo,
     int truck_id
 ) {
     const std::string topic_cmd = "/mina/caminhoes/" + std::to_string(truck_id) + "/comandos";
 
     while (!stop_flag.load()) {
         // consumir última leitura (não bloqueante) — pode ser usada para decisões se preciso
-        SensorData sd;
         // espera por nova leitura por curto período para evitar polling intenso
-        buf_logic.pop_wait_for(sd, 50ms);
+        co_await buf_logic.pop_for(50ms);
 
         // Consome comandos vindos do buffer de comandos (inseridos pelo Coletor
         // quando a interface publica em /comandos). Usamos wait.
-        std::string cmdpl;
-        if (buf_cmds.pop_wait_for(cmdpl, 50ms)) {
-            std::string pl = cmdpl;
+        auto cmdpl = co_await buf_cmds.pop_for(50ms);
+        if (cmdpl) {
+            std::string pl = *cmdpl;
             std::cerr << "[Logica] popped from buf_cmds: '" << pl << "'\n";
             std::string low = pl;
             for (char &c : low) c = std::tolower((unsigned char)c);
@@ -356,37 +425,40 @@ void LogicaDeComando_thread(
                 std::ostringstream sp; sp << "x=" << vx << ",y=" << vy;
                 mqtt.publish("/mina/caminhoes/" + std::to_string(truck_id) + "/setpoints", sp.str());
             }
-            } else {
-            // fallback: se nada no buffer de comandos, ainda podemos checar MQTT
-            auto maybe = mqtt.try_pop_message(topic_cmd);
+            co_await ritmo.pausa(30ms);
+        } else {
+            // nada no buffer de comandos: a pausa do ciclo vira a espera do
+            // próprio /comandos, que retoma a tarefa assim que um comando chega
+            auto maybe = co_await mqtt.next_for(topic_cmd, ritmo.espera(30ms));
             if (maybe) {
                 std::string pl = *maybe;
                 // encaminhar para o buffer para unificar o caminho
                     std::cerr << "[Logica] mqtt->comandos received, forwarding to buf_cmds: '" << pl << "'\n";
-                    try { buf_cmds.push_wait(pl); } catch(...) { std::cerr << "[Logica] push to buf_cmds failed\n"; }
+                    try { co_await buf_cmds.push(pl); } catch(...) { std::cerr << "[Logica] push to buf_cmds failed\n"; }
             }
         }
-
-        std::this_thread::sleep_for(30ms);
     }
 }
 
 // -------------------------------------------
-// THREAD 3: Monitoramento de Falhas
+// TAREFA 3: Monitoramento de Falhas
 // - lê buffer de falhas filtrado e publica eventos (temp > 95 ou flags)
 // -------------------------------------------
-void MonitoramentoDeFalhas_thread(
+Tarefa MonitoramentoDeFalhas_tarefa(
     std::atomic<bool>& stop_flag,
-    BufferCircular<SensorData>& buf_falhas,
+    BufferCircular<SensorDataV2>& buf_falhas,
     MqttClient& mqtt,
     EstadosCaminhao& estados,
+    PublicadorSnapshot& snapshot,
+    RitmoCaminhao& ritmo,
     int truck_id
 ) {
     while (!stop_flag.load()) {
-        SensorData sd;
-        if (!buf_falhas.pop_wait_for(sd, 100ms)) {
+        auto amostra = co_await buf_falhas.pop_for(100ms);
+        if (!amostra) {
             continue;
         }
+        SensorData sd = para_v1(*amostra);
 
         bool temp_alert = sd.i_temperatura > 95;   // nível de alerta
         bool temp_defect = sd.i_temperatura > 120; // nível de defeito
@@ -401,6 +473,14 @@ void MonitoramentoDeFalhas_thread(
             // se não há condição de defeito, mantém e_defeito como está (não reset automático)
         }
 
+        // Última falha do snapshot retido (só muda no início de uma falha diferente)
+        std::string falhas_amostra;
+        if (falha_ele) falhas_amostra += "FALHA_ELETRICA;";
+        if (falha_hid) falhas_amostra += "FALHA_HIDRAULICA;";
+        if (temp_defect) falhas_amostra += "DEFEITO_TEMPERATURA;";
+        if (!falhas_amostra.empty()) falhas_amostra.pop_back();
+        snapshot.falhas(falhas_amostra, sd.timestamp_ms);
+
         // Publica evento sempre que há alerta/defeito/falha
         if (temp_alert || temp_defect || falha_ele || falha_hid) {
             std::ostringstream ss;
@@ -429,23 +509,25 @@ void MonitoramentoDeFalhas_thread(
             } catch(...) {}
         }
 
-        std::this_thread::sleep_for(40ms);
+        co_await ritmo.pausa(40ms);
     }
 }
 
 // -------------------------------------------
-// THREAD 4: Controle de Navegação (Acadêmico)
+// TAREFA 4: Controle de Navegação (Acadêmico)
 // - modo manual: aplica comandos incrementais (operator intent)
 // - modo automático: controlador PI para velocidade + P para direção
 // - bumpless transfer ao habilitar controller
+// - desvio entre caminhões (ORCA, Orca.h) sobre rumo e velocidade desejados
 // -------------------------------------------
-void ControleDeNavegacao_thread(
+Tarefa ControleDeNavegacao_tarefa(
     std::atomic<bool>& stop_flag,
-    BufferCircular<SensorData>& buf_nav,
+    BufferCircular<SensorDataV2>& buf_nav,
     MqttClient& mqtt,
     EstadosCaminhao& estados,
     ComandosCaminhao& comandos,
     AtuadoresCaminhao& atuadores,
+    RitmoCaminhao& ritmo,
     int truck_id
 ) {
     const std::string topic_setp = "/mina/caminhoes/" + std::to_string(truck_id) + "/setpoints";
@@ -461,21 +543,81 @@ void ControleDeNavegacao_thread(
     const double Ts_sec = 0.1;   // período de controle (100 ms)
 
     // anti-windup: integrador limits
-    const double INT_MIN = -200.0;
-    const double INT_MAX = 200.0;
+    const double INTEG_MIN = -200.0;
+    const double INTEG_MAX = 200.0;
 
     int period_ms = static_cast<int>(Ts_sec * 1000.0);
 
+    // Controle longitudinal opcional por MPC (ATR_MPC=1); o padrão continua o PI.
+    // Horizonte de 20 ciclos (2 s) cobre a frenagem a partir da velocidade de cruzeiro.
+    const char* env_mpc = std::getenv("ATR_MPC");
+    const bool usar_mpc = env_mpc && std::string(env_mpc) == "1";
+    ParametrosMpc param_mpc;
+    param_mpc.ts = Ts_sec;
+    MpcVelocidade<20> mpc(param_mpc);
+
     // last sensor used to estimate speed (numerical differentiation)
+    // Amostras novas são identificadas pela seq (SensorDataV2), não pelo timestamp;
+    // lacunas na seq indicam amostras perdidas entre Tratamento e Navegação.
+    SensorDataV2 last_pk{};
+    bool have_last = false;
     SensorData last_sd{};
-    double last_disp_time = static_cast<double>(now_ms());
+    double last_disp_time = static_cast<double>(Relogio::mono_ms());
     double estimated_speed = 0.0; // px/s
+    uint64_t amostras_perdidas = 0;
+
+    // Desvio entre caminhões (ORCA, Orca.h); ATR_ORCA=0 desativa. Os vizinhos
+    // vêm do /posicao dos demais caminhões, extrapolado (ReconstrucaoPosicao.h).
+    const char* env_orca = std::getenv("ATR_ORCA");
+    const bool usar_orca = !(env_orca && std::string(env_orca) == "0");
+    const std::string filtro_pos = "/mina/caminhoes/+/posicao";
+    const std::string topic_pos = "/mina/caminhoes/" + std::to_string(truck_id) + "/posicao";
+    const uint64_t VIZINHO_EXPIRA_MS = 3000;
+    ParametrosOrca param_orca;
+    param_orca.periodo = Ts_sec;
+    Orca orca(param_orca);
+    std::map<int, ReconstrutorPosicao> frota;
+    std::vector<AgenteOrca> vizinhos_orca;
+    std::vector<const AgenteOrca*> ptr_vizinhos;
+    if (usar_orca) mqtt.subscribe_topic(filtro_pos);
+
+    // Ritmo adaptativo (RitmoAdaptativo.h): o regime sai do estado de cada
+    // ciclo; com MPC o período fica no Ts do modelo, exceto hibernando.
+    const int PERIODO_BASE_MS = period_ms;
+    PoliticaRitmo politica;
+    auto pausa_controle = [&](const EntradaRitmo& er) {
+        if (ritmo.ativo()) {
+            ritmo.definir(politica.avaliar(er, static_cast<uint64_t>(Relogio::mono_ms()),
+                                           static_cast<uint64_t>(ritmo.ultimo_despertar_ms())));
+        }
+        period_ms = (usar_mpc && ritmo.regime() != RegimeRitmo::Hibernando)
+                        ? PERIODO_BASE_MS : ritmo.periodo_controle_ms(PERIODO_BASE_MS);
+        return ritmo.pausa(std::chrono::milliseconds(period_ms));
+    };
 
     bool prev_auto = estados.e_automatico.load();
+    MqttClient::Publicador pub_atuadores =
+        mqtt.publicador("/mina/caminhoes/" + std::to_string(truck_id) + "/atuadores");
     while (!stop_flag.load()) {
-        // read latest sensor (wait for a short time)
-        SensorData sd;
-        bool have_sd = buf_nav.pop_wait_for(sd, 100ms);
+        // Lê a amostra mais nova: as intermediárias que chegaram durante a pausa
+        // são descartadas (não perdidas), senão buf_nav acumula atraso quando o
+        // sensor roda mais rápido que o controle.
+        auto lido = co_await buf_nav.pop_for(std::chrono::milliseconds(period_ms));
+        uint32_t lacuna = 0;
+        if (lido) {
+            if (have_last) lacuna = seq_lacuna(last_pk.seq, lido->seq);
+            SensorDataV2 mais;
+            while (buf_nav.try_pop(mais)) {
+                if (!seq_nova(lido->seq, mais.seq)) continue;
+                lacuna += seq_lacuna(lido->seq, mais.seq);
+                lido = mais;
+            }
+        }
+        bool have_sd = lido.has_value();
+        SensorDataV2 pk = lido.value_or(SensorDataV2{});
+        // descarta duplicatas/reordenações
+        if (have_sd && have_last && !seq_nova(last_pk.seq, pk.seq)) have_sd = false;
+        SensorData sd = have_sd ? para_v1(pk) : SensorData{};
 
         // update setpoint if MQTT sent
         auto maybe_sp = mqtt.try_pop_message(topic_setp);
@@ -488,16 +630,24 @@ void ControleDeNavegacao_thread(
         }
 
         // estimate speed from successive sensor samples (if available)
-        double now_t = static_cast<double>(now_ms());
-        if (have_sd && last_sd.timestamp_ms != 0 && sd.timestamp_ms != last_sd.timestamp_ms) {
-            double dt = (double)(sd.timestamp_ms - last_sd.timestamp_ms) / 1000.0;
+        double now_t = static_cast<double>(Relogio::mono_ms());
+        if (have_sd && have_last) {
+            if (lacuna > 0) {
+                amostras_perdidas += lacuna;
+                std::cerr << "[Controle] " << lacuna << " amostra(s) perdida(s) antes da seq "
+                          << pk.seq << " (total " << amostras_perdidas << ")\n";
+            }
+            double dt = (double)(pk.timestamp_ms - last_pk.timestamp_ms) / 1000.0;
             if (dt > 0.0001) {
-                double dx = double(sd.i_posicao_x - last_sd.i_posicao_x);
-                double dy = double(sd.i_posicao_y - last_sd.i_posicao_y);
+                // posição sub-pixel da amostra compacta
+                double dx = pk.x() - last_pk.x();
+                double dy = pk.y() - last_pk.y();
                 estimated_speed = std::hypot(dx, dy) / dt;
             }
         }
         if (have_sd) {
+            last_pk = pk;
+            have_last = true;
             last_sd = sd;
             last_disp_time = now_t;
         }
@@ -509,6 +659,42 @@ void ControleDeNavegacao_thread(
         }
         bool is_def = estados.e_defeito.load();
 
+        EntradaRitmo er;
+        er.automatico = is_auto;
+        er.defeito = is_def;
+        er.comandos_ativos = comandos.c_acelera.load() || comandos.c_direita.load() || comandos.c_esquerda.load();
+        er.velocidade = estimated_speed;
+        if (have_last) {
+            er.x = last_pk.x();
+            er.y = last_pk.y();
+            er.dist_borda = std::min({er.x, er.y, 1000.0 - er.x, 1000.0 - er.y}); // mundo 0..1000
+        }
+
+        // Vizinhos (ORCA): o /posicao da frota é drenado a cada ciclo, em
+        // qualquer modo; senão a fila cresce em manual/defeito e é reaplicada
+        // inteira na volta ao automático.
+        if (usar_orca) {
+            const uint64_t agora = static_cast<uint64_t>(Relogio::mono_ms());
+            for (auto& [topico, pl] : mqtt.drenar_filtro(filtro_pos, topic_pos)) {
+                int id = 0;
+                try { id = std::stoi(topico.substr(16)); } catch (...) { continue; } // "/mina/caminhoes/<id>/posicao"
+                frota[id].atualizar(pl, agora);
+            }
+            vizinhos_orca.clear();
+            for (auto it = frota.begin(); it != frota.end();) {
+                if (agora - it->second.recebido_em() > VIZINHO_EXPIRA_MS) { it = frota.erase(it); continue; }
+                const EstadoPosicao e = it->second.em(agora);
+                AgenteOrca o;
+                o.id = it->first;
+                o.pos = {e.x, e.y};
+                const double r = e.rumo * M_PI / 180.0;
+                if (e.com_modelo) o.vel = {e.v * cos(r), e.v * sin(r)};
+                if (have_last && std::hypot(o.pos.x - last_pk.x(), o.pos.y - last_pk.y()) <= param_orca.raio_vizinhanca)
+                    vizinhos_orca.push_back(o);
+                ++it;
+            }
+        }
+
         if (is_def) {
             // zero outputs in emergency
             atuadores.o_aceleracao.store(0);
@@ -516,8 +702,8 @@ void ControleDeNavegacao_thread(
             std::ostringstream ss;
             ss << "{\"o_acel\":0,\"o_dir\":" << atuadores.o_direcao.load()
                << ",\"e_automatico\":" << (is_auto?1:0) << ",\"e_defeito\":1}";
-            mqtt.publish("/mina/caminhoes/" + std::to_string(truck_id) + "/atuadores", ss.str());
-            std::this_thread::sleep_for(std::chrono::milliseconds(period_ms));
+            pub_atuadores.publicar(ss.str());
+            co_await pausa_controle(er);
             continue;
         }
 
@@ -531,7 +717,7 @@ void ControleDeNavegacao_thread(
             if (have_sd) {
                 setpoint_x = sd.i_posicao_x;
                 setpoint_y = sd.i_posicao_y;
-            } else if (last_sd.timestamp_ms != 0) {
+            } else if (have_last) {
                 setpoint_x = last_sd.i_posicao_x;
                 setpoint_y = last_sd.i_posicao_y;
             }
@@ -560,10 +746,10 @@ void ControleDeNavegacao_thread(
             std::ostringstream ss;
             ss << "{\"o_acel\":" << acel << ",\"o_dir\":" << dir
                << ",\"e_automatico\":0,\"e_defeito\":0}";
-            mqtt.publish("/mina/caminhoes/" + std::to_string(truck_id) + "/atuadores", ss.str());
+            pub_atuadores.publicar(ss.str());
 
             // Aguarda o próximo ciclo de controle.
-            std::this_thread::sleep_for(std::chrono::milliseconds(period_ms));
+            co_await pausa_controle(er);
             continue;
         }
 
@@ -573,12 +759,13 @@ void ControleDeNavegacao_thread(
             // proporcional à aceleração atual. Isso evita um "tranco" no integrador
             // quando o controle automático é ativado, garantindo uma transição suave.
             integrador_v = static_cast<double>(atuadores.o_aceleracao.load()) * 0.1;
+            mpc.reiniciar(static_cast<double>(atuadores.o_aceleracao.load()));
             controller_enabled = true;
         }
 
         // Se não houver leitura do sensor disponível, aguarda e tenta novamente no próximo ciclo.
         if (!have_sd) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(period_ms));
+            co_await pausa_controle(er);
             continue;
         }
 
@@ -600,6 +787,33 @@ void ControleDeNavegacao_thread(
             desired_ang = atan2((double)dy, (double)dx) * 180.0 / M_PI;
             if (desired_ang < 0) desired_ang += 360.0; // Normaliza para 0-359
         }
+        // Define a velocidade desejada proporcional à distância até o alvo (máx 80.0).
+        double desired_speed = std::min(80.0, dist * 0.4);
+        double dist_ref = dist; // distância equivalente para o MPC
+
+        // --- Desvio entre caminhões (ORCA) ---
+        // Troca a velocidade desejada (rumo e módulo) pela mais próxima livre
+        // de colisão com os vizinhos nos próximos tau segundos (vizinhos_orca
+        // é montado no início do ciclo).
+        if (usar_orca && !vizinhos_orca.empty()) {
+            ptr_vizinhos.clear();
+            for (const AgenteOrca& o : vizinhos_orca) ptr_vizinhos.push_back(&o);
+            const double r_atual = current_ang * M_PI / 180.0;
+            const double r_desej = desired_ang * M_PI / 180.0;
+            AgenteOrca eu;
+            eu.id = truck_id;
+            eu.pos = {pk.x(), pk.y()};
+            eu.vel = {estimated_speed * cos(r_atual), estimated_speed * sin(r_atual)};
+            eu.vel_pref = {desired_speed * cos(r_desej), desired_speed * sin(r_desej)};
+            const Vetor2 v = orca.resolver(eu, ptr_vizinhos);
+            desired_speed = std::hypot(v.x, v.y);
+            if (desired_speed > 0.5) {
+                desired_ang = atan2(v.y, v.x) * 180.0 / M_PI;
+                if (desired_ang < 0) desired_ang += 360.0;
+            }
+            dist_ref = std::min(dist, desired_speed / 0.4);
+        }
+
         // Função auxiliar para normalizar o erro angular entre -180 e 180 graus.
         auto wrap180 = [](double a) {
             while (a > 180.0) a -= 360.0;
@@ -608,24 +822,29 @@ void ControleDeNavegacao_thread(
         };
         // Calcula o erro angular e aplica o ganho proporcional (Kp_ang).
         double ang_err = wrap180(desired_ang - current_ang);
+        er.dist_alvo = dist;
+        er.erro_rumo = ang_err;
+        for (const AgenteOrca& o : vizinhos_orca) {
+            const double d = std::hypot(o.pos.x - pk.x(), o.pos.y - pk.y());
+            if (er.dist_vizinho < 0.0 || d < er.dist_vizinho) er.dist_vizinho = d;
+        }
         int out_dir = static_cast<int>(current_ang + std::round(Kp_ang * ang_err));
         // Normaliza o ângulo de saída para o intervalo -180 a 180.
         if (out_dir > 180) out_dir -= 360;
         if (out_dir < -180) out_dir += 360;
 
         // --- Controlador de Velocidade (Proporcional-Integral - PI) ---
-        // Define a velocidade desejada proporcional à distância até o alvo (máx 80.0).
-        double desired_speed = std::min(80.0, dist * 0.4);
         double current_speed = estimated_speed; // Velocidade estimada anteriormente
         double error_v = desired_speed - current_speed; // Erro de velocidade
 
         // Atualização discreta do integrador com proteção anti-windup (limites).
-        integrador_v += error_v * Ki_v * Ts_sec;
-        if (integrador_v > INT_MAX) integrador_v = INT_MAX;
-        if (integrador_v < INT_MIN) integrador_v = INT_MIN;
+        integrador_v += error_v * Ki_v * (period_ms / 1000.0); // período real do ciclo
+        if (integrador_v > INTEG_MAX) integrador_v = INTEG_MAX;
+        if (integrador_v < INTEG_MIN) integrador_v = INTEG_MIN;
 
-        // Calcula a saída de aceleração (comando P + I).
-        double out_acc = Kp_v * error_v + integrador_v;
+        // Calcula a saída de aceleração (comando P + I, ou MPC se habilitado).
+        double out_acc = usar_mpc ? mpc.calcular(dist_ref, current_speed)
+                                  : Kp_v * error_v + integrador_v;
         int out_acc_i = static_cast<int>(std::round(out_acc));
         // Limita a aceleração de saída ao intervalo -100 a 100.
         if (out_acc_i > 100) out_acc_i = 100;
@@ -639,39 +858,94 @@ void ControleDeNavegacao_thread(
         std::ostringstream ss;
         ss << "{\"o_acel\":" << out_acc_i << ",\"o_dir\":" << out_dir
            << ",\"e_automatico\":1,\"e_defeito\":0}";
-        mqtt.publish("/mina/caminhoes/" + std::to_string(truck_id) + "/atuadores", ss.str());
+        pub_atuadores.publicar(ss.str());
 
         // Aguarda o próximo ciclo de controle.
-        std::this_thread::sleep_for(std::chrono::milliseconds(period_ms));
+        co_await pausa_controle(er);
+    }
+
+    if (usar_mpc) {
+        const EstatisticasMpc& e = mpc.estatisticas();
+        std::cerr << "[Controle] MPC: " << e.solucoes << " soluções, pior " << e.max_us
+                  << " us, " << e.estouros << " acima do orçamento\n";
+    }
+    if (usar_orca && orca.estatisticas().solucoes > 0) {
+        const EstatisticasOrca& e = orca.estatisticas();
+        std::cerr << "[Controle] ORCA: " << e.solucoes << " soluções, " << e.inviaveis
+                  << " inviáveis, pior " << e.max_us << " us\n";
+    }
+}
+
+// Último timestamp_ms gravado no CSV (lê só o final do arquivo); -1 se não
+// há linha de dados.
+static int64_t ultimo_timestamp_csv(const fs::path& caminho)
+{
+    std::ifstream fin(caminho, std::ios::binary);
+    if (!fin) return -1;
+    fin.seekg(0, std::ios::end);
+    const std::streamoff tam = fin.tellg();
+    const std::streamoff n = std::min<std::streamoff>(tam, 4096);
+    if (n <= 0) return -1;
+    std::string cauda(static_cast<size_t>(n), '\0');
+    fin.seekg(tam - n);
+    fin.read(&cauda[0], n);
+    const size_t fim = cauda.find_last_not_of("\r\n");
+    if (fim == std::string::npos) return -1;
+    const size_t ini = cauda.rfind('\n', fim);
+    try {
+        return std::stoll(cauda.substr(ini == std::string::npos ? 0 : ini + 1));
+    } catch (...) {
+        return -1; // cabeçalho
     }
 }
 
 // -------------------------------------------
-// THREAD 5: Coletor de Dados
+// TAREFA 5: Coletor de Dados
 // - grava logs Tabela 3 (timestamp, id, estado, pos, evento)
 // - grava csv detalhado (sensores+atuadores)
 // - publica /logs simplificado
 // -------------------------------------------
-void ColetorDeDados_thread(
+Tarefa ColetorDeDados_tarefa(
     std::atomic<bool>& stop_flag,
-    BufferCircular<SensorData>& buf_coletor,
-    BufferCircular<SensorData>& buf_logic,
+    BufferCircular<SensorDataV2>& buf_coletor,
+    BufferCircular<SensorDataV2>& buf_logic,
     BufferCircular<std::string>& buf_cmds,
     MqttClient& mqtt,
     EstadosCaminhao& estados,
     ComandosCaminhao& comandos,
     AtuadoresCaminhao& atuadores,
+    PublicadorSnapshot& snapshot,
+    AgregadorKpi& kpi,
+    RitmoCaminhao& ritmo,
     int truck_id
 ) {
+    PerfContadores::nomear_thread("Coletor");
+
     // criar pasta logs se não existir
     try { fs::create_directories("logs");} catch(...) {}
 
-    std::ofstream fout("logs/logs_caminhao.txt", std::ios::app);
-
     // Verifica se o CSV já existe e se o cabeçalho contém a nova coluna.
+    // Os reparos de formato só valem para logs antigos: um CSV já compactado
+    // (CompactacaoLog.h) começa num trecho descartado e não é relido inteiro.
     fs::path detailed_path = "logs/logs_caminhao_detailed.csv";
+
+    // CSV de versões anteriores, carimbado com o relógio monotônico: não se
+    // mistura com carimbos Unix (índice e compactação assumem tempo crescente).
+    // Fica ao lado como .monotonico; índice e estado da compactação recomeçam.
+    try {
+        const int64_t ultimo = ultimo_timestamp_csv(detailed_path);
+        if (ultimo >= 0 && ultimo < Relogio::UNIX_MS_MINIMO) {
+            fs::rename(detailed_path, detailed_path.string() + ".monotonico");
+            fs::remove(detailed_path.string() + ".idx");
+            fs::remove(detailed_path.string() + ".compactacao");
+            std::cerr << "[Coletor] CSV com carimbos monotônicos movido para "
+                      << detailed_path.string() << ".monotonico\n";
+        }
+    } catch (...) { /* best-effort */ }
+
+    const bool log_compactado = inicio_dados_log(detailed_path.string()) > 0;
     try {
-        if (fs::exists(detailed_path)) {
+        if (!log_compactado && fs::exists(detailed_path)) {
             // lê primeira linha para checar cabeçalho existente
             std::ifstream fin(detailed_path);
             std::string first;
@@ -713,7 +987,7 @@ void ColetorDeDados_thread(
     // ou linhas históricas sem a coluna e_alerta_temp e reescrever o arquivo de forma segura.
     try {
         std::ifstream fincheck(detailed_path);
-        if (fincheck) {
+        if (fincheck && !log_compactado) {
             std::vector<std::string> lines;
             std::string l;
             while (std::getline(fincheck, l)) lines.push_back(l);
@@ -765,15 +1039,36 @@ void ColetorDeDados_thread(
     } catch(...) {
         try { fout_detailed << "timestamp_ms,truck_id,pos_x,pos_y,ang,temp,fe,fh,o_acel,o_dir,e_auto,e_defeito,e_alerta_temp\n"; } catch(...) {}
     }
+    fout_detailed.close();
+
+    // Índice esparso de timestamps (logs_caminhao_detailed.csv.idx, ver IndiceLog.h).
+    // Criado depois dos reparos acima: se o CSV foi reescrito, o índice é reconstruído.
+    // Declarado antes do gravador: os callbacks de offset o usam até o gravador fechar.
+    EscritorIndiceLog indice(detailed_path.string());
+
+    // As escritas dos dois logs saem desta tarefa e vão para a thread de E/S
+    // do gravador (io_uring, ou write() como fallback; ver IoLog.h).
+    GravadorLog gravador;
+    const int arq_txt = gravador.abrir("logs/logs_caminhao.txt");
+    const int arq_det = gravador.abrir(detailed_path.string());
+
+    const std::string base_topico = "/mina/caminhoes/" + std::to_string(truck_id);
+    MqttClient::Publicador pub_logs = mqtt.publicador(base_topico + "/logs");
+    MqttClient::Publicador pub_estado = mqtt.publicador(base_topico + "/estado");
 
     while (!stop_flag.load()) {
-        SensorData sd;
-        if (!buf_coletor.pop_wait_for(sd, 200ms)) {
+        auto amostra = co_await buf_coletor.pop_for(200ms);
+        if (!amostra) {
             continue;
         }
+        PerfContadores::nomear_thread("Coletor"); // a tarefa pode ter migrado de thread
+        SensorData sd = para_v1(*amostra);
 
         bool is_auto = estados.e_automatico.load();
         bool is_def  = estados.e_defeito.load();
+        snapshot.estado(is_auto, is_def, estados.e_alerta_temperatura.load()); // publica só se mudou
+        kpi.amostra(amostra->timestamp_ms, amostra->x(), amostra->y(), amostra->temperatura(),
+                    is_auto, estados.e_alerta_temperatura.load(), is_def);
 
         // descrição do evento: se houver alerta de temperatura global, priorizar "ALERTA_TEMP"
         std::string desc_str;
@@ -788,26 +1083,35 @@ void ColetorDeDados_thread(
             else desc_str = desc.str();
         }
 
-        // Tabela 3
-           std::ostringstream line;
-           // Formato Tabela 3: timestamp_ms,truck_id,estado,pos_x,pos_y,descricao
-           line << sd.timestamp_ms << "," << truck_id << "," << (is_auto?"AUTOMATICO":"MANUAL") << ","
-               << sd.i_posicao_x << "," << sd.i_posicao_y << "," << desc_str;
-        fout << line.str() << "\n";
-        fout.flush();
-
-        // csv detalhado
-        fout_detailed << sd.timestamp_ms << "," << truck_id << ","
-                  << sd.i_posicao_x << "," << sd.i_posicao_y << "," << sd.i_angulo_x << ","
-                  << sd.i_temperatura << "," << sd.i_falha_eletrica << "," << sd.i_falha_hidraulica << ","
-                  << atuadores.o_aceleracao.load() << "," << atuadores.o_direcao.load() << ","
-                  << (is_auto?1:0) << "," << (is_def?1:0) << "," << (estados.e_alerta_temperatura.load()?1:0) << "\n";
-        fout_detailed.flush();
+        {
+            EstagioPerf ep("log_csv");
+            // Tabela 3
+            std::ostringstream line;
+            // Formato Tabela 3: timestamp_ms,truck_id,estado,pos_x,pos_y,descricao
+            line << sd.timestamp_ms << "," << truck_id << "," << (is_auto?"AUTOMATICO":"MANUAL") << ","
+                << sd.i_posicao_x << "," << sd.i_posicao_y << "," << desc_str;
+            line << "\n";
+            gravador.escrever(arq_txt, line.str());
+
+            // csv detalhado (o offset em que a linha foi gravada alimenta o índice esparso)
+            std::ostringstream det;
+            det << sd.timestamp_ms << "," << truck_id << ","
+                << sd.i_posicao_x << "," << sd.i_posicao_y << "," << sd.i_angulo_x << ","
+                << sd.i_temperatura << "," << sd.i_falha_eletrica << "," << sd.i_falha_hidraulica << ","
+                << atuadores.o_aceleracao.load() << "," << atuadores.o_direcao.load() << ","
+                << (is_auto?1:0) << "," << (is_def?1:0) << "," << (estados.e_alerta_temperatura.load()?1:0) << "\n";
+            std::string linha_det = det.str();
+            const int64_t ts_det = static_cast<int64_t>(sd.timestamp_ms);
+            const uint64_t tam_det = linha_det.size();
+            gravador.escrever(arq_det, std::move(linha_det), [&indice, ts_det, truck_id, tam_det](uint64_t offset) {
+                indice.registrar(ts_det, truck_id, offset, tam_det);
+            });
+        }
 
         // publicar log simplificado
         std::ostringstream ss;
         ss << sd.timestamp_ms << "," << truck_id << "," << sd.i_posicao_x << "," << sd.i_posicao_y << "," << sd.i_angulo_x;
-        mqtt.publish("/mina/caminhoes/" + std::to_string(truck_id) + "/logs", ss.str());
+        pub_logs.publicar(ss.str());
 
         // publicar estado atual para Interface Local
         try {
@@ -824,11 +1128,11 @@ void ColetorDeDados_thread(
                  << "\"falha_elet\":" << (sd.i_falha_eletrica?1:0) << ","
                  << "\"falha_hidr\":" << (sd.i_falha_hidraulica?1:0)
                  << "}";
-            mqtt.publish("/mina/caminhoes/" + std::to_string(truck_id) + "/estado", estj.str());
+            pub_estado.publicar(estj.str());
         } catch(...) {}
 
         // Também checar comandos vindos da Interface Local e atualizar flags locais
-        // (faz papel similar ao LogicaDeComando_thread caso a interface publique direto no tópico)
+        // (faz papel similar ao LogicaDeComando_tarefa caso a interface publique direto no tópico)
         auto maybe_cmd = mqtt.try_pop_message("/mina/caminhoes/" + std::to_string(truck_id) + "/comandos");
         if (maybe_cmd) {
             std::string pl = *maybe_cmd;
@@ -868,19 +1172,122 @@ void ColetorDeDados_thread(
             }
             // Empurra payload de comando (string) para buffer dedicado
             try {
-                buf_cmds.push_wait(pl);
+                co_await buf_cmds.push(pl);
                 std::cerr << "[Coletor] forwarded to buf_cmds: '" << pl << "'\n";
                 // also record a diagnostic entry in the textual log to make debugging visible
                 try {
-                    fout << "DBG_CMD," << sd.timestamp_ms << "," << truck_id << "," << pl << "\n";
-                    fout.flush();
+                    gravador.escrever(arq_txt, "DBG_CMD," + std::to_string(sd.timestamp_ms) + "," +
+                                               std::to_string(truck_id) + "," + pl + "\n");
                 } catch(...) {}
             } catch(...) { std::cerr << "[Coletor] push to buf_cmds failed\n"; }
         }
 
-        std::this_thread::sleep_for(40ms);
+        co_await ritmo.pausa(40ms);
     }
 
-    fout.close(); 
-    fout_detailed.close();
+    gravador.descarregar();
+    auto est = gravador.estatisticas();
+    std::cout << "[Coletor] logs via " << gravador.backend() << ": " << est.linhas << " linhas em "
+              << est.rodadas << " lotes, " << est.chamadas << " syscalls, " << est.fsyncs
+              << " fsyncs, " << est.erros << " erros, " << est.sem_offset << " lotes sem offset\n";
+}
+
+// -------------------------------------------
+// TAREFA 6: Gerenciador de Rota
+// - publica em /setpoints o waypoint atual da rota
+// - avança quando a posição (reconstruída de /posicao) fica a menos de 12 px do waypoint
+// - aceita rota nova em /route (ignora o eco da própria republicação)
+// -------------------------------------------
+Tarefa GerenciadorDeRota_tarefa(
+    std::atomic<bool>& stop_flag,
+    MqttClient& mqtt,
+    Route& route,
+    CheckpointCaminhao& checkpoint,
+    PublicadorSnapshot& snapshot,
+    AgregadorKpi& kpi,
+    RitmoCaminhao& ritmo,
+    int truck_id
+) {
+    if (route.size() == 0) co_return; // nada a fazer
+
+    const std::string topic_setp = "/mina/caminhoes/" + std::to_string(truck_id) + "/setpoints";
+    const std::string topic_route = "/mina/caminhoes/" + std::to_string(truck_id) + "/route";
+    const std::string topic_pos = "/mina/caminhoes/" + std::to_string(truck_id) + "/posicao";
+
+    // Warm start: retoma do waypoint salvo no checkpoint
+    size_t idx = 0;
+    {
+        std::lock_guard<MutexAtr> lk(state_mtx);
+        if (checkpoint.valido && checkpoint.waypoint_idx < route.size()) idx = checkpoint.waypoint_idx;
+    }
+    snapshot.waypoint(idx);
+
+    // Inscreve nos tópicos de posição e rota para acompanhar progresso e receber atualizações
+    try {
+        mqtt.subscribe_topic(topic_pos);
+        mqtt.subscribe_topic(topic_route);
+    } catch(...) {}
+
+    const auto publish_interval = 500ms; // atualiza setpoint a cada 500ms
+    const double reach_threshold = 12.0; // distância (px) para considerar waypoint alcançado
+
+    auto publica_setpoint = [&]() {
+        const Waypoint &wp = route[idx];
+        std::ostringstream ss;
+        ss << "x=" << static_cast<int>(std::round(wp.x)) << ",y=" << static_cast<int>(std::round(wp.y));
+        mqtt.publish(topic_setp, ss.str());
+    };
+
+    ReconstrutorPosicao reconstrutor;
+    std::string last_route_payload;
+    std::optional<std::string> maybe_route; // chegada durante a espera do ciclo anterior
+    publica_setpoint();
+
+    while (!stop_flag.load()) {
+        // ignora o eco da própria republicação (senão a rota reiniciaria a cada ciclo)
+        if (maybe_route && *maybe_route == last_route_payload) maybe_route.reset();
+        if (maybe_route) {
+            std::string pl = *maybe_route;
+            std::cerr << "[RouteMgr] received route payload (len=" << pl.size() << ")\n";
+            // best-effort: parse payload as same text format used by files
+            Route nova;
+            if (nova.loadFromString(pl) && nova.size() > 0) {
+                route = nova;
+                std::cerr << "[RouteMgr] route updated: " << route.size() << " waypoints\n";
+                idx = 0; // reinicia sequência
+                snapshot.rota(route);
+                last_route_payload = pl;
+                // republishes updated route for others
+                try { mqtt.publish(topic_route, pl); } catch(...){}
+            } else {
+                std::cerr << "[RouteMgr] failed to parse incoming route payload\n";
+            }
+        }
+
+        // read position messages (non-blocking); /posicao chega esparsa
+        // (dead reckoning), então a posição usada é a extrapolada agora
+        const uint64_t agora = static_cast<uint64_t>(Relogio::mono_ms());
+        while (auto maybe = mqtt.try_pop_message(topic_pos)) reconstrutor.atualizar(*maybe, agora);
+        if (reconstrutor.valido()) {
+            const EstadoPosicao pos = reconstrutor.em(agora);
+            const Waypoint &cur = route[idx];
+            double dist = std::hypot(pos.x - cur.x, pos.y - cur.y);
+            // avança waypoint (no último, permanece nele)
+            if (dist <= reach_threshold && idx + 1 < route.size()) {
+                idx++;
+                snapshot.waypoint(idx);
+                kpi.waypoint_alcancado();
+                publica_setpoint();
+            }
+        }
+
+        // periodic publish to ensure controller has current target
+        publica_setpoint();
+
+        // espera o próximo ciclo ou uma rota nova, o que vier primeiro
+        maybe_route = co_await mqtt.next_for(topic_route, ritmo.espera(publish_interval));
+    }
+
+    std::lock_guard<MutexAtr> lk(state_mtx);
+    checkpoint.waypoint_idx = idx;
 }
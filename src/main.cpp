@@ -11,16 +11,17 @@
  * para comunicação entre threads, conexão com o broker MQTT e reinicialização
  * das estruturas globais de estado, comandos e atuadores.
  * 3. Gerenciamento de rotas: Carrega a rota inicial de um arquivo e inicia uma
- * thread dedicada (th_route_mgr) para gerenciar a navegação ponto a ponto,
+ * tarefa dedicada (GerenciadorDeRota_tarefa) para a navegação ponto a ponto,
  * publicando os setpoints sequencialmente via MQTT e permitindo atualizações
  * dinâmicas da rota em tempo de execução.
- * 4. Lançamento das threads de trabalho: Inicia as cinco threads principais do
+ * 4. Lançamento das tarefas de trabalho: Inicia as cinco tarefas principais do
  * sistema (TratamentoSensores, LogicaDeComando, MonitoramentoDeFalhas,
- * ControleDeNavegacao, ColetorDeDados), passando a elas as referências
- * necessárias para os buffers, cliente MQTT e estados globais.
+ * ControleDeNavegacao, ColetorDeDados) como corrotinas num Executor com
+ * poucas threads (Executor.h), passando a elas as referências necessárias
+ * para os buffers, cliente MQTT e estados globais.
  * 5. Loop principal e encerramento: Mantém o programa em execução até receber
  * um sinal de parada, momento em que coordena o encerramento gracioso de
- * todas as threads e a desconexão do broker MQTT antes de finalizar o processo.
+ * todas as tarefas e a desconexão do broker MQTT antes de finalizar o processo.
  *
  * Bibliotecas Utilizadas:
  * - iostream, sstream: E/S padrão e manipulação de strings.
@@ -43,6 +44,8 @@
 #include <cstdlib>
 #include <filesystem>
 #include <cmath>
+#include <map>
+#include <stdexcept>
 
 #include "BufferCircular.h"
 #include "SensorData.h"
@@ -51,39 +54,169 @@
 #include "MqttClient.h"
 #include "Autuadores.h"
 #include "Route.h"
+#include "PerfilLocks.h"
+#include "PerfContadores.h"
+#include "Checkpoint.h"
+#include "HostFrota.h"
+#include "Despachante.h"
+#include "Executor.h"
+#include "Reator.h"
+#include "IndiceLog.h"
+#include "Cenario.h"
+#include "KpiCaminhao.h"
+#include "ServicoMapaCalor.h"
+#include "ServicoSeries.h"
+#include "RpcMqtt.h"
+#include "JsonSimples.h"
+#include "CompactacaoLog.h"
+#include "Relogio.h"
 
 // =======================================================================
 // NOTE: As variáveis ESTADO/COMANDO/ATUADOR são declaradas em Autuadores.h
 // e DEFINIDAS em src/Autuadores.cpp (uma única definição do produto).
 // =======================================================================
 
-// Ponteiro usado pelo signal handler para sinalizar encerramento.
-// Declarado aqui como ponteiro nulo até inicializarmos a flag no main.
-static std::atomic<bool>* g_stop_ptr = nullptr;
+// --------------------------------------------------------------
+// Consulta ao log CSV detalhado pelo índice esparso (IndiceLog.h):
+//   --log-query=T            estado do caminhão (--truck-id=N) no instante T
+//   --log-query=T0,T1        linhas no intervalo (de todos, ou de --truck-id)
+//   --log-file=PATH          CSV consultado (padrão logs/logs_caminhao_detailed.csv)
+//   --log-reindex            reconstrói o índice do CSV
+//   --log-tier=1s|1min       consulta os níveis agregados (CompactacaoLog.h)
+//   --log-compact-once       uma rodada de compactação (ver config_compactacao)
+// Retorna -1 se nenhum desses argumentos foi passado.
+// --------------------------------------------------------------
+
+// Compactação do log (CompactacaoLog.h):
+//   --log-age-h=H            idade a partir da qual o bruto é agregado (padrão 72)
+//   --log-raw=delete|archive|keep   destino do bruto agregado (padrão delete)
+//   --log-keep-1s-d=D        retenção do nível de 1 s em dias (padrão 30; 0 = sempre)
+//   --log-compact-jobs=N     threads de agregação (padrão metade dos núcleos)
+static ConfigCompactacao config_compactacao(int argc, char** argv)
+{
+    ConfigCompactacao cfg;
+    for (int i = 1; i < argc; ++i) {
+        std::string a(argv[i]);
+        try {
+            if (a.rfind("--log-file=", 0) == 0) cfg.csv = a.substr(11);
+            else if (a.rfind("--log-age-h=", 0) == 0) cfg.idade_ms = static_cast<int64_t>(std::stod(a.substr(12)) * 3600000.0);
+            else if (a.rfind("--log-keep-1s-d=", 0) == 0) cfg.retencao_1s_ms = static_cast<int64_t>(std::stod(a.substr(16)) * 86400000.0);
+            else if (a.rfind("--log-compact-jobs=", 0) == 0) cfg.paralelismo = static_cast<unsigned>(std::stoul(a.substr(19)));
+            else if (a == "--log-raw=archive") cfg.bruto = ConfigCompactacao::Bruto::Arquivar;
+            else if (a == "--log-raw=keep") cfg.bruto = ConfigCompactacao::Bruto::Manter;
+            else if (a == "--log-compact-once") cfg.uma_vez = true;
+        } catch (...) {
+            std::cerr << "[LOG] argumento inválido: " << a << "\n";
+        }
+    }
+    return cfg;
+}
 
-void signal_handler(int)
+static int executar_consulta_log(int argc, char** argv)
 {
-    if (g_stop_ptr) {
-        g_stop_ptr->store(true);
+    std::string consulta;
+    std::string arquivo = "logs/logs_caminhao_detailed.csv";
+    std::string nivel;
+    int truck = -1;
+    bool reindexar = false;
+    bool compactar = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string a(argv[i]);
+        if (a.rfind("--log-query=", 0) == 0) consulta = a.substr(12);
+        else if (a.rfind("--log-file=", 0) == 0) arquivo = a.substr(11);
+        else if (a.rfind("--log-tier=", 0) == 0) nivel = a.substr(11);
+        else if (a == "--log-reindex") reindexar = true;
+        else if (a == "--log-compact-once") compactar = true;
+        else if (a.rfind("--truck-id=", 0) == 0) {
+            try { truck = std::stoi(a.substr(11)); } catch(...) { }
+        }
+    }
+    if (consulta.empty() && !reindexar && !compactar) return -1;
+
+    if (compactar) {
+        std::atomic<bool> nunca(false);
+        return executar_compactacao(config_compactacao(argc, argv), nunca);
+    }
+
+    if (reindexar) {
+        long n = reconstruir_indice_log(arquivo);
+        std::cerr << "[LOG] índice de '" << arquivo << "': " << n << " entradas\n";
+        if (n < 0) return 1;
+        if (consulta.empty()) return 0;
+    }
+
+    int64_t t0 = 0, t1 = 0;
+    try {
+        size_t virg = consulta.find(',');
+        t0 = std::stoll(consulta.substr(0, virg));
+        t1 = virg == std::string::npos ? t0 : std::stoll(consulta.substr(virg + 1));
+    } catch (...) {
+        std::cerr << "[LOG] uso: --log-query=T0[,T1] [--truck-id=N] [--log-file=PATH]\n";
+        return 1;
+    }
+
+    auto inicio = std::chrono::steady_clock::now();
+    if (!nivel.empty()) {
+        const ConfigCompactacao cfg = config_compactacao(argc, argv);
+        size_t n = consultar_agregados(cfg.dir_agregados, nivel, t0, t1, truck,
+                                       [](int64_t balde, int tr, const Agregado& a) {
+                                           std::cout << serializar_agregado(balde, tr, a) << "\n";
+                                           return true;
+                                       });
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - inicio).count();
+        std::cerr << "[LOG] " << n << " balde(s) de " << nivel << " em " << us << " us\n";
+        return 0;
+    }
+    LeitorLog leitor(arquivo);
+    size_t n = 0;
+    if (consulta.find(',') == std::string::npos && truck >= 0) {
+        if (auto linha = leitor.estado_em(t0, truck)) {
+            std::cout << *linha << "\n";
+            n = 1;
+        }
+    } else {
+        n = leitor.consultar(t0, t1, truck, [](const std::string& linha) {
+            std::cout << linha << "\n";
+            return true;
+        });
     }
-    std::cout << "\n[MAIN] Encerrando (Ctrl+C)...\n";
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                  std::chrono::steady_clock::now() - inicio).count();
+    std::cerr << "[LOG] " << n << " linha(s) em " << us << " us (índice com "
+              << leitor.entradas() << " entradas)\n";
+    return 0;
 }
 
 int main(int argc, char** argv)
 {
+    int rc_consulta = executar_consulta_log(argc, argv);
+    if (rc_consulta >= 0) return rc_consulta;
+
     std::cout << "=========================================\n";
     std::cout << "     Sistema ATR - Caminhão Autônomo     \n";
     std::cout << "=========================================\n";
 
+    // Calibra o relógio das amostras (Relogio.h) antes de qualquer tarefa.
+    Relogio::calibrar();
+    std::cout << Relogio::resumo() << "\n";
+
     std::this_thread::sleep_for(std::chrono::seconds(3));
     
     // --------------------------------------------------------------
-    // Flag local de encerramento (passada para as threads por ref)
-    // e registro do handler via ponteiro global seguro para o handler.
+    // Flag local de encerramento (passada para as tarefas por ref).
+    // SIGINT/SIGTERM chegam pelo signalfd do reator, tratados na thread
+    // do reator (não num signal handler). Precisa vir antes de qualquer
+    // outra thread para que todas herdem a máscara de sinais.
     // --------------------------------------------------------------
     std::atomic<bool> stop_flag(false);
-    g_stop_ptr = &stop_flag;
-    std::signal(SIGINT, signal_handler);
+    Reator reator;
+    reator.tratar_sinais({SIGINT, SIGTERM}, [&](int sig) {
+        stop_flag.store(true);
+        std::cout << "\n[MAIN] Encerrando (" << (sig == SIGTERM ? "SIGTERM" : "Ctrl+C") << ")...\n";
+        reator.parar();
+    });
+    reator.iniciar();
 
     // --------------------------------------------------------------
     // Cria diretório de logs caso não exista
@@ -97,26 +230,94 @@ int main(int argc, char** argv)
     // --------------------------------------------------------------
     // Instancia buffers circulares
     // --------------------------------------------------------------
-    BufferCircular<SensorData> BUF_NAV(200);
-    BufferCircular<SensorData> BUF_LOGIC(200);
-    BufferCircular<SensorData> BUF_FALHAS(200);
-    BufferCircular<SensorData> BUF_COLETOR(200);
-    BufferCircular<std::string> BUF_CMDS(200);
+    BufferCircular<SensorDataV2> BUF_NAV(200, "BUF_NAV");
+    BufferCircular<SensorDataV2> BUF_LOGIC(200, "BUF_LOGIC");
+    BufferCircular<SensorDataV2> BUF_FALHAS(200, "BUF_FALHAS");
+    BufferCircular<SensorDataV2> BUF_COLETOR(200, "BUF_COLETOR");
+    BufferCircular<std::string> BUF_CMDS(200, "BUF_CMDS");
 
     // --------------------------------------------------------------
     // Parse simples de argumentos: --truck-id=N e --route=PATH
+    // Modo host de frota: --fleet-host=NOME --fleet-trucks=1-20 [--fleet-routes=1:a.route,2:b.route]
+    // --warm-start: restaura o checkpoint retido do caminhão, se houver
+    // Modo despachante: --dispatcher --fleet-trucks=1-20 [--road-graph=PATH]
+    // Modo cenário: --cenario=a.cen[,b.cen] [--cenario-saida=PATH] [--cenario-rotulo=TXT]
+    // Modo mapa de calor: --heatmap --fleet-trucks=1-20
+    // Modo séries temporais: --timeseries --fleet-trucks=1-20
+    // Cliente RPC: --rpc=N:metodo [--rpc-params=JSON] (ver RpcMqtt.h)
+    // Modo compactação do log: --log-compact [--log-age-h=H --log-raw=...]
     // --------------------------------------------------------------
     int truck_id = 1;
     std::string arg_route;
+    std::string fleet_host;
+    std::string fleet_trucks = "1";
+    std::map<int, std::string> fleet_routes;
+    bool warm_start = false;
+    bool dispatcher = false;
+    std::string arg_malha;
+    bool heatmap = false;
+    bool timeseries = false;
+    bool compactar_log = false;
+    std::string rpc_chamada;
+    std::string rpc_params = "{}";
+    ConfigCampanha campanha;
     for (int i = 1; i < argc; ++i) {
         std::string a(argv[i]);
         if (a.rfind("--truck-id=", 0) == 0) {
             try { truck_id = std::stoi(a.substr(11)); } catch(...) { }
         } else if (a.rfind("--route=", 0) == 0) {
             arg_route = a.substr(8);
+        } else if (a.rfind("--fleet-host=", 0) == 0) {
+            fleet_host = a.substr(13);
+        } else if (a.rfind("--fleet-trucks=", 0) == 0) {
+            fleet_trucks = a.substr(15);
+        } else if (a.rfind("--fleet-routes=", 0) == 0) {
+            std::istringstream lista(a.substr(15));
+            std::string par;
+            while (std::getline(lista, par, ',')) {
+                const size_t sep = par.find(':');
+                try {
+                    if (sep == std::string::npos) throw std::invalid_argument(par);
+                    fleet_routes[std::stoi(par.substr(0, sep))] = par.substr(sep + 1);
+                } catch (...) {
+                    std::cerr << "[MAIN] --fleet-routes: par inválido '" << par << "' (esperado id:rota)\n";
+                }
+            }
+        } else if (a == "--warm-start") {
+            warm_start = true;
+        } else if (a == "--dispatcher") {
+            dispatcher = true;
+        } else if (a.rfind("--road-graph=", 0) == 0) {
+            arg_malha = a.substr(13);
+        } else if (a == "--heatmap") {
+            heatmap = true;
+        } else if (a == "--timeseries") {
+            timeseries = true;
+        } else if (a == "--log-compact") {
+            compactar_log = true;
+        } else if (a.rfind("--rpc=", 0) == 0) {
+            rpc_chamada = a.substr(6);
+        } else if (a.rfind("--rpc-params=", 0) == 0) {
+            rpc_params = a.substr(13);
+        } else if (a.rfind("--cenario=", 0) == 0) {
+            std::istringstream lista(a.substr(10));
+            std::string arq;
+            while (std::getline(lista, arq, ',')) if (!arq.empty()) campanha.arquivos.push_back(arq);
+        } else if (a.rfind("--cenario-saida=", 0) == 0) {
+            campanha.saida = a.substr(16);
+        } else if (a.rfind("--cenario-rotulo=", 0) == 0) {
+            campanha.rotulo = a.substr(17);
         }
     }
 
+    // --------------------------------------------------------------
+    // Modo compactação do log: agrega o CSV detalhado antigo em níveis de
+    // 1 s e 1 min e descarta o bruto (ver CompactacaoLog.h). Sem MQTT.
+    // --------------------------------------------------------------
+    if (compactar_log) {
+        return executar_compactacao(config_compactacao(argc, argv), stop_flag);
+    }
+
     // --------------------------------------------------------------
     // Instancia cliente MQTT
     // Broker pode ser alterado pela variável de ambiente MQTT_BROKER
@@ -124,18 +325,147 @@ int main(int argc, char** argv)
     const char* broker_env = std::getenv("MQTT_BROKER");
     std::string broker = broker_env ? broker_env : "localhost";
 
+    // --------------------------------------------------------------
+    // Modo host de frota: este processo não simula um caminhão; ele
+    // assume parte da frota via hash consistente e executa cada caminhão
+    // como processo filho (ver HostFrota.h).
+    // --------------------------------------------------------------
+    if (!fleet_host.empty()) {
+        MqttClient mqtt_host(broker, "frota_" + fleet_host + "_cpp");
+        ConfigHostFrota cfg;
+        cfg.host_id = fleet_host;
+        cfg.caminhoes = parse_lista_caminhoes(fleet_trucks);
+        cfg.route = arg_route;
+        cfg.rotas = fleet_routes;
+        cfg.executavel = std::filesystem::exists("/proc/self/exe")
+                             ? std::filesystem::read_symlink("/proc/self/exe").string()
+                             : std::string(argv[0]);
+        int rc = executar_host_frota(cfg, mqtt_host, stop_flag);
+        mqtt_host.disconnect();
+        return rc;
+    }
+
+    // --------------------------------------------------------------
+    // Modo despachante: atribui tarefas abertas aos caminhões pelo
+    // método húngaro e publica as rotas (ver Despachante.h); com
+    // --road-graph, custos e rotas vêm da malha viária (MalhaViaria.h).
+    // --------------------------------------------------------------
+    if (dispatcher) {
+        MqttClient mqtt_desp(broker, "despachante_cpp");
+        int rc = executar_despachante(parse_lista_caminhoes(fleet_trucks), mqtt_desp, stop_flag, arg_malha);
+        mqtt_desp.disconnect();
+        return rc;
+    }
+
+    // --------------------------------------------------------------
+    // Modo mapa de calor: acumula a permanência da frota numa grade com
+    // decaimento e publica deltas comprimidos (ver ServicoMapaCalor.h).
+    // --------------------------------------------------------------
+    if (heatmap) {
+        MqttClient mqtt_mapa(broker, "heatmap_cpp");
+        int rc = executar_mapa_calor(parse_lista_caminhoes(fleet_trucks), mqtt_mapa, stop_flag);
+        mqtt_mapa.disconnect();
+        return rc;
+    }
+
+    // --------------------------------------------------------------
+    // Modo séries temporais: guarda a telemetria recente da frota em
+    // memória e responde consultas por intervalo (ver SerieTemporal.h).
+    // --------------------------------------------------------------
+    if (timeseries) {
+        MqttClient mqtt_series(broker, "series_cpp");
+        int rc = executar_series(parse_lista_caminhoes(fleet_trucks), mqtt_series, stop_flag);
+        mqtt_series.disconnect();
+        return rc;
+    }
+
+    // --------------------------------------------------------------
+    // Modo cenário: executa a campanha de estresse contra os caminhões
+    // em execução e imprime uma linha JSON por cenário (ver Cenario.h).
+    // --------------------------------------------------------------
+    if (!campanha.arquivos.empty()) {
+        MqttClient mqtt_cen(broker, "cenario_cpp");
+        int rc = executar_campanha(campanha, mqtt_cen, stop_flag);
+        mqtt_cen.disconnect();
+        return rc;
+    }
+
+    // --------------------------------------------------------------
+    // Cliente RPC: uma chamada a um caminhão, imprime a resposta e sai.
+    // --------------------------------------------------------------
+    if (!rpc_chamada.empty()) {
+        const size_t sep = rpc_chamada.find(':');
+        int alvo = -1;
+        try { alvo = std::stoi(rpc_chamada.substr(0, sep)); } catch (...) { }
+        if (sep == std::string::npos || alvo < 0) {
+            std::cerr << "[RPC] uso: --rpc=N:metodo [--rpc-params=JSON]\n";
+            return 1;
+        }
+        MqttClient mqtt_rpc(broker, "rpc_cli_cpp");
+        ClienteRpc cliente(mqtt_rpc, "cli");
+        auto r = cliente.chamar(topico_rpc(alvo), rpc_chamada.substr(sep + 1), rpc_params);
+        if (r) std::cout << *r << "\n";
+        else std::cerr << "[RPC] sem resposta do caminhão " << alvo << "\n";
+        mqtt_rpc.disconnect();
+        return r ? 0 : 1;
+    }
+
     std::string client_id = std::string("caminhao") + std::to_string(truck_id) + "_cpp";
     MqttClient mqtt(broker, client_id);
     std::cout << "[MAIN] MQTT inicializado.\n";
 
+    // Telemetria de alta frequência: alias de tópico e sequência (v5). Amostras
+    // de sensores/posição/atuadores perdem valor em segundos e expiram no broker;
+    // o log é histórico e não expira. Eventos de falha vão na fila crítica, à
+    // frente da telemetria; log e rota completa vão na fila de volume.
+    {
+        const std::string base = "/mina/caminhoes/" + std::to_string(truck_id);
+        MqttClient::ConfigTopico telemetria;
+        telemetria.expira_s = 5;
+        for (const char* t : {"/sensores", "/posicao", "/atuadores", "/estado"})
+            mqtt.configurar_topico(base + t, telemetria);
+
+        MqttClient::ConfigTopico volume;
+        volume.prioridade = MqttClient::Prioridade::Volume;
+        mqtt.configurar_topico(base + "/logs", volume);
+        volume.alias = false;
+        mqtt.configurar_topico(base + "/route", volume);
+
+        MqttClient::ConfigTopico critica;
+        critica.alias = false;
+        critica.prioridade = MqttClient::Prioridade::Critica;
+        mqtt.configurar_topico(base + "/eventos", critica);
+        mqtt.configurar_topico("/mina/gerente/falhas", critica);
+    }
+
+    // --------------------------------------------------------------
+    // Warm start: o checkpoint é retido pelo broker, então chega logo
+    // após a assinatura (aguarda no máximo 1 s).
+    // --------------------------------------------------------------
+    CheckpointCaminhao checkpoint;
+    if (warm_start) {
+        mqtt.subscribe_topic(topico_checkpoint(truck_id));
+        for (int i = 0; i < 20 && !checkpoint.valido; ++i) {
+            if (auto ck = mqtt.try_pop_message(topico_checkpoint(truck_id))) {
+                if (CheckpointCaminhao::desserializar(*ck, checkpoint)) {
+                    std::cout << "[MAIN] Warm start: " << *ck << "\n";
+                }
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+        }
+        if (!checkpoint.valido) std::cout << "[MAIN] Warm start: nenhum checkpoint, partindo do padrão.\n";
+    }
+
     // --------------------------------------------------------------
     // Zera estados, comandos e atuadores (protegido por mutex global)
     // --------------------------------------------------------------
+    nomear_lock(state_mtx, "state_mtx");
     {
-        std::lock_guard<std::mutex> lock(state_mtx);
+        std::lock_guard<MutexAtr> lock(state_mtx);
 
-        // Estados
-        ESTADO.e_automatico.store(false);
+        // Estados (o modo pode vir do checkpoint)
+        ESTADO.e_automatico.store(checkpoint.valido && checkpoint.automatico);
         ESTADO.e_defeito.store(false);
 
         // Comandos
@@ -168,19 +498,31 @@ int main(int argc, char** argv)
         std::cout << "[MAIN] Arquivo de rota não existe ('" << route_path << "'), continuando sem rota.\n";
     }
 
+    // --------------------------------------------------------------
+    // Snapshot retido (modo, defeito, versão da rota, última falha): clientes
+    // que chegam depois sincronizam na assinatura (ver SnapshotCaminhao.h).
+    // --------------------------------------------------------------
+    PublicadorSnapshot snapshot(mqtt, truck_id);
+
+    // --------------------------------------------------------------
+    // Indicadores do caminhão (KpiCaminhao.h): alimentados pelo coletor e
+    // pelo gerenciador de rota, publicados em /kpi a cada kpi_periodo_s
+    // (5 s; RPC set-config muda, 0 = só sob pedido) e a cada pedido em
+    // /kpi/pedido ("reset" publica e zera: novo turno).
+    // --------------------------------------------------------------
+    AgregadorKpi kpi;
+    const std::string topico_kpi = "/mina/caminhoes/" + std::to_string(truck_id) + "/kpi";
+    mqtt.subscribe_topic(topico_kpi + "/pedido");
+    std::atomic<int> kpi_periodo_s{5}; // 0 = só sob pedido (ajustável por set-config)
+
     // --------------------------------------------------------------
     // Publica rota completa em MQTT para interfaces (simulacao_mina.py) consumirem
     // Tópico: /mina/caminhoes/<id>/route
     // Payload: texto com mesmo formato de arquivo (cada linha: x y [speed])
     // --------------------------------------------------------------
     auto publish_route = [&](const Route &r) {
-        std::ostringstream out;
-        for (size_t i = 0; i < r.size(); ++i) {
-            const Waypoint &wp = r[i];
-            out << wp.x << " " << wp.y << " " << wp.speed;
-            if (i + 1 < r.size()) out << "\n";
-        }
-        try { mqtt.publish(std::string("/mina/caminhoes/") + std::to_string(truck_id) + "/route", out.str()); } catch(...) {}
+        try { mqtt.publish(std::string("/mina/caminhoes/") + std::to_string(truck_id) + "/route", texto_rota(r)); } catch(...) {}
+        snapshot.rota(r);
     };
     if (route.size() > 0) publish_route(route);
 
@@ -192,72 +534,49 @@ int main(int argc, char** argv)
     } catch(...) {
         std::cerr << "[MAIN] Falha ao assinar tópicos de consumo (ignorado).\n";
     }
+    // /sim/queda suspende o envio do caminhão: só é assinado em simulação
+    // (ATR_SIM_QUEDA=1), nunca aberto a qualquer cliente do broker.
+    const char* env_queda = std::getenv("ATR_SIM_QUEDA");
+    if (env_queda && std::string(env_queda) == "1") {
+        try {
+            mqtt.subscribe_topic(std::string("/mina/caminhoes/") + std::to_string(truck_id) + "/sim/queda");
+            std::cout << "[MAIN] Quedas simuladas do enlace habilitadas (/sim/queda)\n";
+        } catch(...) {
+            std::cerr << "[MAIN] Falha ao assinar /sim/queda (ignorado).\n";
+        }
+    }
+
+    // Ritmo adaptativo dos laços (RitmoAdaptativo.h); ATR_RITMO=0 fixa o
+    // ritmo normal. Comando, rota nova ou defeito simulado acordam as tarefas.
+    const char* env_ritmo = std::getenv("ATR_RITMO");
+    RitmoCaminhao ritmo(!(env_ritmo && std::string(env_ritmo) == "0"));
+    for (const char* sufixo : {"/comandos", "/route", "/sim/defeito"}) {
+        mqtt.ao_chegar(std::string("/mina/caminhoes/") + std::to_string(truck_id) + sufixo,
+                       [&ritmo] { ritmo.despertar(); });
+    }
 
     // --------------------------------------------------------------
-    // Lança threads
+    // Lança as tarefas (corrotinas) no executor
+    // ATR_EXECUTOR_THREADS define o número de threads (padrão 2).
     // --------------------------------------------------------------
-    std::cout << "[MAIN] Iniciando threads...\n";
+    int n_exec = 2;
+    if (const char* env_exec = std::getenv("ATR_EXECUTOR_THREADS")) {
+        try { n_exec = std::max(1, std::stoi(env_exec)); } catch(...) { }
+    }
+    std::cout << "[MAIN] Iniciando tarefas em " << n_exec << " thread(s)...\n";
+    Executor exec(reator, n_exec, "Executor::mtx_");
 
-    std::thread th_tratamento(
-        TratamentoSensores_thread,
-        std::ref(stop_flag),
-        std::ref(BUF_NAV),
-        std::ref(BUF_LOGIC),
-        std::ref(BUF_FALHAS),
-        std::ref(BUF_COLETOR),
-        std::ref(mqtt),
-        std::ref(ESTADO),
-        std::ref(COMANDO),
-        std::ref(ATUADOR),
+    exec.gerar(TratamentoSensores_tarefa(
+        stop_flag, BUF_NAV, BUF_LOGIC, BUF_FALHAS, BUF_COLETOR, mqtt,
+        ESTADO, COMANDO, ATUADOR, checkpoint,
         5,      // ordem média móvel
         50,     // período ms (mais suave)
-        truck_id
-    );
-
-    std::thread th_logic(
-        LogicaDeComando_thread,
-        std::ref(stop_flag),
-        std::ref(BUF_LOGIC),
-        std::ref(BUF_CMDS),
-        std::ref(mqtt),
-        std::ref(ESTADO),
-        std::ref(COMANDO),
-        std::ref(ATUADOR),
-        truck_id
-    );
-
-    std::thread th_falhas(
-        MonitoramentoDeFalhas_thread,
-        std::ref(stop_flag),
-        std::ref(BUF_FALHAS),
-        std::ref(mqtt),
-        std::ref(ESTADO),
-        truck_id
-    );
-
-    std::thread th_nav(
-        ControleDeNavegacao_thread,
-        std::ref(stop_flag),
-        std::ref(BUF_NAV),
-        std::ref(mqtt),
-        std::ref(ESTADO),
-        std::ref(COMANDO),
-        std::ref(ATUADOR),
-        truck_id
-    );
-
-    std::thread th_coletor(
-        ColetorDeDados_thread,
-        std::ref(stop_flag),
-        std::ref(BUF_COLETOR),
-        std::ref(BUF_LOGIC),
-        std::ref(BUF_CMDS),
-        std::ref(mqtt),
-        std::ref(ESTADO),
-        std::ref(COMANDO),
-        std::ref(ATUADOR),
-        truck_id
-    );
+        ritmo,
+        truck_id));
+    exec.gerar(LogicaDeComando_tarefa(stop_flag, BUF_LOGIC, BUF_CMDS, mqtt, ESTADO, COMANDO, ATUADOR, ritmo, truck_id));
+    exec.gerar(MonitoramentoDeFalhas_tarefa(stop_flag, BUF_FALHAS, mqtt, ESTADO, snapshot, ritmo, truck_id));
+    exec.gerar(ControleDeNavegacao_tarefa(stop_flag, BUF_NAV, mqtt, ESTADO, COMANDO, ATUADOR, ritmo, truck_id));
+    exec.gerar(ColetorDeDados_tarefa(stop_flag, BUF_COLETOR, BUF_LOGIC, BUF_CMDS, mqtt, ESTADO, COMANDO, ATUADOR, snapshot, kpi, ritmo, truck_id));
 
     // --------------------------------------------------------------
     // Spawner: escuta tópico de gerência para criação dinâmica de caminhões
@@ -327,137 +646,120 @@ int main(int argc, char** argv)
     });*/
 
     // --------------------------------------------------------------
-    // Thread gerenciadora de rota (publica setpoints MQTT sequencialmente)
-    // Não modifica a lógica interna das threads existentes — apenas publica
+    // Tarefa gerenciadora de rota (publica setpoints MQTT sequencialmente)
+    // Não modifica a lógica interna das demais tarefas — apenas publica
     // em /mina/caminhoes/<id>/setpoints para que o controlador já presente
     // receba os setpoints e navegue.
     // --------------------------------------------------------------
-    std::thread th_route_mgr([&stop_flag, &mqtt, &route, truck_id]() {
-        if (route.size() == 0) return; // nada a fazer
-
-        const Waypoint &wp = route[0];
-        std::ostringstream ss;
-        ss << "x=" << (int)wp.x << ",y=" << (int)wp.y;
-        mqtt.publish("/mina/caminhoes/.../setpoints", ss.str());
+    exec.gerar(GerenciadorDeRota_tarefa(stop_flag, mqtt, route, checkpoint, snapshot, kpi, ritmo, truck_id));
 
+    // --------------------------------------------------------------
+    // RPC (RpcMqtt.h): consultas sob demanda em /mina/caminhoes/<id>/rpc.
+    // --------------------------------------------------------------
+    RegistroRpc rpc;
+    rpc.registrar("get-state", [&snapshot](const std::string&) {
+        std::string s = snapshot.atual().serializar();
+        s.pop_back(); // acrescenta os atuadores ao objeto do snapshot
+        return RespostaRpc::sucesso(s + ",\"o_acel\":" + std::to_string(ATUADOR.o_aceleracao.load())
+                                    + ",\"o_dir\":" + std::to_string(ATUADOR.o_direcao.load()) + "}");
+    });
+    rpc.registrar("get-route", [&snapshot](const std::string&) {
+        const SnapshotCaminhao s = snapshot.atual();
+        return RespostaRpc::sucesso("{\"versao\":" + std::to_string(s.rota_versao) + ",\"waypoint\":"
+                                    + std::to_string(s.waypoint) + ",\"waypoints\":" + std::to_string(s.waypoints)
+                                    + ",\"rota\":\"" + json_escapar(snapshot.rota_texto()) + "\"}");
+    });
+    rpc.registrar("get-metrics", [&kpi, &mqtt](const std::string&) {
+        return RespostaRpc::sucesso("{\"kpi\":" + kpi.atual().serializar() + ",\"locks\":"
+                                    + RegistroLocks::instancia().relatorio_json() + ",\"filas\":\""
+                                    + json_escapar(mqtt.resumo_filas()) + "\"}");
+    });
+    rpc.registrar("set-config", [&kpi_periodo_s](const std::string& params) {
+        const std::string periodo = valor_json(params, "kpi_periodo_s");
+        if (periodo.empty()) return RespostaRpc::falha("chaves aceitas: kpi_periodo_s");
+        int v = -1;
+        try { v = std::stoi(periodo); } catch (...) { }
+        if (v < 0) return RespostaRpc::falha("kpi_periodo_s inválido: " + periodo);
+        kpi_periodo_s.store(v);
+        return RespostaRpc::sucesso("{\"kpi_periodo_s\":" + std::to_string(v) + "}");
+    });
+    exec.gerar(ServidorRpc_tarefa(stop_flag, mqtt, topico_rpc(truck_id), rpc));
 
-        // Inscreve nos tópicos de posição e rota para acompanhar progresso e receber atualizações
-        try {
-            mqtt.subscribe_topic(std::string("/mina/caminhoes/") + std::to_string(truck_id) + "/posicao");
-            mqtt.subscribe_topic(std::string("/mina/caminhoes/") + std::to_string(truck_id) + "/route");
-        } catch(...) {}
-
-        size_t idx = 0;
-        const int publish_interval_ms = 500; // atualiza setpoint a cada 500ms
-        const double reach_threshold = 12.0; // distância (px) para considerar waypoint alcançado
-
-        // pequena função para extrair inteiro do JSON simples {"x":123,...}
-        auto extract_int = [](const std::string &s, const std::string &key, int &out) -> bool {
-            auto pos = s.find(key);
-            if (pos == std::string::npos) return false;
-            size_t colon = s.find(':', pos);
-            if (colon == std::string::npos) return false;
-            size_t i = colon + 1;
-            while (i < s.size() && isspace((unsigned char)s[i])) ++i;
-            bool neg = false;
-            if (i < s.size() && (s[i] == '+' || s[i] == '-')) { neg = (s[i] == '-'); ++i; }
-            size_t start = i;
-            while (i < s.size() && (isdigit((unsigned char)s[i]) || s[i] == '-')) ++i;
-            if (i == start) return false;
-            try { out = std::stoi(s.substr(start, i - start)); if (neg) out = -out; return true; } catch(...) { return false; }
-        };
-
-        int last_x = -1, last_y = -1;
-        // Publish initial setpoint
-        {
-            const Waypoint &wp = route[0];
-            std::ostringstream ss; ss << "x=" << static_cast<int>(std::round(wp.x)) << ",y=" << static_cast<int>(std::round(wp.y));
-            mqtt.publish(std::string("/mina/caminhoes/") + std::to_string(truck_id) + "/setpoints", ss.str());
-        }
-
-        while (!stop_flag.load()) {
-            // read route update messages (non-blocking)
-            auto maybe_route = mqtt.try_pop_message(std::string("/mina/caminhoes/") + std::to_string(truck_id) + "/route");
-            if (maybe_route) {
-                std::string pl = *maybe_route;
-                std::cerr << "[RouteMgr] received route payload (len=" << pl.size() << ")\n";
-                // best-effort: parse payload as same text format used by files
-                if (route.loadFromString(pl)) {
-                    std::cerr << "[RouteMgr] route updated: " << route.size() << " waypoints\n";
-                    idx = 0; // reinicia sequência
-                    // republishes updated route for others
-                    try { mqtt.publish(std::string("/mina/caminhoes/") + std::to_string(truck_id) + "/route", pl); } catch(...){}
-                } else {
-                    std::cerr << "[RouteMgr] failed to parse incoming route payload\n";
-                }
-            }
-
-            // read position messages (non-blocking)
-            auto maybe = mqtt.try_pop_message(std::string("/mina/caminhoes/") + std::to_string(truck_id) + "/posicao");
-            if (maybe) {
-                std::string pl = *maybe;
-                int px = 0, py = 0;
-                if (extract_int(pl, "x", px)) last_x = px;
-                if (extract_int(pl, "y", py)) last_y = py;
-
-                if (last_x >= 0 && last_y >= 0 && route.size() > 0) {
-                    const Waypoint &cur = route[idx];
-                    double dx = double(last_x) - cur.x;
-                    double dy = double(last_y) - cur.y;
-                    double dist = std::hypot(dx, dy);
-                    if (dist <= reach_threshold) {
-                        // avança waypoint
-                        if (idx + 1 < route.size()) {
-                            idx++;
-                            const Waypoint &wp = route[idx];
-                            std::ostringstream ss; ss << "x=" << static_cast<int>(std::round(wp.x)) << ",y=" << static_cast<int>(std::round(wp.y));
-                            mqtt.publish(std::string("/mina/caminhoes/") + std::to_string(truck_id) + "/setpoints", ss.str());
-                        } else {
-                            // rota finalizada: publica último setpoint e para
-                            // (opcional: loopar ou ficar no último)
-                        }
-                    }
-                }
-            }
-
-            // periodic publish to ensure controller has current target
-            if (route.size() > 0) {
-                const Waypoint &wp = route[idx];
-                std::ostringstream ss; ss << "x=" << static_cast<int>(std::round(wp.x)) << ",y=" << static_cast<int>(std::round(wp.y));
-                mqtt.publish(std::string("/mina/caminhoes/") + std::to_string(truck_id) + "/setpoints", ss.str());
-            }
+    std::cout << "[MAIN] Todas as tarefas iniciadas.\n";
+    std::cout << "[MAIN] Pressione Ctrl+C para encerrar.\n";
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(publish_interval_ms));
+    // --------------------------------------------------------------
+    // Thread principal ociosa até o sinal de parada (sem polling).
+    // Com ATR_LOCK_PROFILING, exporta o perfil de contenção a cada ~5 s.
+    // --------------------------------------------------------------
+#ifdef ATR_LOCK_PROFILING
+    reator.a_cada(std::chrono::milliseconds(5100), [&mqtt, truck_id]() {
+        mqtt.publish(std::string("/mina/caminhoes/") + std::to_string(truck_id) + "/metricas/locks",
+                     RegistroLocks::instancia().relatorio_json());
+    });
+#endif
+    reator.a_cada(std::chrono::milliseconds(250), [&mqtt, &kpi, &kpi_periodo_s, topico_kpi, ciclos = 0]() mutable {
+        const int periodo = kpi_periodo_s.load() * 4;
+        bool publicar = periodo > 0 && ++ciclos >= periodo;
+        if (publicar) ciclos = 0;
+        bool reiniciar = false;
+        while (auto pedido = mqtt.try_pop_message(topico_kpi + "/pedido")) {
+            publicar = true;
+            if (pedido->find("reset") != std::string::npos) reiniciar = true;
         }
+        if (!publicar) return;
+        mqtt.publish(topico_kpi, (reiniciar ? kpi.reiniciar() : kpi.atual()).serializar());
     });
-
-    std::cout << "[MAIN] Todas as threads iniciadas.\n";
-    std::cout << "[MAIN] Pressione Ctrl+C para encerrar.\n";
+    reator.aguardar_parada();
 
     // --------------------------------------------------------------
-    // Loop principal ocioso
+    // Fecha os buffers: um produtor suspenso num buffer cheio (ex.: o
+    // Tratamento em BUF_LOGIC depois que a Lógica saiu) volta com falha
+    // em vez de esperar por um pop que não virá.
     // --------------------------------------------------------------
-    while (!stop_flag.load()) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(300));
-    }
+    BUF_NAV.fechar();
+    BUF_LOGIC.fechar();
+    BUF_FALHAS.fechar();
+    BUF_COLETOR.fechar();
+    BUF_CMDS.fechar();
 
     // --------------------------------------------------------------
-    // Aguarda encerramento das threads
+    // Aguarda encerramento das tarefas (todas observam stop_flag)
     // --------------------------------------------------------------
-    std::cout << "[MAIN] Aguardando threads...\n";
+    std::cout << "[MAIN] Aguardando tarefas...\n";
+    exec.aguardar();
 
-    if (th_tratamento.joinable()) th_tratamento.join();
-    if (th_logic.joinable())      th_logic.join();
-    if (th_falhas.joinable())     th_falhas.join();
-    if (th_nav.joinable())        th_nav.join();
-    if (th_coletor.joinable())    th_coletor.join();
-   /* if (th_spawner.joinable())    th_spawner.join();*/
+    // --------------------------------------------------------------
+    // Publica o checkpoint retido (warm start / transferência entre hosts)
+    // --------------------------------------------------------------
+    {
+        std::lock_guard<MutexAtr> lk(state_mtx);
+        checkpoint.automatico = ESTADO.e_automatico.load();
+        checkpoint.t_ms = Relogio::unix_ms();
+        mqtt.publish(topico_checkpoint(truck_id), checkpoint.serializar(), true);
+    }
+    mqtt.publish(topico_kpi, kpi.atual().serializar()); // fechamento do turno
 
-    // Tenta desconectar MQTT (se disponível na sua API)
+    // Tenta desconectar MQTT (se disponível na sua API); as filas são
+    // descarregadas antes.
     try {
         mqtt.disconnect();
     } catch (...) {}
 
+    std::cout << ritmo.resumo() << "\n";
+    if (mqtt.usa_v5()) std::cout << mqtt.resumo_v5() << "\n";
+    std::cout << mqtt.resumo_filas() << "\n";
+
+    if (PerfContadores::habilitado()) {
+        std::cout << "[MAIN] Contadores de hardware por estágio:\n"
+                  << PerfContadores::relatorio();
+    }
+
+#ifdef ATR_LOCK_PROFILING
+    std::cout << "[MAIN] Perfil de contenção dos locks:\n"
+              << RegistroLocks::instancia().relatorio_texto();
+#endif
+
     std::cout << "[MAIN] Sistema finalizado com segurança.\n";
     return 0;
 }
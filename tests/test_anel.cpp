@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+#include <map>
+#include "AnelConsistente.h"
+
+namespace {
+
+std::map<int, std::string> donos(const AnelConsistente& a, int n)
+{
+    std::map<int, std::string> d;
+    for (int id = 1; id <= n; ++id) d[id] = a.dono(id);
+    return d;
+}
+
+} // namespace
+
+TEST(AnelConsistenteTest, EntradaDeHostSoMoveCaminhoesParaEle) {
+    AnelConsistente a;
+    a.definir_hosts({"h1", "h2", "h3"});
+    const auto antes = donos(a, 300);
+    a.adicionar_host("h4");
+    const auto depois = donos(a, 300);
+
+    int movidos = 0;
+    for (const auto& [id, dono] : antes) {
+        if (depois.at(id) == dono) continue;
+        EXPECT_EQ(depois.at(id), "h4") << "caminhão " << id << " trocou entre hosts antigos";
+        ++movidos;
+    }
+    // ~1/4 da frota (folga para a variância dos nós virtuais)
+    EXPECT_GT(movidos, 300 / 8);
+    EXPECT_LT(movidos, 300 / 2);
+}
+
+TEST(AnelConsistenteTest, SaidaDeHostSoMoveCaminhoesDele) {
+    AnelConsistente a;
+    a.definir_hosts({"h1", "h2", "h3", "h4"});
+    const auto antes = donos(a, 300);
+    a.remover_host("h2");
+    const auto depois = donos(a, 300);
+
+    for (const auto& [id, dono] : antes) {
+        if (dono == "h2") EXPECT_NE(depois.at(id), "h2");
+        else EXPECT_EQ(depois.at(id), dono) << "caminhão " << id;
+    }
+    // a lista por host bate com dono() e a ordem de inserção não importa
+    AnelConsistente b;
+    b.definir_hosts({"h4", "h3", "h1"});
+    EXPECT_EQ(donos(b, 300), depois);
+    for (int id : b.caminhoes_de("h3", {1, 2, 3, 4, 5, 6, 7, 8})) EXPECT_EQ(b.dono(id), "h3");
+}
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include "Cenario.h"
+
+// Raiz do repositório (os caminhos de rota nos .cen são relativos a ela).
+#ifndef ATR_DIR_FONTE
+#define ATR_DIR_FONTE "."
+#endif
+
+TEST(CenarioTest, CarregaFalhasFrota) {
+    const auto cwd = std::filesystem::current_path();
+    std::filesystem::current_path(ATR_DIR_FONTE);
+    Cenario c;
+    std::string erro;
+    const bool ok = carregar_cenario("cenarios/falhas_frota.cen", c, erro);
+    std::filesystem::current_path(cwd);
+    ASSERT_TRUE(ok) << erro;
+
+    EXPECT_EQ(c.nome, "falhas_frota");
+    EXPECT_EQ(c.caminhoes, (std::vector<int>{1, 2, 3}));
+    EXPECT_EQ(c.duracao_ms, 20000);
+    // 3 auto + 3 defeitos + 3x5 rearmes em rajada + defeito, rearme, rota e queda
+    ASSERT_EQ(c.eventos.size(), 25u);
+    for (size_t i = 1; i < c.eventos.size(); ++i) EXPECT_LE(c.eventos[i - 1].t_ms, c.eventos[i].t_ms);
+
+    int rajada = 0;
+    for (const auto& ev : c.eventos) {
+        if (ev.acao != AcaoCenario::Comando || ev.argumento != "rearme" || ev.caminhao != 1 || ev.t_ms < 4000 || ev.t_ms > 4400) continue;
+        EXPECT_EQ((ev.t_ms - 4000) % 100, 0);
+        ++rajada;
+    }
+    EXPECT_EQ(rajada, 5);
+
+    const EventoCenario& rota = c.eventos[c.eventos.size() - 2];
+    EXPECT_EQ(rota.acao, AcaoCenario::Rota);
+    EXPECT_EQ(rota.caminhao, 1);
+    EXPECT_EQ(rota.argumento.rfind("200 150 50", 0), 0u); // já convertida para o texto do /route
+
+    const EventoCenario& queda = c.eventos.back();
+    EXPECT_EQ(queda.acao, AcaoCenario::Queda);
+    EXPECT_EQ(queda.caminhao, 3);
+    EXPECT_EQ(queda.t_ms, 11000);
+    EXPECT_EQ(queda.argumento, "3000");
+}
+
+TEST(CenarioTest, ErrosApontamALinha) {
+    Cenario c;
+    std::string erro;
+    EXPECT_FALSE(carregar_cenario_texto("nome x\n1000 defeito * eletrica=1\n", c, erro));
+    EXPECT_NE(erro.find("linha 2"), std::string::npos) << erro;
+    EXPECT_FALSE(carregar_cenario_texto("caminhoes 1\n\n500 queda 1 muito\n", c, erro));
+    EXPECT_NE(erro.find("linha 3"), std::string::npos) << erro;
+    EXPECT_FALSE(carregar_cenario_texto("caminhoes 1\n500 queda 1 -3000\n", c, erro));
+    EXPECT_NE(erro.find("negativa"), std::string::npos) << erro;
+    EXPECT_FALSE(carregar_cenario_texto("caminhoes 1\n500 explodir 1 agora\n", c, erro));
+    EXPECT_NE(erro.find("desconhecida"), std::string::npos) << erro;
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include "CompactacaoLog.h"
+#include "IndiceLog.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// CSV detalhado com dois caminhões a 20 Hz por 'minutos' minutos; pos_x do
+// caminhão 1 sobe 1 por amostra, o 2 tem falha elétrica nas amostras pares.
+std::string gera_log(const std::string& dir, int minutos)
+{
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    const std::string csv = dir + "/det.csv";
+    std::ofstream out(csv, std::ios::binary);
+    out << "timestamp_ms,truck_id,pos_x,pos_y,ang,temp,fe,fh,o_acel,o_dir,e_auto,e_defeito,e_alerta_temp\n";
+    for (int i = 0; i < minutos * 60 * 20; ++i) {
+        const int64_t ts = 600000 + 50LL * i;
+        out << ts << ",1," << i << ",10,90,70,0,0,5,0,1,0,0\n";
+        out << ts << ",2,500,500,0,80," << (i % 2 == 0) << ",0,0,0,0,0,0\n";
+    }
+    out.close();
+    reconstruir_indice_log(csv, 64, 1 << 16);
+    return csv;
+}
+
+} // namespace
+
+TEST(CompactacaoTest, AgregaDescartaEConsulta) {
+    const std::string dir = (fs::temp_directory_path() / "atr_compactacao_teste").string();
+    const std::string csv = gera_log(dir, 10);
+
+    ConfigCompactacao cfg;
+    cfg.csv = csv;
+    cfg.dir_agregados = dir + "/agregados";
+    cfg.idade_ms = 4 * 60 * 1000;
+    cfg.janela_ms = 2 * 60 * 1000;   // várias janelas
+    cfg.segmento_bytes = 4096;       // vários segmentos por janela
+    cfg.paralelismo = 3;
+    ResultadoCompactacao r = compactar_log(cfg);
+
+    // último ts 1 199 950 - 4 min, arredondado ao minuto. O corte vem do índice
+    // esparso: até dois passos (64 linhas) antes do horizonte fica no bruto.
+    EXPECT_EQ(r.horizonte_ms, 900000);
+    EXPECT_EQ(r.janelas, 3u);
+    EXPECT_LE(r.linhas, 2u * (900000 - 600000) / 50);
+    EXPECT_GE(r.linhas, 2u * (900000 - 600000) / 50 - 2 * 64);
+
+    uint64_t soma_n = 0;
+    consultar_agregados(cfg.dir_agregados, "1min", 0, 900000, -1, [&](int64_t, int, const Agregado& a) {
+        soma_n += a.n;
+        return true;
+    });
+    EXPECT_EQ(soma_n, r.linhas);
+
+    // minuto 3 do caminhão 1: amostras 3600..4799
+    size_t n = consultar_agregados(cfg.dir_agregados, "1min", 780000, 780000, 1,
+                                   [](int64_t balde, int truck, const Agregado& a) {
+                                       EXPECT_EQ(balde, 780000);
+                                       EXPECT_EQ(truck, 1);
+                                       EXPECT_EQ(a.n, 1200u);
+                                       EXPECT_DOUBLE_EQ(a.campos[0].min, 3600);
+                                       EXPECT_DOUBLE_EQ(a.campos[0].max, 4799);
+                                       EXPECT_NEAR(a.campos[0].soma / a.n, 4199.5, 1e-6);
+                                       EXPECT_DOUBLE_EQ(a.campos[0].ultimo, 4799);
+                                       return true;
+                                   });
+    EXPECT_EQ(n, 1u);
+    consultar_agregados(cfg.dir_agregados, "1s", 700000, 700000, 2, [](int64_t, int, const Agregado& a) {
+        EXPECT_EQ(a.n, 20u);
+        EXPECT_EQ(a.flags[0], 10u); // fe nas amostras pares
+        return true;
+    });
+
+    // O bruto antes do corte sumiu; o restante continua consultável.
+    LeitorLog leitor(csv);
+    EXPECT_GT(inicio_dados_log(csv), 0u);
+    size_t antigas = leitor.consultar(0, 899999, -1, [](const std::string&) { return true; });
+    size_t novas = leitor.consultar(900000, 2000000, -1, [](const std::string&) { return true; });
+    EXPECT_EQ(antigas + r.linhas, 2u * (900000 - 600000) / 50);
+    EXPECT_EQ(novas, 2u * (1200000 - 900000) / 50);
+    EXPECT_TRUE(leitor.estado_em(950000, 1).has_value());
+
+    // Segunda rodada sem dados novos não faz nada.
+    EXPECT_EQ(compactar_log(cfg).janelas, 0u);
+    fs::remove_all(dir);
+}
@@ -0,0 +1,302 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BufferCircular.h"
+#include "CaixaMensagens.h"
+#include "Executor.h"
+#include "Reator.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// aguardar() sem prazo prenderia o teste num travamento; aqui a espera vence.
+bool aguardar_ate(Executor& ex, std::chrono::milliseconds limite)
+{
+    const auto fim = std::chrono::steady_clock::now() + limite;
+    while (ex.tarefas_vivas() > 0) {
+        if (std::chrono::steady_clock::now() > fim) return false;
+        std::this_thread::sleep_for(1ms);
+    }
+    ex.aguardar();
+    return true;
+}
+
+// Com um único worker e a fila de prontas em ordem, o marcador só roda
+// depois que as tarefas geradas antes dele suspenderam (ou terminaram).
+Tarefa marcar(std::atomic<bool>& flag)
+{
+    flag.store(true);
+    co_return;
+}
+
+void ate_suspender(Executor& ex)
+{
+    std::atomic<bool> flag{false};
+    ex.gerar(marcar(flag));
+    while (!flag.load()) std::this_thread::sleep_for(1ms);
+}
+
+Tarefa consumir_um(BufferCircular<int>& b, std::atomic<int>& out)
+{
+    out.store(co_await b.pop());
+}
+
+Tarefa esperar_mensagem(CaixaMensagens& c, std::string& out, std::atomic<bool>& pronto)
+{
+    out = co_await c.next("/t");
+    pronto.store(true);
+}
+
+Tarefa produzir_um(BufferCircular<int>& b, int v, std::atomic<int>& falhas)
+{
+    const bool ok = co_await b.push(v);
+    if (!ok) ++falhas;
+}
+
+Tarefa consumir_registrando(BufferCircular<int>& b, int id, std::mutex& m, std::vector<std::pair<int, int>>& ordem)
+{
+    int v = co_await b.pop();
+    std::lock_guard<std::mutex> lk(m);
+    ordem.emplace_back(id, v);
+}
+
+Tarefa consumir_fechado(BufferCircular<int>& b, std::atomic<int>& fechados)
+{
+    try {
+        co_await b.pop();
+    } catch (const BufferFechado&) {
+        ++fechados;
+    }
+}
+
+// n esperas com timeout curto disputando com um produtor externo.
+Tarefa corrida_buffer(BufferCircular<int>& b, int n, std::atomic<int>& recebidos, std::atomic<int>& timeouts)
+{
+    for (int i = 0; i < n; ++i) {
+        auto v = co_await b.pop_for(200us);
+        if (v) ++recebidos; else ++timeouts;
+    }
+}
+
+Tarefa corrida_caixa(CaixaMensagens& c, int n, std::atomic<int>& recebidos, std::atomic<int>& timeouts)
+{
+    for (int i = 0; i < n; ++i) {
+        auto m = co_await c.next_for("/t", 200us);
+        if (m) ++recebidos; else ++timeouts;
+    }
+}
+
+// Produz mais rápido do que o consumidor drena (como Tratamento -> BUF_LOGIC).
+Tarefa produtor_rapido(std::atomic<bool>& stop, BufferCircular<int>& b, std::atomic<int>& falhas)
+{
+    int i = 0;
+    while (!stop.load()) {
+        const bool ok = co_await b.push(i++);
+        if (!ok) ++falhas;
+        co_await Executor::after(1ms);
+    }
+}
+
+Tarefa consumidor_lento(std::atomic<bool>& stop, BufferCircular<int>& b)
+{
+    while (!stop.load()) {
+        co_await b.pop_for(20ms);
+        co_await Executor::after(200ms);
+    }
+}
+
+} // namespace
+
+TEST(ExecutorTest, FecharBufferLiberaProdutorSuspensoNoDesligamento) {
+    Reator r;
+    r.iniciar();
+    Executor ex(r, 2);
+    BufferCircular<int> b(4);
+    std::atomic<bool> stop{false};
+    std::atomic<int> falhas{0};
+    ex.gerar(produtor_rapido(stop, b, falhas));
+    ex.gerar(consumidor_lento(stop, b));
+
+    // espera o produtor ficar parado no buffer cheio
+    const auto fim = std::chrono::steady_clock::now() + 2s;
+    while (b.size() < b.capacity() && std::chrono::steady_clock::now() < fim) std::this_thread::sleep_for(5ms);
+    ASSERT_EQ(b.size(), b.capacity());
+    std::this_thread::sleep_for(20ms); // produtor já suspenso em push(), consumidor em after()
+
+    stop.store(true);
+    r.parar();  // acorda quem está em after()/pop_for()
+    b.fechar(); // acorda quem está em push()
+    EXPECT_TRUE(aguardar_ate(ex, 2000ms)) << "vivas=" << ex.tarefas_vivas();
+    EXPECT_LE(falhas.load(), 1);
+}
+
+TEST(ExecutorTest, BufferFechadoFalhaSemEsperar) {
+    BufferCircular<int> b(2);
+    ASSERT_TRUE(b.try_push(1));
+    b.fechar();
+    EXPECT_TRUE(b.fechado());
+    EXPECT_FALSE(b.try_push(2));
+    EXPECT_FALSE(b.push_wait(2));
+
+    // o que restou ainda sai; depois, falha sem bloquear
+    int v = 0;
+    EXPECT_TRUE(b.pop_wait(v));
+    EXPECT_EQ(v, 1);
+    EXPECT_FALSE(b.pop_wait(v));
+    EXPECT_FALSE(b.pop_wait_for(v, 1s));
+}
+
+TEST(ExecutorTest, FecharAcordaThreadBloqueada) {
+    BufferCircular<int> b(1);
+    std::atomic<bool> retornou{false};
+    bool ok = true;
+    std::thread t([&] {
+        int v;
+        ok = b.pop_wait(v);
+        retornou.store(true);
+    });
+    std::this_thread::sleep_for(20ms);
+    EXPECT_FALSE(retornou.load());
+    b.fechar();
+    t.join();
+    EXPECT_FALSE(ok);
+}
+
+TEST(ExecutorTest, PushEntregaDiretoAoConsumidorSuspenso) {
+    Reator r;
+    r.iniciar();
+    Executor ex(r, 1);
+    BufferCircular<int> b(4);
+    std::atomic<int> v{-1};
+    ex.gerar(consumir_um(b, v));
+    ate_suspender(ex);
+
+    ASSERT_TRUE(b.try_push(7));
+    EXPECT_EQ(b.size(), 0u); // não passou pelo buffer
+    ASSERT_TRUE(aguardar_ate(ex, 2000ms));
+    EXPECT_EQ(v.load(), 7);
+}
+
+TEST(ExecutorTest, MensagemEntregueDiretoAQuemEspera) {
+    Reator r;
+    r.iniciar();
+    Executor ex(r, 1);
+    CaixaMensagens caixa;
+    int ganchos = 0;
+    caixa.ao_chegar("/t", [&] { ++ganchos; });
+    std::string msg;
+    std::atomic<bool> pronto{false};
+    ex.gerar(esperar_mensagem(caixa, msg, pronto));
+    ate_suspender(ex);
+
+    caixa.entregar("/outro", "x");
+    caixa.entregar("/t", "ola");
+    ASSERT_TRUE(aguardar_ate(ex, 2000ms));
+    EXPECT_TRUE(pronto.load());
+    EXPECT_EQ(msg, "ola");
+    EXPECT_EQ(ganchos, 1);
+    EXPECT_FALSE(caixa.try_pop("/t")); // entregue, não enfileirada
+    EXPECT_EQ(caixa.try_pop("/outro"), std::optional<std::string>("x"));
+}
+
+TEST(ExecutorTest, ProdutoresEConsumidoresSaoAtendidosEmOrdem) {
+    Reator r;
+    r.iniciar();
+    Executor ex(r, 1);
+
+    // produtores suspensos num buffer cheio entram na ordem em que pararam
+    BufferCircular<int> cheio(1);
+    ASSERT_TRUE(cheio.try_push(-1));
+    std::atomic<int> falhas{0};
+    for (int i = 0; i < 5; ++i) {
+        ex.gerar(produzir_um(cheio, i, falhas));
+        ate_suspender(ex);
+    }
+    for (int esperado = -1; esperado < 5; ++esperado) {
+        int v = 0;
+        ASSERT_TRUE(cheio.pop_wait_for(v, 2s));
+        EXPECT_EQ(v, esperado);
+    }
+
+    // consumidores suspensos num buffer vazio recebem na ordem em que pararam
+    BufferCircular<int> vazio(4);
+    std::mutex m;
+    std::vector<std::pair<int, int>> ordem;
+    for (int i = 0; i < 5; ++i) {
+        ex.gerar(consumir_registrando(vazio, i, m, ordem));
+        ate_suspender(ex);
+    }
+    for (int i = 0; i < 5; ++i) ASSERT_TRUE(vazio.try_push(100 + i));
+    ASSERT_TRUE(aguardar_ate(ex, 2000ms));
+    EXPECT_EQ(falhas.load(), 0);
+    ASSERT_EQ(ordem.size(), 5u);
+    for (auto [id, v] : ordem) EXPECT_EQ(v, 100 + id);
+}
+
+TEST(ExecutorTest, TimeoutEEventoRetomamUmaVezSo) {
+    Reator r;
+    r.iniciar();
+    Executor ex(r, 2);
+    BufferCircular<int> b(1000);
+    CaixaMensagens caixa;
+    const int N = 2000;
+    std::atomic<int> rec_b{0}, to_b{0}, rec_c{0}, to_c{0};
+    ex.gerar(corrida_buffer(b, N, rec_b, to_b));
+    ex.gerar(corrida_caixa(caixa, N, rec_c, to_c));
+
+    // eventos em instantes aleatórios, perto do vencimento dos timeouts
+    int enviados_b = 0, enviados_c = 0;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> atraso(0, 400);
+    while (ex.tarefas_vivas() > 0) {
+        if (b.try_push(enviados_b)) ++enviados_b;
+        caixa.entregar("/t", "m");
+        ++enviados_c;
+        std::this_thread::sleep_for(std::chrono::microseconds(atraso(rng)));
+    }
+    ex.aguardar();
+
+    // cada espera terminou uma única vez, por evento ou por timeout
+    EXPECT_EQ(rec_b.load() + to_b.load(), N);
+    EXPECT_EQ(rec_c.load() + to_c.load(), N);
+    // nenhum evento foi perdido nem entregue duas vezes
+    int restantes_b = 0, v;
+    while (b.try_pop(v)) ++restantes_b;
+    int restantes_c = 0;
+    while (caixa.try_pop("/t")) ++restantes_c;
+    EXPECT_EQ(rec_b.load() + restantes_b, enviados_b);
+    EXPECT_EQ(rec_c.load() + restantes_c, enviados_c);
+    EXPECT_GT(rec_b.load(), 0);
+    EXPECT_GT(to_b.load(), 0);
+}
+
+TEST(ExecutorTest, FecharRetomaVariosProdutoresEConsumidores) {
+    Reator r;
+    r.iniciar();
+    Executor ex(r, 2);
+    BufferCircular<int> cheio(2);
+    BufferCircular<int> vazio(2);
+    ASSERT_TRUE(cheio.try_push(0));
+    ASSERT_TRUE(cheio.try_push(0));
+    std::atomic<int> falhas{0}, fechados{0};
+    for (int i = 0; i < 8; ++i) {
+        ex.gerar(produzir_um(cheio, i, falhas));
+        ex.gerar(consumir_fechado(vazio, fechados));
+    }
+    ate_suspender(ex);
+    std::this_thread::sleep_for(20ms); // o segundo worker também suspendeu os seus
+    EXPECT_EQ(ex.tarefas_vivas(), 16u);
+
+    cheio.fechar();
+    vazio.fechar();
+    EXPECT_TRUE(aguardar_ate(ex, 2000ms)) << "vivas=" << ex.tarefas_vivas();
+    EXPECT_EQ(falhas.load(), 8);
+    EXPECT_EQ(fechados.load(), 8);
+    EXPECT_EQ(cheio.size(), 2u); // o que já estava no buffer fica
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include "Hungaro.h"
+
+// Ótimo por força bruta (permuta as tarefas sobre os caminhões).
+static double forca_bruta(int n, int m, const std::vector<double>& c)
+{
+    int k = std::max(n, m);
+    std::vector<int> perm(k);
+    std::iota(perm.begin(), perm.end(), 0);
+    double melhor = 1e300;
+    do {
+        double s = 0.0;
+        // índices >= m são colunas fictícias (caminhão ocioso, custo zero)
+        for (int i = 0; i < n; ++i) if (perm[i] < m) s += c[i * m + perm[i]];
+        melhor = std::min(melhor, s);
+    } while (std::next_permutation(perm.begin(), perm.end()));
+    return melhor;
+}
+
+TEST(HungaroTest, IgualForcaBruta) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> d(0.0, 100.0);
+    for (int n = 1; n <= 5; ++n) {
+        for (int m = 1; m <= 5; ++m) {
+            std::vector<double> c(n * m);
+            for (auto& v : c) v = d(rng);
+            AtribuicaoHungara h;
+            h.definir_custos(n, m, c);
+            EXPECT_NEAR(h.resolver(), forca_bruta(n, m, c), 1e-9) << n << "x" << m;
+        }
+    }
+}
+
+TEST(HungaroTest, AtribuicaoSemRepeticao) {
+    std::vector<double> c = {4, 1, 3,
+                             2, 0, 5,
+                             3, 2, 2};
+    AtribuicaoHungara h;
+    h.definir_custos(3, 3, c);
+    EXPECT_DOUBLE_EQ(h.resolver(), 5.0);
+    EXPECT_EQ(h.tarefa_de(0), 1);
+    EXPECT_EQ(h.tarefa_de(1), 0);
+    EXPECT_EQ(h.tarefa_de(2), 2);
+}
+
+TEST(HungaroTest, RemocaoIncrementalIgualSolucaoCompleta) {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> d(0.0, 500.0);
+    const int n = 30, m = 40;
+    std::vector<double> c(n * m);
+    for (auto& v : c) v = d(rng);
+
+    AtribuicaoHungara inc;
+    inc.definir_custos(n, m, c);
+    inc.resolver();
+    int tarefas = m;
+    while (tarefas > 20) {
+        int j = static_cast<int>(rng() % tarefas);
+        double custo_inc = inc.remover_tarefa(j);
+        // mesma matriz sem a coluna j, resolvida do zero
+        std::vector<double> r;
+        for (int i = 0; i < n; ++i)
+            for (int k = 0; k < tarefas; ++k)
+                if (k != j) r.push_back(c[i * tarefas + k]);
+        c.swap(r);
+        --tarefas;
+        AtribuicaoHungara cheia;
+        cheia.definir_custos(n, tarefas, c);
+        EXPECT_NEAR(custo_inc, cheia.resolver(), 1e-6);
+    }
+}
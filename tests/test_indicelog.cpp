@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include "IndiceLog.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+namespace {
+
+struct LinhaTeste { int64_t ts; int truck; std::string texto; };
+
+// Gera um CSV com dois caminhões intercalados, cada um com seu escritor de
+// índice, como dois processos de caminhão (passo pequeno: várias entradas).
+std::vector<LinhaTeste> gera_log(const std::string& caminho, int n)
+{
+    std::remove(caminho.c_str());
+    std::remove(caminho_indice(caminho).c_str());
+    std::vector<LinhaTeste> linhas;
+    std::ofstream out(caminho, std::ios::binary);
+    out << "timestamp_ms,truck_id,pos_x,pos_y\n";
+    uint64_t offset = static_cast<uint64_t>(out.tellp());
+    out.flush();
+    EscritorIndiceLog indice7(caminho, 4, 1 << 20);
+    EscritorIndiceLog indice2(caminho, 4, 1 << 20);
+    for (int i = 0; i < n; ++i) {
+        int truck = (i % 3 == 0) ? 7 : 2;
+        int64_t ts = 1000 + 10 * i;
+        std::ostringstream ss;
+        ss << ts << "," << truck << "," << i << "," << 2 * i;
+        std::string l = ss.str();
+        out << l << "\n";
+        (truck == 7 ? indice7 : indice2).registrar(ts, truck, offset, l.size() + 1);
+        offset += l.size() + 1;
+        linhas.push_back({ts, truck, l});
+    }
+    return linhas;
+}
+
+} // namespace
+
+TEST(IndiceLogTest, ConsultaIgualVarreduraCompleta) {
+    const std::string csv = "test_indicelog.csv";
+    auto linhas = gera_log(csv, 500);
+    LeitorLog leitor(csv);
+    EXPECT_GT(leitor.entradas(), 10u);
+    EXPECT_LT(leitor.entradas(), 200u);
+
+    for (int truck : {-1, 2, 7}) {
+        for (auto [t0, t1] : {std::pair<int64_t, int64_t>{0, 100000}, {1500, 1700}, {3333, 3333}, {5990, 9000}}) {
+            std::vector<std::string> esperado, obtido;
+            for (const auto& l : linhas) {
+                if ((truck < 0 || l.truck == truck) && l.ts >= t0 && l.ts <= t1) esperado.push_back(l.texto);
+            }
+            leitor.consultar(t0, t1, truck, [&](const std::string& s) { obtido.push_back(s); return true; });
+            EXPECT_EQ(obtido, esperado) << "truck=" << truck << " t0=" << t0 << " t1=" << t1;
+        }
+    }
+    // O início pelo índice fica perto do alvo, não no começo do arquivo.
+    EXPECT_GT(leitor.offset_inicial(5000, 7), 5000u);
+}
+
+TEST(IndiceLogTest, EstadoNoInstante) {
+    const std::string csv = "test_indicelog.csv";
+    auto linhas = gera_log(csv, 300);
+    LeitorLog leitor(csv);
+
+    // Caminhão 7 grava em 1000, 1030, 1060...: em 1055 vale a linha de 1030.
+    auto e = leitor.estado_em(1055, 7);
+    ASSERT_TRUE(e.has_value());
+    EXPECT_EQ(e->rfind("1030,7,", 0), 0u);
+    EXPECT_FALSE(leitor.estado_em(999, 7).has_value());
+    EXPECT_FALSE(leitor.estado_em(2000, 99).has_value());
+}
+
+TEST(IndiceLogTest, ReconstroiIndiceInvalido) {
+    const std::string csv = "test_indicelog.csv";
+    auto linhas = gera_log(csv, 100);
+    // Reescreve o CSV com outro conteúdo: o índice antigo não confere mais.
+    {
+        std::ofstream out(csv, std::ios::binary | std::ios::trunc);
+        out << "timestamp_ms,truck_id\n5000,3,1\n5010,3,2\n";
+    }
+    { EscritorIndiceLog indice(csv); }
+    LeitorLog leitor(csv);
+    EXPECT_EQ(leitor.entradas(), 1u);
+    auto e = leitor.estado_em(5015, 3);
+    ASSERT_TRUE(e.has_value());
+    EXPECT_EQ(*e, "5010,3,2");
+    std::remove(csv.c_str());
+    std::remove(caminho_indice(csv).c_str());
+}
+
+TEST(IndiceLogTest, RegistroEsperaReconstrucaoEmCurso) {
+    const std::string csv = "test_indicelog_lock.csv";
+    gera_log(csv, 0);
+    EscritorIndiceLog indice(csv, 1, 1 << 20);
+
+    // outro processo reconstruindo: LOCK_EX e o arquivo truncado para reescrita
+    int fd = ::open(caminho_indice(csv).c_str(), O_RDWR);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(::flock(fd, LOCK_EX), 0);
+    ASSERT_EQ(::ftruncate(fd, 0), 0);
+    std::atomic<bool> gravou{false};
+    std::thread t([&] { indice.registrar(1000, 7, 34, 20); gravou = true; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(gravou.load());
+    ASSERT_EQ(::ftruncate(fd, 0), 0); // a reescrita termina sem a entrada nova
+    ::flock(fd, LOCK_UN);
+    t.join();
+    ::close(fd);
+    EXPECT_EQ(std::filesystem::file_size(caminho_indice(csv)), sizeof(EntradaIndiceLog));
+    std::remove(csv.c_str());
+    std::remove(caminho_indice(csv).c_str());
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include "IoLog.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+TEST(IoLogTest, GravadorEntregaOffsetsDasLinhas) {
+    const std::string caminho = "test_iolog.txt";
+    std::remove(caminho.c_str());
+    {
+        std::ofstream pre(caminho);
+        pre << "cabecalho\n";
+    }
+    std::vector<std::string> linhas;
+    std::vector<uint64_t> offsets;
+    {
+        GravadorLog g(std::chrono::milliseconds(5));
+        int arq = g.abrir(caminho);
+        ASSERT_GE(arq, 0);
+        for (int i = 0; i < 2000; ++i) {
+            std::string l = "linha " + std::to_string(i) + std::string(i % 37, 'x') + "\n";
+            linhas.push_back(l);
+            g.escrever(arq, l, [&offsets, i](uint64_t off) {
+                if (offsets.size() <= static_cast<size_t>(i)) offsets.resize(i + 1);
+                offsets[i] = off;
+            });
+        }
+        g.descarregar();
+        EXPECT_EQ(g.estatisticas().linhas, 2000u);
+        EXPECT_EQ(g.estatisticas().erros, 0u);
+    }
+    std::ifstream in(caminho, std::ios::binary);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    const std::string conteudo = ss.str();
+    ASSERT_EQ(offsets.size(), linhas.size());
+    for (size_t i = 0; i < linhas.size(); ++i) {
+        ASSERT_EQ(conteudo.compare(offsets[i], linhas[i].size(), linhas[i]), 0) << "linha " << i;
+    }
+    std::remove(caminho.c_str());
+}
+
+TEST(IoLogTest, LeitorSequencialAtravessaBlocos) {
+    const std::string caminho = "test_iolog.txt";
+    std::vector<std::string> linhas;
+    {
+        std::ofstream out(caminho, std::ios::binary | std::ios::trunc);
+        for (int i = 0; i < 5000; ++i) {
+            linhas.push_back(std::to_string(i) + "," + std::string(i % 101, 'y'));
+            out << linhas.back() << "\n";
+        }
+        out << "sem_quebra_final";
+    }
+    LeitorSequencial r(caminho, 0, 4096, 3);
+    ASSERT_TRUE(r.aberto());
+    std::string l;
+    for (const auto& esperada : linhas) {
+        ASSERT_TRUE(r.linha(l));
+        ASSERT_EQ(l, esperada);
+    }
+    ASSERT_TRUE(r.linha(l));
+    EXPECT_EQ(l, "sem_quebra_final");
+    EXPECT_FALSE(r.linha(l));
+    std::remove(caminho.c_str());
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "KpiCaminhao.h"
+
+TEST(KpiTest, WelfordIgualDuasPassadas) {
+    std::mt19937 rng(3);
+    std::normal_distribution<double> d(70.0, 4.0);
+    std::vector<double> v(1000);
+    EstatisticaCorrente e;
+    for (auto& x : v) { x = d(rng); e.adicionar(x); }
+
+    double media = 0.0;
+    for (double x : v) media += x;
+    media /= v.size();
+    double var = 0.0;
+    for (double x : v) var += (x - media) * (x - media);
+    var /= (v.size() - 1);
+
+    EXPECT_EQ(e.n, v.size());
+    EXPECT_NEAR(e.media, media, 1e-9);
+    EXPECT_NEAR(e.variancia(), var, 1e-9);
+    EXPECT_DOUBLE_EQ(e.min, *std::min_element(v.begin(), v.end()));
+    EXPECT_DOUBLE_EQ(e.max, *std::max_element(v.begin(), v.end()));
+}
+
+TEST(KpiTest, DuracoesPonderadasPeloTempo) {
+    AgregadorKpi a;
+    // 0..1000 ms manual, 1000..1500 automático com alerta, 1500..1600 defeito
+    a.amostra(0, 0, 0, 70, false, false, false);
+    a.amostra(1000, 0, 0, 70, true, true, false);
+    a.amostra(1500, 0, 0, 70, true, false, true);
+    a.amostra(1600, 0, 0, 70, true, false, true);
+    // lacuna acima de MAX_INTERVALO_MS não conta
+    a.amostra(5000, 0, 0, 70, true, false, false);
+
+    KpiCaminhao k = a.atual();
+    EXPECT_EQ(k.ms_total, 1600u);
+    EXPECT_EQ(k.ms_manual, 1000u);
+    EXPECT_EQ(k.ms_automatico, 600u);
+    EXPECT_EQ(k.ms_alerta, 500u);
+    EXPECT_EQ(k.ms_defeito, 100u);
+    EXPECT_EQ(k.defeitos, 1u);
+    EXPECT_EQ(k.amostras, 5u);
+}
+
+// Caminhão hibernando em manual: amostras a cada 1 s mais o atraso do laço
+// não são lacunas.
+TEST(KpiTest, HibernandoContaOTempoParado) {
+    AgregadorKpi a;
+    uint64_t t = 0, esperado = 0;
+    a.amostra(t, 0, 0, 70, false, false, false);
+    for (uint64_t dt = 1001; dt <= 1010; ++dt) {
+        t += dt;
+        esperado += dt;
+        a.amostra(t, 0, 0, 70, false, false, false);
+    }
+    KpiCaminhao k = a.atual();
+    EXPECT_EQ(k.ms_total, esperado);
+    EXPECT_EQ(k.ms_manual, esperado);
+    EXPECT_EQ(k.ms_automatico, 0u);
+}
+
+TEST(KpiTest, DistanciaIgnoraRuidoParado) {
+    AgregadorKpi a;
+    std::mt19937 rng(5);
+    std::normal_distribution<double> ruido(0.0, 0.4);
+    uint64_t t = 0;
+    for (int i = 0; i < 200; ++i, t += 50) a.amostra(t, 100 + ruido(rng), 100 + ruido(rng), 70, true, false, false);
+    EXPECT_LT(a.atual().distancia, 5.0);
+
+    // 100 px em linha reta a 50 px/s
+    for (int i = 1; i <= 40; ++i, t += 50) a.amostra(t, 100 + i * 2.5, 100, 70, true, false, false);
+    KpiCaminhao k = a.reiniciar();
+    EXPECT_NEAR(k.distancia, 100.0, 5.0);
+    EXPECT_NEAR(k.velocidade.media, 50.0, 10.0);
+    EXPECT_EQ(a.atual().amostras, 0u);
+}
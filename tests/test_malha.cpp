@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <queue>
+#include <random>
+#include "MalhaViaria.h"
+
+// Dijkstra simples sobre as vias (referência).
+static double dijkstra(const MalhaViaria& m, int s, int t)
+{
+    const size_t n = m.nos().size();
+    std::vector<double> d(n, MalhaViaria::INFINITO);
+    using Item = std::pair<double, int>;
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> f;
+    d[s] = 0.0;
+    f.push({0.0, s});
+    while (!f.empty()) {
+        auto [dv, v] = f.top();
+        f.pop();
+        if (dv > d[v]) continue;
+        for (const ViaMalha& e : m.vias()) {
+            if (e.de == v && dv + e.tempo() < d[e.para]) {
+                d[e.para] = dv + e.tempo();
+                f.push({d[e.para], e.para});
+            }
+        }
+    }
+    return d[t];
+}
+
+TEST(MalhaViariaTest, IgualDijkstraEmGradeAleatoria) {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> vel(10.0, 90.0);
+    std::uniform_int_distribution<int> sorteio(0, 9);
+    const int L = 15;
+    MalhaViaria m;
+    for (int i = 0; i < L * L; ++i) m.adicionar_no(100 + i, (i % L) * 50.0, (i / L) * 50.0);
+    for (int i = 0; i < L * L; ++i) {
+        const int x = i % L, y = i / L;
+        for (int viz : {x + 1 < L ? i + 1 : -1, y + 1 < L ? i + L : -1}) {
+            if (viz < 0) continue;
+            const int tipo = sorteio(rng); // 0: sem via; 1-2: mão única; resto: mão dupla
+            if (tipo == 0) continue;
+            if (tipo != 2) m.adicionar_via(100 + i, 100 + viz, vel(rng));
+            if (tipo != 1) m.adicionar_via(100 + viz, 100 + i, vel(rng));
+        }
+    }
+    m.preparar();
+
+    std::uniform_int_distribution<int> no(0, L * L - 1);
+    for (int k = 0; k < 300; ++k) {
+        const int s = no(rng), t = no(rng);
+        std::vector<int> caminho;
+        const double ch = m.tempo(100 + s, 100 + t, &caminho);
+        const double ref = dijkstra(m, s, t);
+        if (ref == MalhaViaria::INFINITO) {
+            EXPECT_EQ(ch, MalhaViaria::INFINITO) << s << "->" << t;
+            continue;
+        }
+        ASSERT_NEAR(ch, ref, 1e-9) << s << "->" << t;
+        // o caminho desempacotado usa só vias existentes e soma o mesmo tempo
+        ASSERT_FALSE(caminho.empty());
+        EXPECT_EQ(caminho.front(), 100 + s);
+        EXPECT_EQ(caminho.back(), 100 + t);
+        double soma = 0.0;
+        for (size_t i = 1; i < caminho.size(); ++i) {
+            double melhor = MalhaViaria::INFINITO;
+            for (const ViaMalha& e : m.vias()) {
+                if (e.de == caminho[i - 1] - 100 && e.para == caminho[i] - 100) melhor = std::min(melhor, e.tempo());
+            }
+            ASSERT_LT(melhor, MalhaViaria::INFINITO) << "via inexistente " << caminho[i - 1] << "->" << caminho[i];
+            soma += melhor;
+        }
+        EXPECT_NEAR(soma, ref, 1e-9);
+    }
+}
+
+TEST(MalhaViariaTest, CarregaTextoERespondeRota) {
+    MalhaViaria m;
+    ASSERT_TRUE(m.loadFromString(
+        "# carga (1) -> britador (3)\n"
+        "via2 1 2 40\n"          // via antes dos nós
+        "no 1 0 0\n"
+        "no 2 100 0\n"
+        "no 3 100 100\n"
+        "via 2 3 50 2\n"         // mão única, capacidade 2
+        "via 1 3 10 1 150\n"));  // atalho direto lento: 15 s
+    ASSERT_EQ(m.nos().size(), 3u);
+    EXPECT_DOUBLE_EQ(m.tempo(1, 3), 100.0 / 40 + 100.0 / 50);
+    EXPECT_EQ(m.tempo(3, 1), MalhaViaria::INFINITO);
+
+    Route r = m.rota_entre(-10, 0, 100, 110);
+    ASSERT_EQ(r.size(), 5u);
+    EXPECT_DOUBLE_EQ(r[0].x, -10);
+    EXPECT_DOUBLE_EQ(r[2].x, 100);
+    EXPECT_DOUBLE_EQ(r[2].speed, 40);
+    EXPECT_DOUBLE_EQ(r[3].speed, 50);
+    EXPECT_DOUBLE_EQ(r[4].y, 110);
+    EXPECT_NEAR(m.custo(-10, 0, 100, 110), 4.5 + 20.0 / MalhaViaria::VELOCIDADE_ACESSO, 1e-9);
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+#include "MapaCalor.h"
+
+namespace {
+
+// Permanência esperada em t = n s para amostras de 1 s em t = 1..n (cada uma
+// soma 1 s decaído por exp(-(n - i)/tau)).
+double permanencia_continua(int n, double tau)
+{
+    return (1.0 - std::exp(-n / tau)) / (1.0 - std::exp(-1.0 / tau));
+}
+
+std::string celulas(const std::string& quadro)
+{
+    size_t c = quadro.find(";c=");
+    return c == std::string::npos ? std::string() : quadro.substr(c + 3);
+}
+
+} // namespace
+
+TEST(MapaCalorTest, DecaimentoPorEscala) {
+    MapaCalor m(1000.0, 1000.0, 10.0, {60.0, 3600.0});
+    for (uint64_t t = 0; t <= 10000; t += 1000) m.amostra(1, 55.0, 25.0, t); // célula (5, 2)
+
+    EXPECT_NEAR(m.valor(0, 5, 2, 10000), permanencia_continua(10, 60.0), 1e-9);
+    EXPECT_NEAR(m.valor(1, 5, 2, 10000), permanencia_continua(10, 3600.0), 1e-9);
+    EXPECT_DOUBLE_EQ(m.valor(0, 4, 2, 10000), 0.0);
+
+    // Uma constante de tempo depois: a escala de 1 min cai para 1/e, a de 1 h quase não muda.
+    const double a0 = m.valor(0, 5, 2, 10000), b0 = m.valor(1, 5, 2, 10000);
+    EXPECT_NEAR(m.valor(0, 5, 2, 70000) / a0, std::exp(-1.0), 1e-9);
+    EXPECT_NEAR(m.valor(1, 5, 2, 70000) / b0, std::exp(-60.0 / 3600.0), 1e-9);
+
+    // Lacunas maiores que MAX_INTERVALO_MS contam só o máximo.
+    m.amostra(1, 55.0, 25.0, 70000);
+    EXPECT_NEAR(m.valor(1, 5, 2, 70000), b0 * std::exp(-60.0 / 3600.0) + 1.0, 1e-9);
+}
+
+TEST(MapaCalorTest, RebaseMantemValores) {
+    // 2000 s a 1 Hz: o fator da escala de 1 min passa de FATOR_MAX (~830 s) duas vezes.
+    MapaCalor m(1000.0, 1000.0, 10.0, {60.0, 600.0});
+    for (uint64_t t = 0; t <= 2000000; t += 1000) m.amostra(7, 500.0, 500.0, t);
+    EXPECT_NEAR(m.valor(0, 50, 50, 2000000), permanencia_continua(2000, 60.0), 1e-6);
+    EXPECT_NEAR(m.valor(1, 50, 50, 2000000), permanencia_continua(2000, 600.0), 1e-6);
+
+    // O quadro completo reflete o valor rebaseado.
+    const std::string q = m.codificar(0, 2000000, true);
+    const long esperado = std::lround(permanencia_continua(2000, 60.0) * 10.0);
+    EXPECT_EQ(celulas(q), std::to_string(50 * 100 + 50) + ":" + std::to_string(esperado));
+}
+
+TEST(MapaCalorTest, DeltasSoComCelulasAlteradas) {
+    MapaCalor m(1000.0, 1000.0, 10.0, {600.0});
+    for (uint64_t t = 0; t <= 5000; t += 1000) {
+        m.amostra(1, 15.0, 5.0, t);   // célula 1
+        m.amostra(2, 35.0, 25.0, t);  // célula 2*100 + 3 = 203
+    }
+    const std::string completo = m.codificar(0, 5000, true);
+    EXPECT_EQ(completo.rfind("t=5000;escala=600;celula=10;grade=100x100;c=", 0), 0u) << completo;
+    EXPECT_EQ(celulas(completo), "1:50,202:50"); // saltos: 1, depois 203 - 1
+
+    // Nada mudou além do limiar: sem delta.
+    EXPECT_EQ(m.codificar(0, 6000, false), "");
+
+    // Só o caminhão 2 se mexe: o delta traz apenas a célula dele.
+    for (uint64_t t = 6000; t <= 10000; t += 1000) m.amostra(2, 35.0, 25.0, t);
+    const std::string delta = m.codificar(0, 10000, false);
+    const long v203 = std::lround(m.valor(0, 3, 2, 10000) * 10.0);
+    EXPECT_EQ(celulas(delta), "203:" + std::to_string(v203));
+}
+
+TEST(MapaCalorTest, ContadorNaoSaturaComFila) {
+    // Dois caminhões 4 h na mesma célula: ~2·tau·(1 - e^-4) s, acima de 65535 décimos.
+    MapaCalor m(1000.0, 1000.0, 10.0, {3600.0});
+    for (uint64_t t = 0; t <= 14400000; t += 1000) {
+        m.amostra(1, 5.0, 5.0, t);
+        m.amostra(2, 5.0, 5.0, t);
+    }
+    const long esperado = std::lround(2.0 * permanencia_continua(14400, 3600.0) * 10.0);
+    EXPECT_GT(esperado, 65535);
+    EXPECT_EQ(celulas(m.codificar(0, 14400000, true)), "0:" + std::to_string(esperado));
+}
+
+TEST(MapaCalorTest, PosicaoSuprimidaCobreTodaAReta) {
+    // Reta a 20 px/s por 30 s, amostrada a 20 Hz pelo emissor com supressão.
+    MapaCalor real(1000.0, 1000.0, 10.0, {600.0});
+    MapaCalor mapa(1000.0, 1000.0, 10.0, {600.0});
+    AmostradorMapa amostrador(mapa);
+    SupressorPosicao supressor(3.0);
+    int publicadas = 0;
+    for (uint64_t t = 0; t <= 30000; t += 50) {
+        EstadoPosicao e;
+        e.t_ms = t;
+        e.x = 100.0 + 20.0 * t / 1000.0;
+        e.y = 105.0;
+        e.v = 20.0;
+        if (supressor.avaliar(e)) {
+            amostrador.posicao(1, serializar_posicao(e, 0), t);
+            ++publicadas;
+        }
+        if (t % AmostradorMapa::PERIODO_MS == 0) {
+            amostrador.amostrar(t);
+            real.amostra(1, e.x, e.y, t);
+        }
+    }
+    EXPECT_LT(publicadas, 40); // ~1 por segundo, não 20
+
+    // Cada célula de 10 px recebe ~0,5 s, como com a trajetória real.
+    for (int col = 11; col < 70; ++col) {
+        EXPECT_NEAR(mapa.valor(0, col, 10, 30000), real.valor(0, col, 10, 30000), 0.15) << "coluna " << col;
+        EXPECT_GT(mapa.valor(0, col, 10, 30000), 0.3) << "coluna " << col;
+    }
+
+    // Sem /posicao por mais que EXPIRA_MS, o caminhão para de somar.
+    auto total = [&](uint64_t t) {
+        double soma = 0.0;
+        for (int col = 0; col < mapa.colunas(); ++col) soma += mapa.valor(0, col, 10, t);
+        return soma;
+    };
+    for (uint64_t t = 30100; t <= 40000; t += AmostradorMapa::PERIODO_MS) amostrador.amostrar(t);
+    const double t40 = total(40000);
+    EXPECT_LE(t40, total(30000) * std::exp(-10.0 / 600.0) + AmostradorMapa::EXPIRA_MS / 1000.0);
+    for (uint64_t t = 40100; t <= 60000; t += AmostradorMapa::PERIODO_MS) amostrador.amostrar(t);
+    EXPECT_NEAR(total(60000), t40 * std::exp(-20.0 / 600.0), 1e-9);
+}
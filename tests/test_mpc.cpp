@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include "MpcVelocidade.h"
+
+// Dinâmica longitudinal de TratamentoSensores_thread: v += accel_scale * u * dt,
+// limitada a [-30, 160] px/s, com passo de simulação de 50 ms. O comando é
+// arredondado e mantido entre ciclos de controle, como em ControleDeNavegacao.
+struct SimLongitudinal
+{
+    double d = 0.0; // distância restante até o setpoint (px)
+    double v = 0.0; // px/s
+
+    void avancar(int u, double dt)
+    {
+        v = std::clamp(v + 0.6 * u * dt, -30.0, 160.0);
+        d -= v * dt;
+    }
+};
+
+TEST(MatrizTest, ProdutoETransposta) {
+    Matriz<2, 3> a;
+    a(0, 0) = 1; a(0, 1) = 2; a(0, 2) = 3;
+    a(1, 0) = 4; a(1, 1) = 5; a(1, 2) = 6;
+    Matriz<3, 2> t = a.transposta();
+    Matriz<2, 2> p = a * t;
+    EXPECT_DOUBLE_EQ(p(0, 0), 14.0);
+    EXPECT_DOUBLE_EQ(p(0, 1), 32.0);
+    EXPECT_DOUBLE_EQ(p(1, 0), 32.0);
+    EXPECT_DOUBLE_EQ(p(1, 1), 77.0);
+    Matriz<2, 2> i = Matriz<2, 2>::identidade();
+    EXPECT_DOUBLE_EQ((p * i)(1, 0), 32.0);
+}
+
+TEST(MpcVelocidadeTest, ChegaEm300pxSemSobressinal) {
+    ParametrosMpc p;
+    MpcVelocidade<20> mpc(p);
+    SimLongitudinal sim;
+    sim.d = 300.0;
+
+    const double dt_sim = 0.05;
+    const int sub = static_cast<int>(std::lround(p.ts / dt_sim));
+    double menor_d = sim.d;
+    double u_max_visto = 0.0;
+    for (int k = 0; k < 300; ++k) { // 30 s
+        const double u = mpc.calcular(sim.d, sim.v);
+        u_max_visto = std::max(u_max_visto, std::abs(u));
+        const int u_i = static_cast<int>(std::round(u));
+        for (int s = 0; s < sub; ++s) {
+            sim.avancar(u_i, dt_sim);
+            menor_d = std::min(menor_d, sim.d);
+        }
+    }
+
+    EXPECT_LE(u_max_visto, p.u_max);
+    EXPECT_GE(menor_d, -0.5) << "passou do setpoint"; // folga do arredondamento de u
+    EXPECT_LT(std::abs(sim.d), 1.0);
+    EXPECT_LT(std::abs(sim.v), 0.5);
+
+    const EstatisticasMpc& e = mpc.estatisticas();
+    EXPECT_EQ(e.solucoes, 300u);
+    EXPECT_EQ(e.estouros, 0u);
+    EXPECT_LE(e.ultimas_iter, p.max_iter);
+}
+
+TEST(MpcVelocidadeTest, ComandoRespeitaACaixa) {
+    ParametrosMpc p;
+    MpcVelocidade<20> mpc(p);
+    // estados extremos: muito longe parado, em cima do alvo a toda velocidade
+    // e depois do alvo andando para trás
+    const double casos[][2] = {{5000.0, 0.0}, {0.0, 160.0}, {10.0, 160.0}, {-50.0, -30.0}};
+    for (const auto& c : casos) {
+        mpc.reiniciar(0.0);
+        for (int k = 0; k < 10; ++k) {
+            const double u = mpc.calcular(c[0], c[1]);
+            EXPECT_LE(std::abs(u), p.u_max) << "d=" << c[0] << " v=" << c[1];
+        }
+    }
+    // freia forte perto do alvo a toda velocidade e acelera longe dele parado
+    mpc.reiniciar(0.0);
+    EXPECT_LT(mpc.calcular(10.0, 160.0), -50.0);
+    mpc.reiniciar(0.0);
+    EXPECT_GT(mpc.calcular(5000.0, 0.0), 50.0);
+}
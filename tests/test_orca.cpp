@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include "Orca.h"
+
+// Integra os agentes com as velocidades do ORCA; retorna a menor distância
+// entre centros observada e deixa os agentes nas posições finais.
+static double simular(std::vector<AgenteOrca>& ag, const std::vector<Vetor2>& alvo, int passos)
+{
+    Orca orca;
+    const double dt = orca.parametros().periodo;
+    std::vector<Vetor2> vel;
+    double menor = 1e9;
+    for (int k = 0; k < passos; ++k) {
+        for (size_t i = 0; i < ag.size(); ++i) {
+            const double dx = alvo[i].x - ag[i].pos.x, dy = alvo[i].y - ag[i].pos.y;
+            const double d = std::hypot(dx, dy);
+            const double v = std::min(ag[i].vel_max, d * 0.4);
+            ag[i].vel_pref = d > 1e-6 ? Vetor2{dx / d * v, dy / d * v} : Vetor2{};
+        }
+        orca.calcular_lote(ag, vel);
+        for (size_t i = 0; i < ag.size(); ++i) {
+            ag[i].vel = vel[i];
+            ag[i].pos.x += vel[i].x * dt;
+            ag[i].pos.y += vel[i].y * dt;
+        }
+        for (size_t i = 0; i < ag.size(); ++i)
+            for (size_t j = i + 1; j < ag.size(); ++j)
+                menor = std::min(menor, std::hypot(ag[i].pos.x - ag[j].pos.x, ag[i].pos.y - ag[j].pos.y));
+    }
+    return menor;
+}
+
+TEST(OrcaTest, FrenteAFrenteSemColisao) {
+    std::vector<AgenteOrca> ag(2);
+    ag[0].pos = {100, 500};
+    ag[1].pos = {900, 500.5};
+    const std::vector<Vetor2> alvo = {{900, 500}, {100, 500}};
+    const double menor = simular(ag, alvo, 400);
+    EXPECT_GE(menor, 2 * ag[0].raio - 0.5);
+    EXPECT_NEAR(ag[0].pos.x, 900, 5);
+    EXPECT_NEAR(ag[1].pos.x, 100, 5);
+}
+
+TEST(OrcaTest, TrocaEmCirculo) {
+    const int n = 12;
+    std::vector<AgenteOrca> ag(n);
+    std::vector<Vetor2> alvo(n);
+    for (int i = 0; i < n; ++i) {
+        const double a = 2 * M_PI * i / n + 0.01 * i; // simetria perfeita trava o ORCA
+        ag[i].id = i;
+        ag[i].pos = {500 + 300 * std::cos(a), 500 + 300 * std::sin(a)};
+        alvo[i] = {500 - 300 * std::cos(a), 500 - 300 * std::sin(a)};
+    }
+    const double menor = simular(ag, alvo, 600);
+    EXPECT_GE(menor, 2 * ag[0].raio - 0.5);
+    for (int i = 0; i < n; ++i)
+        EXPECT_LT(std::hypot(ag[i].pos.x - alvo[i].x, ag[i].pos.y - alvo[i].y), 10.0) << "agente " << i;
+}
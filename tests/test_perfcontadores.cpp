@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include "PerfContadores.h"
+
+// Sem ATR_PERF_COUNTERS=1 os estágios não leem contadores nem acumulam.
+TEST(PerfContadoresTest, DesabilitadoEhNoOp) {
+    if (std::getenv("ATR_PERF_COUNTERS")) GTEST_SKIP() << "ATR_PERF_COUNTERS definido no ambiente";
+    EXPECT_FALSE(PerfContadores::habilitado());
+    std::thread t([] {
+        PerfContadores::nomear_thread("TesteDesab");
+        EstagioPerf externo("externo");
+        {
+            EstagioPerf interno("interno");
+        }
+    });
+    t.join();
+    LeituraPerf soma;
+    uint64_t n = 0;
+    EXPECT_FALSE(PerfContadores::totais("TesteDesab/externo", soma, n));
+    EXPECT_FALSE(PerfContadores::totais("TesteDesab/interno", soma, n));
+    EXPECT_NE(PerfContadores::relatorio().find("desabilitados"), std::string::npos);
+}
+
+// Estágios aninhados acumulam cada um o seu trecho; renomear a thread
+// separa as chaves; o mesmo nome em outro buffer cai na mesma entrada.
+TEST(PerfContadoresTest, AgregaPorThreadEEstagio) {
+    std::thread t([] {
+        PerfContadores::nomear_thread("TesteAgg");
+        LeituraPerf externo{100, 200, 3, 4};
+        LeituraPerf interno{40, 80, 1, 1};
+        PerfContadores::acumular("interno", interno);
+        PerfContadores::acumular("externo", externo);
+        const std::string copia = "externo"; // outro ponteiro, mesmo estágio
+        PerfContadores::acumular(copia.c_str(), externo);
+
+        PerfContadores::nomear_thread("TesteAggB");
+        PerfContadores::acumular("externo", interno);
+    });
+    t.join();
+
+    LeituraPerf s;
+    uint64_t n = 0;
+    ASSERT_TRUE(PerfContadores::totais("TesteAgg/externo", s, n));
+    EXPECT_EQ(n, 2u);
+    EXPECT_EQ(s.ciclos, 200u);
+    EXPECT_EQ(s.instrucoes, 400u);
+    EXPECT_EQ(s.cache_misses, 6u);
+    EXPECT_EQ(s.branch_misses, 8u);
+    ASSERT_TRUE(PerfContadores::totais("TesteAgg/interno", s, n));
+    EXPECT_EQ(n, 1u);
+    EXPECT_EQ(s.ciclos, 40u);
+    ASSERT_TRUE(PerfContadores::totais("TesteAggB/externo", s, n));
+    EXPECT_EQ(n, 1u);
+    EXPECT_EQ(s.instrucoes, 80u);
+}
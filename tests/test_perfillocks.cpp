@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include "JsonSimples.h"
+#include "PerfilLocks.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Objeto JSON do lock 'nome' no relatório ("" se ausente).
+std::string entrada_json(const std::string& rel, const std::string& nome)
+{
+    const size_t i = rel.find("{\"nome\":\"" + nome + "\"");
+    if (i == std::string::npos) return "";
+    return rel.substr(i, rel.find('}', i) - i + 1);
+}
+
+double campo(const std::string& obj, const std::string& chave)
+{
+    double v = -1.0;
+    EXPECT_TRUE(numero_json(obj, chave, v)) << chave << " em " << obj;
+    return v;
+}
+
+} // namespace
+
+TEST(PerfilLocksTest, BucketLog2) {
+    EXPECT_EQ(EstatisticasLock::bucket_de(0), 0);
+    EXPECT_EQ(EstatisticasLock::bucket_de(1), 0);
+    EXPECT_EQ(EstatisticasLock::bucket_de(2), 1);
+    EXPECT_EQ(EstatisticasLock::bucket_de(3), 1);
+    EXPECT_EQ(EstatisticasLock::bucket_de(1023), 9);
+    EXPECT_EQ(EstatisticasLock::bucket_de(1024), 10);
+    // acima de ~2 s tudo cai no último bucket
+    EXPECT_EQ(EstatisticasLock::bucket_de(uint64_t{1} << 40), EstatisticasLock::N_BUCKETS - 1);
+}
+
+TEST(PerfilLocksTest, PercentisEMaximoDoRelatorio) {
+    EstatisticasLock* s = RegistroLocks::instancia().obter("teste::percentis");
+    RegistroLocks::instancia().obter("teste::nunca_usado");
+
+    // 90 esperas de 100 ns ([64, 128)) e 10 de 5000 ns ([4096, 8192))
+    for (int i = 0; i < 90; ++i) s->registrar_espera(100);
+    for (int i = 0; i < 10; ++i) s->registrar_espera(5000);
+    // posse: 100 de 1000 ns ([512, 1024))
+    for (int i = 0; i < 100; ++i) s->registrar_posse(1000);
+    s->aquisicoes.store(100);
+
+    EXPECT_EQ(s->hist_espera[6].load(), 90u);
+    EXPECT_EQ(s->hist_espera[12].load(), 10u);
+    EXPECT_EQ(s->hist_posse[9].load(), 100u);
+    EXPECT_EQ(EstatisticasLock::percentil(s->hist_espera, 0.50), 128u);
+    EXPECT_EQ(EstatisticasLock::percentil(s->hist_espera, 0.99), 8192u);
+
+    const std::string rel = RegistroLocks::instancia().relatorio_json();
+    const std::string obj = entrada_json(rel, "teste::percentis");
+    ASSERT_FALSE(obj.empty()) << rel;
+    EXPECT_EQ(campo(obj, "aq"), 100);
+    EXPECT_EQ(campo(obj, "espera_total_ns"), 90 * 100 + 10 * 5000);
+    EXPECT_EQ(campo(obj, "espera_p50_ns"), 128);
+    EXPECT_EQ(campo(obj, "espera_p99_ns"), 8192);
+    EXPECT_EQ(campo(obj, "espera_max_ns"), 5000);
+    EXPECT_EQ(campo(obj, "posse_p50_ns"), 1024);
+    EXPECT_EQ(campo(obj, "posse_p99_ns"), 1024);
+    EXPECT_EQ(campo(obj, "posse_max_ns"), 1000);
+    // locks sem aquisição ficam fora do relatório
+    EXPECT_TRUE(entrada_json(rel, "teste::nunca_usado").empty());
+}
+
+TEST(PerfilLocksTest, HistogramaVazio) {
+    EstatisticasLock::Histograma h{};
+    EXPECT_EQ(EstatisticasLock::percentil(h, 0.5), 0u);
+}
+
+TEST(PerfilLocksTest, MutexInstrumentadoMedeContencao) {
+    ASSERT_TRUE(RegistroLocks::instancia().ativo());
+    MutexInstrumentado m("teste::contencao");
+    EstatisticasLock* s = RegistroLocks::instancia().obter("teste::contencao");
+
+    m.lock();
+    std::thread t([&] {
+        m.lock(); // espera a posse da thread principal
+        m.unlock();
+    });
+    std::this_thread::sleep_for(20ms);
+    m.unlock();
+    t.join();
+
+    EXPECT_EQ(s->aquisicoes.load(), 2u);
+    EXPECT_EQ(s->contendidas.load(), 1u);
+    EXPECT_GE(s->espera_max_ns.load(), 5'000'000u); // ~20 ms, com folga
+    EXPECT_GE(s->posse_max_ns.load(), 5'000'000u);
+    uint64_t soma = 0;
+    for (const auto& b : s->hist_espera) soma += b.load();
+    EXPECT_EQ(soma, 2u); // uma amostra de espera por aquisição
+
+    // desligado em tempo de execução: nada é contado
+    RegistroLocks::instancia().set_ativo(false);
+    m.lock();
+    m.unlock();
+    RegistroLocks::instancia().set_ativo(true);
+    EXPECT_EQ(s->aquisicoes.load(), 2u);
+}
@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include "ReconstrucaoPosicao.h"
+
+// Trajetória de teste: reta, curva com taxa variável e nova reta, a 50 ms.
+static EstadoPosicao trajetoria(uint64_t t_ms)
+{
+    static EstadoPosicao e;
+    static uint64_t ultimo = 0;
+    if (t_ms == 0) { e = EstadoPosicao{}; e.x = 100; e.y = 100; e.v = 60; e.com_modelo = true; ultimo = 0; return e; }
+    const double dt = (t_ms - ultimo) / 1000.0;
+    ultimo = t_ms;
+    e.taxa = (t_ms > 4000 && t_ms < 8000) ? 20.0 * std::sin(t_ms / 700.0) : 0.0;
+    e = extrapolar(e, dt);
+    e.t_ms = t_ms;
+    return e;
+}
+
+TEST(ReconstrucaoTest, ErroLimitadoPelaTolerancia) {
+    const double tol = 3.0;
+    SupressorPosicao sup(tol, 1000);
+    ReconstrutorPosicao rec;
+    for (uint64_t t = 0; t <= 12000; t += 50) {
+        const EstadoPosicao real = trajetoria(t);
+        if (sup.avaliar(real)) {
+            ASSERT_TRUE(rec.atualizar(serializar_posicao(real, 0), t));
+        }
+        const EstadoPosicao est = rec.em(t);
+        EXPECT_LE(std::hypot(est.x - real.x, est.y - real.y), tol) << "t=" << t;
+    }
+    // trechos previsíveis: ao menos uma ordem de grandeza menos mensagens
+    EXPECT_GT(sup.suprimidas(), 9 * sup.enviadas());
+}
+
+TEST(ReconstrucaoTest, PayloadAntigoSemExtrapolacao) {
+    ReconstrutorPosicao rec;
+    ASSERT_TRUE(rec.atualizar("{\"x\":10,\"y\":20,\"ang\":90}", 0));
+    const EstadoPosicao e = rec.em(500);
+    EXPECT_DOUBLE_EQ(e.x, 10.0);
+    EXPECT_DOUBLE_EQ(e.y, 20.0);
+    EXPECT_FALSE(rec.atualizar("{\"ang\":90}", 0));
+}
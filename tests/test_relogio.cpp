@@ -0,0 +1,26 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdlib>
+#include "Relogio.h"
+
+TEST(RelogioTest, MonotonicoAcompanhaSteadyClock) {
+    using namespace std::chrono;
+    Relogio::calibrar();
+    int64_t anterior = Relogio::mono_ns();
+    const auto fim = steady_clock::now() + milliseconds(1200); // passa por uma recalibração
+    while (steady_clock::now() < fim) {
+        const int64_t t = Relogio::mono_ns();
+        ASSERT_GE(t, anterior);
+        anterior = t;
+    }
+    const int64_t steady = duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+    EXPECT_LT(std::llabs(Relogio::mono_ns() - steady), 1000000); // mesma origem, < 1 ms
+}
+
+TEST(RelogioTest, CarimboUnixAcompanhaSystemClock) {
+    using namespace std::chrono;
+    const Carimbo c = Relogio::agora();
+    const int64_t parede = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+    EXPECT_GE(c.unix_ms(), Relogio::UNIX_MS_MINIMO);
+    EXPECT_LT(std::llabs(c.unix_ms() - parede), 5);
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include "PoliticaRitmo.h"
+
+namespace {
+
+EntradaRitmo manual_parado(double x = 100.0, double y = 100.0)
+{
+    EntradaRitmo e;
+    e.x = x;
+    e.y = y;
+    return e;
+}
+
+EntradaRitmo reta(uint64_t t_ms)
+{
+    EntradaRitmo e;
+    e.automatico = true;
+    e.x = 100.0 + 0.05 * t_ms; // 50 px/s
+    e.y = 300.0;
+    e.velocidade = 50.0;
+    e.dist_alvo = 500.0;
+    e.erro_rumo = 2.0;
+    return e;
+}
+
+} // namespace
+
+TEST(PoliticaRitmoTest, HibernaParadoEAcordaComComando) {
+    PoliticaRitmo p;
+    uint64_t t = 0;
+    // Ruído de posição dentro de RAIO_PARADO não reinicia a contagem.
+    for (; t < PoliticaRitmo::PARADO_MS; t += 100) {
+        const double ruido = (t / 100 % 2) ? 2.0 : -2.0;
+        EXPECT_EQ(p.avaliar(manual_parado(100.0 + ruido), t, 0), RegimeRitmo::Normal) << t;
+    }
+    EXPECT_EQ(p.avaliar(manual_parado(), t, 0), RegimeRitmo::Hibernando);
+
+    // Comando pressionado: sai na hora.
+    EntradaRitmo cmd = manual_parado();
+    cmd.comandos_ativos = true;
+    EXPECT_EQ(p.avaliar(cmd, t += 100, 0), RegimeRitmo::Normal);
+
+    // Logo após um despertar não volta a hibernar antes de PARADO_MS.
+    const uint64_t despertar = t;
+    EXPECT_EQ(p.avaliar(manual_parado(), t += 100, despertar), RegimeRitmo::Normal);
+    EXPECT_EQ(p.avaliar(manual_parado(), despertar + PoliticaRitmo::PARADO_MS - 1, despertar), RegimeRitmo::Normal);
+    EXPECT_EQ(p.avaliar(manual_parado(), despertar + PoliticaRitmo::PARADO_MS, despertar), RegimeRitmo::Hibernando);
+
+    // Saiu do círculo de parado: volta ao Normal e recomeça a contagem.
+    t = despertar + PoliticaRitmo::PARADO_MS + 100;
+    EXPECT_EQ(p.avaliar(manual_parado(120.0), t, despertar), RegimeRitmo::Normal);
+    EXPECT_EQ(p.avaliar(manual_parado(120.0), t + PoliticaRitmo::PARADO_MS - 100, despertar), RegimeRitmo::Normal);
+    EXPECT_EQ(p.avaliar(manual_parado(120.0), t + PoliticaRitmo::PARADO_MS, despertar), RegimeRitmo::Hibernando);
+}
+
+TEST(PoliticaRitmoTest, RetaSoDepoisDeEstavel) {
+    PoliticaRitmo p;
+    const uint64_t t0 = 10000;
+    EXPECT_EQ(p.avaliar(reta(t0), t0, 0), RegimeRitmo::Normal);
+    EXPECT_EQ(p.avaliar(reta(t0 + 500), t0 + 500, 0), RegimeRitmo::Normal);
+    EXPECT_EQ(p.avaliar(reta(t0 + PoliticaRitmo::ESTAVEL_MS - 1), t0 + PoliticaRitmo::ESTAVEL_MS - 1, 0),
+              RegimeRitmo::Normal);
+    EXPECT_EQ(p.avaliar(reta(t0 + PoliticaRitmo::ESTAVEL_MS), t0 + PoliticaRitmo::ESTAVEL_MS, 0), RegimeRitmo::Reta);
+
+    // Rumo desalinhado interrompe a reta; realinhado, a espera recomeça.
+    uint64_t t = t0 + 2000;
+    EntradaRitmo curva = reta(t);
+    curva.erro_rumo = 20.0;
+    EXPECT_EQ(p.avaliar(curva, t, 0), RegimeRitmo::Normal);
+    t += 100;
+    EXPECT_EQ(p.avaliar(reta(t), t, 0), RegimeRitmo::Normal);
+    EXPECT_EQ(p.avaliar(reta(t + PoliticaRitmo::ESTAVEL_MS - 1), t + PoliticaRitmo::ESTAVEL_MS - 1, 0),
+              RegimeRitmo::Normal);
+    EXPECT_EQ(p.avaliar(reta(t + PoliticaRitmo::ESTAVEL_MS), t + PoliticaRitmo::ESTAVEL_MS, 0), RegimeRitmo::Reta);
+
+    // Vizinho próximo tem prioridade e não espera; defeito fixa o Normal.
+    t += 2000;
+    EntradaRitmo viz = reta(t);
+    viz.dist_vizinho = PoliticaRitmo::RAIO_VIZINHO - 1.0;
+    EXPECT_EQ(p.avaliar(viz, t, 0), RegimeRitmo::Atencao);
+    EntradaRitmo def = reta(t + 100);
+    def.defeito = true;
+    EXPECT_EQ(p.avaliar(def, t + 100, 0), RegimeRitmo::Normal);
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include "RegistroRpc.h"
+
+namespace {
+
+const std::string RESPOSTA = "/mina/rpc/teste/resposta";
+
+std::string pedido(const std::string& id, const std::string& metodo, const std::string& extra = "")
+{
+    return "{\"id\":\"" + id + "\",\"metodo\":\"" + metodo + "\",\"resposta\":\"" + RESPOSTA + "\"" + extra + "}";
+}
+
+} // namespace
+
+TEST(RegistroRpcTest, RepeticaoDevolveRespostaGuardada) {
+    RegistroRpc reg;
+    int chamadas = 0;
+    reg.registrar("set-config", [&](const std::string& params) {
+        ++chamadas;
+        return RespostaRpc::sucesso(params);
+    });
+
+    std::string topico, r1, r2;
+    ASSERT_TRUE(reg.tratar(pedido("c1", "set-config", ",\"params\":{\"kpi_periodo_s\":5}"), 0, topico, r1));
+    EXPECT_EQ(topico, RESPOSTA);
+    EXPECT_EQ(r1, "{\"id\":\"c1\",\"ok\":true,\"resultado\":{\"kpi_periodo_s\":5}}");
+
+    // Retentativa com o mesmo id: mesma resposta, manipulador não roda de novo.
+    ASSERT_TRUE(reg.tratar(pedido("c1", "set-config", ",\"params\":{\"kpi_periodo_s\":9}"), 0, topico, r2));
+    EXPECT_EQ(r2, r1);
+    EXPECT_EQ(chamadas, 1);
+    EXPECT_EQ(reg.repetidos(), 1u);
+    EXPECT_EQ(reg.atendidos(), 1u);
+}
+
+TEST(RegistroRpcTest, CacheSeparaClientesEMetodos) {
+    RegistroRpc reg;
+    int chamadas = 0;
+    reg.registrar("kpi", [&](const std::string&) { ++chamadas; return RespostaRpc::sucesso("1"); });
+    reg.registrar("snapshot", [&](const std::string&) { ++chamadas; return RespostaRpc::sucesso("2"); });
+
+    std::string topico, r;
+    ASSERT_TRUE(reg.tratar(pedido("x1", "kpi"), 0, topico, r));
+    EXPECT_EQ(chamadas, 1);
+
+    // Mesmo id vindo de outro cliente (outro tópico de resposta): executa.
+    const std::string outro = "{\"id\":\"x1\",\"metodo\":\"kpi\",\"resposta\":\"/mina/rpc/outro/resposta\"}";
+    ASSERT_TRUE(reg.tratar(outro, 0, topico, r));
+    EXPECT_EQ(topico, "/mina/rpc/outro/resposta");
+    EXPECT_EQ(chamadas, 2);
+
+    // Mesmo cliente e id, método diferente: não é retentativa.
+    ASSERT_TRUE(reg.tratar(pedido("x1", "snapshot"), 0, topico, r));
+    EXPECT_EQ(r, "{\"id\":\"x1\",\"ok\":true,\"resultado\":2}");
+    EXPECT_EQ(chamadas, 3);
+
+    // A entrada passa a ser a do último método.
+    ASSERT_TRUE(reg.tratar(pedido("x1", "snapshot"), 0, topico, r));
+    EXPECT_EQ(chamadas, 3);
+    EXPECT_EQ(reg.repetidos(), 1u);
+    EXPECT_EQ(reg.atendidos(), 3u);
+}
+
+TEST(RegistroRpcTest, PrazoVencidoDescarta) {
+    RegistroRpc reg;
+    bool chamado = false;
+    reg.registrar("get-state", [&](const std::string&) { chamado = true; return RespostaRpc::sucesso("{}"); });
+
+    std::string topico, resposta;
+    EXPECT_FALSE(reg.tratar(pedido("c2", "get-state", ",\"prazo\":999"), 1000, topico, resposta));
+    EXPECT_FALSE(chamado);
+    EXPECT_EQ(reg.vencidos(), 1u);
+    EXPECT_TRUE(reg.tratar(pedido("c3", "get-state", ",\"prazo\":1000"), 1000, topico, resposta));
+    EXPECT_TRUE(chamado);
+
+    // Sem tópico de resposta não há a quem responder.
+    EXPECT_FALSE(reg.tratar("{\"id\":\"c4\",\"metodo\":\"get-state\"}", 0, topico, resposta));
+}
+
+TEST(RegistroRpcTest, MetodoDesconhecido) {
+    RegistroRpc reg;
+    std::string topico, resposta;
+    ASSERT_TRUE(reg.tratar(pedido("c5", "reboot"), 0, topico, resposta));
+    EXPECT_EQ(resposta, "{\"id\":\"c5\",\"ok\":false,\"erro\":\"metodo desconhecido: reboot\"}");
+}
+
+TEST(RegistroRpcTest, ExcecaoDoManipuladorViraErro) {
+    RegistroRpc reg;
+    reg.registrar("falha", [](const std::string&) -> RespostaRpc { throw std::runtime_error("disco \"cheio\""); });
+    reg.registrar("estranho", [](const std::string&) -> RespostaRpc { throw 42; });
+
+    std::string topico, resposta;
+    ASSERT_TRUE(reg.tratar(pedido("c6", "falha"), 0, topico, resposta));
+    EXPECT_EQ(resposta, "{\"id\":\"c6\",\"ok\":false,\"erro\":\"excecao: disco \\\"cheio\\\"\"}");
+    ASSERT_TRUE(reg.tratar(pedido("c7", "estranho"), 0, topico, resposta));
+    EXPECT_NE(resposta.find("\"ok\":false"), std::string::npos);
+}
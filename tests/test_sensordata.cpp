@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include "SensorData.h"
+#include "Sensores.h"
+
+TEST(SensorDataV2Test, LayoutCompacto) {
+    EXPECT_LT(sizeof(SensorDataV2), 24u);
+    SensorDataV2 s;
+    EXPECT_EQ(s.versao, SensorDataV2::VERSAO);
+}
+
+TEST(SensorDataV2Test, ConversaoIdaEVolta) {
+    SensorData v1;
+    v1.timestamp_ms = 123456789ull;
+    v1.i_posicao_x = 812;
+    v1.i_posicao_y = 17;
+    v1.i_angulo_x = 359;
+    v1.i_temperatura = 97;
+    v1.i_falha_hidraulica = true;
+
+    SensorDataV2 v2 = para_v2(v1, 42);
+    EXPECT_EQ(v2.seq, 42u);
+    EXPECT_DOUBLE_EQ(v2.x(), 812.0);
+    EXPECT_DOUBLE_EQ(v2.angulo(), 359.0);
+    EXPECT_FALSE(v2.falha_eletrica());
+    EXPECT_TRUE(v2.falha_hidraulica());
+
+    SensorData back = para_v1(v2);
+    EXPECT_EQ(back.timestamp_ms, v1.timestamp_ms);
+    EXPECT_EQ(back.i_posicao_x, 812);
+    EXPECT_EQ(back.i_posicao_y, 17);
+    EXPECT_EQ(back.i_angulo_x, 359);
+    EXPECT_EQ(back.i_temperatura, 97);
+    EXPECT_TRUE(back.i_falha_hidraulica);
+}
+
+TEST(SensorDataV2Test, SaturacaoEPrecisao) {
+    SensorDataV2 s;
+    s.set_x(-5.0);
+    EXPECT_DOUBLE_EQ(s.x(), 0.0);
+    s.set_y(100.25);
+    EXPECT_DOUBLE_EQ(s.y(), 100.25);   // 1/64 px representa 0.25 exatamente
+    s.set_angulo(-90.0);
+    EXPECT_DOUBLE_EQ(s.angulo(), 270.0);
+    s.set_angulo(359.999);
+    EXPECT_DOUBLE_EQ(s.angulo(), 0.0);
+}
+
+TEST(SensorDataV2Test, LacunasDeSequencia) {
+    EXPECT_EQ(seq_lacuna(10, 11), 0u);
+    EXPECT_EQ(seq_lacuna(10, 14), 3u);
+    EXPECT_EQ(seq_lacuna(0xFFFFFFFFu, 1), 1u);  // wrap-around
+    EXPECT_TRUE(seq_nova(0xFFFFFFFFu, 0));
+    EXPECT_FALSE(seq_nova(10, 10));              // duplicata
+    EXPECT_FALSE(seq_nova(10, 9));               // reordenada
+}
+
+TEST(SensorDataV2Test, FiltroPreservaSubPixel) {
+    Sensores f(2);
+    SensorData a; a.i_posicao_x = 10;
+    SensorData b; b.i_posicao_x = 11;
+    f.filtrar_v2(a, 1);
+    SensorDataV2 out = f.filtrar_v2(b, 2);
+    EXPECT_DOUBLE_EQ(out.x(), 10.5);
+    EXPECT_EQ(out.seq, 2u);
+}
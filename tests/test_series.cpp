@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include "SerieTemporal.h"
+
+namespace {
+
+// Amostra i no instante 1000 + 50·i com x = i e temp = i % 10.
+void preenche(ArmazemSeries& a, int truck, int de, int ate)
+{
+    for (int i = de; i < ate; ++i) {
+        const float v[SerieCaminhao::NUM_CAMPOS] = {static_cast<float>(i), 0.0f, 0.0f, static_cast<float>(i % 10)};
+        a.adicionar(truck, 1000 + 50LL * i, v);
+    }
+}
+
+} // namespace
+
+TEST(SerieTemporalTest, AgregaAtravesDaVoltaDoAnel) {
+    ArmazemSeries a(1000);
+    preenche(a, 1, 0, 2500); // anel deu a volta: ficam as amostras 1500..2499
+
+    ResultadoSerie r;
+    ASSERT_TRUE(a.consultar(1, 0, 1000000, {CampoSerie::X, CampoSerie::Temp}, 1000, AgregacaoSerie::Media, r));
+    EXPECT_EQ(r.passo, 1000);
+    ASSERT_EQ(r.t.size(), 50u); // 20 amostras por balde de 1 s
+    for (size_t k = 0; k < r.t.size(); ++k) {
+        const int primeira = 1500 + 20 * static_cast<int>(k);
+        EXPECT_EQ(r.t[k], 1000 + 50LL * primeira);
+        EXPECT_DOUBLE_EQ(r.valores[0][k], primeira + 9.5);
+        EXPECT_DOUBLE_EQ(r.valores[1][k], 4.5);
+    }
+
+    ASSERT_TRUE(a.consultar(1, 1000 + 50 * 1990, 1000 + 50 * 2010, {CampoSerie::X}, 0, AgregacaoSerie::Media, r));
+    EXPECT_EQ(r.passo, 0);
+    ASSERT_EQ(r.t.size(), 21u);
+    EXPECT_DOUBLE_EQ(r.valores[0].front(), 1990);
+    EXPECT_DOUBLE_EQ(r.valores[0].back(), 2010);
+
+    ASSERT_TRUE(a.consultar(1, 0, 1000000, {CampoSerie::X}, 5000, AgregacaoSerie::Min, r));
+    EXPECT_DOUBLE_EQ(r.valores[0].front(), 1500);
+    ASSERT_TRUE(a.consultar(1, 0, 1000000, {CampoSerie::X}, 5000, AgregacaoSerie::Max, r));
+    EXPECT_DOUBLE_EQ(r.valores[0].back(), 2499);
+    ASSERT_TRUE(a.consultar(1, 0, 1000000, {CampoSerie::X}, 5000, AgregacaoSerie::Contagem, r));
+    double n = 0;
+    for (double c : r.valores[0]) n += c;
+    EXPECT_EQ(n, 1000);
+
+    EXPECT_FALSE(a.consultar(2, 0, 1000000, {CampoSerie::X}, 0, AgregacaoSerie::Media, r));
+}
+
+TEST(SerieTemporalTest, LimitaPontosERespondeJson) {
+    ArmazemSeries a(20000);
+    preenche(a, 3, 0, 12000); // 10 min a 20 Hz
+
+    ResultadoSerie r;
+    ASSERT_TRUE(a.consultar(3, 0, 10000000, {CampoSerie::X}, 0, AgregacaoSerie::Ultimo, r));
+    EXPECT_GT(r.passo, 0);
+    EXPECT_LE(r.t.size(), ArmazemSeries::MAX_PONTOS);
+    EXPECT_DOUBLE_EQ(r.valores[0].back(), 11999);
+
+    std::string id;
+    const int64_t agora = 1000 + 50LL * 12000;
+    std::string resp = responder_consulta_series(
+        a, R"({"id":"g1","truck":3,"campos":"temp","ultimos_ms":1000,"passo":500,"agg":"max"})", agora, id);
+    EXPECT_EQ(id, "g1");
+    EXPECT_EQ(resp, "{\"id\":\"g1\",\"truck\":3,\"agg\":\"max\",\"passo\":500,\"agora\":601000,"
+                    "\"t\":[600000,600500],\"temp\":[9,9]}");
+
+    resp = responder_consulta_series(a, R"({"id":"g2","truck":3,"campos":"vel"})", agora, id);
+    EXPECT_NE(resp.find("\"erro\""), std::string::npos);
+}
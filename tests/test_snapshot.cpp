@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "EstadoSnapshot.h"
+#include "JsonSimples.h"
+
+namespace {
+
+Route rota_de(std::initializer_list<Waypoint> wps)
+{
+    Route r;
+    for (const auto& w : wps) r.addWaypoint(w);
+    return r;
+}
+
+} // namespace
+
+TEST(SnapshotTest, SerializarMesmasChavesDoEstado) {
+    SnapshotCaminhao s;
+    s.automatico = true;
+    s.alerta_temp = true;
+    s.rota_versao = 2;
+    s.waypoints = 5;
+    s.waypoint = 1;
+    s.ultima_falha = "FALHA \"ELETRICA\"";
+    s.falha_ts = 123;
+    EXPECT_EQ(s.serializar(),
+              "{\"automatico\":1,\"defeito\":0,\"alerta_temp\":1,\"rota_versao\":2,"
+              "\"waypoints\":5,\"waypoint\":1,\"ultima_falha\":\"FALHA \\\"ELETRICA\\\"\","
+              "\"falha_ts\":123}");
+    double v = -1;
+    EXPECT_TRUE(numero_json(s.serializar(), "waypoints", v));
+    EXPECT_EQ(v, 5);
+    EXPECT_EQ(topico_snapshot(3), "/mina/caminhoes/3/snapshot");
+    EXPECT_EQ(topico_rota_atual(3), "/mina/caminhoes/3/rota_atual");
+}
+
+TEST(SnapshotTest, PendenteSoQuandoMuda) {
+    EstadoSnapshot e;
+    EXPECT_TRUE(e.pendente()); // o primeiro snapshot sempre sai
+    e.marcar_publicado();
+    EXPECT_FALSE(e.pendente());
+
+    e.estado(false, false, false); // igual ao publicado
+    e.waypoint(0);
+    EXPECT_FALSE(e.pendente());
+
+    e.estado(true, false, false);
+    EXPECT_TRUE(e.pendente());
+    e.marcar_publicado();
+    e.estado(true, false, false);
+    EXPECT_FALSE(e.pendente());
+
+    // mudou e voltou antes de publicar: nada a publicar
+    e.waypoint(4);
+    e.waypoint(0);
+    EXPECT_FALSE(e.pendente());
+}
+
+TEST(SnapshotTest, FalhaSoNoInicioDeOutraFalha) {
+    EstadoSnapshot e;
+    e.marcar_publicado();
+
+    e.falhas("", 10); // sem falha
+    EXPECT_FALSE(e.pendente());
+
+    e.falhas("FALHA_ELETRICA", 100);
+    EXPECT_EQ(e.atual().ultima_falha, "FALHA_ELETRICA");
+    EXPECT_EQ(e.atual().falha_ts, 100u);
+    e.marcar_publicado();
+
+    // a mesma falha ainda ativa não muda o instante
+    e.falhas("FALHA_ELETRICA", 200);
+    EXPECT_FALSE(e.pendente());
+    EXPECT_EQ(e.atual().falha_ts, 100u);
+
+    // fim da falha: ultima_falha permanece
+    e.falhas("", 300);
+    EXPECT_FALSE(e.pendente());
+    EXPECT_EQ(e.atual().ultima_falha, "FALHA_ELETRICA");
+
+    // a mesma falha de novo é um novo início
+    e.falhas("FALHA_ELETRICA", 400);
+    EXPECT_TRUE(e.pendente());
+    EXPECT_EQ(e.atual().falha_ts, 400u);
+    e.marcar_publicado();
+
+    e.falhas("FALHA_HIDRAULICA", 500);
+    EXPECT_EQ(e.atual().ultima_falha, "FALHA_HIDRAULICA");
+    EXPECT_EQ(e.atual().falha_ts, 500u);
+}
+
+TEST(SnapshotTest, VersaoSoComRotaDiferente) {
+    EstadoSnapshot e;
+    const Route a = rota_de({Waypoint(10, 20, 1.0), Waypoint(30, 40, 1.0)});
+    const Route b = rota_de({Waypoint(10, 20, 1.0), Waypoint(30, 41, 1.0), Waypoint(50, 60, 0.5)});
+
+    EXPECT_TRUE(e.rota(a));
+    EXPECT_EQ(e.atual().rota_versao, 1u);
+    EXPECT_EQ(e.atual().waypoints, 2u);
+    EXPECT_EQ(e.rota_texto(), texto_rota(a));
+    e.waypoint(1);
+    e.marcar_publicado();
+
+    // mesma rota (outra instância, mesmo conteúdo): nada muda
+    EXPECT_FALSE(e.rota(rota_de({Waypoint(10, 20, 1.0), Waypoint(30, 40, 1.0)})));
+    EXPECT_EQ(e.atual().rota_versao, 1u);
+    EXPECT_EQ(e.atual().waypoint, 1u);
+    EXPECT_FALSE(e.pendente());
+
+    EXPECT_TRUE(e.rota(b));
+    EXPECT_EQ(e.atual().rota_versao, 2u);
+    EXPECT_EQ(e.atual().waypoints, 3u);
+    EXPECT_EQ(e.atual().waypoint, 0u); // rota nova recomeça
+    EXPECT_TRUE(e.pendente());
+
+    // voltar à rota anterior também é uma versão nova
+    EXPECT_TRUE(e.rota(a));
+    EXPECT_EQ(e.atual().rota_versao, 3u);
+}
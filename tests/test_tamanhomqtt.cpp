@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "TamanhoMqtt.h"
+
+TEST(TamanhoMqttTest, Varint) {
+    EXPECT_EQ(TamanhoMqtt::varint(0), 1u);
+    EXPECT_EQ(TamanhoMqtt::varint(127), 1u);
+    EXPECT_EQ(TamanhoMqtt::varint(128), 2u);
+    EXPECT_EQ(TamanhoMqtt::varint(16383), 2u);
+    EXPECT_EQ(TamanhoMqtt::varint(16384), 3u);
+}
+
+// Amostra típica de /sensores: a economia do alias é quase toda consumida
+// pelas propriedades que vão em cada mensagem.
+TEST(TamanhoMqttTest, SensoresComAliasContraTresPontoUm) {
+    const std::string topico = "/mina/caminhoes/12/sensores";
+    const std::string payload = "{\"x\":512,\"y\":300,\"ang\":90,\"temp\":85,\"ts\":1760000000000}";
+    ASSERT_EQ(topico.size(), 27u);
+    ASSERT_EQ(payload.size(), 55u);
+
+    // 3.1.1: 1 + varint(84) + (2 + 27 + 55)
+    const size_t v311 = TamanhoMqtt::publish(topico.size(), payload.size(), false);
+    EXPECT_EQ(v311, 86u);
+
+    // v5 em regime: só o alias, seq de 5 dígitos e expiração
+    const size_t props = TamanhoMqtt::PROP_ALIAS + TamanhoMqtt::prop_usuario("seq", "12345")
+                       + TamanhoMqtt::PROP_EXPIRA;
+    EXPECT_EQ(props, 3u + 13u + 5u);
+    const size_t v5 = TamanhoMqtt::publish(0, payload.size(), true, props);
+    EXPECT_EQ(v5, 81u);
+
+    // repetir "v" a cada mensagem tornaria o v5 maior que o 3.1.1
+    const size_t com_v = TamanhoMqtt::publish(0, payload.size(), true, props + TamanhoMqtt::prop_usuario("v", "1"));
+    EXPECT_EQ(com_v, 88u);
+    EXPECT_GT(com_v, v311);
+}
+
+TEST(TamanhoMqttTest, RemainingLengthDeDoisBytes) {
+    // 2 + 10 + 200 = 212 >= 128: o cabeçalho fixo passa a 3 bytes
+    EXPECT_EQ(TamanhoMqtt::publish(10, 200, false), 1u + 2u + 212u);
+    // QoS > 0 leva o identificador do pacote
+    EXPECT_EQ(TamanhoMqtt::publish(10, 20, false, 0, 1), 1u + 1u + 34u);
+}
+
+// Sem x/y no /sensores (a posição só vai no /posicao suprimido): 16 bytes a
+// menos por amostra, 320 B/s por caminhão a 20 Hz.
+TEST(TamanhoMqttTest, SensoresSemPosicao) {
+    const std::string com_xy = "{\"x\":512,\"y\":300,\"ang\":90,\"temp\":85,\"ts\":1760000000000}";
+    const std::string sem_xy = "{\"ang\":90,\"temp\":85,\"ts\":1760000000000}";
+    ASSERT_EQ(sem_xy.size(), 39u);
+    EXPECT_EQ(TamanhoMqtt::publish(27, com_xy.size(), false) - TamanhoMqtt::publish(27, sem_xy.size(), false), 16u);
+    EXPECT_EQ(TamanhoMqtt::publish(27, sem_xy.size(), false), 70u);
+}